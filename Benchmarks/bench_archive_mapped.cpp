@@ -0,0 +1,108 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// ON_BinaryFile vs ON_MappedFileArchive on a 3dm file.
+//
+//   bench_archive_mapped model.3dm
+//
+// For each archive the output has the best of 3 times to read every
+// byte of the file with ReadByte() in 1 MB blocks and to read the model
+// with ONX_Model::Read(). The first pass loads the file into the
+// operating system's file cache, so the times do not include disk reads.
+// Use a large model; the request this answers was about 2 to 4 GB files.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+static bool BenchReadBytes(ON_BinaryArchive& archive, ON__UINT64 size)
+{
+  ON_SimpleArray<ON__UINT8> buffer(1 << 20);
+  buffer.SetCount(1 << 20);
+  while (size > 0)
+  {
+    const size_t count = (size < (ON__UINT64)buffer.UnsignedCount()) ? (size_t)size : buffer.UnsignedCount();
+    if (false == archive.ReadByte(count, buffer.Array()))
+      return false;
+    size -= count;
+  }
+  return true;
+}
+
+static bool BenchReadModel(ON_BinaryArchive& archive)
+{
+  ONX_Model model;
+  return model.Read(archive);
+}
+
+int main(int argc, const char* argv[])
+{
+  if (argc < 2)
+  {
+    printf("Usage: bench_archive_mapped model.3dm\n");
+    return 1;
+  }
+  const char* path = argv[1];
+
+  ON__UINT64 size = 0;
+  {
+    ON_MappedFileArchive archive(path);
+    if (false == archive.IsOpen())
+    {
+      printf("%s could not be mapped.\n", path);
+      return 1;
+    }
+    size = archive.MappedSize();
+  }
+
+  bool rc = true;
+  const double file_bytes_ms = BenchBestTime(3,
+    [&]()
+    {
+      FILE* fp = ON_FileStream::Open(path, "rb");
+      ON_BinaryFile archive(ON::archive_mode::read, fp);
+      rc = (nullptr != fp) && BenchReadBytes(archive, size) && rc;
+      ON_FileStream::Close(fp);
+    }
+  );
+  const double mapped_bytes_ms = BenchBestTime(3,
+    [&]()
+    {
+      ON_MappedFileArchive archive(path);
+      rc = BenchReadBytes(archive, size) && rc;
+    }
+  );
+  const double file_model_ms = BenchBestTime(3,
+    [&]()
+    {
+      FILE* fp = ON_FileStream::Open(path, "rb");
+      ON_BinaryFile archive(ON::archive_mode::read3dm, fp);
+      rc = (nullptr != fp) && BenchReadModel(archive) && rc;
+      ON_FileStream::Close(fp);
+    }
+  );
+  const double mapped_model_ms = BenchBestTime(3,
+    [&]()
+    {
+      ON_MappedFileArchive archive(path);
+      rc = BenchReadModel(archive) && rc;
+    }
+  );
+  if (false == rc)
+    printf("A read failed.\n");
+
+  printf("%s, %.1f MB\n", path, size / 1048576.0);
+  printf("%-16s %14s %14s\n", "", "ON_BinaryFile", "Mapped");
+  printf("%-16s %11.1f ms %11.1f ms\n", "ReadByte()", file_bytes_ms, mapped_bytes_ms);
+  printf("%-16s %11.1f ms %11.1f ms\n", "ONX_Model::Read", file_model_ms, mapped_model_ms);
+  return rc ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// ON_BrepParallelMesher::CreateMesh() scaling from 1 to 32 threads.
+//
+//   bench_brep_parallel_mesh model.3dm [model2.3dm ...]
+//
+// Every brep, and every object with a brep form, in the models is meshed
+// with ON_MeshParameters::DefaultMesh. Thread counts above the number of
+// hardware threads are not run. For each thread count, the output has the
+// best of 3 times to mesh every brep, the speedup and parallel efficiency
+// relative to 1 thread, and whether the meshes are identical to the
+// 1 thread meshes.
+//
+// In OPENNURBS_PLUS builds the faces are meshed with
+// ON_BrepFace::CreateMesh(). Otherwise each face's surface is sampled on
+// a 64 x 64 grid, ignoring trims, which measures the threading and
+// stitching but not a real face mesher.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+#if !defined(OPENNURBS_PLUS)
+static ON_Mesh* BenchGridFaceMesher(const ON_BrepFace& face, const ON_MeshParameters&)
+{
+  const int n = 64;
+  const ON_Interval udom = face.Domain(0);
+  const ON_Interval vdom = face.Domain(1);
+  ON_Mesh* mesh = new ON_Mesh(n * n, (n + 1) * (n + 1), false, false);
+  for (int i = 0; i <= n; ++i)
+  {
+    const double u = udom.ParameterAt(((double)i) / n);
+    for (int j = 0; j <= n; ++j)
+      mesh->m_V.Append(ON_3fPoint(face.PointAt(u, vdom.ParameterAt(((double)j) / n))));
+  }
+  for (int i = 0; i < n; ++i)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      const int v0 = i * (n + 1) + j;
+      mesh->SetQuad(mesh->m_F.Count(), v0, v0 + n + 1, v0 + n + 2, v0 + 1);
+    }
+  }
+  return mesh;
+}
+#endif
+
+static int BenchMeshBrep(const ON_Brep& brep, unsigned int thread_count, ON_SimpleArray<ON_Mesh*>& mesh_list)
+{
+#if defined(OPENNURBS_PLUS)
+  return ON_BrepParallelMesher::CreateMesh(brep, ON_MeshParameters::DefaultMesh, mesh_list, thread_count);
+#else
+  return ON_BrepParallelMesher::CreateMesh(brep, ON_MeshParameters::DefaultMesh, mesh_list, BenchGridFaceMesher, thread_count);
+#endif
+}
+
+static void BenchDeleteMeshes(ON_SimpleArray<ON_Mesh*>& mesh_list)
+{
+  for (int i = 0; i < mesh_list.Count(); ++i)
+    delete mesh_list[i];
+  mesh_list.SetCount(0);
+}
+
+// Returns true if the meshes have the same vertices and faces.
+static bool BenchSameMeshes(const ON_SimpleArray<ON_Mesh*>& a, const ON_SimpleArray<ON_Mesh*>& b)
+{
+  if (a.Count() != b.Count())
+    return false;
+  for (int i = 0; i < a.Count(); ++i)
+  {
+    if (nullptr == a[i] || nullptr == b[i])
+    {
+      if (a[i] != b[i])
+        return false;
+      continue;
+    }
+    const ON_Mesh& A = *a[i];
+    const ON_Mesh& B = *b[i];
+    if (A.m_V.Count() != B.m_V.Count() || A.m_F.Count() != B.m_F.Count())
+      return false;
+    if (0 != memcmp(A.m_V.Array(), B.m_V.Array(), A.m_V.Count() * sizeof(A.m_V[0])))
+      return false;
+    if (0 != memcmp(A.m_F.Array(), B.m_F.Array(), A.m_F.Count() * sizeof(A.m_F[0])))
+      return false;
+  }
+  return true;
+}
+
+int main(int argc, const char* argv[])
+{
+  if (argc < 2)
+  {
+    printf("Usage: bench_brep_parallel_mesh model.3dm [model2.3dm ...]\n");
+    return 1;
+  }
+
+  ON_SimpleArray<ONX_Model*> models(argc - 1);
+  ON_SimpleArray<const ON_Brep*> breps;
+  ON_SimpleArray<ON_Brep*> brep_forms;
+  for (int i = 1; i < argc; ++i)
+  {
+    ONX_Model* model = new ONX_Model();
+    models.Append(model);
+    if (false == model->Read(argv[i]))
+    {
+      printf("%s could not be read.\n", argv[i]);
+      continue;
+    }
+    ONX_ModelComponentIterator it(*model, ON_ModelComponent::Type::ModelGeometry);
+    for (const ON_ModelComponent* component = it.FirstComponent(); nullptr != component; component = it.NextComponent())
+    {
+      const ON_ModelGeometryComponent* geometry_component = ON_ModelGeometryComponent::Cast(component);
+      const ON_Geometry* geometry = (nullptr != geometry_component) ? geometry_component->Geometry(nullptr) : nullptr;
+      const ON_Brep* brep = ON_Brep::Cast(geometry);
+      if (nullptr == brep && nullptr != geometry && geometry->HasBrepForm())
+      {
+        ON_Brep* brep_form = geometry->BrepForm();
+        brep_forms.Append(brep_form);
+        brep = brep_form;
+      }
+      if (nullptr != brep && brep->m_F.Count() > 0)
+        breps.Append(brep);
+    }
+  }
+
+  int face_count = 0;
+  for (int i = 0; i < breps.Count(); ++i)
+    face_count += breps[i]->m_F.Count();
+  if (0 == face_count)
+  {
+    printf("The models have no brep faces.\n");
+    return 1;
+  }
+
+  // Fill in the brep caches before timing so the 1 thread run does not pay for them.
+  for (int i = 0; i < breps.Count(); ++i)
+    ON_BrepParallelMesher::PrepareForConcurrentMeshing(*breps[i]);
+
+  const unsigned int hardware_thread_count = ON_Parallel::HardwareThreadCount();
+  const unsigned int max_thread_count = (hardware_thread_count < 32) ? hardware_thread_count : 32;
+
+#if defined(OPENNURBS_PLUS)
+  const char* mesher = "ON_BrepFace::CreateMesh()";
+#else
+  const char* mesher = "64 x 64 surface grid";
+#endif
+  printf("%d breps, %d faces, %s, %u hardware threads\n", breps.Count(), face_count, mesher, hardware_thread_count);
+  printf("%8s %14s %9s %11s %10s\n", "threads", "time", "speedup", "efficiency", "identical");
+
+  ON_SimpleArray<ON_Mesh*> serial_meshes;
+  double serial_ms = 0.0;
+  const std::vector<unsigned int> thread_counts = BenchThreadCounts(max_thread_count);
+  for (size_t t = 0; t < thread_counts.size(); ++t)
+  {
+    const unsigned int thread_count = thread_counts[t];
+    ON_SimpleArray<ON_Mesh*> meshes;
+    const double ms = BenchBestTime(3,
+      [&]()
+      {
+        BenchDeleteMeshes(meshes);
+        for (int i = 0; i < breps.Count(); ++i)
+          BenchMeshBrep(*breps[i], thread_count, meshes);
+      }
+    );
+    if (0 == t)
+    {
+      serial_ms = ms;
+      serial_meshes = meshes;
+      meshes.SetCount(0);
+    }
+    const double speedup = (ms > 0.0) ? serial_ms / ms : 0.0;
+    printf("%8u %11.1f ms %8.2fx %10.0f%% %10s\n",
+      thread_count, ms, speedup, 100.0 * speedup / thread_count,
+      (0 == t || BenchSameMeshes(serial_meshes, meshes)) ? "yes" : "no"
+    );
+    BenchDeleteMeshes(meshes);
+  }
+  BenchDeleteMeshes(serial_meshes);
+
+  for (int i = 0; i < brep_forms.Count(); ++i)
+    delete brep_forms[i];
+  for (int i = 0; i < models.Count(); ++i)
+    delete models[i];
+  return 0;
+}
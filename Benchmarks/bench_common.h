@@ -0,0 +1,159 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(BENCH_COMMON_INC_)
+#define BENCH_COMMON_INC_
+
+#include "opennurbs.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/*
+Description:
+  Wall clock stopwatch for the benchmarks.
+*/
+class BenchTimer
+{
+public:
+  BenchTimer()
+    : m_start(std::chrono::steady_clock::now())
+  {}
+
+  void Restart()
+  {
+    m_start = std::chrono::steady_clock::now();
+  }
+
+  // Returns milliseconds since construction or the last Restart().
+  double Milliseconds() const
+  {
+    const std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - m_start;
+    return d.count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/*
+Returns:
+  The smallest time in milliseconds of repeat_count calls to f().
+*/
+template <class F>
+inline double BenchBestTime(int repeat_count, const F& f)
+{
+  double best = 0.0;
+  for (int i = 0; i < repeat_count; ++i)
+  {
+    BenchTimer timer;
+    f();
+    const double t = timer.Milliseconds();
+    if (0 == i || t < best)
+      best = t;
+  }
+  return best;
+}
+
+/*
+Returns:
+  1, 2, 4, ... up to max_thread_count, and max_thread_count itself.
+*/
+inline std::vector<unsigned int> BenchThreadCounts(unsigned int max_thread_count)
+{
+  std::vector<unsigned int> counts;
+  for (unsigned int n = 1; n < max_thread_count; n *= 2)
+    counts.push_back(n);
+  counts.push_back(max_thread_count);
+  return counts;
+}
+
+/*
+Description:
+  Returns argv[i] as an unsigned integer, or default_value when
+  argc <= i or argv[i] is not a positive number.
+*/
+inline unsigned int BenchArgument(int argc, const char* const* argv, int i, unsigned int default_value)
+{
+  if (i < argc && nullptr != argv[i])
+  {
+    const long v = strtol(argv[i], nullptr, 10);
+    if (v > 0)
+      return (unsigned int)v;
+  }
+  return default_value;
+}
+
+/*
+Description:
+  Fill mesh with an n x n grid of unit squares in the z = 0 plane.
+  The vertices are numbered row by row.
+Parameters:
+  n - [in]
+  bTriangles - [in]
+    If true, each square is two triangles, otherwise one quad.
+  mesh - [out]
+*/
+inline void BenchCreateGridMesh(unsigned int n, bool bTriangles, ON_Mesh& mesh)
+{
+  mesh.Destroy();
+  const int row = (int)n + 1;
+  mesh.m_V.Reserve((size_t)row * row);
+  mesh.m_F.Reserve((bTriangles ? 2 : 1) * (size_t)n * n);
+  for (int i = 0; i < row; ++i)
+  {
+    for (int j = 0; j < row; ++j)
+      mesh.m_V.Append(ON_3fPoint((float)j, (float)i, 0.0f));
+  }
+  for (int i = 0; i < (int)n; ++i)
+  {
+    for (int j = 0; j < (int)n; ++j)
+    {
+      const int v0 = i * row + j;
+      const int v1 = v0 + 1;
+      const int v2 = v1 + row;
+      const int v3 = v0 + row;
+      if (bTriangles)
+      {
+        mesh.SetTriangle(mesh.m_F.Count(), v0, v1, v2);
+        mesh.SetTriangle(mesh.m_F.Count(), v0, v2, v3);
+      }
+      else
+        mesh.SetQuad(mesh.m_F.Count(), v0, v1, v2, v3);
+    }
+  }
+}
+
+/*
+Description:
+  Fill order[] with a random permutation of 0,...,count-1.
+*/
+inline void BenchRandomPermutation(unsigned int count, ON__UINT32 seed, ON_SimpleArray<unsigned int>& order)
+{
+  order.SetCount(0);
+  order.Reserve(count);
+  for (unsigned int i = 0; i < count; ++i)
+    order.Append(i);
+  ON_RandomNumberGenerator rng;
+  rng.Seed(seed);
+  for (unsigned int i = count; i > 1; --i)
+  {
+    const unsigned int j = rng.RandomNumber() % i;
+    const unsigned int t = order[i - 1];
+    order[i - 1] = order[j];
+    order[j] = t;
+  }
+}
+
+#endif
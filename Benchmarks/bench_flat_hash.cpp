@@ -0,0 +1,283 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// Lookup heavy ON_Hash32Table and ON_SerialNumberMap workloads vs
+// ON_FlatHashTable and ON_SerialNumberFlatMap.
+//
+//   bench_flat_hash [item_count]
+//
+// item_count defaults to 1000000. The output has the best of 3 times for
+// adding item_count items and the average time of one lookup when every
+// item is found once in random order, and when item_count keys that are
+// not in the table are looked up.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+class BenchIdItem : public ON_Hash32TableItem
+{
+public:
+  ON_UUID m_id = ON_nil_uuid;
+  unsigned int m_value = 0;
+};
+
+static void BenchCreateIds(unsigned int count, ON__UINT32 seed, ON_SimpleArray<ON_UUID>& ids)
+{
+  ON_RandomNumberGenerator rng;
+  rng.Seed(seed);
+  ids.SetCount(0);
+  ids.Reserve(count);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    ON_UUID id;
+    id.Data1 = rng.RandomNumber();
+    id.Data2 = (unsigned short)rng.RandomNumber();
+    id.Data3 = (unsigned short)rng.RandomNumber();
+    const ON__UINT32 d4[2] = { rng.RandomNumber(), rng.RandomNumber() };
+    memcpy(id.Data4, d4, sizeof(id.Data4));
+    ids.Append(id);
+  }
+}
+
+static const BenchIdItem* BenchFind(const ON_Hash32Table& table, const ON_UUID& id)
+{
+  const ON__UINT32 hash32 = ON_Hash32TableItem::Hash32FromId(id);
+  for (const ON_Hash32TableItem* item = table.FirstItemWithHash(hash32); nullptr != item; item = table.NextItemWithHash(item))
+  {
+    const BenchIdItem* id_item = static_cast<const BenchIdItem*>(item);
+    if (id_item->m_id == id)
+      return id_item;
+  }
+  return nullptr;
+}
+
+static void BenchPrintRow(const char* label, double a_ms, double b_ms, unsigned int count, bool bPerItem)
+{
+  if (bPerItem)
+    printf("%-24s %11.1f ns %11.1f ns\n", label, 1.0e6 * a_ms / count, 1.0e6 * b_ms / count);
+  else
+    printf("%-24s %11.1f ms %11.1f ms\n", label, a_ms, b_ms);
+}
+
+static void BenchIdTables(const ON_SimpleArray<ON_UUID>& ids, const ON_SimpleArray<ON_UUID>& missing_ids, const ON_SimpleArray<unsigned int>& order)
+{
+  const unsigned int count = ids.UnsignedCount();
+  ON__UINT64 check[2] = {};
+
+  ON_SimpleArray<BenchIdItem> items(count);
+  items.SetCount(count);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    items[i].m_id = ids[i];
+    items[i].m_value = i;
+  }
+
+  ON_Hash32Table* hash32 = nullptr;
+  const double hash32_add_ms = BenchBestTime(3,
+    [&]()
+    {
+      delete hash32;
+      hash32 = new ON_Hash32Table();
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        items[i].ClearHashTableSerialNumberForExperts();
+        hash32->AddItem(ON_Hash32TableItem::Hash32FromId(ids[i]), &items[i]);
+      }
+    }
+  );
+  const double hash32_find_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        const BenchIdItem* item = BenchFind(*hash32, ids[order[i]]);
+        if (nullptr != item)
+          check[0] += item->m_value;
+      }
+    }
+  );
+  const double hash32_miss_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        if (nullptr != BenchFind(*hash32, missing_ids[i]))
+          check[0]++;
+      }
+    }
+  );
+
+  ON_FlatHashTable<ON_UUID, unsigned int>* flat = nullptr;
+  const double flat_add_ms = BenchBestTime(3,
+    [&]()
+    {
+      delete flat;
+      flat = new ON_FlatHashTable<ON_UUID, unsigned int>();
+      for (unsigned int i = 0; i < count; ++i)
+        flat->Add(ids[i], i);
+    }
+  );
+  const double flat_find_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        const unsigned int* value = flat->Find(ids[order[i]]);
+        if (nullptr != value)
+          check[1] += *value;
+      }
+    }
+  );
+  const double flat_miss_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        if (nullptr != flat->Find(missing_ids[i]))
+          check[1]++;
+      }
+    }
+  );
+
+  // The ON_Hash32Table must be emptied before the items it points to are destroyed.
+  hash32->RemoveAllItems();
+  delete hash32;
+  delete flat;
+
+  printf("%-24s %14s %14s\n", "id -> value", "ON_Hash32Table", "ON_FlatHash");
+  BenchPrintRow("add all", hash32_add_ms, flat_add_ms, count, false);
+  BenchPrintRow("find (found)", hash32_find_ms, flat_find_ms, count, true);
+  BenchPrintRow("find (not found)", hash32_miss_ms, flat_miss_ms, count, true);
+  if (check[0] != check[1])
+    printf("The tables found different items.\n");
+}
+
+static void BenchSerialNumberMaps(const ON_SimpleArray<ON_UUID>& ids, const ON_SimpleArray<ON_UUID>& missing_ids, const ON_SimpleArray<unsigned int>& order)
+{
+  const unsigned int count = ids.UnsignedCount();
+  ON__UINT64 check[2] = {};
+
+  // Serial numbers are added in increasing order, as they are in a model.
+  ON_SerialNumberMap* sn_map = nullptr;
+  const double map_add_ms = BenchBestTime(3,
+    [&]()
+    {
+      delete sn_map;
+      sn_map = new ON_SerialNumberMap();
+      for (unsigned int i = 0; i < count; ++i)
+        sn_map->AddSerialNumberAndId(i + 1, ids[i]);
+    }
+  );
+  const double map_sn_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        if (nullptr != sn_map->FindSerialNumber(order[i] + 1))
+          check[0] += order[i];
+      }
+    }
+  );
+  const double map_id_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        const ON_SerialNumberMap::SN_ELEMENT* e = sn_map->FindId(ids[order[i]]);
+        if (nullptr != e)
+          check[0] += e->m_sn;
+      }
+    }
+  );
+  const double map_miss_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        if (nullptr != sn_map->FindId(missing_ids[i]))
+          check[0]++;
+      }
+    }
+  );
+
+  ON_SerialNumberFlatMap* flat_map = nullptr;
+  const double flat_add_ms = BenchBestTime(3,
+    [&]()
+    {
+      delete flat_map;
+      flat_map = new ON_SerialNumberFlatMap();
+      for (unsigned int i = 0; i < count; ++i)
+        flat_map->AddSerialNumberAndId(i + 1, ids[i]);
+    }
+  );
+  const double flat_sn_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        if (nullptr != flat_map->FindSerialNumber(order[i] + 1))
+          check[1] += order[i];
+      }
+    }
+  );
+  const double flat_id_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        const ON_SerialNumberMap::SN_ELEMENT* e = flat_map->FindId(ids[order[i]]);
+        if (nullptr != e)
+          check[1] += e->m_sn;
+      }
+    }
+  );
+  const double flat_miss_ms = BenchBestTime(3,
+    [&]()
+    {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        if (nullptr != flat_map->FindId(missing_ids[i]))
+          check[1]++;
+      }
+    }
+  );
+
+  delete sn_map;
+  delete flat_map;
+
+  printf("%-24s %14s %14s\n", "serial number map", "ON_SN_Map", "ON_SN_FlatMap");
+  BenchPrintRow("add all", map_add_ms, flat_add_ms, count, false);
+  BenchPrintRow("FindSerialNumber()", map_sn_ms, flat_sn_ms, count, true);
+  BenchPrintRow("FindId() (found)", map_id_ms, flat_id_ms, count, true);
+  BenchPrintRow("FindId() (not found)", map_miss_ms, flat_miss_ms, count, true);
+  if (check[0] != check[1])
+    printf("The maps found different elements.\n");
+}
+
+int main(int argc, const char* argv[])
+{
+  const unsigned int count = BenchArgument(argc, argv, 1, 1000000);
+
+  ON_SimpleArray<ON_UUID> ids;
+  ON_SimpleArray<ON_UUID> missing_ids;
+  ON_SimpleArray<unsigned int> order;
+  BenchCreateIds(count, 1, ids);
+  BenchCreateIds(count, 2, missing_ids);
+  BenchRandomPermutation(count, 3, order);
+
+  printf("%u items\n", count);
+  BenchIdTables(ids, missing_ids, order);
+  printf("\n");
+  BenchSerialNumberMaps(ids, missing_ids, order);
+  return 0;
+}
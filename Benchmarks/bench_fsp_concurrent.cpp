@@ -0,0 +1,120 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// Allocation throughput of ON_FixedSizePool::ThreadSafe...() and
+// ON_ConcurrentFixedSizePool for 1 to 64 threads.
+//
+//   bench_fsp_concurrent [max_thread_count] [operations_per_thread]
+//
+// Every thread keeps up to 256 live elements and allocates or returns
+// one element per operation. The output has one line per thread count
+// with the millions of operations per second of both pools.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+#include <thread>
+
+struct BenchFspElement
+{
+  void* m_bookkeeping[2];
+  ON__UINT64 m_payload[2];
+};
+
+template <class Allocate, class Return>
+static void BenchFspThread(
+  unsigned int thread_index,
+  unsigned int operation_count,
+  const Allocate& allocate,
+  const Return& return_element
+  )
+{
+  std::vector<BenchFspElement*> live;
+  live.reserve(256);
+  ON_RandomNumberGenerator rng;
+  rng.Seed(thread_index + 1);
+  for (unsigned int i = 0; i < operation_count; ++i)
+  {
+    if (live.empty() || (live.size() < 256 && 0 != (rng.RandomNumber() % 3)))
+    {
+      BenchFspElement* e = (BenchFspElement*)allocate();
+      e->m_payload[0] = i;
+      live.push_back(e);
+    }
+    else
+    {
+      const size_t j = rng.RandomNumber() % live.size();
+      return_element(live[j]);
+      live[j] = live.back();
+      live.pop_back();
+    }
+  }
+  for (BenchFspElement* e : live)
+    return_element(e);
+}
+
+template <class Allocate, class Return>
+static double BenchFspRun(
+  unsigned int thread_count,
+  unsigned int operation_count,
+  const Allocate& allocate,
+  const Return& return_element
+  )
+{
+  const double ms = BenchBestTime(3,
+    [&]()
+    {
+      std::vector<std::thread> threads;
+      for (unsigned int t = 0; t < thread_count; ++t)
+        threads.emplace_back(BenchFspThread<Allocate, Return>, t, operation_count, std::cref(allocate), std::cref(return_element));
+      for (std::thread& t : threads)
+        t.join();
+    }
+  );
+  // millions of operations per second
+  return (ms > 0.0) ? (thread_count * (double)operation_count) / (1000.0 * ms) : 0.0;
+}
+
+int main(int argc, const char* argv[])
+{
+  const unsigned int max_thread_count = BenchArgument(argc, argv, 1, 64);
+  const unsigned int operation_count = BenchArgument(argc, argv, 2, 1000000);
+
+  ON_FixedSizePool fsp;
+  if (false == fsp.Create(sizeof(BenchFspElement), 0, 0))
+    return 1;
+
+  printf("threads  ThreadSafe Mops/s  Concurrent Mops/s\n");
+  for (unsigned int thread_count : BenchThreadCounts(max_thread_count))
+  {
+    const double locked = BenchFspRun(thread_count, operation_count,
+      [&fsp]() { return fsp.ThreadSafeAllocateDirtyElement(); },
+      [&fsp](void* p) { fsp.ThreadSafeReturnElement(p); }
+    );
+    fsp.ReturnAll();
+
+    double concurrent = 0.0;
+    {
+      ON_ConcurrentFixedSizePool cfsp(fsp);
+      concurrent = BenchFspRun(thread_count, operation_count,
+        [&cfsp]() { return cfsp.AllocateDirtyElement(); },
+        [&cfsp](void* p) { cfsp.ReturnElement(p); }
+      );
+      cfsp.Flush();
+    }
+    fsp.ReturnAll();
+
+    printf("%7u  %17.2f  %17.2f\n", thread_count, locked, concurrent);
+  }
+  return 0;
+}
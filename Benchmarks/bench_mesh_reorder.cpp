@@ -0,0 +1,52 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// Vertex cache miss ratio (ACMR) before and after ON_MeshReorder::Optimize().
+//
+//   bench_mesh_reorder [grid_size]
+//
+// The mesh is a triangulated grid_size x grid_size grid with its faces
+// and vertices shuffled. The output has the ACMR for 16 and 32 entry
+// caches before and after Optimize() and the Optimize() time.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+int main(int argc, const char* argv[])
+{
+  const unsigned int grid_size = BenchArgument(argc, argv, 1, 300);
+
+  ON_Mesh mesh;
+  BenchCreateGridMesh(grid_size, true, mesh);
+  ON_SimpleArray<unsigned int> order;
+  BenchRandomPermutation(mesh.FaceUnsignedCount(), 1, order);
+  ON_MeshReorder::PermuteFaces(mesh, order.Array());
+  BenchRandomPermutation(mesh.VertexUnsignedCount(), 2, order);
+  ON_MeshReorder::PermuteVertices(mesh, order.Array());
+
+  const double before16 = ON_MeshReorder::ACMR(mesh, 16);
+  const double before32 = ON_MeshReorder::ACMR(mesh, 32);
+  BenchTimer timer;
+  if (false == ON_MeshReorder::Optimize(mesh, 16))
+    return 1;
+  const double ms = timer.Milliseconds();
+  const double after16 = ON_MeshReorder::ACMR(mesh, 16);
+  const double after32 = ON_MeshReorder::ACMR(mesh, 32);
+
+  printf("%u faces, %u vertices\n", mesh.FaceUnsignedCount(), mesh.VertexUnsignedCount());
+  printf("cache  ACMR before  ACMR after\n");
+  printf("%5d  %11.3f  %10.3f\n", 16, before16, after16);
+  printf("%5d  %11.3f  %10.3f\n", 32, before32, after32);
+  printf("Optimize() %.1f ms\n", ms);
+  return 0;
+}
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// ON_Mesh functions vs the ON_MeshVertexSoA kernels.
+//
+//   bench_mesh_soa [vertex_count]
+//
+// The mesh is a quad grid with about vertex_count vertices, 10 million
+// by default. Each line has the best of 3 times of the ON_Mesh or
+// ON_TransformPointList() call and of the ON_MeshVertexSoA kernel on one
+// thread and on every thread.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+static void BenchLine(const char* name, double mesh_ms, double soa1_ms, double soa_ms)
+{
+  printf("%-22s %10.1f %10.1f %10.1f %8.2fx\n", name, mesh_ms, soa1_ms, soa_ms, (soa_ms > 0.0) ? mesh_ms / soa_ms : 0.0);
+}
+
+int main(int argc, const char* argv[])
+{
+  const unsigned int vertex_count = BenchArgument(argc, argv, 1, 10000000);
+  const unsigned int grid_size = (unsigned int)sqrt((double)vertex_count);
+
+  ON_Mesh mesh;
+  BenchCreateGridMesh(grid_size > 1 ? grid_size - 1 : 1, false, mesh);
+  ON_Xform xform;
+  xform.Rotation(0.25, ON_3dVector(1.0, 2.0, 3.0).UnitVector(), ON_3dPoint(1.0, 0.0, 0.0));
+  const ON_Xform inverse = xform.Inverse();
+
+  ON_MeshVertexSoA soa;
+  const double copy_ms = BenchBestTime(3, [&]() { soa.SetFromMesh(mesh); });
+
+  printf("%u vertices, %u faces, SetFromMesh() %.1f ms\n", mesh.VertexUnsignedCount(), mesh.FaceUnsignedCount(), copy_ms);
+  printf("%-22s %10s %10s %10s %9s\n", "", "ON_Mesh ms", "SoA 1 ms", "SoA ms", "speedup");
+
+  ON_BoundingBox bbox;
+  BenchLine("GetBoundingBox",
+    BenchBestTime(3, [&]() { mesh.InvalidateBoundingBoxes(); mesh.GetBoundingBox(bbox); }),
+    BenchBestTime(3, [&]() { soa.GetBoundingBox(bbox, false, false); }),
+    BenchBestTime(3, [&]() { soa.GetBoundingBox(bbox); })
+  );
+
+  // Each timed call is followed by the inverse so the points stay put.
+  BenchLine("Transform",
+    BenchBestTime(3, [&]() { mesh.Transform(xform); mesh.Transform(inverse); }),
+    BenchBestTime(3, [&]() { soa.Transform(xform, false); soa.Transform(inverse, false); }),
+    BenchBestTime(3, [&]() { soa.Transform(xform); soa.Transform(inverse); })
+  );
+
+  ON_SimpleArray<ON_3dPoint> points(mesh.m_V.Count());
+  for (int i = 0; i < mesh.m_V.Count(); ++i)
+    points.Append(ON_3dPoint(mesh.m_V[i]));
+  double* p = &points.Array()->x;
+  const int point_count = points.Count();
+  BenchLine("TransformPointList 3d",
+    BenchBestTime(3, [&]() { ON_TransformPointList(3, false, point_count, 3, p, xform); ON_TransformPointList(3, false, point_count, 3, p, inverse); }),
+    BenchBestTime(3, [&]() { ON_MeshVertexSoA::TransformPointList(xform, points.UnsignedCount(), points.Array(), false); ON_MeshVertexSoA::TransformPointList(inverse, points.UnsignedCount(), points.Array(), false); }),
+    BenchBestTime(3, [&]() { ON_MeshVertexSoA::TransformPointList(xform, points.UnsignedCount(), points.Array()); ON_MeshVertexSoA::TransformPointList(inverse, points.UnsignedCount(), points.Array()); })
+  );
+
+  BenchLine("ComputeFaceNormals",
+    BenchBestTime(3, [&]() { mesh.m_FN.SetCount(0); mesh.ComputeFaceNormals(); }),
+    BenchBestTime(3, [&]() { soa.ComputeFaceNormals(mesh, false); }),
+    BenchBestTime(3, [&]() { soa.ComputeFaceNormals(mesh); })
+  );
+
+  BenchLine("ComputeVertexNormals",
+    BenchBestTime(3, [&]() { mesh.m_N.SetCount(0); mesh.ComputeVertexNormals(); }),
+    BenchBestTime(3, [&]() { soa.ComputeVertexNormals(mesh, false); }),
+    BenchBestTime(3, [&]() { soa.ComputeVertexNormals(mesh); })
+  );
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// ON_NurbsSurface::EvaluateGrid() vs one ON_NurbsSurface::Evaluate() call
+// per grid point.
+//
+//   bench_nurbs_surface_grid [grid_size] [cv_count]
+//
+// grid_size defaults to 256 and cv_count to 20. The surfaces are bicubic
+// with cv_count x cv_count control points, one non-rational and one
+// rational. For 0, 1 and 2 derivatives, the output has the best of 3
+// times to evaluate a grid_size x grid_size grid both ways and the
+// largest difference between the results.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+static void BenchCreateSurface(int cv_count, bool bRational, ON_NurbsSurface& srf)
+{
+  srf.Create(3, bRational, 4, 4, cv_count, cv_count);
+  srf.MakeClampedUniformKnotVector(0, 1.0);
+  srf.MakeClampedUniformKnotVector(1, 1.0);
+  ON_RandomNumberGenerator rng;
+  rng.Seed(7);
+  for (int i = 0; i < cv_count; ++i)
+  {
+    for (int j = 0; j < cv_count; ++j)
+    {
+      const ON_3dPoint P(i, j, rng.RandomDouble(-1.0, 1.0));
+      if (bRational)
+      {
+        const double w = rng.RandomDouble(0.5, 2.0);
+        srf.SetCV(i, j, ON_4dPoint(w * P.x, w * P.y, w * P.z, w));
+      }
+      else
+        srf.SetCV(i, j, P);
+    }
+  }
+}
+
+static void BenchRun(const ON_NurbsSurface& srf, int grid_size, int der_count)
+{
+  const int partial_count = (der_count + 1) * (der_count + 2) / 2;
+  const size_t point_count = (size_t)grid_size * grid_size;
+
+  ON_SimpleArray<double> u(grid_size);
+  ON_SimpleArray<double> v(grid_size);
+  for (int i = 0; i < grid_size; ++i)
+  {
+    const double t = (grid_size > 1) ? ((double)i) / (grid_size - 1) : 0.0;
+    u.Append(srf.Domain(0).ParameterAt(t));
+    v.Append(srf.Domain(1).ParameterAt(t));
+  }
+
+  // Evaluate() returns the partials of a point together.
+  ON_SimpleArray<double> each(point_count * partial_count * 3);
+  each.SetCount(each.Capacity());
+  bool rc_each = true;
+  const double each_ms = BenchBestTime(3,
+    [&]()
+    {
+      int hint[2] = { 0, 0 };
+      for (int i = 0; i < grid_size; ++i)
+      {
+        for (int j = 0; j < grid_size; ++j)
+        {
+          double* p = each.Array() + ((size_t)i * grid_size + j) * partial_count * 3;
+          if (false == srf.Evaluate(u[i], v[j], der_count, 3, p, 0, hint))
+            rc_each = false;
+        }
+      }
+    }
+  );
+
+  // EvaluateGrid() returns structure of arrays.
+  ON_SimpleArray<double> grid(point_count * partial_count * 3);
+  grid.SetCount(grid.Capacity());
+  bool rc_grid = true;
+  const double grid_ms = BenchBestTime(3,
+    [&]()
+    {
+      rc_grid = srf.EvaluateGrid(u.Array(), grid_size, v.Array(), grid_size, der_count, 0, point_count, grid.Array());
+    }
+  );
+
+  double max_difference = 0.0;
+  for (size_t g = 0; g < point_count; ++g)
+  {
+    for (int d = 0; d < partial_count; ++d)
+    {
+      for (int c = 0; c < 3; ++c)
+      {
+        const double a = each[(g * partial_count + d) * 3 + c];
+        const double b = grid[((size_t)d * 3 + c) * point_count + g];
+        const double x = fabs(a - b);
+        if (x > max_difference)
+          max_difference = x;
+      }
+    }
+  }
+
+  printf("%-10s %5d %11.2f ms %11.2f ms %8.2fx %12.3g%s\n",
+    srf.IsRational() ? "rational" : "polynomial",
+    der_count,
+    each_ms,
+    grid_ms,
+    (grid_ms > 0.0) ? each_ms / grid_ms : 0.0,
+    max_difference,
+    (rc_each && rc_grid) ? "" : " (evaluation failed)"
+  );
+}
+
+int main(int argc, const char* argv[])
+{
+  const int grid_size = (int)BenchArgument(argc, argv, 1, 256);
+  const int cv_count = (int)BenchArgument(argc, argv, 2, 20);
+  if (cv_count < 4)
+  {
+    printf("cv_count must be at least 4.\n");
+    return 1;
+  }
+
+  printf("%d x %d grid, %d x %d control points, bicubic\n", grid_size, grid_size, cv_count, cv_count);
+  printf("%-10s %5s %14s %14s %9s %12s\n", "surface", "ders", "Evaluate()", "EvaluateGrid()", "speedup", "max diff");
+  for (int r = 0; r < 2; ++r)
+  {
+    ON_NurbsSurface srf;
+    BenchCreateSurface(cv_count, 1 == r, srf);
+    for (int der_count = 0; der_count <= 2; ++der_count)
+      BenchRun(srf, grid_size, der_count);
+  }
+  return 0;
+}
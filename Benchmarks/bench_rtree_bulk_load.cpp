@@ -0,0 +1,110 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+// ON_RTree built with Insert() vs ON_RTree::BulkLoad().
+//
+//   bench_rtree_bulk_load [element_count] [query_count]
+//
+// The elements are small random boxes in a unit cube. For each build the
+// output has the build time, the node count and the time to run
+// query_count random box searches.
+// See README.md for the build command.
+
+#include "bench_common.h"
+
+static unsigned int BenchNodeCount(const ON_RTreeNode* node)
+{
+  if (nullptr == node)
+    return 0;
+  unsigned int count = 1;
+  if (node->m_level > 0)
+  {
+    for (int i = 0; i < node->m_count; ++i)
+      count += BenchNodeCount(node->m_branch[i].m_child);
+  }
+  return count;
+}
+
+static bool ON_CALLBACK_CDECL BenchCountHit(void* a_context, ON__INT_PTR)
+{
+  ++(*(size_t*)a_context);
+  return true;
+}
+
+static void BenchRandomBoxes(size_t count, double size, ON__UINT32 seed, ON_SimpleArray<ON_RTreeBBox>& boxes)
+{
+  ON_RandomNumberGenerator rng;
+  rng.Seed(seed);
+  boxes.SetCount(0);
+  boxes.Reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    ON_RTreeBBox& box = boxes.AppendNew();
+    for (int j = 0; j < 3; ++j)
+    {
+      box.m_min[j] = rng.RandomDouble(0.0, 1.0);
+      box.m_max[j] = box.m_min[j] + size * rng.RandomDouble(0.1, 1.0);
+    }
+  }
+}
+
+static void BenchReport(const char* name, double build_ms, const ON_RTree& tree, const ON_SimpleArray<ON_RTreeBBox>& queries)
+{
+  size_t hit_count = 0;
+  const double query_ms = BenchBestTime(3,
+    [&]()
+    {
+      hit_count = 0;
+      for (int i = 0; i < queries.Count(); ++i)
+      {
+        ON_RTreeBBox q = queries[i];
+        tree.Search(&q, BenchCountHit, &hit_count);
+      }
+    }
+  );
+  printf("%-22s %10.1f %10u %10.1f %10zu\n", name, build_ms, BenchNodeCount(tree.Root()), query_ms, hit_count);
+}
+
+int main(int argc, const char* argv[])
+{
+  const unsigned int element_count = BenchArgument(argc, argv, 1, 2000000);
+  const unsigned int query_count = BenchArgument(argc, argv, 2, 100000);
+
+  ON_SimpleArray<ON_RTreeBBox> boxes;
+  ON_SimpleArray<ON_RTreeBBox> queries;
+  BenchRandomBoxes(element_count, 2.0 / cbrt((double)element_count), 1, boxes);
+  BenchRandomBoxes(query_count, 8.0 / cbrt((double)element_count), 2, queries);
+
+  printf("%u elements, %u queries\n", element_count, query_count);
+  printf("%-22s %10s %10s %10s %10s\n", "build", "build ms", "nodes", "query ms", "hits");
+
+  {
+    ON_RTree tree;
+    BenchTimer timer;
+    for (int i = 0; i < boxes.Count(); ++i)
+      tree.Insert(boxes[i].m_min, boxes[i].m_max, i);
+    BenchReport("Insert()", timer.Milliseconds(), tree, queries);
+  }
+
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    const bool bMultithreaded = (1 == pass);
+    ON_RTree tree;
+    BenchTimer timer;
+    if (false == tree.BulkLoad(boxes.Array(), nullptr, boxes.UnsignedCount(), bMultithreaded))
+      return 1;
+    BenchReport(bMultithreaded ? "BulkLoad() threaded" : "BulkLoad() 1 thread", timer.Milliseconds(), tree, queries);
+  }
+
+  return 0;
+}
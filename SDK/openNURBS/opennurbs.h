@@ -48,15 +48,20 @@
 #include "opennurbs_progress_reporter.h" // ON_ProgressReporter class
 #include "opennurbs_terminator.h"        // ON_Terminator class 
 #include "opennurbs_lock.h"              // simple atomic operation lock setter
+#include "opennurbs_parallel.h"          // ON_Parallel multi-threading tools
 #include "opennurbs_fsp.h"            // fixed size memory pool
+#include "opennurbs_fsp_concurrent.h" // lock-free thread caches for ON_FixedSizePool
 #include "opennurbs_function_list.h"      /* list of functions to run */
 #include "opennurbs_std_string.h"     // std::string utilities
 #include "opennurbs_md5.h"
 #include "opennurbs_sha1.h"
 #include "opennurbs_string.h"         // dynamic string classes (single and double byte)
 #include "opennurbs_hash_table.h"
+#include "opennurbs_flat_hash_table.h"   // open addressing hash table
 #include "opennurbs_file_utilities.h"
 #include "opennurbs_array.h"          // dynamic array templates
+#include "opennurbs_small_array.h"    // dynamic array with inline capacity
+#include "opennurbs_memory_arena.h"   // thread local arena allocation
 #include "opennurbs_compress.h"
 #include "opennurbs_base64.h"         // base64 encodeing and decoding
 #include "opennurbs_color.h"          // R G B color
@@ -105,6 +110,9 @@
 #include "opennurbs_object.h"         // virtual base class for all openNURBS objects
 #include "opennurbs_model_component.h"
 #include "opennurbs_archive.h"        // binary archive objects for serialization to file, memory blocks, etc.
+#include "opennurbs_archive_mapped.h" // memory mapped 3dm file reader
+#include "opennurbs_compress_codec.h" // pluggable buffer compression codecs
+#include "opennurbs_compress_blocks.h" // block parallel buffer compression
 #include "opennurbs_model_geometry.h"
 #include "opennurbs_arc.h"            // simple 3d circular arc
 #include "opennurbs_userdata.h"       // class for attaching persistent user information to openNURBS objects
@@ -125,6 +133,11 @@
 #include "opennurbs_curveproxy.h"     // proxy curve provides a way to use an existing curve
 #include "opennurbs_surfaceproxy.h"   // proxy surface provides a way to use another surface
 #include "opennurbs_mesh.h"           // mesh object
+#include "opennurbs_mesh_soa.h"       // structure of arrays mesh vertex kernels
+#include "opennurbs_mesh_topology_builder.h" // multi-threaded ON_MeshTopology builder
+#include "opennurbs_mesh_quantized.h"     // compact read-only mesh for display
+#include "opennurbs_mesh_meshlet.h"       // spatially coherent mesh clusters for culling
+#include "opennurbs_mesh_reorder.h"       // vertex cache face and vertex ordering
 
 #if defined(OPENNURBS_PLUS)
 //#include "opennurbs_plus_meshbooleans_impl.h" //mesh booleans functions are part of conditionally-compiled ON_Mesh now
@@ -136,12 +149,15 @@
 #include "opennurbs_polylinecurve.h"  // polyline as a paramtric curve object
 #include "opennurbs_nurbscurve.h"     // NURBS curve
 #include "opennurbs_polycurve.h"      // polycurve (composite curve)
+#include "opennurbs_curve_tessellation_cache.h" // cached curve polylines
 #include "opennurbs_curveonsurface.h" // curve on surface (other kind of composite curve)
 #include "opennurbs_nurbssurface.h"   // NURBS surface
 #include "opennurbs_planesurface.h"   // plane surface
 #include "opennurbs_revsurface.h"     // surface of revolution
 #include "opennurbs_sumsurface.h"     // sum surface
 #include "opennurbs_brep.h"           // boundary rep
+#include "opennurbs_brep_parallel_mesh.h" // multi-threaded brep face meshing
+#include "opennurbs_batch_closest_point.h" // closest points to many points
 #include "opennurbs_beam.h"           // lightweight extrusion object
 #include "opennurbs_subd.h"           // subdivison surface object
 #if defined(OPENNURBS_PLUS)
@@ -173,6 +189,7 @@
 #include "opennurbs_offsetsurface.h"  // ON_OffsetSurface definition
 #include "opennurbs_detail.h"         // ON_Detail definition
 #include "opennurbs_lookup.h"         // ON_SerialNumberTable
+#include "opennurbs_flat_hash_adapters.h" // ON_FlatHashTable versions of ON_SerialNumberMap and ON_SubDComponentPtrPairHashTable
 #include "opennurbs_object_history.h"
 #if defined(OPENNURBS_PLUS)
 #include "opennurbs_table.h"
@@ -197,6 +214,9 @@
 #include "opennurbs_post_effects.h"        // Post Effect support.
 #include "opennurbs_mesh_modifiers.h"      // Mesh Modifiers support.
 #include "opennurbs_extensions.h"
+#include "opennurbs_model_parallel_read.h" // Parallel ONX_Model object table reading.
+#include "opennurbs_model_lazy_geometry.h"  // Lazy ONX_Model geometry loading.
+#include "opennurbs_model_incremental_save.h" // Incremental ONX_Model saving.
 #include "opennurbs_freetype.h"
 
 #if defined(OPENNURBS_PLUS)
@@ -5996,4 +5996,283 @@ private:
   ON_DebugWriteArchive& operator=(const ON_DebugWriteArchive&) = delete;
 };
 
+////////////////////////////////////////////////////////////////
+//
+// ON_RTree serialization
+//
+// ON_RTree is declared before ON_BinaryArchive, so ON_RTree::Write()
+// and ON_RTree::Read() are defined here.
+//
+
+inline bool ON_RTree::Write(
+  ON_BinaryArchive& archive,
+  const ON_SHA1_Hash& geometry_hash
+  ) const
+{
+  // Flatten the tree in depth first order. Each node contributes
+  // (m_level,m_count) to node_data, 6 doubles per branch to rect_data
+  // and, at leaf nodes, one id per branch to id_data.
+  ON_SimpleArray<ON__INT32> node_data;
+  ON_SimpleArray<double> rect_data;
+  ON_SimpleArray<ON__INT64> id_data;
+  if (nullptr != m_root && m_root->m_count > 0)
+  {
+    ON_SimpleArray<const ON_RTreeNode*> stack(64);
+    stack.Append(m_root);
+    while (stack.Count() > 0)
+    {
+      const ON_RTreeNode* node = *stack.Last();
+      stack.Remove();
+      node_data.Append(node->m_level);
+      node_data.Append(node->m_count);
+      for (int i = 0; i < node->m_count; ++i)
+      {
+        rect_data.Append(3, node->m_branch[i].m_rect.m_min);
+        rect_data.Append(3, node->m_branch[i].m_rect.m_max);
+      }
+      if (node->IsLeaf())
+      {
+        for (int i = 0; i < node->m_count; ++i)
+          id_data.Append((ON__INT64)node->m_branch[i].m_id);
+      }
+      else
+      {
+        // push in reverse order so the children are written first to last
+        for (int i = node->m_count - 1; i >= 0; --i)
+          stack.Append(node->m_branch[i].m_child);
+      }
+    }
+  }
+
+  ON__UINT32 crc = 0;
+  crc = ON_CRC32(crc, node_data.UnsignedCount() * sizeof(node_data[0]), node_data.Array());
+  crc = ON_CRC32(crc, rect_data.UnsignedCount() * sizeof(rect_data[0]), rect_data.Array());
+  crc = ON_CRC32(crc, id_data.UnsignedCount() * sizeof(id_data[0]), id_data.Array());
+
+  if (!archive.BeginWrite3dmAnonymousChunk(1))
+    return false;
+
+  bool rc = false;
+  for (;;)
+  {
+    if (!geometry_hash.Write(archive))
+      break;
+    if (!archive.WriteInt(node_data.Count()))
+      break;
+    if (!archive.WriteInt(rect_data.Count()))
+      break;
+    if (!archive.WriteInt(id_data.Count()))
+      break;
+    if (!archive.WriteInt(node_data.UnsignedCount(), node_data.Array()))
+      break;
+    if (!archive.WriteDouble(rect_data.UnsignedCount(), rect_data.Array()))
+      break;
+    if (!archive.WriteBigInt(id_data.UnsignedCount(), id_data.Array()))
+      break;
+    if (!archive.WriteInt(crc))
+      break;
+    rc = true;
+    break;
+  }
+
+  if (!archive.EndWrite3dmChunk())
+    rc = false;
+
+  return rc;
+}
+
+inline bool ON_RTree::Read(
+  ON_BinaryArchive& archive,
+  const ON_SHA1_Hash& geometry_hash
+  )
+{
+  RemoveAll();
+
+  int version = 0;
+  if (!archive.BeginRead3dmAnonymousChunk(&version))
+    return false;
+
+  bool rc = false;
+  ON_RTreeNode* root = nullptr;
+  for (;;)
+  {
+    if (version < 1)
+      break;
+
+    ON_SHA1_Hash saved_geometry_hash;
+    if (!saved_geometry_hash.Read(archive))
+      break;
+    if (!geometry_hash.IsZeroDigest() && saved_geometry_hash != geometry_hash)
+      break; // the geometry changed after the tree was saved
+
+    int node_data_count = 0;
+    int rect_data_count = 0;
+    int id_data_count = 0;
+    if (!archive.ReadInt(&node_data_count))
+      break;
+    if (!archive.ReadInt(&rect_data_count))
+      break;
+    if (!archive.ReadInt(&id_data_count))
+      break;
+    if (node_data_count < 0 || 0 != (node_data_count % 2))
+      break;
+    if (rect_data_count < 0 || 0 != (rect_data_count % 6))
+      break;
+    if (id_data_count < 0 || id_data_count > rect_data_count / 6)
+      break;
+
+    // A damaged file can have huge counts. The arrays and the CRC must
+    // fit in what is left of the chunk before anything is allocated.
+    ON_3DM_BIG_CHUNK chunk;
+    if (archive.GetCurrentChunk(chunk) <= 0)
+      break;
+    const ON__UINT64 sizeof_data
+      = sizeof(ON__INT32) * (ON__UINT64)node_data_count
+      + sizeof(double) * (ON__UINT64)rect_data_count
+      + sizeof(ON__INT64) * (ON__UINT64)id_data_count
+      + sizeof(ON__UINT32);
+    if (sizeof_data > chunk.LengthRemaining(archive.CurrentPosition()))
+    {
+      ON_ERROR("Saved ON_RTree is damaged.");
+      break;
+    }
+
+    ON_SimpleArray<ON__INT32> node_data(node_data_count);
+    ON_SimpleArray<double> rect_data(rect_data_count);
+    ON_SimpleArray<ON__INT64> id_data(id_data_count);
+    node_data.SetCount(node_data_count);
+    rect_data.SetCount(rect_data_count);
+    id_data.SetCount(id_data_count);
+    if (!archive.ReadInt(node_data.UnsignedCount(), node_data.Array()))
+      break;
+    if (!archive.ReadDouble(rect_data.UnsignedCount(), rect_data.Array()))
+      break;
+    if (!archive.ReadBigInt(id_data.UnsignedCount(), id_data.Array()))
+      break;
+    ON__UINT32 saved_crc = 0;
+    if (!archive.ReadInt(&saved_crc))
+      break;
+
+    ON__UINT32 crc = 0;
+    crc = ON_CRC32(crc, node_data.UnsignedCount() * sizeof(node_data[0]), node_data.Array());
+    crc = ON_CRC32(crc, rect_data.UnsignedCount() * sizeof(rect_data[0]), rect_data.Array());
+    crc = ON_CRC32(crc, id_data.UnsignedCount() * sizeof(id_data[0]), id_data.Array());
+    if (crc != saved_crc)
+    {
+      ON_ERROR("Saved ON_RTree is damaged.");
+      break;
+    }
+
+    if (0 == node_data_count)
+    {
+      // empty tree
+      rc = (0 == rect_data_count && 0 == id_data_count);
+      break;
+    }
+
+    // Rebuild the nodes in the order they were written.
+    const int node_count = node_data_count / 2;
+    const ON__INT32* nd = node_data.Array();
+    const double* rd = rect_data.Array();
+    const ON__INT64* idd = id_data.Array();
+    int node_index = 0;
+    int rect_index = 0;
+    int id_index = 0;
+    auto read_node = [&](int expected_level) -> ON_RTreeNode*
+    {
+      if (node_index >= node_count)
+        return nullptr;
+      const int level = nd[2 * node_index];
+      const int count = nd[2 * node_index + 1];
+      if (level < 0 || level >= 64 || (expected_level >= 0 && level != expected_level))
+        return nullptr;
+      if (count < 1 || count > ON_RTree_MAX_NODE_COUNT)
+        return nullptr;
+      if (rect_index + 6 * count > rect_data_count)
+        return nullptr;
+      if (0 == level && id_index + count > id_data_count)
+        return nullptr;
+      ON_RTreeNode* node = m_mem_pool.AllocNode();
+      if (nullptr == node)
+        return nullptr;
+      node->m_level = level;
+      node->m_count = count;
+      for (int i = 0; i < count; ++i, rect_index += 6)
+      {
+        ON_RTreeBranch& branch = node->m_branch[i];
+        for (int j = 0; j < 3; ++j)
+        {
+          branch.m_rect.m_min[j] = rd[rect_index + j];
+          branch.m_rect.m_max[j] = rd[rect_index + 3 + j];
+        }
+        if (0 == level)
+          branch.m_id = (ON__INT_PTR)idd[id_index++];
+        else
+          branch.m_child = nullptr;
+      }
+      ++node_index;
+      return node;
+    };
+
+    ON_RTreeNode* new_root = read_node(-1);
+    if (nullptr == new_root)
+      break;
+
+    // Child levels strictly decrease, so the depth is <= 64.
+    ON_RTreeNode* stack_node[64];
+    int stack_branch[64];
+    int depth = 0;
+    if (new_root->m_level > 0)
+    {
+      stack_node[0] = new_root;
+      stack_branch[0] = 0;
+      depth = 1;
+    }
+    bool bValid = true;
+    while (depth > 0)
+    {
+      ON_RTreeNode* parent = stack_node[depth - 1];
+      const int bi = stack_branch[depth - 1];
+      if (bi >= parent->m_count)
+      {
+        --depth;
+        continue;
+      }
+      ON_RTreeNode* child = read_node(parent->m_level - 1);
+      if (nullptr == child)
+      {
+        bValid = false;
+        break;
+      }
+      parent->m_branch[bi].m_child = child;
+      stack_branch[depth - 1] = bi + 1;
+      if (child->m_level > 0)
+      {
+        stack_node[depth] = child;
+        stack_branch[depth] = 0;
+        ++depth;
+      }
+    }
+    if (!bValid || node_index != node_count || rect_index != rect_data_count || id_index != id_data_count)
+      break;
+
+    root = new_root;
+    rc = true;
+    break;
+  }
+
+  if (!archive.EndRead3dmChunk(true))
+    rc = false;
+
+  if (!rc)
+  {
+    // Free nodes from a partial read. The caller rebuilds the tree.
+    RemoveAll();
+    return false;
+  }
+
+  m_root = root;
+  return true;
+}
+
 #endif
@@ -0,0 +1,187 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_ARCHIVE_MAPPED_INC_)
+#define OPENNURBS_ARCHIVE_MAPPED_INC_
+
+/*
+Description:
+  ON_MappedFileArchive reads a 3dm file that is mapped into memory.
+  It can be used anywhere an ON_BinaryFile opened for reading is used,
+  for example ONX_Model::Read().
+  - Reading copies bytes from the mapping. There are no read system
+    calls and no intermediate file buffer.
+  - ReadView() returns a pointer into the mapping instead of copying
+    the bytes into a caller supplied buffer.
+Remarks:
+  The file is mapped read only with mmap() on Apple, Linux and Android
+  and with MapViewOfFile() on Windows. On other platforms, and when the
+  file cannot be mapped, Open() returns false and ON_BinaryFile should
+  be used instead. In 32 bit processes, files larger than the available
+  address space cannot be mapped.
+  The file must not be changed while it is mapped.
+Example:
+
+        ON_MappedFileArchive archive(L"model.3dm");
+        ONX_Model model;
+        if (archive.IsOpen())
+          model.Read(archive);
+
+*/
+class ON_MappedFileArchive : public ON_BinaryArchive
+{
+public:
+  ON_MappedFileArchive();
+
+  /*
+  Description:
+    Construct an archive and call Open(file_system_path).
+    Use IsOpen() to see if the file was mapped.
+  */
+  ON_MappedFileArchive(
+    const wchar_t* file_system_path
+    );
+
+  ON_MappedFileArchive(
+    const char* file_system_path
+    );
+
+  ~ON_MappedFileArchive();
+
+  /*
+  Description:
+    Map a file into memory and set the archive position to the start of the file.
+  Parameters:
+    file_system_path - [in]
+      char strings are UTF-8 encoded.
+  Returns:
+    True if the file was mapped.
+  */
+  bool Open(
+    const wchar_t* file_system_path
+    );
+
+  bool Open(
+    const char* file_system_path
+    );
+
+  /*
+  Description:
+    Unmap the file. Views returned by ReadView() are no longer valid.
+  */
+  void Close();
+
+  bool IsOpen() const;
+
+  /*
+  Returns:
+    Pointer to the start of the mapped file or nullptr if no file is mapped.
+  */
+  const ON__UINT8* MappedBuffer() const;
+
+  /*
+  Returns:
+    Size of the mapped file in bytes.
+  */
+  ON__UINT64 MappedSize() const;
+
+  /*
+  Description:
+    Read bytes the way ReadByte() does, but instead of copying them,
+    return a pointer to the bytes in the mapping.
+  Parameters:
+    sizeof_view - [in]
+      Number of bytes to read.
+    view - [out]
+      Pointer to the first byte. The pointer is valid until Close() is called.
+  Returns:
+    True if successful.
+  Remarks:
+    - Chunk boundaries are checked exactly like ReadByte() checks them.
+    - When the current chunk has a CRC and CRC calculation is enabled,
+      the bytes are copied through ReadByte() into a 4 KB stack buffer
+      so the chunk CRC is updated. ON_BinaryArchive updates the CRC
+      with a private function, so it cannot be updated from the mapped
+      bytes directly. The view is still a pointer into the mapping, but
+      every byte is read twice. Callers that do not need CRC checking
+      can call EnableCRCCalculation(false) around ReadView() to skip
+      the copy.
+    - The bytes are in the archive's byte order (little endian) and are
+      not aligned. Use memcpy() or the ReadDouble(), ReadInt(), ...
+      functions for values that need to be swapped or aligned.
+  */
+  bool ReadView(
+    size_t sizeof_view,
+    const void** view
+    );
+
+protected:
+  // ON_BinaryArchive overrides
+  ON__UINT64 Internal_CurrentPositionOverride() const override;
+  bool Internal_SeekFromCurrentPositionOverride(int byte_offset) override;
+  bool Internal_SeekToStartOverride() override;
+
+public:
+  // ON_BinaryArchive overrides
+  bool AtEnd() const override;
+
+protected:
+  // ON_BinaryArchive overrides
+  size_t Internal_ReadOverride(size_t, void*) override;
+  size_t Internal_WriteOverride(size_t, const void*) override;
+  bool Flush() override;
+
+private:
+  const ON__UINT8* m_buffer = nullptr;
+  ON__UINT64 m_sizeof_buffer = 0;
+  ON__UINT64 m_buffer_position = 0;
+
+private:
+  // prohibit copy construction and operator=
+  ON_MappedFileArchive(const ON_MappedFileArchive&) = delete;
+  ON_MappedFileArchive& operator=(const ON_MappedFileArchive&) = delete;
+};
+
+/*
+Description:
+  Get an unsigned integer stored in little endian byte order, the byte
+  order of the integers in 3dm files.
+Parameters:
+  p - [in]
+    first byte of the value
+  sizeof_value - [in]
+    number of bytes in the value (<= 8)
+*/
+ON__UINT64 ON_LittleEndianValue(
+  const ON__UINT8* p,
+  unsigned int sizeof_value
+  );
+
+/*
+Description:
+  Store the low sizeof_value bytes of value in little endian byte order.
+Parameters:
+  value - [in]
+  sizeof_value - [in]
+    number of bytes to store (<= 8)
+  p - [out]
+*/
+void ON_SetLittleEndianValue(
+  ON__UINT64 value,
+  unsigned int sizeof_value,
+  ON__UINT8* p
+  );
+
+#include "opennurbs_archive_mapped_defs.h"
+
+#endif
@@ -0,0 +1,284 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_ARCHIVE_MAPPED_DEFS_INC_)
+#define OPENNURBS_ARCHIVE_MAPPED_DEFS_INC_
+
+#if defined(ON_RUNTIME_WIN) && !defined(ON_NO_WINDOWS)
+// CreateFileMappingW() and MapViewOfFile() are declared in windows.h,
+// which opennurbs_system.h includes.
+#elif defined(ON_RUNTIME_APPLE) || defined(ON_RUNTIME_LINUX) || defined(ON_RUNTIME_ANDROID)
+#pragma ON_PRAGMA_WARNING_BEFORE_DIRTY_INCLUDE
+#include <sys/mman.h> // for mmap()
+#include <fcntl.h>    // for open()
+#include <unistd.h>   // for close()
+#pragma ON_PRAGMA_WARNING_AFTER_DIRTY_INCLUDE
+#endif
+
+inline ON_MappedFileArchive::ON_MappedFileArchive()
+  : ON_BinaryArchive(ON::archive_mode::read3dm)
+{}
+
+inline ON_MappedFileArchive::ON_MappedFileArchive(const wchar_t* file_system_path)
+  : ON_BinaryArchive(ON::archive_mode::read3dm)
+{
+  Open(file_system_path);
+}
+
+inline ON_MappedFileArchive::ON_MappedFileArchive(const char* file_system_path)
+  : ON_BinaryArchive(ON::archive_mode::read3dm)
+{
+  Open(file_system_path);
+}
+
+inline ON_MappedFileArchive::~ON_MappedFileArchive()
+{
+  Close();
+}
+
+inline bool ON_MappedFileArchive::Open(const wchar_t* file_system_path)
+{
+  Close();
+  if (nullptr == file_system_path || 0 == file_system_path[0])
+    return false;
+
+#if defined(ON_RUNTIME_WIN) && !defined(ON_NO_WINDOWS)
+  HANDLE file = ::CreateFileW(
+    file_system_path,
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+    nullptr
+  );
+  if (INVALID_HANDLE_VALUE == file)
+    return false;
+  LARGE_INTEGER file_size;
+  file_size.QuadPart = 0;
+  HANDLE mapping = nullptr;
+  if (::GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 && (ON__UINT64)file_size.QuadPart <= (ON__UINT64)SIZE_MAX)
+    mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // The view keeps the mapping and the file open.
+  const void* view = (nullptr != mapping) ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (nullptr != mapping)
+    ::CloseHandle(mapping);
+  ::CloseHandle(file);
+  if (nullptr == view)
+    return false;
+  m_buffer = (const ON__UINT8*)view;
+  m_sizeof_buffer = (ON__UINT64)file_size.QuadPart;
+  m_buffer_position = 0;
+  return true;
+#else
+  const ON_String utf8_path(file_system_path);
+  return Open(static_cast<const char*>(utf8_path));
+#endif
+}
+
+inline bool ON_MappedFileArchive::Open(const char* file_system_path)
+{
+  Close();
+  if (nullptr == file_system_path || 0 == file_system_path[0])
+    return false;
+
+#if defined(ON_RUNTIME_WIN) && !defined(ON_NO_WINDOWS)
+  const ON_wString wide_path(file_system_path);
+  return Open(static_cast<const wchar_t*>(wide_path));
+#elif defined(ON_RUNTIME_APPLE) || defined(ON_RUNTIME_LINUX) || defined(ON_RUNTIME_ANDROID)
+  const int fd = ::open(file_system_path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat file_status;
+  void* view = MAP_FAILED;
+  if (0 == ::fstat(fd, &file_status) && file_status.st_size > 0 && (ON__UINT64)file_status.st_size <= (ON__UINT64)SIZE_MAX)
+    view = ::mmap(nullptr, (size_t)file_status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file open.
+  ::close(fd);
+  if (MAP_FAILED == view)
+    return false;
+  // 3dm files are read from start to end.
+  ::madvise(view, (size_t)file_status.st_size, MADV_SEQUENTIAL);
+  m_buffer = (const ON__UINT8*)view;
+  m_sizeof_buffer = (ON__UINT64)file_status.st_size;
+  m_buffer_position = 0;
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline void ON_MappedFileArchive::Close()
+{
+  if (nullptr != m_buffer)
+  {
+#if defined(ON_RUNTIME_WIN) && !defined(ON_NO_WINDOWS)
+    ::UnmapViewOfFile(m_buffer);
+#elif defined(ON_RUNTIME_APPLE) || defined(ON_RUNTIME_LINUX) || defined(ON_RUNTIME_ANDROID)
+    ::munmap((void*)m_buffer, (size_t)m_sizeof_buffer);
+#endif
+  }
+  m_buffer = nullptr;
+  m_sizeof_buffer = 0;
+  m_buffer_position = 0;
+}
+
+inline bool ON_MappedFileArchive::IsOpen() const
+{
+  return (nullptr != m_buffer);
+}
+
+inline const ON__UINT8* ON_MappedFileArchive::MappedBuffer() const
+{
+  return m_buffer;
+}
+
+inline ON__UINT64 ON_MappedFileArchive::MappedSize() const
+{
+  return m_sizeof_buffer;
+}
+
+inline bool ON_MappedFileArchive::ReadView(size_t sizeof_view, const void** view)
+{
+  if (nullptr == view)
+    return false;
+  *view = nullptr;
+  if (nullptr == m_buffer || m_buffer_position > m_sizeof_buffer)
+    return false;
+  if ((ON__UINT64)sizeof_view > m_sizeof_buffer - m_buffer_position)
+    return false;
+
+  const ON__UINT8* p = m_buffer + m_buffer_position;
+
+  ON_3DM_BIG_CHUNK chunk;
+  bool bChunkCRC
+    = GetCurrentChunk(chunk) > 0
+    && (0 != chunk.m_do_crc16 || 0 != chunk.m_do_crc32);
+  if (bChunkCRC)
+  {
+    // EnableCRCCalculation() returns the current setting.
+    bChunkCRC = EnableCRCCalculation(true);
+    EnableCRCCalculation(bChunkCRC);
+  }
+
+  bool rc = true;
+  if (bChunkCRC)
+  {
+    // UpdateCRC() is private, so the bytes are copied with ReadByte(),
+    // which updates the chunk CRC.
+    ON__UINT8 scratch[4096];
+    size_t remaining = sizeof_view;
+    while (rc && remaining > 0)
+    {
+      const size_t count = (remaining < sizeof(scratch)) ? remaining : sizeof(scratch);
+      rc = ReadByte(count, scratch);
+      remaining -= count;
+    }
+  }
+  else if (sizeof_view > 0)
+  {
+    rc = SeekForward(sizeof_view);
+  }
+
+  if (rc)
+    *view = p;
+  return rc;
+}
+
+inline ON__UINT64 ON_MappedFileArchive::Internal_CurrentPositionOverride() const
+{
+  return m_buffer_position;
+}
+
+inline bool ON_MappedFileArchive::Internal_SeekFromCurrentPositionOverride(int byte_offset)
+{
+  if (nullptr == m_buffer)
+    return false;
+  if (byte_offset < 0)
+  {
+    const ON__UINT64 back = (ON__UINT64)(-(ON__INT64)byte_offset);
+    if (back > m_buffer_position)
+      return false;
+    m_buffer_position -= back;
+  }
+  else
+  {
+    const ON__UINT64 forward = (ON__UINT64)byte_offset;
+    if (m_buffer_position > m_sizeof_buffer || forward > m_sizeof_buffer - m_buffer_position)
+      return false;
+    m_buffer_position += forward;
+  }
+  return true;
+}
+
+inline bool ON_MappedFileArchive::Internal_SeekToStartOverride()
+{
+  if (nullptr == m_buffer)
+    return false;
+  m_buffer_position = 0;
+  return true;
+}
+
+inline bool ON_MappedFileArchive::AtEnd() const
+{
+  return (m_buffer_position >= m_sizeof_buffer);
+}
+
+inline size_t ON_MappedFileArchive::Internal_ReadOverride(size_t count, void* buffer)
+{
+  if (nullptr == m_buffer || nullptr == buffer || m_buffer_position >= m_sizeof_buffer)
+    return 0;
+  const ON__UINT64 available = m_sizeof_buffer - m_buffer_position;
+  if ((ON__UINT64)count > available)
+    count = (size_t)available;
+  memcpy(buffer, m_buffer + m_buffer_position, count);
+  m_buffer_position += count;
+  return count;
+}
+
+inline size_t ON_MappedFileArchive::Internal_WriteOverride(size_t, const void*)
+{
+  // mapped archives are read only
+  return 0;
+}
+
+inline bool ON_MappedFileArchive::Flush()
+{
+  return false;
+}
+
+inline ON__UINT64 ON_LittleEndianValue(
+  const ON__UINT8* p,
+  unsigned int sizeof_value
+  )
+{
+  ON__UINT64 value = 0;
+  for (unsigned int i = sizeof_value; i > 0; --i)
+    value = (value << 8) | p[i - 1];
+  return value;
+}
+
+inline void ON_SetLittleEndianValue(
+  ON__UINT64 value,
+  unsigned int sizeof_value,
+  ON__UINT8* p
+  )
+{
+  for (unsigned int i = 0; i < sizeof_value; ++i)
+  {
+    p[i] = (ON__UINT8)(value & 0xFF);
+    value >>= 8;
+  }
+}
+
+#endif
@@ -0,0 +1,344 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_BATCH_CLOSEST_POINT_INC_)
+#define OPENNURBS_BATCH_CLOSEST_POINT_INC_
+
+/*
+Description:
+  ON_BatchClosestPoint finds the closest points on a set of curves and
+  surfaces to many query points.
+
+  Build() makes an ON_RTree with the bounding box of the control points
+  of every nonempty span of every curve and every span patch of every
+  surface. A span is inside the convex hull of its control points, so
+  the box of a span contains the span. A query is a best-first
+  ON_RTree::SearchNearest() over the span boxes. Newton iterations find
+  the closest point on a span, and only spans whose boxes are closer than
+  the best point found so far are visited.
+
+  GetClosestPoints() splits the query points into contiguous ranges, one
+  per thread. The closest span and parameters of the previous point in
+  the range are tried first for the next point. For ordered scan data
+  this usually gives a tight distance bound before the tree is searched,
+  and the Newton iterations on that span converge in a few steps.
+Remarks:
+  - Curves and surfaces are copied in their NURBS form. When the NURBS form
+    has a different parameterization, the added curve or surface must exist
+    while the ON_BatchClosestPoint is used, so results can be converted to
+    its parameters.
+  - Closest points on brep faces respect trimming. See AddBrepFaces().
+  - After Build(), the const member functions may be called from multiple threads.
+*/
+class ON_BatchClosestPoint
+{
+public:
+  ON_BatchClosestPoint() = default;
+  ~ON_BatchClosestPoint() = default;
+
+  /*
+  Description:
+    Add a curve.
+  Returns:
+    The object index of the curve or -1 if the curve does not have a
+    NURBS form.
+  */
+  int AddCurve(
+    const class ON_Curve& curve
+    );
+
+  /*
+  Description:
+    Add a surface.
+  Returns:
+    The object index of the surface or -1 if the surface does not have a
+    NURBS form.
+  */
+  int AddSurface(
+    const class ON_Surface& surface
+    );
+
+  /*
+  Description:
+    Add the faces of a brep. Closest points on a face are inside its
+    trimming loops: when the closest point on a span of the face's
+    surface is outside the loops, that span is not used and the closest
+    point on the face's edges is found instead.
+  Parameters:
+    brep - [in]
+      The brep must exist and must not be modified while the
+      ON_BatchClosestPoint is used.
+    face_object_index - [out]
+      If not nullptr, face_object_index[fi] is set to the object index
+      of brep.m_F[fi] or -1. The array must have brep.m_F.Count() elements.
+  Returns:
+    Number of faces added.
+  Remarks:
+    Trimming loops are approximated by polylines with
+    ON_BATCH_CLOSEST_POINT_TRIM_SPAN_SAMPLE_COUNT points on each span of
+    each trim, so points very close to a trim may be classified by the
+    polyline. Only the closest point on each span of the surface is
+    tested against the loops. When it is outside the loops, a second
+    local minimum of that span inside the loops is not found.
+  */
+  int AddBrepFaces(
+    const class ON_Brep& brep,
+    int* face_object_index = nullptr
+    );
+
+  /*
+  Description:
+    Create the span bounding boxes and the R-tree.
+    Call after the curves and surfaces are added.
+  Parameters:
+    bMultithreaded - [in]
+      If true and there are many spans, the R-tree is sorted on multiple threads.
+  Returns:
+    True if successful.
+  */
+  bool Build(
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Remove every curve and surface.
+  */
+  void Destroy();
+
+  int ObjectCount() const;
+
+  /*
+  Returns:
+    The NURBS form of the curve with the object index or nullptr
+    if the object is not a curve.
+  */
+  const class ON_NurbsCurve* Curve(
+    int object_index
+    ) const;
+
+  /*
+  Returns:
+    The NURBS form of the surface with the object index or nullptr
+    if the object is not a surface.
+  */
+  const class ON_NurbsSurface* Surface(
+    int object_index
+    ) const;
+
+  class Result
+  {
+  public:
+    // Object index from AddCurve(), AddSurface() or AddBrepFaces().
+    // -1 if no closest point was found.
+    int m_object_index = -1;
+
+    // Curve parameter in m_t[0] or surface parameters in m_t[0] and m_t[1].
+    // The parameters are those of the curve or surface that was added.
+    // For a brep face, they are the parameters of the face's surface, also
+    // when the point is on an edge.
+    double m_t[2] = { ON_UNSET_VALUE, ON_UNSET_VALUE };
+
+    ON_3dPoint m_point = ON_3dPoint::UnsetPoint;
+
+    double m_distance = ON_DBL_MAX;
+  };
+
+  /*
+  Description:
+    Find the closest point to P.
+  Parameters:
+    P - [in]
+    maximum_distance - [in]
+      If > 0, only points with distance <= maximum_distance are found.
+    result - [out]
+  Returns:
+    True if a point was found.
+  */
+  bool GetClosestPoint(
+    ON_3dPoint P,
+    double maximum_distance,
+    Result& result
+    ) const;
+
+  /*
+  Description:
+    Find the closest points to many points.
+  Parameters:
+    points - [in]
+    point_count - [in]
+    maximum_distance - [in]
+      If > 0, only points with distance <= maximum_distance are found.
+    results - [out]
+      array of point_count results. results[i] is the closest point to points[i].
+    thread_count - [in]
+      Maximum number of threads to use. 0 uses every hardware thread.
+  Returns:
+    Number of points with a closest point.
+  Remarks:
+    Points that are near each other in the points[] array should be near each
+    other in space. Scan lines and grids are already in a good order.
+  */
+  size_t GetClosestPoints(
+    const ON_3dPoint* points,
+    size_t point_count,
+    double maximum_distance,
+    Result* results,
+    unsigned int thread_count = 0
+    ) const;
+
+private:
+  class Object
+  {
+  public:
+    // index in m_curves[] or -1
+    int m_curve_index = -1;
+    // index in m_surfaces[] or -1
+    int m_surface_index = -1;
+    // If not nullptr, the NURBS form has a different parameterization
+    // and results are converted to the parameters of these.
+    const class ON_Curve* m_curve = nullptr;
+    const class ON_Surface* m_surface = nullptr;
+    // index in m_face_loops[] of a brep face or -1
+    int m_face_loops_index = -1;
+  };
+
+  // An edge of a brep face
+  class Edge
+  {
+  public:
+    // index in m_curves[]
+    int m_curve_index = -1;
+    const class ON_BrepEdge* m_edge = nullptr;
+    // the face's trim that uses the edge
+    const class ON_BrepTrim* m_trim = nullptr;
+    // object index of the face
+    int m_face_object_index = -1;
+  };
+
+  // Polygons that approximate the trimming loops of a face in the
+  // parameter space of the face's surface.
+  class FaceLoops
+  {
+  public:
+    ON_SimpleArray<ON_2dPoint> m_points;
+    // Loop i is m_points[m_loop_end[i-1]] to m_points[m_loop_end[i]-1].
+    ON_SimpleArray<int> m_loop_end;
+  };
+
+  class Span
+  {
+  public:
+    // Object index. For an edge span, the object index of the face.
+    int m_object_index;
+    // index in m_edges[] or -1
+    int m_edge_index;
+    ON_Interval m_domain[2];
+  };
+
+  // Closest point on one span
+  class SpanPoint
+  {
+  public:
+    int m_span_index = -1;
+    double m_t[2] = { 0.0, 0.0 };
+    ON_3dPoint m_point = ON_3dPoint::UnsetPoint;
+    double m_distance = ON_DBL_MAX;
+  };
+
+  class Query;
+
+  // Append the NURBS form of curve to m_curves[]. Returns the index or -1.
+  int Internal_AddNurbsCurve(
+    const class ON_Curve& curve,
+    int* nurb_form_rc
+    );
+
+  static void Internal_GetLoopPolygons(
+    const class ON_BrepFace& face,
+    FaceLoops& loops
+    );
+
+  // True if the NURBS form surface parameters t[] are inside the face loops.
+  bool Internal_IsInsideFace(
+    const Object& object,
+    const double t[2]
+    ) const;
+
+  // Surface parameters of the face at a closest point on an edge.
+  void Internal_GetEdgePointSurfaceParameters(
+    const Edge& edge,
+    const Object& face_object,
+    const SpanPoint& span_point,
+    double t[2]
+    ) const;
+
+  bool Internal_GetClosestPoint(
+    const ON_3dPoint& P,
+    double maximum_distance,
+    const SpanPoint* seed,
+    ON_SimpleArray<ON_RTreeNeighbor>& neighbors,
+    SpanPoint& best
+    ) const;
+
+  bool Internal_SpanClosestPoint(
+    int span_index,
+    const ON_3dPoint& P,
+    const double* seed_t,
+    SpanPoint& span_point
+    ) const;
+
+  static double ON_CALLBACK_CDECL Internal_SpanDistance(
+    void* context,
+    ON__INT_PTR span_index
+    );
+
+  void Internal_SetResult(
+    const SpanPoint& span_point,
+    Result& result
+    ) const;
+
+  static bool Internal_CurveSpanClosestPoint(
+    const class ON_NurbsCurve& curve,
+    const ON_Interval& domain,
+    const ON_3dPoint& P,
+    const double* seed_t,
+    double& t,
+    ON_3dPoint& Q
+    );
+
+  static bool Internal_SurfaceSpanClosestPoint(
+    const class ON_NurbsSurface& surface,
+    const ON_Interval domain[2],
+    const ON_3dPoint& P,
+    const double* seed_t,
+    double t[2],
+    ON_3dPoint& Q
+    );
+
+  ON_ObjectArray<ON_NurbsCurve> m_curves;
+  ON_ObjectArray<ON_NurbsSurface> m_surfaces;
+  ON_SimpleArray<Object> m_objects;
+  ON_SimpleArray<Edge> m_edges;
+  ON_ClassArray<FaceLoops> m_face_loops;
+  ON_SimpleArray<Span> m_spans;
+  ON_RTree m_tree;
+
+private:
+  ON_BatchClosestPoint(const ON_BatchClosestPoint&) = delete;
+  ON_BatchClosestPoint& operator=(const ON_BatchClosestPoint&) = delete;
+};
+
+#include "opennurbs_batch_closest_point_defs.h"
+
+#endif
@@ -0,0 +1,772 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_BATCH_CLOSEST_POINT_DEFS_INC_)
+#define OPENNURBS_BATCH_CLOSEST_POINT_DEFS_INC_
+
+// Maximum number of Newton iterations on a span.
+#define ON_BATCH_CLOSEST_POINT_MAX_ITERATIONS 16
+
+// Minimum number of query points a thread must have in GetClosestPoints().
+#define ON_BATCH_CLOSEST_POINT_MIN_COUNT_PER_THREAD 64
+
+// Number of polyline points on each span of a trim in the face loop polygons.
+#define ON_BATCH_CLOSEST_POINT_TRIM_SPAN_SAMPLE_COUNT 16
+
+// Search context passed to ON_BatchClosestPoint::Internal_SpanDistance().
+class ON_BatchClosestPoint::Query
+{
+public:
+  const ON_BatchClosestPoint* m_batch;
+  ON_3dPoint m_P;
+  // points farther than this are not results
+  double m_maximum_distance;
+  // closest point on the seed span or nullptr
+  const SpanPoint* m_seed_point;
+  SpanPoint* m_best;
+};
+
+inline int ON_BatchClosestPoint::Internal_AddNurbsCurve(
+  const ON_Curve& curve,
+  int* nurb_form_rc
+  )
+{
+  const int curve_index = m_curves.Count();
+  ON_NurbsCurve& nurbs_curve = m_curves.AppendNew();
+  *nurb_form_rc = curve.GetNurbForm(nurbs_curve);
+  if (0 == *nurb_form_rc || nurbs_curve.m_order < 2 || nurbs_curve.m_cv_count < nurbs_curve.m_order
+    || (3 != nurbs_curve.m_dim && false == nurbs_curve.ChangeDimension(3)))
+  {
+    m_curves.Remove(curve_index);
+    return -1;
+  }
+  return curve_index;
+}
+
+inline int ON_BatchClosestPoint::AddCurve(
+  const ON_Curve& curve
+  )
+{
+  int rc = 0;
+  const int curve_index = Internal_AddNurbsCurve(curve, &rc);
+  if (curve_index < 0)
+    return -1;
+  Object& object = m_objects.AppendNew();
+  object = Object();
+  object.m_curve_index = curve_index;
+  if (2 == rc)
+    object.m_curve = &curve;
+  return m_objects.Count() - 1;
+}
+
+inline int ON_BatchClosestPoint::AddSurface(
+  const ON_Surface& surface
+  )
+{
+  const int surface_index = m_surfaces.Count();
+  ON_NurbsSurface& nurbs_surface = m_surfaces.AppendNew();
+  const int rc = surface.GetNurbForm(nurbs_surface);
+  if (0 == rc
+    || nurbs_surface.m_order[0] < 2 || nurbs_surface.m_cv_count[0] < nurbs_surface.m_order[0]
+    || nurbs_surface.m_order[1] < 2 || nurbs_surface.m_cv_count[1] < nurbs_surface.m_order[1]
+    || (3 != nurbs_surface.m_dim && false == nurbs_surface.ChangeDimension(3)))
+  {
+    m_surfaces.Remove(surface_index);
+    return -1;
+  }
+  Object& object = m_objects.AppendNew();
+  object = Object();
+  object.m_surface_index = surface_index;
+  if (2 == rc)
+    object.m_surface = &surface;
+  return m_objects.Count() - 1;
+}
+
+inline int ON_BatchClosestPoint::AddBrepFaces(
+  const ON_Brep& brep,
+  int* face_object_index
+  )
+{
+  int added_count = 0;
+  const int face_count = brep.m_F.Count();
+  for (int fi = 0; fi < face_count; ++fi)
+  {
+    const ON_BrepFace& face = brep.m_F[fi];
+    const ON_Surface* surface = (face.m_face_index >= 0) ? face.SurfaceOf() : nullptr;
+    const int object_index = (nullptr != surface) ? AddSurface(*surface) : -1;
+    if (nullptr != face_object_index)
+      face_object_index[fi] = object_index;
+    if (object_index < 0)
+      continue;
+    ++added_count;
+
+    FaceLoops& loops = m_face_loops.AppendNew();
+    Internal_GetLoopPolygons(face, loops);
+    m_objects[object_index].m_face_loops_index = m_face_loops.Count() - 1;
+
+    // The edges of the face are used when the closest point on a span
+    // of the surface is outside the loops.
+    const int edge_count0 = m_edges.Count();
+    for (int fli = 0; fli < face.LoopCount(); ++fli)
+    {
+      const ON_BrepLoop* loop = face.Loop(fli);
+      for (int lti = 0; nullptr != loop && lti < loop->TrimCount(); ++lti)
+      {
+        const ON_BrepTrim* trim = loop->Trim(lti);
+        const ON_BrepEdge* edge = (nullptr != trim) ? trim->Edge() : nullptr;
+        if (nullptr == edge)
+          continue;
+        bool bAdded = false;
+        for (int ei = edge_count0; ei < m_edges.Count() && false == bAdded; ++ei)
+          bAdded = (edge == m_edges[ei].m_edge);
+        int rc = 0;
+        const int curve_index = bAdded ? -1 : Internal_AddNurbsCurve(*edge, &rc);
+        if (curve_index < 0)
+          continue;
+        Edge& e = m_edges.AppendNew();
+        e = Edge();
+        e.m_curve_index = curve_index;
+        e.m_edge = edge;
+        e.m_trim = trim;
+        e.m_face_object_index = object_index;
+      }
+    }
+  }
+  return added_count;
+}
+
+inline void ON_BatchClosestPoint::Internal_GetLoopPolygons(
+  const ON_BrepFace& face,
+  FaceLoops& loops
+  )
+{
+  const int n = ON_BATCH_CLOSEST_POINT_TRIM_SPAN_SAMPLE_COUNT;
+  ON_SimpleArray<double> s;
+  for (int fli = 0; fli < face.LoopCount(); ++fli)
+  {
+    const ON_BrepLoop* loop = face.Loop(fli);
+    if (nullptr == loop || ON_BrepLoop::ptonsrf == loop->m_type)
+      continue;
+    const int loop_start = loops.m_points.Count();
+    for (int lti = 0; lti < loop->TrimCount(); ++lti)
+    {
+      const ON_BrepTrim* trim = loop->Trim(lti);
+      const int span_count = (nullptr != trim) ? trim->SpanCount() : 0;
+      if (span_count < 1)
+        continue;
+      s.SetCount(0);
+      s.Reserve(span_count + 1);
+      s.SetCount(span_count + 1);
+      if (false == trim->GetSpanVector(s.Array()))
+        continue;
+      // The end of a trim is the start of the next trim in the loop.
+      for (int si = 0; si < span_count; ++si)
+      {
+        for (int k = 0; k < n; ++k)
+        {
+          const ON_3dPoint p = trim->PointAt(s[si] + (s[si + 1] - s[si]) * ((double)k) / ((double)n));
+          loops.m_points.Append(ON_2dPoint(p.x, p.y));
+        }
+      }
+    }
+    if (loops.m_points.Count() - loop_start >= 3)
+      loops.m_loop_end.Append(loops.m_points.Count());
+    else
+      loops.m_points.SetCount(loop_start);
+  }
+}
+
+inline bool ON_BatchClosestPoint::Internal_IsInsideFace(
+  const Object& object,
+  const double t[2]
+  ) const
+{
+  if (object.m_face_loops_index < 0)
+    return true;
+  ON_2dPoint p(t[0], t[1]);
+  if (nullptr != object.m_surface)
+    object.m_surface->GetSurfaceParameterFromNurbFormParameter(t[0], t[1], &p.x, &p.y);
+
+  // Even-odd rule over every loop, so points in holes are outside.
+  const FaceLoops& loops = m_face_loops[object.m_face_loops_index];
+  const ON_2dPoint* points = loops.m_points.Array();
+  bool bInside = false;
+  int i0 = 0;
+  for (int li = 0; li < loops.m_loop_end.Count(); ++li)
+  {
+    const int i1 = loops.m_loop_end[li];
+    for (int i = i0, j = i1 - 1; i < i1; j = i++)
+    {
+      const ON_2dPoint& a = points[i];
+      const ON_2dPoint& b = points[j];
+      if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (b.x - a.x) * (p.y - a.y) / (b.y - a.y))
+        bInside = !bInside;
+    }
+    i0 = i1;
+  }
+  return bInside;
+}
+
+inline bool ON_BatchClosestPoint::Build(
+  bool bMultithreaded
+  )
+{
+  m_tree.RemoveAll();
+  m_spans.SetCount(0);
+  ON_SimpleArray<ON_RTreeBBox> boxes;
+
+  // Box of the Euclidean control points cv[i*stride0 + j*stride1], 0 <= i < count0, 0 <= j < count1.
+  auto AddSpan = [this, &boxes](int object_index, const ON_Interval& d0, const ON_Interval& d1,
+    const double* cv, int count0, int stride0, int count1, int stride1, bool bIsRational)
+  {
+    ON_RTreeBBox& box = boxes.AppendNew();
+    box.m_min[0] = box.m_min[1] = box.m_min[2] = ON_DBL_MAX;
+    box.m_max[0] = box.m_max[1] = box.m_max[2] = -ON_DBL_MAX;
+    for (int i = 0; i < count0; ++i)
+    {
+      for (int j = 0; j < count1; ++j)
+      {
+        const double* p = cv + (size_t)i * stride0 + (size_t)j * stride1;
+        const double w = (bIsRational && 0.0 != p[3]) ? (1.0 / p[3]) : 1.0;
+        for (int k = 0; k < 3; ++k)
+        {
+          const double x = w * p[k];
+          if (x < box.m_min[k])
+            box.m_min[k] = x;
+          if (x > box.m_max[k])
+            box.m_max[k] = x;
+        }
+      }
+    }
+    Span& span = m_spans.AppendNew();
+    span.m_object_index = object_index;
+    span.m_edge_index = -1;
+    span.m_domain[0] = d0;
+    span.m_domain[1] = d1;
+  };
+
+  const int object_count = m_objects.Count();
+  for (int oi = 0; oi < object_count; ++oi)
+  {
+    const Object& object = m_objects[oi];
+    if (object.m_curve_index >= 0)
+    {
+      const ON_NurbsCurve& c = m_curves[object.m_curve_index];
+      for (int s = 0; s + c.m_order <= c.m_cv_count; ++s)
+      {
+        const ON_Interval d(c.m_knot[s + c.m_order - 2], c.m_knot[s + c.m_order - 1]);
+        if (d[0] < d[1])
+          AddSpan(oi, d, ON_Interval::EmptyInterval, c.CV(s), c.m_order, c.m_cv_stride, 1, 0, c.m_is_rat ? true : false);
+      }
+    }
+    else if (object.m_surface_index >= 0)
+    {
+      const ON_NurbsSurface& srf = m_surfaces[object.m_surface_index];
+      for (int i = 0; i + srf.m_order[0] <= srf.m_cv_count[0]; ++i)
+      {
+        const ON_Interval d0(srf.m_knot[0][i + srf.m_order[0] - 2], srf.m_knot[0][i + srf.m_order[0] - 1]);
+        if (!(d0[0] < d0[1]))
+          continue;
+        for (int j = 0; j + srf.m_order[1] <= srf.m_cv_count[1]; ++j)
+        {
+          const ON_Interval d1(srf.m_knot[1][j + srf.m_order[1] - 2], srf.m_knot[1][j + srf.m_order[1] - 1]);
+          if (d1[0] < d1[1])
+            AddSpan(oi, d0, d1, srf.CV(i, j), srf.m_order[0], srf.m_cv_stride[0], srf.m_order[1], srf.m_cv_stride[1], srf.m_is_rat ? true : false);
+        }
+      }
+    }
+  }
+
+  const int edge_count = m_edges.Count();
+  for (int ei = 0; ei < edge_count; ++ei)
+  {
+    const ON_NurbsCurve& c = m_curves[m_edges[ei].m_curve_index];
+    for (int s = 0; s + c.m_order <= c.m_cv_count; ++s)
+    {
+      const ON_Interval d(c.m_knot[s + c.m_order - 2], c.m_knot[s + c.m_order - 1]);
+      if (!(d[0] < d[1]))
+        continue;
+      AddSpan(m_edges[ei].m_face_object_index, d, ON_Interval::EmptyInterval, c.CV(s), c.m_order, c.m_cv_stride, 1, 0, c.m_is_rat ? true : false);
+      m_spans.Last()->m_edge_index = ei;
+    }
+  }
+
+  if (0 == boxes.Count())
+    return false;
+  return m_tree.BulkLoad(boxes.Array(), nullptr, (size_t)boxes.Count(), bMultithreaded);
+}
+
+inline void ON_BatchClosestPoint::Destroy()
+{
+  m_tree.RemoveAll();
+  m_spans.Destroy();
+  m_face_loops.Destroy();
+  m_edges.Destroy();
+  m_objects.Destroy();
+  m_surfaces.Destroy();
+  m_curves.Destroy();
+}
+
+inline int ON_BatchClosestPoint::ObjectCount() const
+{
+  return m_objects.Count();
+}
+
+inline const ON_NurbsCurve* ON_BatchClosestPoint::Curve(
+  int object_index
+  ) const
+{
+  return (object_index >= 0 && object_index < m_objects.Count() && m_objects[object_index].m_curve_index >= 0)
+    ? &m_curves[m_objects[object_index].m_curve_index]
+    : nullptr;
+}
+
+inline const ON_NurbsSurface* ON_BatchClosestPoint::Surface(
+  int object_index
+  ) const
+{
+  return (object_index >= 0 && object_index < m_objects.Count() && m_objects[object_index].m_surface_index >= 0)
+    ? &m_surfaces[m_objects[object_index].m_surface_index]
+    : nullptr;
+}
+
+inline bool ON_BatchClosestPoint::GetClosestPoint(
+  ON_3dPoint P,
+  double maximum_distance,
+  Result& result
+  ) const
+{
+  result = Result();
+  ON_SimpleArray<ON_RTreeNeighbor> neighbors(4);
+  SpanPoint best;
+  if (false == Internal_GetClosestPoint(P, maximum_distance, nullptr, neighbors, best))
+    return false;
+  Internal_SetResult(best, result);
+  return true;
+}
+
+inline size_t ON_BatchClosestPoint::GetClosestPoints(
+  const ON_3dPoint* points,
+  size_t point_count,
+  double maximum_distance,
+  Result* results,
+  unsigned int thread_count
+  ) const
+{
+  if (nullptr == points || nullptr == results || 0 == point_count)
+    return 0;
+
+  thread_count = ON_Parallel::ThreadCount(point_count, ON_BATCH_CLOSEST_POINT_MIN_COUNT_PER_THREAD, thread_count);
+  std::atomic<size_t> found_count(0);
+  ON_Parallel::ForRanges(point_count, thread_count,
+    [this, points, maximum_distance, results, &found_count](size_t i0, size_t i1, unsigned int)
+    {
+      ON_SimpleArray<ON_RTreeNeighbor> neighbors(4);
+      SpanPoint seed;
+      SpanPoint best;
+      size_t count = 0;
+      for (size_t i = i0; i < i1; ++i)
+      {
+        results[i] = Result();
+        if (false == Internal_GetClosestPoint(points[i], maximum_distance, (seed.m_span_index >= 0) ? &seed : nullptr, neighbors, best))
+          continue;
+        Internal_SetResult(best, results[i]);
+        seed = best;
+        ++count;
+      }
+      found_count += count;
+    }
+  );
+  return found_count;
+}
+
+inline bool ON_BatchClosestPoint::Internal_GetClosestPoint(
+  const ON_3dPoint& P,
+  double maximum_distance,
+  const SpanPoint* seed,
+  ON_SimpleArray<ON_RTreeNeighbor>& neighbors,
+  SpanPoint& best
+  ) const
+{
+  best = SpanPoint();
+  if (false == P.IsValid())
+    return false;
+  double bound = (maximum_distance > 0.0) ? maximum_distance : ON_DBL_MAX;
+
+  Query query;
+  query.m_batch = this;
+  query.m_P = P;
+  query.m_maximum_distance = bound;
+  query.m_seed_point = nullptr;
+  query.m_best = &best;
+
+  // The closest point on the previous point's span is usually close to
+  // the answer and limits the search to the spans that are closer.
+  SpanPoint seed_point;
+  if (nullptr != seed
+    && Internal_SpanClosestPoint(seed->m_span_index, P, seed->m_t, seed_point)
+    && seed_point.m_distance <= bound)
+  {
+    best = seed_point;
+    bound = seed_point.m_distance;
+    query.m_seed_point = &seed_point;
+  }
+
+  neighbors.SetCount(0);
+  m_tree.SearchNearest(&P.x, 1, bound, Internal_SpanDistance, &query, neighbors);
+  return best.m_span_index >= 0;
+}
+
+inline double ON_CALLBACK_CDECL ON_BatchClosestPoint::Internal_SpanDistance(
+  void* context,
+  ON__INT_PTR span_index
+  )
+{
+  Query* query = (Query*)context;
+  if (nullptr != query->m_seed_point && span_index == (ON__INT_PTR)query->m_seed_point->m_span_index)
+    return query->m_seed_point->m_distance;
+  SpanPoint span_point;
+  if (false == query->m_batch->Internal_SpanClosestPoint((int)span_index, query->m_P, nullptr, span_point))
+    return -1.0;
+  // SearchNearest() ignores distances larger than its bound, but the
+  // best point is set here and must honor the maximum distance too.
+  if (span_point.m_distance <= query->m_maximum_distance && span_point.m_distance < query->m_best->m_distance)
+    *query->m_best = span_point;
+  return span_point.m_distance;
+}
+
+inline bool ON_BatchClosestPoint::Internal_SpanClosestPoint(
+  int span_index,
+  const ON_3dPoint& P,
+  const double* seed_t,
+  SpanPoint& span_point
+  ) const
+{
+  if (span_index < 0 || span_index >= m_spans.Count())
+    return false;
+  const Span& span = m_spans[span_index];
+  const Object& object = m_objects[span.m_object_index];
+  const int curve_index = (span.m_edge_index >= 0) ? m_edges[span.m_edge_index].m_curve_index : object.m_curve_index;
+  ON_3dPoint Q;
+  bool rc = false;
+  if (curve_index >= 0)
+  {
+    rc = Internal_CurveSpanClosestPoint(m_curves[curve_index], span.m_domain[0], P, seed_t, span_point.m_t[0], Q);
+    span_point.m_t[1] = 0.0;
+  }
+  else if (object.m_surface_index >= 0)
+  {
+    // A point outside the trimming loops of a face is not on the face.
+    // The closest point on the face's edges is found by the edge spans.
+    rc = Internal_SurfaceSpanClosestPoint(m_surfaces[object.m_surface_index], span.m_domain, P, seed_t, span_point.m_t, Q)
+      && Internal_IsInsideFace(object, span_point.m_t);
+  }
+  if (false == rc)
+    return false;
+  span_point.m_span_index = span_index;
+  span_point.m_point = Q;
+  span_point.m_distance = P.DistanceTo(Q);
+  return true;
+}
+
+inline void ON_BatchClosestPoint::Internal_SetResult(
+  const SpanPoint& span_point,
+  Result& result
+  ) const
+{
+  const Span& span = m_spans[span_point.m_span_index];
+  const Object& object = m_objects[span.m_object_index];
+  result.m_object_index = span.m_object_index;
+  result.m_point = span_point.m_point;
+  result.m_distance = span_point.m_distance;
+  result.m_t[0] = span_point.m_t[0];
+  result.m_t[1] = ON_UNSET_VALUE;
+  if (span.m_edge_index >= 0)
+  {
+    Internal_GetEdgePointSurfaceParameters(m_edges[span.m_edge_index], object, span_point, result.m_t);
+  }
+  else if (object.m_curve_index >= 0)
+  {
+    if (nullptr != object.m_curve)
+      object.m_curve->GetCurveParameterFromNurbFormParameter(span_point.m_t[0], &result.m_t[0]);
+  }
+  else
+  {
+    result.m_t[1] = span_point.m_t[1];
+    if (nullptr != object.m_surface)
+      object.m_surface->GetSurfaceParameterFromNurbFormParameter(span_point.m_t[0], span_point.m_t[1], &result.m_t[0], &result.m_t[1]);
+  }
+}
+
+inline void ON_BatchClosestPoint::Internal_GetEdgePointSurfaceParameters(
+  const Edge& edge,
+  const Object& face_object,
+  const SpanPoint& span_point,
+  double t[2]
+  ) const
+{
+  // Edge and trim parameters are not related exactly. The trim point at
+  // the same normalized parameter starts Newton iterations for the
+  // surface parameters of the edge point.
+  double edge_t = span_point.m_t[0];
+  edge.m_edge->GetCurveParameterFromNurbFormParameter(span_point.m_t[0], &edge_t);
+  double x = edge.m_edge->Domain().NormalizedParameterAt(edge_t);
+  if (edge.m_trim->m_bRev3d)
+    x = 1.0 - x;
+  const ON_3dPoint uv = edge.m_trim->PointAt(edge.m_trim->Domain().ParameterAt(x));
+  double seed_t[2] = { uv.x, uv.y };
+  if (nullptr != face_object.m_surface)
+    face_object.m_surface->GetNurbFormParameterFromSurfaceParameter(uv.x, uv.y, &seed_t[0], &seed_t[1]);
+
+  const ON_NurbsSurface& surface = m_surfaces[face_object.m_surface_index];
+  const ON_Interval domain[2] = { surface.Domain(0), surface.Domain(1) };
+  double nurbs_t[2] = { seed_t[0], seed_t[1] };
+  ON_3dPoint Q;
+  if (false == Internal_SurfaceSpanClosestPoint(surface, domain, span_point.m_point, seed_t, nurbs_t, Q))
+  {
+    nurbs_t[0] = seed_t[0];
+    nurbs_t[1] = seed_t[1];
+  }
+  t[0] = nurbs_t[0];
+  t[1] = nurbs_t[1];
+  if (nullptr != face_object.m_surface)
+    face_object.m_surface->GetSurfaceParameterFromNurbFormParameter(nurbs_t[0], nurbs_t[1], &t[0], &t[1]);
+}
+
+inline bool ON_BatchClosestPoint::Internal_CurveSpanClosestPoint(
+  const ON_NurbsCurve& curve,
+  const ON_Interval& domain,
+  const ON_3dPoint& P,
+  const double* seed_t,
+  double& t,
+  ON_3dPoint& Q
+  )
+{
+  // Evaluate from inside the span at its ends.
+  int hint = 0;
+  double v[9];
+  auto Clamp = [](const ON_Interval& d, double s) { d.Clamp(s); return s; };
+  auto Side = [&domain](double s) { return (s >= domain[1]) ? -1 : 1; };
+
+  // Start at the closest of the seed and order+1 samples. A seed is
+  // tried first and is used unless a sample is closer, so a seed that
+  // is far from the answer cannot lead to a worse local minimum.
+  double best_d2 = ON_DBL_MAX;
+  double best_t = domain[0];
+  const int sample_count = curve.m_order + 1;
+  for (int k = (nullptr != seed_t) ? -1 : 0; k < sample_count; ++k)
+  {
+    const double s = (k < 0) ? Clamp(domain, seed_t[0]) : domain.ParameterAt(((double)k) / ((double)(sample_count - 1)));
+    if (false == curve.Evaluate(s, 0, 3, v, Side(s), &hint))
+      return false;
+    const double d2 = (v[0] - P.x) * (v[0] - P.x) + (v[1] - P.y) * (v[1] - P.y) + (v[2] - P.z) * (v[2] - P.z);
+    if (d2 < best_d2)
+    {
+      best_d2 = d2;
+      best_t = s;
+    }
+  }
+  best_d2 = ON_DBL_MAX;
+
+  // Newton iterations for (C(t) - P)o(C'(t)) = 0 restricted to the span.
+  // A step that does not reduce the distance is halved.
+  const double step_tolerance = 1.0e-12 * domain.Length();
+  t = best_t;
+  for (int iteration = 0; iteration < ON_BATCH_CLOSEST_POINT_MAX_ITERATIONS; ++iteration)
+  {
+    if (false == curve.Evaluate(t, 2, 3, v, Side(t), &hint))
+      return false;
+    const ON_3dVector R(v[0] - P.x, v[1] - P.y, v[2] - P.z);
+    const ON_3dVector D1(v[3], v[4], v[5]);
+    const ON_3dVector D2(v[6], v[7], v[8]);
+    const double d2 = R * R;
+    if (d2 < best_d2)
+    {
+      best_d2 = d2;
+      best_t = t;
+    }
+    else
+    {
+      t = 0.5 * (best_t + t);
+      if (fabs(t - best_t) <= step_tolerance)
+        break;
+      continue;
+    }
+    const double f = R * D1;
+    double df = D1 * D1 + R * D2;
+    if (!(df > 0.0))
+      df = D1 * D1;
+    if (!(df > 0.0))
+      break;
+    const double t1 = Clamp(domain, t - f / df);
+    const bool bDone = fabs(t1 - t) <= step_tolerance;
+    t = t1;
+    if (bDone)
+      break;
+  }
+
+  if (false == curve.Evaluate(t, 0, 3, v, Side(t), &hint))
+    return false;
+  Q = ON_3dPoint(v[0], v[1], v[2]);
+  if (Q.DistanceTo(P) * Q.DistanceTo(P) > best_d2)
+  {
+    t = best_t;
+    if (false == curve.Evaluate(t, 0, 3, v, Side(t), &hint))
+      return false;
+    Q = ON_3dPoint(v[0], v[1], v[2]);
+  }
+  return true;
+}
+
+inline bool ON_BatchClosestPoint::Internal_SurfaceSpanClosestPoint(
+  const ON_NurbsSurface& surface,
+  const ON_Interval domain[2],
+  const ON_3dPoint& P,
+  const double* seed_t,
+  double t[2],
+  ON_3dPoint& Q
+  )
+{
+  // Evaluate from inside the span patch on its upper sides.
+  int hint[2] = { 0, 0 };
+  double v[18];
+  auto Clamp = [](const ON_Interval& d, double s) { d.Clamp(s); return s; };
+  auto Quadrant = [domain](double s0, double s1)
+  {
+    const bool b0 = (s0 >= domain[0][1]);
+    const bool b1 = (s1 >= domain[1][1]);
+    return b0 ? (b1 ? 3 : 2) : (b1 ? 4 : 1);
+  };
+
+  // Start at the closest of the seed and a grid of samples with
+  // max(order,3) samples in each direction. See the curve case.
+  double best_d2 = ON_DBL_MAX;
+  double best_t[2] = { domain[0][0], domain[1][0] };
+  const int sample_count0 = (surface.m_order[0] > 3) ? surface.m_order[0] : 3;
+  const int sample_count1 = (surface.m_order[1] > 3) ? surface.m_order[1] : 3;
+  for (int i = (nullptr != seed_t) ? -1 : 0; i < sample_count0; ++i)
+  {
+    for (int j = (i < 0) ? -1 : 0; j < ((i < 0) ? 0 : sample_count1); ++j)
+    {
+      const double s0 = (i < 0) ? Clamp(domain[0], seed_t[0]) : domain[0].ParameterAt(((double)i) / ((double)(sample_count0 - 1)));
+      const double s1 = (j < 0) ? Clamp(domain[1], seed_t[1]) : domain[1].ParameterAt(((double)j) / ((double)(sample_count1 - 1)));
+      if (false == surface.Evaluate(s0, s1, 0, 3, v, Quadrant(s0, s1), hint))
+        return false;
+      const double d2 = (v[0] - P.x) * (v[0] - P.x) + (v[1] - P.y) * (v[1] - P.y) + (v[2] - P.z) * (v[2] - P.z);
+      if (d2 < best_d2)
+      {
+        best_d2 = d2;
+        best_t[0] = s0;
+        best_t[1] = s1;
+      }
+    }
+  }
+  best_d2 = ON_DBL_MAX;
+
+  // Newton iterations for (S - P)oSu = 0 and (S - P)oSv = 0 restricted to
+  // the span patch. A parameter on a side of the patch where the distance
+  // decreases out of the patch is held fixed and the other one takes a
+  // one dimensional Newton step. A step that does not reduce the distance
+  // is halved.
+  const double step_tolerance0 = 1.0e-12 * domain[0].Length();
+  const double step_tolerance1 = 1.0e-12 * domain[1].Length();
+  t[0] = best_t[0];
+  t[1] = best_t[1];
+  for (int iteration = 0; iteration < ON_BATCH_CLOSEST_POINT_MAX_ITERATIONS; ++iteration)
+  {
+    if (false == surface.Evaluate(t[0], t[1], 2, 3, v, Quadrant(t[0], t[1]), hint))
+      return false;
+    const ON_3dVector R(v[0] - P.x, v[1] - P.y, v[2] - P.z);
+    const ON_3dVector Su(v[3], v[4], v[5]);
+    const ON_3dVector Sv(v[6], v[7], v[8]);
+    const ON_3dVector Suu(v[9], v[10], v[11]);
+    const ON_3dVector Suv(v[12], v[13], v[14]);
+    const ON_3dVector Svv(v[15], v[16], v[17]);
+    const double d2 = R * R;
+    if (d2 < best_d2)
+    {
+      best_d2 = d2;
+      best_t[0] = t[0];
+      best_t[1] = t[1];
+    }
+    else
+    {
+      t[0] = 0.5 * (best_t[0] + t[0]);
+      t[1] = 0.5 * (best_t[1] + t[1]);
+      if (fabs(t[0] - best_t[0]) <= step_tolerance0 && fabs(t[1] - best_t[1]) <= step_tolerance1)
+        break;
+      continue;
+    }
+    const double g0 = R * Su;
+    const double g1 = R * Sv;
+    const bool bFixed0 = (t[0] <= domain[0][0] && g0 > 0.0) || (t[0] >= domain[0][1] && g0 < 0.0);
+    const bool bFixed1 = (t[1] <= domain[1][0] && g1 > 0.0) || (t[1] >= domain[1][1] && g1 < 0.0);
+    if (bFixed0 && bFixed1)
+      break;
+    double a = Su * Su + R * Suu;
+    double b = Su * Sv + R * Suv;
+    double c = Sv * Sv + R * Svv;
+    double det = a * c - b * b;
+    if (!(a > 0.0 && det > 0.0))
+    {
+      // Gauss-Newton when the Hessian is not positive definite.
+      a = Su * Su;
+      b = Su * Sv;
+      c = Sv * Sv;
+      det = a * c - b * b;
+    }
+    double s0 = t[0];
+    double s1 = t[1];
+    if (bFixed0)
+    {
+      if (!(c > 0.0))
+        break;
+      s1 -= g1 / c;
+    }
+    else if (bFixed1)
+    {
+      if (!(a > 0.0))
+        break;
+      s0 -= g0 / a;
+    }
+    else
+    {
+      if (!(det > 0.0))
+        break;
+      s0 -= (c * g0 - b * g1) / det;
+      s1 -= (a * g1 - b * g0) / det;
+    }
+    s0 = Clamp(domain[0], s0);
+    s1 = Clamp(domain[1], s1);
+    const bool bDone = fabs(s0 - t[0]) <= step_tolerance0 && fabs(s1 - t[1]) <= step_tolerance1;
+    t[0] = s0;
+    t[1] = s1;
+    if (bDone)
+      break;
+  }
+
+  if (false == surface.Evaluate(t[0], t[1], 0, 3, v, Quadrant(t[0], t[1]), hint))
+    return false;
+  Q = ON_3dPoint(v[0], v[1], v[2]);
+  if (Q.DistanceTo(P) * Q.DistanceTo(P) > best_d2)
+  {
+    t[0] = best_t[0];
+    t[1] = best_t[1];
+    if (false == surface.Evaluate(t[0], t[1], 0, 3, v, Quadrant(t[0], t[1]), hint))
+      return false;
+    Q = ON_3dPoint(v[0], v[1], v[2]);
+  }
+  return true;
+}
+
+#endif
@@ -2053,6 +2053,7 @@ public:
     Number of meshes appended to mesh_list[] array.
   Note:
     This function is not thread safe.  
+    ON_BrepParallelMesher::CreateMesh() meshes the faces on multiple threads.
   */
   int CreateMesh( 
     const ON_MeshParameters& mp,
@@ -0,0 +1,204 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_BREP_PARALLEL_MESH_INC_)
+#define OPENNURBS_BREP_PARALLEL_MESH_INC_
+
+/*
+Description:
+  ON_BrepParallelMesher meshes the faces of a brep on multiple threads.
+
+  ON_Brep::CreateMesh() is not thread safe because meshing a face fills
+  in caches that are shared by the brep: face bounding boxes and, in
+  OPENNURBS_PLUS builds, the curve and surface trees of the trim, edge
+  and face geometry. PrepareForConcurrentMeshing() fills in those caches
+  on the calling thread. After that, meshing a face only reads the brep
+  and faces can be meshed at the same time.
+
+  Each face is meshed into its own result slot, so the results do not
+  depend on thread scheduling. When every face is meshed, the face meshes
+  are stitched along shared edges. See StitchSharedEdges(). The result
+  is the same for every thread count.
+Example:
+          ON_SimpleArray<ON_Mesh*> mesh_list;
+          ON_BrepParallelMesher::CreateMesh(brep, mp, mesh_list,
+            [](const ON_BrepFace& face, const ON_MeshParameters& face_mp)
+            {
+              return face.CreateMesh(face_mp);
+            }
+          );
+*/
+class ON_BrepParallelMesher
+{
+public:
+  /*
+  Description:
+    Fill in the lazily computed caches of the brep so that faces can be
+    meshed on several threads at the same time.
+  Parameters:
+    brep - [in]
+  Remarks:
+    Call on one thread before meshing starts. If the brep is modified,
+    call it again before meshing.
+  */
+  static void PrepareForConcurrentMeshing(
+    const class ON_Brep& brep
+    );
+
+  /*
+  Description:
+    Mesh every face of a brep using multiple threads.
+  Parameters:
+    brep - [in]
+    mp - [in]
+      meshing parameters
+    mesh_list - [out]
+      brep.m_F.Count() meshes are appended to this array.
+      The mesh of brep.m_F[fi] is mesh_list[mesh_list_count0 + fi],
+      where mesh_list_count0 is the count before the call.
+      It is nullptr if meshing that face failed.
+    face_mesher - [in]
+      Function object with signature
+      ON_Mesh* face_mesher(const ON_BrepFace& face, const ON_MeshParameters& mp).
+      It is called at the same time on different threads with different
+      faces. It must only read the brep and return a new mesh that the
+      caller will delete.
+    thread_count - [in]
+      Maximum number of threads to use. 0 uses every hardware thread.
+      1 meshes the faces on the calling thread.
+    stitch_tolerance - [in]
+      Vertices of adjacent face meshes that are on a shared edge and
+      closer than this distance are moved to the same location. If
+      stitch_tolerance <= 0, each edge's m_tolerance is used, or
+      ON_ZERO_TOLERANCE when the edge tolerance is not set. The
+      tolerance is never smaller than the float precision of mesh
+      vertices at the edge.
+  Returns:
+    Number of faces that were meshed.
+  */
+  template <class FaceMesher>
+  static int CreateMesh(
+    const class ON_Brep& brep,
+    const class ON_MeshParameters& mp,
+    ON_SimpleArray<class ON_Mesh*>& mesh_list,
+    const FaceMesher& face_mesher,
+    unsigned int thread_count = 0,
+    double stitch_tolerance = 0.0
+    );
+
+#if defined(OPENNURBS_PLUS)
+  /*
+  Description:
+    Mesh every face of a brep with ON_BrepFace::CreateMesh() using
+    multiple threads. This is a multi-threaded replacement for
+    ON_Brep::CreateMesh(mp, mesh_list).
+  */
+  static int CreateMesh(
+    const class ON_Brep& brep,
+    const class ON_MeshParameters& mp,
+    ON_SimpleArray<class ON_Mesh*>& mesh_list,
+    unsigned int thread_count = 0
+    );
+#endif
+
+  /*
+  Description:
+    Make adjacent face meshes meet along their shared edges.
+    For each edge, in increasing edge index order, the naked vertices
+    of the other face meshes are moved to the matching vertex of the
+    face mesh with the lowest index. A vertex with no match within the
+    tolerance is a T-junction. It is inserted in the naked side of the
+    other face mesh it is on, which splits the face of that side.
+  Parameters:
+    brep - [in]
+    face_mesh - [in]
+      face_mesh[fi] is the mesh of brep.m_F[fi] or nullptr.
+    face_mesh_count - [in]
+      Number of elements in face_mesh[]. Faces with fi >= face_mesh_count
+      are ignored.
+    stitch_tolerance - [in]
+      See CreateMesh().
+  Returns:
+    Number of vertices that were moved or inserted.
+  Remarks:
+    Only vertices on the naked edges of a face mesh are moved and only
+    naked sides are split, so the result is deterministic and does not
+    depend on the thread count.
+    The face meshes are watertight along an edge when their naked
+    vertices there are within the tolerance of a vertex or a naked side
+    of the other mesh. Gaps wider than the tolerance, for example from
+    face meshes that do not follow the edge, are not closed. Vertices
+    are not inserted in meshes that have ngons.
+  */
+  static unsigned int StitchSharedEdges(
+    const class ON_Brep& brep,
+    class ON_Mesh* const* face_mesh,
+    int face_mesh_count,
+    double stitch_tolerance = 0.0
+    );
+
+private:
+  // Side m_k of face m_fi of a mesh
+  class NakedSide
+  {
+  public:
+    int m_fi;
+    int m_k;
+  };
+
+  // Sets naked_sides[] to the naked sides with both ends in box,
+  // sorted by face index and side.
+  static void Internal_GetNakedSides(
+    const class ON_Mesh& mesh,
+    const ON_BoundingBox& box,
+    ON_SimpleArray<NakedSide>& naked_sides
+    );
+
+  // Inserts a vertex at P in the naked side that P is on and returns
+  // its index or ON_UNSET_UINT_INDEX.
+  static unsigned int Internal_InsertSideVertex(
+    class ON_Mesh& mesh,
+    ON_SimpleArray<NakedSide>& naked_sides,
+    const ON_3dPoint& P,
+    double tolerance
+    );
+
+  // Sets naked_vi[] to the indices of the vertices on naked mesh edges.
+  static void Internal_GetNakedVertices(
+    const class ON_Mesh& mesh,
+    ON_SimpleArray<unsigned int>& naked_vi
+    );
+
+  static const ON_3dPoint Internal_Vertex(
+    const class ON_Mesh& mesh,
+    unsigned int vi
+    );
+
+  static void Internal_SetVertex(
+    class ON_Mesh& mesh,
+    unsigned int vi,
+    const ON_3dPoint& P
+    );
+
+  static unsigned int Internal_StitchSharedEdges(
+    const class ON_Brep& brep,
+    class ON_Mesh* const* face_mesh,
+    int face_mesh_count,
+    ON_SimpleArray<unsigned int>* naked_vi,
+    double stitch_tolerance
+    );
+};
+
+#include "opennurbs_brep_parallel_mesh_defs.h"
+
+#endif
@@ -0,0 +1,569 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_BREP_PARALLEL_MESH_DEFS_INC_)
+#define OPENNURBS_BREP_PARALLEL_MESH_DEFS_INC_
+
+inline void ON_BrepParallelMesher::PrepareForConcurrentMeshing(
+  const ON_Brep& brep
+  )
+{
+  brep.BoundingBox();
+
+  const int face_count = brep.m_F.Count();
+  for (int fi = 0; fi < face_count; ++fi)
+  {
+    const ON_BrepFace& face = brep.m_F[fi];
+    if (face.m_face_index < 0)
+      continue;
+    face.BoundingBox();
+#if defined(OPENNURBS_PLUS)
+    const ON_Surface* srf = face.SurfaceOf();
+    if (nullptr != srf)
+      srf->SurfaceTree();
+#endif
+  }
+
+#if defined(OPENNURBS_PLUS)
+  const int edge_count = brep.m_E.Count();
+  for (int ei = 0; ei < edge_count; ++ei)
+  {
+    const ON_Curve* curve = brep.m_E[ei].EdgeCurveOf();
+    if (nullptr != curve)
+      curve->CurveTree();
+  }
+
+  const int trim_count = brep.m_T.Count();
+  for (int ti = 0; ti < trim_count; ++ti)
+  {
+    const ON_Curve* curve = brep.m_T[ti].TrimCurveOf();
+    if (nullptr != curve)
+      curve->CurveTree();
+  }
+#endif
+}
+
+template <class FaceMesher>
+inline int ON_BrepParallelMesher::CreateMesh(
+  const ON_Brep& brep,
+  const ON_MeshParameters& mp,
+  ON_SimpleArray<ON_Mesh*>& mesh_list,
+  const FaceMesher& face_mesher,
+  unsigned int thread_count,
+  double stitch_tolerance
+  )
+{
+  const int face_count = brep.m_F.Count();
+  if (face_count <= 0)
+    return 0;
+
+  const int mesh_list_count0 = mesh_list.Count();
+  mesh_list.Reserve((size_t)mesh_list_count0 + (size_t)face_count);
+  mesh_list.SetCount(mesh_list_count0 + face_count);
+  ON_Mesh** face_mesh = mesh_list.Array() + mesh_list_count0;
+  for (int fi = 0; fi < face_count; ++fi)
+    face_mesh[fi] = nullptr;
+
+  PrepareForConcurrentMeshing(brep);
+
+  thread_count = ON_Parallel::ThreadCount((size_t)face_count, 1, thread_count);
+
+  ON_ClassArray< ON_SimpleArray<unsigned int> > naked_vi(face_count);
+  naked_vi.SetCount(face_count);
+
+  ON_Parallel::For((size_t)face_count, thread_count,
+    [&brep, &mp, &face_mesher, face_mesh, &naked_vi](size_t fi, unsigned int)
+    {
+      const ON_BrepFace& face = brep.m_F[(int)fi];
+      if (face.m_face_index < 0)
+        return;
+      ON_Mesh* mesh = face_mesher(face, mp);
+      face_mesh[fi] = mesh;
+      if (nullptr != mesh)
+        Internal_GetNakedVertices(*mesh, naked_vi[(int)fi]);
+    }
+  );
+
+  Internal_StitchSharedEdges(brep, face_mesh, face_count, naked_vi.Array(), stitch_tolerance);
+
+  int mesh_count = 0;
+  for (int fi = 0; fi < face_count; ++fi)
+  {
+    if (nullptr != face_mesh[fi])
+      ++mesh_count;
+  }
+  return mesh_count;
+}
+
+#if defined(OPENNURBS_PLUS)
+inline int ON_BrepParallelMesher::CreateMesh(
+  const ON_Brep& brep,
+  const ON_MeshParameters& mp,
+  ON_SimpleArray<ON_Mesh*>& mesh_list,
+  unsigned int thread_count
+  )
+{
+  return ON_BrepParallelMesher::CreateMesh(brep, mp, mesh_list,
+    [](const ON_BrepFace& face, const ON_MeshParameters& face_mp)
+    {
+      return face.CreateMesh(face_mp, nullptr);
+    },
+    thread_count
+  );
+}
+#endif
+
+inline unsigned int ON_BrepParallelMesher::StitchSharedEdges(
+  const ON_Brep& brep,
+  ON_Mesh* const* face_mesh,
+  int face_mesh_count,
+  double stitch_tolerance
+  )
+{
+  if (nullptr == face_mesh || face_mesh_count <= 0)
+    return 0;
+  if (face_mesh_count > brep.m_F.Count())
+    face_mesh_count = brep.m_F.Count();
+
+  ON_ClassArray< ON_SimpleArray<unsigned int> > naked_vi(face_mesh_count);
+  naked_vi.SetCount(face_mesh_count);
+  ON_Parallel::For((size_t)face_mesh_count, ON_Parallel::ThreadCount((size_t)face_mesh_count, 16),
+    [face_mesh, &naked_vi](size_t fi, unsigned int)
+    {
+      if (nullptr != face_mesh[fi])
+        Internal_GetNakedVertices(*face_mesh[fi], naked_vi[(int)fi]);
+    }
+  );
+
+  return Internal_StitchSharedEdges(brep, face_mesh, face_mesh_count, naked_vi.Array(), stitch_tolerance);
+}
+
+inline void ON_BrepParallelMesher::Internal_GetNakedVertices(
+  const ON_Mesh& mesh,
+  ON_SimpleArray<unsigned int>& naked_vi
+  )
+{
+  naked_vi.SetCount(0);
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const int face_count = mesh.m_F.Count();
+  if (0 == vertex_count || face_count <= 0)
+    return;
+
+  // Every face side as (smaller vertex index, larger vertex index).
+  // A side that appears once is a naked edge.
+  ON_SimpleArray<ON__UINT64> sides(4 * face_count);
+  for (int fi = 0; fi < face_count; ++fi)
+  {
+    const ON_MeshFace& f = mesh.m_F[fi];
+    const int side_count = f.IsTriangle() ? 3 : 4;
+    for (int k = 0; k < side_count; ++k)
+    {
+      unsigned int vi0 = (unsigned int)f.vi[k];
+      unsigned int vi1 = (unsigned int)f.vi[(k + 1) % side_count];
+      if (vi0 >= vertex_count || vi1 >= vertex_count || vi0 == vi1)
+        continue;
+      if (vi0 > vi1)
+      {
+        const unsigned int i = vi0;
+        vi0 = vi1;
+        vi1 = i;
+      }
+      sides.Append((((ON__UINT64)vi0) << 32) | (ON__UINT64)vi1);
+    }
+  }
+  ON__UINT64* s = sides.Array();
+  const int side_count = sides.Count();
+  std::sort(s, s + side_count);
+
+  ON_SimpleArray<bool> bNaked((int)vertex_count);
+  bNaked.SetCount((int)vertex_count);
+  bNaked.Zero();
+  for (int i = 0; i < side_count; )
+  {
+    int j = i + 1;
+    while (j < side_count && s[j] == s[i])
+      ++j;
+    if (j == i + 1)
+    {
+      bNaked[(int)(s[i] >> 32)] = true;
+      bNaked[(int)(s[i] & 0xFFFFFFFFU)] = true;
+    }
+    i = j;
+  }
+
+  for (unsigned int vi = 0; vi < vertex_count; ++vi)
+  {
+    if (bNaked[(int)vi])
+      naked_vi.Append(vi);
+  }
+}
+
+inline const ON_3dPoint ON_BrepParallelMesher::Internal_Vertex(
+  const ON_Mesh& mesh,
+  unsigned int vi
+  )
+{
+  return mesh.HasDoublePrecisionVertices()
+    ? mesh.m_dV[(int)vi]
+    : ON_3dPoint(mesh.m_V[(int)vi]);
+}
+
+inline void ON_BrepParallelMesher::Internal_SetVertex(
+  ON_Mesh& mesh,
+  unsigned int vi,
+  const ON_3dPoint& P
+  )
+{
+  if (mesh.HasDoublePrecisionVertices())
+    mesh.m_dV[(int)vi] = P;
+  mesh.m_V[(int)vi] = ON_3fPoint(P);
+}
+
+inline void ON_BrepParallelMesher::Internal_GetNakedSides(
+  const ON_Mesh& mesh,
+  const ON_BoundingBox& box,
+  ON_SimpleArray<NakedSide>& naked_sides
+  )
+{
+  naked_sides.SetCount(0);
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const int face_count = mesh.m_F.Count();
+
+  // Every face that uses a side with both ends in the box is scanned,
+  // so a side that appears once is naked.
+  ON_SimpleArray<ON__UINT64> keys(64);
+  ON_SimpleArray<NakedSide> sides(64);
+  for (int fi = 0; fi < face_count; ++fi)
+  {
+    const ON_MeshFace& f = mesh.m_F[fi];
+    const int side_count = f.IsTriangle() ? 3 : 4;
+    for (int k = 0; k < side_count; ++k)
+    {
+      unsigned int vi0 = (unsigned int)f.vi[k];
+      unsigned int vi1 = (unsigned int)f.vi[(k + 1) % side_count];
+      if (vi0 >= vertex_count || vi1 >= vertex_count || vi0 == vi1)
+        continue;
+      if (!box.IsPointIn(Internal_Vertex(mesh, vi0)) || !box.IsPointIn(Internal_Vertex(mesh, vi1)))
+        continue;
+      if (vi0 > vi1)
+      {
+        const unsigned int i = vi0;
+        vi0 = vi1;
+        vi1 = i;
+      }
+      keys.Append((((ON__UINT64)vi0) << 32) | (ON__UINT64)vi1);
+      sides.Append(NakedSide{ fi, k });
+    }
+  }
+
+  const int count = keys.Count();
+  ON_SimpleArray<int> order(count);
+  order.SetCount(count);
+  for (int i = 0; i < count; ++i)
+    order[i] = i;
+  const ON__UINT64* key = keys.Array();
+  std::sort(order.Array(), order.Array() + count,
+    [key](int a, int b)
+    {
+      return (key[a] < key[b]) || (key[a] == key[b] && a < b);
+    }
+  );
+  for (int i = 0; i < count; )
+  {
+    int j = i + 1;
+    while (j < count && key[order[j]] == key[order[i]])
+      ++j;
+    if (j == i + 1)
+      naked_sides.Append(sides[order[i]]);
+    i = j;
+  }
+  std::sort(naked_sides.Array(), naked_sides.Array() + naked_sides.Count(),
+    [](const NakedSide& a, const NakedSide& b)
+    {
+      return (a.m_fi < b.m_fi) || (a.m_fi == b.m_fi && a.m_k < b.m_k);
+    }
+  );
+}
+
+inline unsigned int ON_BrepParallelMesher::Internal_InsertSideVertex(
+  ON_Mesh& mesh,
+  ON_SimpleArray<NakedSide>& naked_sides,
+  const ON_3dPoint& P,
+  double tolerance
+  )
+{
+  // Find the naked side that P is on.
+  int best_i = -1;
+  double best_s = 0.0;
+  double best_d = tolerance;
+  for (int i = 0; i < naked_sides.Count(); ++i)
+  {
+    const ON_MeshFace& f = mesh.m_F[naked_sides[i].m_fi];
+    const int k = naked_sides[i].m_k;
+    const ON_3dPoint A = Internal_Vertex(mesh, (unsigned int)f.vi[k]);
+    const ON_3dPoint B = Internal_Vertex(mesh, (unsigned int)f.vi[(k + 1) % (f.IsTriangle() ? 3 : 4)]);
+    if (!(A.DistanceTo(P) > tolerance) || !(B.DistanceTo(P) > tolerance))
+      continue;
+    const ON_Line line(A, B);
+    double s = 0.0;
+    if (false == line.ClosestPointTo(P, &s) || !(s > 0.0 && s < 1.0))
+      continue;
+    const double d = line.PointAt(s).DistanceTo(P);
+    if (d <= best_d)
+    {
+      best_i = i;
+      best_s = s;
+      best_d = d;
+    }
+  }
+  if (best_i < 0)
+    return ON_UNSET_UINT_INDEX;
+
+  const int fi = naked_sides[best_i].m_fi;
+  const int k = naked_sides[best_i].m_k;
+  const ON_MeshFace f = mesh.m_F[fi];
+  const int side_count = f.IsTriangle() ? 3 : 4;
+  const int a = f.vi[k];
+  const int b = f.vi[(k + 1) % side_count];
+
+  const unsigned int vi = mesh.AppendDuplicateVertex((unsigned int)a);
+  if (ON_UNSET_UINT_INDEX == vi)
+    return ON_UNSET_UINT_INDEX;
+  Internal_SetVertex(mesh, vi, P);
+  const int v = (int)vi;
+  if (mesh.m_N.Count() == mesh.m_V.Count())
+  {
+    ON_3fVector N = (1.0f - (float)best_s) * mesh.m_N[a] + ((float)best_s) * mesh.m_N[b];
+    if (N.Unitize())
+      mesh.m_N[v] = N;
+  }
+  if (mesh.m_T.Count() == mesh.m_V.Count())
+    mesh.m_T[v] = ON_2fPoint((1.0f - (float)best_s) * mesh.m_T[a].x + ((float)best_s) * mesh.m_T[b].x, (1.0f - (float)best_s) * mesh.m_T[a].y + ((float)best_s) * mesh.m_T[b].y);
+  if (mesh.m_S.Count() == mesh.m_V.Count())
+    mesh.m_S[v] = (1.0 - best_s) * mesh.m_S[a] + best_s * mesh.m_S[b];
+
+  // Face (a, b, c[, d]) becomes (a, v, c[, d]) and the new triangle
+  // (v, b, c) is appended. Both keep the orientation of the face.
+  const int c = f.vi[(k + 2) % side_count];
+  const bool bHasFaceNormals = (mesh.m_FN.Count() == mesh.m_F.Count());
+  ON_MeshFace& f0 = mesh.m_F[fi];
+  f0.vi[(k + 1) % side_count] = v;
+  if (3 == side_count)
+    f0.vi[3] = f0.vi[2];
+  ON_MeshFace& f1 = mesh.m_F.AppendNew();
+  f1.vi[0] = v;
+  f1.vi[1] = b;
+  f1.vi[2] = c;
+  f1.vi[3] = c;
+  if (bHasFaceNormals)
+  {
+    const ON_3fVector FN = mesh.m_FN[fi];
+    mesh.m_FN.Append(FN);
+  }
+
+  // The side (a, b) is now (a, v) and (v, b). The side (b, c) moved
+  // to the new triangle.
+  const int new_fi = mesh.m_F.Count() - 1;
+  const int bc = (k + 1) % side_count;
+  for (int i = 0; i < naked_sides.Count(); ++i)
+  {
+    if (fi == naked_sides[i].m_fi && bc == naked_sides[i].m_k)
+      naked_sides[i] = NakedSide{ new_fi, 1 };
+  }
+  naked_sides.Append(NakedSide{ new_fi, 0 });
+  return vi;
+}
+
+inline unsigned int ON_BrepParallelMesher::Internal_StitchSharedEdges(
+  const ON_Brep& brep,
+  ON_Mesh* const* face_mesh,
+  int face_mesh_count,
+  ON_SimpleArray<unsigned int>* naked_vi,
+  double stitch_tolerance
+  )
+{
+  struct SortedVertex
+  {
+    double x;
+    unsigned int vi;
+  };
+
+  unsigned int changed_count = 0;
+  ON_SimpleArray<bool> bMoved(face_mesh_count);
+  bMoved.SetCount(face_mesh_count);
+  bMoved.Zero();
+  ON_SimpleArray<bool> bInserted(face_mesh_count);
+  bInserted.SetCount(face_mesh_count);
+  bInserted.Zero();
+  ON_SimpleArray<int> edge_fi(8);
+  ON_SimpleArray<SortedVertex> sorted(64);
+  ON_SimpleArray<bool> bMatched(64);
+  ON_3dPointArray unmatched(64);
+  ON_SimpleArray<NakedSide> naked_sides(64);
+
+  const int edge_count = brep.m_E.Count();
+  for (int ei = 0; ei < edge_count; ++ei)
+  {
+    const ON_BrepEdge& edge = brep.m_E[ei];
+    if (edge.m_edge_index < 0 || edge.m_ti.Count() < 2)
+      continue;
+
+    // Faces that use the edge and have a mesh, in increasing index order.
+    edge_fi.SetCount(0);
+    for (int eti = 0; eti < edge.m_ti.Count(); ++eti)
+    {
+      const int ti = edge.m_ti[eti];
+      if (ti < 0 || ti >= brep.m_T.Count())
+        continue;
+      const int fi = brep.m_T[ti].FaceIndexOf();
+      if (fi >= 0 && fi < face_mesh_count && nullptr != face_mesh[fi])
+        edge_fi.Append(fi);
+    }
+    edge_fi.QuickSortAndRemoveDuplicates(ON_CompareIncreasing<int>);
+    if (edge_fi.Count() < 2)
+      continue;
+
+    ON_BoundingBox box = edge.BoundingBox();
+    if (!box.IsValid())
+      continue;
+
+    // Mesh vertices are floats, so the tolerance is never smaller than
+    // the float precision at the edge.
+    const double float_tol = 16.0 * ON_FLOAT_EPSILON * box.MaximumDistanceTo(ON_3dPoint::Origin);
+    double tol = (stitch_tolerance > 0.0)
+      ? stitch_tolerance
+      : ((ON_IsValid(edge.m_tolerance) && edge.m_tolerance > 0.0) ? edge.m_tolerance : ON_ZERO_TOLERANCE);
+    if (tol < float_tol)
+      tol = float_tol;
+    box.m_min -= ON_3dVector(tol, tol, tol);
+    box.m_max += ON_3dVector(tol, tol, tol);
+
+    const int fi0 = edge_fi[0];
+    ON_Mesh& mesh0 = *face_mesh[fi0];
+    const bool bCanInsert0 = (0 == mesh0.NgonUnsignedCount());
+
+    for (int k = 1; k < edge_fi.Count(); ++k)
+    {
+      // Naked vertices of the lowest index face mesh near the edge,
+      // sorted by x. Vertices inserted for earlier faces are included.
+      sorted.SetCount(0);
+      for (int i = 0; i < naked_vi[fi0].Count(); ++i)
+      {
+        const unsigned int vi = naked_vi[fi0][i];
+        const ON_3dPoint P = Internal_Vertex(mesh0, vi);
+        if (box.IsPointIn(P))
+          sorted.Append(SortedVertex{ P.x, vi });
+      }
+      if (0 == sorted.Count())
+        break;
+      const int sorted_count = sorted.Count();
+      std::sort(sorted.Array(), sorted.Array() + sorted_count,
+        [](const SortedVertex& a, const SortedVertex& b)
+        {
+          return (a.x < b.x) || (a.x == b.x && a.vi < b.vi);
+        }
+      );
+      const SortedVertex* s = sorted.Array();
+      bMatched.SetCount(sorted_count);
+      bMatched.Zero();
+      unmatched.SetCount(0);
+
+      // Move vertices of this face mesh to the matching vertex of mesh0.
+      const int fi = edge_fi[k];
+      ON_Mesh& mesh = *face_mesh[fi];
+      for (int i = 0; i < naked_vi[fi].Count(); ++i)
+      {
+        const unsigned int vi = naked_vi[fi][i];
+        const ON_3dPoint P = Internal_Vertex(mesh, vi);
+        if (!box.IsPointIn(P))
+          continue;
+
+        // nearest vertex in mesh0 with |x - P.x| <= tol
+        const SortedVertex* p = std::lower_bound(s, s + sorted_count, P.x - tol,
+          [](const SortedVertex& a, double x) { return a.x < x; }
+        );
+        double best_d = tol;
+        int best_i = -1;
+        for (; p < s + sorted_count && p->x <= P.x + tol; ++p)
+        {
+          const double d = P.DistanceTo(Internal_Vertex(mesh0, p->vi));
+          if (d <= best_d)
+          {
+            best_d = d;
+            best_i = (int)(p - s);
+          }
+        }
+        if (best_i < 0)
+        {
+          unmatched.Append(P);
+          continue;
+        }
+        bMatched[best_i] = true;
+        const ON_3dPoint Q = Internal_Vertex(mesh0, s[best_i].vi);
+        if (Q == P)
+          continue;
+        Internal_SetVertex(mesh, vi, Q);
+        bMoved[fi] = true;
+        ++changed_count;
+      }
+
+      // A vertex with no match in the other mesh is a T-junction. It is
+      // inserted in the naked side of the other mesh it is on.
+      if (0 == mesh.NgonUnsignedCount())
+      {
+        bool bHaveSides = false;
+        for (int i = 0; i < sorted_count; ++i)
+        {
+          if (bMatched[i])
+            continue;
+          if (false == bHaveSides)
+          {
+            Internal_GetNakedSides(mesh, box, naked_sides);
+            bHaveSides = true;
+          }
+          const unsigned int vi = Internal_InsertSideVertex(mesh, naked_sides, Internal_Vertex(mesh0, s[i].vi), tol);
+          if (ON_UNSET_UINT_INDEX == vi)
+            continue;
+          naked_vi[fi].Append(vi);
+          bInserted[fi] = true;
+          ++changed_count;
+        }
+      }
+      if (bCanInsert0 && unmatched.Count() > 0)
+      {
+        Internal_GetNakedSides(mesh0, box, naked_sides);
+        for (int i = 0; i < unmatched.Count(); ++i)
+        {
+          const unsigned int vi = Internal_InsertSideVertex(mesh0, naked_sides, unmatched[i], tol);
+          if (ON_UNSET_UINT_INDEX == vi)
+            continue;
+          naked_vi[fi0].Append(vi);
+          bInserted[fi0] = true;
+          ++changed_count;
+        }
+      }
+    }
+  }
+
+  for (int fi = 0; fi < face_mesh_count; ++fi)
+  {
+    if (bInserted[fi])
+      face_mesh[fi]->DestroyRuntimeCache(true);
+    if (bMoved[fi] || bInserted[fi])
+      face_mesh[fi]->InvalidateBoundingBoxes();
+  }
+
+  return changed_count;
+}
+
+#endif
@@ -0,0 +1,214 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_COMPRESS_BLOCKS_INC_)
+#define OPENNURBS_COMPRESS_BLOCKS_INC_
+
+/*
+Description:
+  ON_BlockCompressedBuffer compresses a buffer as a sequence of
+  independent blocks. The blocks are compressed and uncompressed on
+  several threads, which makes it much faster than ON_CompressedBuffer
+  for large buffers like mesh arrays and bitmaps.
+  - Each block is an ON_CompressedBuffer and has its own CRC values.
+  - The blocks are compressed with a registered ON_CompressionCodec.
+    The default is deflate, which is what ON_CompressedBuffer uses.
+  - Write() stores the size of every block before the block data, so
+    Read() can give each thread its own blocks.
+  - Each block starts with an empty dictionary, so small blocks compress
+    less well than one large buffer. The default block size loses little.
+Remarks:
+  The archive format is different from the one used by
+  ON_BinaryArchive::WriteCompressedBuffer(). Code that writes
+  an ON_BlockCompressedBuffer must change the major version of the
+  chunk that contains it, so older readers report a version error
+  instead of reading garbage. Use the static WriteCompressedBuffer()
+  and ReadCompressedBuffer() functions to select the format from the
+  chunk version.
+Example:
+
+        // Write
+        const bool bBlockCompression = (archive.Archive3dmVersion() >= 80);
+        archive.BeginWrite3dmChunk(TCODE_ANONYMOUS_CHUNK, bBlockCompression ? 2 : 1, 0);
+        ON_BlockCompressedBuffer::WriteCompressedBuffer(archive, bBlockCompression, sizeof_buffer, buffer, 0);
+        archive.EndWrite3dmChunk();
+
+        // Read
+        int major_version = 0, minor_version = 0;
+        archive.BeginRead3dmChunk(TCODE_ANONYMOUS_CHUNK, &major_version, &minor_version);
+        const bool bBlockCompression = (2 == major_version);
+        size_t sizeof_buffer = 0;
+        ON_BlockCompressedBuffer::ReadCompressedBufferSize(archive, bBlockCompression, &sizeof_buffer);
+        ...
+        ON_BlockCompressedBuffer::ReadCompressedBuffer(archive, bBlockCompression, sizeof_buffer, buffer, &bFailedCRC, 0);
+        archive.EndRead3dmChunk();
+
+*/
+class ON_BlockCompressedBuffer
+{
+public:
+  ON_BlockCompressedBuffer() = default;
+  ~ON_BlockCompressedBuffer() = default;
+  ON_BlockCompressedBuffer(const ON_BlockCompressedBuffer&) = default;
+  ON_BlockCompressedBuffer& operator=(const ON_BlockCompressedBuffer&) = default;
+
+  // Default block size in bytes.
+  static const size_t DefaultBlockSize = 1024 * 1024;
+
+  /*
+  Description:
+    Compress inbuffer.
+  Parameters:
+    sizeof__inbuffer - [in]
+      Number of bytes in inbuffer.
+    inbuffer - [in]
+      Uncompressed information.
+    sizeof_element - [in]
+      Same as ON_CompressedBuffer::Compress(). The block size is rounded
+      down to a multiple of sizeof_element.
+    thread_count - [in]
+      Maximum number of threads. 0 = use the hardware thread count.
+    block_size - [in]
+      Number of uncompressed bytes in a block. 0 = DefaultBlockSize.
+    codec_id - [in]
+      Id of a registered ON_CompressionCodec. Only the deflate codec
+      swaps bytes for sizeof_element. The other codecs compress the
+      bytes as they are in memory.
+  Returns:
+    True if inbuffer is successfully compressed.
+  */
+  bool Compress(
+    size_t sizeof__inbuffer,
+    const void* inbuffer,
+    int sizeof_element,
+    unsigned int thread_count = 0,
+    size_t block_size = 0,
+    unsigned int codec_id = ON_CompressionCodec::DeflateCodecId
+    );
+
+  /*
+  Description:
+    Uncompress the contents of this ON_BlockCompressedBuffer.
+  Parameters:
+    outbuffer - [out]
+      This buffer must have at least SizeOfUncompressedBuffer() bytes.
+    bFailedCRC - [out]
+      If not null, this is set to true if the CRC of any block
+      has changed.
+    thread_count - [in]
+      Maximum number of threads. 0 = use the hardware thread count.
+  Returns:
+    True if the uncompressed information is returned in outbuffer.
+  */
+  bool Uncompress(
+    void* outbuffer,
+    int* bFailedCRC,
+    unsigned int thread_count = 0
+    ) const;
+
+  /*
+  Returns:
+    Number of bytes in the uncompressed information.
+  */
+  size_t SizeOfUncompressedBuffer() const;
+
+  /*
+  Returns:
+    Number of bytes in all the compressed blocks.
+  */
+  size_t SizeOfCompressedBuffer() const;
+
+  unsigned int BlockCount() const;
+
+  /*
+  Returns:
+    Id of the ON_CompressionCodec used to compress the blocks.
+  */
+  unsigned int CodecId() const;
+
+  void Destroy();
+
+  bool Write(ON_BinaryArchive& binary_archive) const;
+  bool Read(ON_BinaryArchive& binary_archive);
+
+  /*
+  Description:
+    Write a buffer with ON_BlockCompressedBuffer when bBlockCompression
+    is true and with ON_BinaryArchive::WriteCompressedBuffer() when it
+    is false. Blocks are compressed with the codec returned by
+    ON_CompressionCodec::ArchiveCodecId(binary_archive).
+  */
+  static bool WriteCompressedBuffer(
+    ON_BinaryArchive& binary_archive,
+    bool bBlockCompression,
+    size_t sizeof__inbuffer,
+    const void* inbuffer,
+    unsigned int thread_count
+    );
+
+  /*
+  Description:
+    Read the uncompressed size of a buffer written by WriteCompressedBuffer().
+    Call ReadCompressedBuffer() next, the same way
+    ON_BinaryArchive::ReadCompressedBufferSize() is used.
+  */
+  static bool ReadCompressedBufferSize(
+    ON_BinaryArchive& binary_archive,
+    bool bBlockCompression,
+    size_t* sizeof__outbuffer
+    );
+
+  /*
+  Description:
+    Read a buffer written by WriteCompressedBuffer().
+    bBlockCompression must have the value used to write the buffer.
+  */
+  static bool ReadCompressedBuffer(
+    ON_BinaryArchive& binary_archive,
+    bool bBlockCompression,
+    size_t sizeof__outbuffer,
+    void* outbuffer,
+    bool* bFailedCRC,
+    unsigned int thread_count
+    );
+
+private:
+  static bool Internal_CompressBlock(
+    const ON_CompressionCodec& codec,
+    size_t sizeof_block,
+    const void* block,
+    int sizeof_element,
+    ON_CompressedBuffer& compressed_block
+    );
+
+  static bool Internal_UncompressBlock(
+    const ON_CompressionCodec& codec,
+    const ON_CompressedBuffer& compressed_block,
+    void* block,
+    int* bFailedCRC
+    );
+
+private:
+  size_t m_sizeof_uncompressed = 0;
+  size_t m_block_size = 0;
+  unsigned int m_codec_id = ON_CompressionCodec::DeflateCodecId;
+
+  // Deflate blocks are made by ON_CompressedBuffer::Compress(). Blocks
+  // made by other codecs use the same fields. m_method is 0 when the
+  // block is stored and 1 when it is compressed.
+  ON_ClassArray<ON_CompressedBuffer> m_block;
+};
+
+#include "opennurbs_compress_blocks_defs.h"
+
+#endif
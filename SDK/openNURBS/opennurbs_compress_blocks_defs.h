@@ -0,0 +1,441 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_COMPRESS_BLOCKS_DEFS_INC_)
+#define OPENNURBS_COMPRESS_BLOCKS_DEFS_INC_
+
+inline bool ON_BlockCompressedBuffer::Compress(
+  size_t sizeof__inbuffer,
+  const void* inbuffer,
+  int sizeof_element,
+  unsigned int thread_count,
+  size_t block_size,
+  unsigned int codec_id
+  )
+{
+  Destroy();
+
+  const ON_CompressionCodec* codec = ON_CompressionCodec::FromId(codec_id);
+  if (nullptr == codec)
+    return false;
+  m_codec_id = codec_id;
+
+  if (0 == sizeof__inbuffer)
+    return true;
+  if (nullptr == inbuffer)
+    return false;
+
+  if (0 == block_size)
+    block_size = ON_BlockCompressedBuffer::DefaultBlockSize;
+  if (2 == sizeof_element || 4 == sizeof_element || 8 == sizeof_element)
+  {
+    block_size -= block_size % (size_t)sizeof_element;
+    if (0 == block_size)
+      block_size = (size_t)sizeof_element;
+  }
+
+  const size_t block_count = (sizeof__inbuffer + block_size - 1) / block_size;
+  if (block_count > 0x7FFFFFFFU)
+    return false;
+
+  m_block.SetCapacity((int)block_count);
+  m_block.SetCount((int)block_count);
+  ON_SimpleArray<bool> block_rc(block_count);
+  block_rc.SetCount((int)block_count);
+  block_rc.Zero();
+
+  const unsigned char* in = (const unsigned char*)inbuffer;
+  ON_Parallel::For(
+    block_count,
+    ON_Parallel::ThreadCount(block_count, 1, thread_count),
+    [&](size_t i, unsigned int)
+    {
+      const size_t offset = i * block_size;
+      const size_t sizeof_block = (sizeof__inbuffer - offset < block_size) ? (sizeof__inbuffer - offset) : block_size;
+      if (ON_CompressionCodec::DeflateCodecId == codec_id)
+        block_rc[i] = m_block[(int)i].Compress(sizeof_block, in + offset, sizeof_element);
+      else
+        block_rc[i] = Internal_CompressBlock(*codec, sizeof_block, in + offset, sizeof_element, m_block[(int)i]);
+    }
+  );
+
+  for (size_t i = 0; i < block_count; ++i)
+  {
+    if (false == block_rc[i])
+    {
+      Destroy();
+      return false;
+    }
+  }
+
+  m_sizeof_uncompressed = sizeof__inbuffer;
+  m_block_size = block_size;
+  return true;
+}
+
+inline bool ON_BlockCompressedBuffer::Uncompress(
+  void* outbuffer,
+  int* bFailedCRC,
+  unsigned int thread_count
+  ) const
+{
+  if (nullptr != bFailedCRC)
+    *bFailedCRC = false;
+  if (0 == m_sizeof_uncompressed)
+    return true;
+  if (nullptr == outbuffer)
+    return false;
+
+  const size_t block_count = m_block.UnsignedCount();
+  ON_SimpleArray<bool> block_rc(block_count);
+  block_rc.SetCount((int)block_count);
+  block_rc.Zero();
+  ON_SimpleArray<int> block_failed_crc(block_count);
+  block_failed_crc.SetCount((int)block_count);
+  block_failed_crc.Zero();
+
+  const ON_CompressionCodec* codec = ON_CompressionCodec::FromId(m_codec_id);
+  if (nullptr == codec)
+    return false;
+
+  unsigned char* out = (unsigned char*)outbuffer;
+  ON_Parallel::For(
+    block_count,
+    ON_Parallel::ThreadCount(block_count, 1, thread_count),
+    [&](size_t i, unsigned int)
+    {
+      if (ON_CompressionCodec::DeflateCodecId == m_codec_id)
+        block_rc[i] = m_block[(int)i].Uncompress(out + i * m_block_size, &block_failed_crc[i]);
+      else
+        block_rc[i] = Internal_UncompressBlock(*codec, m_block[(int)i], out + i * m_block_size, &block_failed_crc[i]);
+    }
+  );
+
+  bool rc = true;
+  for (size_t i = 0; i < block_count; ++i)
+  {
+    if (false == block_rc[i])
+      rc = false;
+    if (0 != block_failed_crc[i] && nullptr != bFailedCRC)
+      *bFailedCRC = true;
+  }
+  return rc;
+}
+
+inline size_t ON_BlockCompressedBuffer::SizeOfUncompressedBuffer() const
+{
+  return m_sizeof_uncompressed;
+}
+
+inline size_t ON_BlockCompressedBuffer::SizeOfCompressedBuffer() const
+{
+  size_t sizeof_compressed = 0;
+  for (unsigned int i = 0; i < m_block.UnsignedCount(); ++i)
+    sizeof_compressed += m_block[i].m_sizeof_compressed;
+  return sizeof_compressed;
+}
+
+inline unsigned int ON_BlockCompressedBuffer::BlockCount() const
+{
+  return m_block.UnsignedCount();
+}
+
+inline unsigned int ON_BlockCompressedBuffer::CodecId() const
+{
+  return m_codec_id;
+}
+
+inline void ON_BlockCompressedBuffer::Destroy()
+{
+  m_sizeof_uncompressed = 0;
+  m_block_size = 0;
+  m_codec_id = ON_CompressionCodec::DeflateCodecId;
+  m_block.Destroy();
+}
+
+inline bool ON_BlockCompressedBuffer::Internal_CompressBlock(
+  const ON_CompressionCodec& codec,
+  size_t sizeof_block,
+  const void* block,
+  int sizeof_element,
+  ON_CompressedBuffer& compressed_block
+  )
+{
+  compressed_block.Destroy();
+  size_t capacity = codec.CompressBound(sizeof_block);
+  if (capacity < sizeof_block)
+    capacity = sizeof_block;
+  void* buffer = onmalloc(capacity);
+  if (nullptr == buffer)
+    return false;
+
+  size_t sizeof_compressed = codec.Compress(sizeof_block, block, capacity, buffer);
+  int method = 1;
+  if (0 == sizeof_compressed || sizeof_compressed >= sizeof_block)
+  {
+    // Store blocks that do not compress.
+    memcpy(buffer, block, sizeof_block);
+    sizeof_compressed = sizeof_block;
+    method = 0;
+  }
+
+  compressed_block.m_sizeof_uncompressed = sizeof_block;
+  compressed_block.m_sizeof_compressed = sizeof_compressed;
+  compressed_block.m_crc_uncompressed = ON_CRC32(0, sizeof_block, block);
+  compressed_block.m_crc_compressed = ON_CRC32(0, sizeof_compressed, buffer);
+  compressed_block.m_method = method;
+  compressed_block.m_sizeof_element = sizeof_element;
+  compressed_block.m_buffer_compressed_capacity = capacity;
+  compressed_block.m_buffer_compressed = buffer;
+  return true;
+}
+
+inline bool ON_BlockCompressedBuffer::Internal_UncompressBlock(
+  const ON_CompressionCodec& codec,
+  const ON_CompressedBuffer& compressed_block,
+  void* block,
+  int* bFailedCRC
+  )
+{
+  *bFailedCRC = false;
+  const size_t sizeof_block = compressed_block.m_sizeof_uncompressed;
+  if (0 == sizeof_block)
+    return true;
+  if (nullptr == compressed_block.m_buffer_compressed)
+    return false;
+
+  bool rc = false;
+  if (0 == compressed_block.m_method)
+  {
+    rc = (compressed_block.m_sizeof_compressed == sizeof_block);
+    if (rc)
+      memcpy(block, compressed_block.m_buffer_compressed, sizeof_block);
+  }
+  else if (1 == compressed_block.m_method)
+  {
+    rc = codec.Uncompress(compressed_block.m_sizeof_compressed, compressed_block.m_buffer_compressed, sizeof_block, block);
+  }
+
+  if (rc && compressed_block.m_crc_uncompressed != ON_CRC32(0, sizeof_block, block))
+    *bFailedCRC = true;
+  return rc;
+}
+
+inline bool ON_BlockCompressedBuffer::Write(ON_BinaryArchive& binary_archive) const
+{
+  // Chunk version 1.0 is deflate. Version 1.1 adds the codec id.
+  const bool bDeflate = (ON_CompressionCodec::DeflateCodecId == m_codec_id);
+  if (false == binary_archive.BeginWrite3dmChunk(TCODE_ANONYMOUS_CHUNK, 1, bDeflate ? 0 : 1))
+    return false;
+
+  bool rc = false;
+  for (;;)
+  {
+    const unsigned int block_count = m_block.UnsignedCount();
+    if (false == binary_archive.WriteBigSize(m_sizeof_uncompressed))
+      break;
+    if (false == binary_archive.WriteBigSize(m_block_size))
+      break;
+    if (false == binary_archive.WriteInt(block_count))
+      break;
+    if (false == bDeflate && false == binary_archive.WriteInt(m_codec_id))
+      break;
+
+    // The block index is written before the block data so a reader knows
+    // where every block is before any of them are uncompressed.
+    bool bIndexWritten = true;
+    for (unsigned int i = 0; i < block_count && bIndexWritten; ++i)
+    {
+      const ON_CompressedBuffer& block = m_block[i];
+      bIndexWritten
+        = binary_archive.WriteBigSize(block.m_sizeof_uncompressed)
+        && binary_archive.WriteBigSize(block.m_sizeof_compressed)
+        && binary_archive.WriteInt(block.m_crc_uncompressed)
+        && binary_archive.WriteInt(block.m_crc_compressed)
+        && binary_archive.WriteInt(block.m_method)
+        && binary_archive.WriteInt(block.m_sizeof_element);
+    }
+    if (false == bIndexWritten)
+      break;
+
+    bool bDataWritten = true;
+    for (unsigned int i = 0; i < block_count && bDataWritten; ++i)
+    {
+      const ON_CompressedBuffer& block = m_block[i];
+      if (block.m_sizeof_compressed > 0)
+        bDataWritten = binary_archive.WriteByte(block.m_sizeof_compressed, block.m_buffer_compressed);
+    }
+    if (false == bDataWritten)
+      break;
+
+    rc = true;
+    break;
+  }
+
+  if (false == binary_archive.EndWrite3dmChunk())
+    rc = false;
+  return rc;
+}
+
+inline bool ON_BlockCompressedBuffer::Read(ON_BinaryArchive& binary_archive)
+{
+  Destroy();
+
+  int major_version = 0;
+  int minor_version = 0;
+  if (false == binary_archive.BeginRead3dmChunk(TCODE_ANONYMOUS_CHUNK, &major_version, &minor_version))
+    return false;
+
+  bool rc = false;
+  for (;;)
+  {
+    if (1 != major_version)
+      break;
+
+    size_t sizeof_uncompressed = 0;
+    size_t block_size = 0;
+    unsigned int block_count = 0;
+    if (false == binary_archive.ReadBigSize(&sizeof_uncompressed))
+      break;
+    if (false == binary_archive.ReadBigSize(&block_size))
+      break;
+    if (false == binary_archive.ReadInt(&block_count))
+      break;
+    unsigned int codec_id = ON_CompressionCodec::DeflateCodecId;
+    if (minor_version >= 1 && false == binary_archive.ReadInt(&codec_id))
+      break;
+    if (nullptr == ON_CompressionCodec::FromId(codec_id))
+    {
+      ON_ERROR("The compression codec used to write the buffer is not registered.");
+      break;
+    }
+    if (0 == block_size || block_count > 0x7FFFFFFFU || block_count != (sizeof_uncompressed + block_size - 1) / block_size)
+      break;
+
+    // Each block index entry is 2 big sizes of 4 or 8 bytes and 4 ints.
+    // A damaged block_count must not size m_block[] beyond what the
+    // chunk holds.
+    const ON__UINT64 sizeof_index_entry = 2 * 4 + 4 * 4;
+    ON_3DM_BIG_CHUNK chunk;
+    if (binary_archive.GetCurrentChunk(chunk) <= 0)
+      break;
+    if ((ON__UINT64)block_count * sizeof_index_entry > chunk.LengthRemaining(binary_archive.CurrentPosition()))
+    {
+      ON_ERROR("The compressed buffer is damaged.");
+      break;
+    }
+
+    m_block.SetCapacity((int)block_count);
+    m_block.SetCount((int)block_count);
+    bool bIndexRead = true;
+    for (unsigned int i = 0; i < block_count && bIndexRead; ++i)
+    {
+      ON_CompressedBuffer& block = m_block[i];
+      bIndexRead
+        = binary_archive.ReadBigSize(&block.m_sizeof_uncompressed)
+        && binary_archive.ReadBigSize(&block.m_sizeof_compressed)
+        && binary_archive.ReadInt(&block.m_crc_uncompressed)
+        && binary_archive.ReadInt(&block.m_crc_compressed)
+        && binary_archive.ReadInt(&block.m_method)
+        && binary_archive.ReadInt(&block.m_sizeof_element);
+      const size_t offset = (size_t)i * block_size;
+      const size_t sizeof_block = (sizeof_uncompressed - offset < block_size) ? (sizeof_uncompressed - offset) : block_size;
+      if (block.m_sizeof_uncompressed != sizeof_block)
+        bIndexRead = false;
+    }
+    if (false == bIndexRead)
+      break;
+
+    bool bDataRead = true;
+    for (unsigned int i = 0; i < block_count && bDataRead; ++i)
+    {
+      ON_CompressedBuffer& block = m_block[i];
+      if (0 == block.m_sizeof_compressed)
+        continue;
+      block.m_buffer_compressed = onmalloc(block.m_sizeof_compressed);
+      block.m_buffer_compressed_capacity = block.m_sizeof_compressed;
+      bDataRead = (nullptr != block.m_buffer_compressed) && binary_archive.ReadByte(block.m_sizeof_compressed, block.m_buffer_compressed);
+    }
+    if (false == bDataRead)
+      break;
+
+    m_sizeof_uncompressed = sizeof_uncompressed;
+    m_block_size = block_size;
+    m_codec_id = codec_id;
+    rc = true;
+    break;
+  }
+
+  if (false == binary_archive.EndRead3dmChunk())
+    rc = false;
+  if (false == rc)
+    Destroy();
+  return rc;
+}
+
+inline bool ON_BlockCompressedBuffer::WriteCompressedBuffer(
+  ON_BinaryArchive& binary_archive,
+  bool bBlockCompression,
+  size_t sizeof__inbuffer,
+  const void* inbuffer,
+  unsigned int thread_count
+  )
+{
+  if (false == bBlockCompression)
+    return binary_archive.WriteCompressedBuffer(sizeof__inbuffer, inbuffer);
+
+  ON_BlockCompressedBuffer block_buffer;
+  return
+    block_buffer.Compress(sizeof__inbuffer, inbuffer, 1, thread_count, 0, ON_CompressionCodec::ArchiveCodecId(binary_archive))
+    && binary_archive.WriteBigSize(sizeof__inbuffer)
+    && block_buffer.Write(binary_archive);
+}
+
+inline bool ON_BlockCompressedBuffer::ReadCompressedBufferSize(
+  ON_BinaryArchive& binary_archive,
+  bool bBlockCompression,
+  size_t* sizeof__outbuffer
+  )
+{
+  if (false == bBlockCompression)
+    return binary_archive.ReadCompressedBufferSize(sizeof__outbuffer);
+  return binary_archive.ReadBigSize(sizeof__outbuffer);
+}
+
+inline bool ON_BlockCompressedBuffer::ReadCompressedBuffer(
+  ON_BinaryArchive& binary_archive,
+  bool bBlockCompression,
+  size_t sizeof__outbuffer,
+  void* outbuffer,
+  bool* bFailedCRC,
+  unsigned int thread_count
+  )
+{
+  if (false == bBlockCompression)
+    return binary_archive.ReadCompressedBuffer(sizeof__outbuffer, outbuffer, bFailedCRC);
+
+  if (nullptr != bFailedCRC)
+    *bFailedCRC = false;
+  ON_BlockCompressedBuffer block_buffer;
+  if (false == block_buffer.Read(binary_archive))
+    return false;
+  if (block_buffer.SizeOfUncompressedBuffer() != sizeof__outbuffer)
+    return false;
+  int bBlockFailedCRC = false;
+  const bool rc = block_buffer.Uncompress(outbuffer, &bBlockFailedCRC, thread_count);
+  if (nullptr != bFailedCRC && 0 != bBlockFailedCRC)
+    *bFailedCRC = true;
+  return rc;
+}
+
+#endif
@@ -0,0 +1,237 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_COMPRESS_CODEC_INC_)
+#define OPENNURBS_COMPRESS_CODEC_INC_
+
+/*
+Description:
+  ON_CompressionCodec is the base class for buffer compression methods
+  used by ON_BlockCompressedBuffer. Codecs are identified in 3dm archives
+  by CodecId() and are found with ON_CompressionCodec::FromId().
+  Built in codecs:
+    DeflateCodecId - zlib deflate, the method used by ON_CompressedBuffer.
+      Use it when the compression ratio matters.
+    FastCodecId - byte oriented LZ77 with a single probe match search and
+      no entropy coding. Compresses faster than deflate with a lower
+      compression ratio. Good for autosave and undo snapshots.
+Remarks:
+  Codec ids below 1024 are reserved for openNURBS. Id 3 is reserved.
+  Applications that register their own codecs must use other ids and
+  must register them before reading archives that use them.
+
+  The registry and the codecs selected by ON_ArchiveCompressionCodecScope
+  are static variables of inline functions. When inline functions are
+  private to each module, as in plug-ins built with the Rhino xcconfig
+  files, every executable and plug-in has its own registry and its own
+  archive codec list. Register application codecs and create the
+  ON_ArchiveCompressionCodecScope in the module that reads or writes the
+  archive. The built in codecs are in every registry.
+*/
+class ON_CompressionCodec
+{
+public:
+  enum : unsigned int
+  {
+    DeflateCodecId = 1,
+    FastCodecId = 2,
+    FirstApplicationCodecId = 1024
+  };
+
+  ON_CompressionCodec() = default;
+  virtual ~ON_CompressionCodec() = default;
+
+  virtual unsigned int CodecId() const = 0;
+
+  virtual const wchar_t* Name() const = 0;
+
+  /*
+  Returns:
+    Size of a buffer that can hold the compressed form of any
+    sizeof_uncompressed bytes.
+  */
+  virtual size_t CompressBound(
+    size_t sizeof_uncompressed
+    ) const = 0;
+
+  /*
+  Description:
+    Compress a buffer. Must be thread safe.
+  Returns:
+    Number of bytes written to compressed or 0 if the buffer could not
+    be compressed into sizeof_compressed bytes.
+  */
+  virtual size_t Compress(
+    size_t sizeof_uncompressed,
+    const void* uncompressed,
+    size_t sizeof_compressed,
+    void* compressed
+    ) const = 0;
+
+  /*
+  Description:
+    Uncompress a buffer. Must be thread safe.
+  Returns:
+    True if exactly sizeof_uncompressed bytes were written to uncompressed.
+  */
+  virtual bool Uncompress(
+    size_t sizeof_compressed,
+    const void* compressed,
+    size_t sizeof_uncompressed,
+    void* uncompressed
+    ) const = 0;
+
+  /*
+  Description:
+    Add a codec to the registry of the calling module.
+    See the class remarks.
+  Parameters:
+    codec - [in]
+      Must exist until the application exits.
+  Returns:
+    False if the codec id is in use.
+  */
+  static bool Register(
+    const ON_CompressionCodec* codec
+    );
+
+  /*
+  Returns:
+    The registered codec with this id or nullptr.
+  */
+  static const ON_CompressionCodec* FromId(
+    unsigned int codec_id
+    );
+
+  /*
+  Returns:
+    The codec id used by ON_BlockCompressedBuffer::WriteCompressedBuffer()
+    when writing to archive. This is DeflateCodecId unless it was changed
+    by an ON_ArchiveCompressionCodecScope.
+  */
+  static unsigned int ArchiveCodecId(
+    const class ON_BinaryArchive& archive
+    );
+
+private:
+  friend class ON_ArchiveCompressionCodecScope;
+
+  class Internal_ArchiveCodec
+  {
+  public:
+    const class ON_BinaryArchive* m_archive;
+    unsigned int m_codec_id;
+  };
+
+  static std::mutex& Internal_Mutex();
+  static ON_SimpleArray<const ON_CompressionCodec*>& Internal_Registry();
+  static ON_SimpleArray<Internal_ArchiveCodec>& Internal_ArchiveCodecs();
+
+private:
+  ON_CompressionCodec(const ON_CompressionCodec&) = delete;
+  ON_CompressionCodec& operator=(const ON_CompressionCodec&) = delete;
+};
+
+/*
+Description:
+  Deflate codec. Compresses with ON_CompressedBuffer and uncompresses
+  with ON_UncompressBuffer().
+*/
+class ON_DeflateCompressionCodec : public ON_CompressionCodec
+{
+public:
+  ON_DeflateCompressionCodec() = default;
+  ~ON_DeflateCompressionCodec() = default;
+
+  unsigned int CodecId() const override;
+  const wchar_t* Name() const override;
+  size_t CompressBound(size_t sizeof_uncompressed) const override;
+  size_t Compress(size_t sizeof_uncompressed, const void* uncompressed, size_t sizeof_compressed, void* compressed) const override;
+  bool Uncompress(size_t sizeof_compressed, const void* compressed, size_t sizeof_uncompressed, void* uncompressed) const override;
+};
+
+/*
+Description:
+  LZ77 codec in the style of LZ4. The compressed stream is a sequence of
+  a token byte (literal count and match length), literal bytes and a
+  16 bit match offset. Matches are found with a hash table of 4 byte
+  sequences in a 64 KB window.
+Parameters:
+  codec_id - [in]
+  match_search_depth - [in]
+    Number of earlier positions checked for each match.
+    1 is fast. Larger values find longer matches and compress more
+    slowly. Without entropy coding the ratio stays below deflate's.
+*/
+class ON_LZCompressionCodec : public ON_CompressionCodec
+{
+public:
+  ON_LZCompressionCodec(
+    unsigned int codec_id,
+    unsigned int match_search_depth
+    );
+  ~ON_LZCompressionCodec() = default;
+
+  unsigned int CodecId() const override;
+  const wchar_t* Name() const override;
+  size_t CompressBound(size_t sizeof_uncompressed) const override;
+  size_t Compress(size_t sizeof_uncompressed, const void* uncompressed, size_t sizeof_compressed, void* compressed) const override;
+  bool Uncompress(size_t sizeof_compressed, const void* compressed, size_t sizeof_uncompressed, void* uncompressed) const override;
+
+private:
+  const unsigned int m_codec_id;
+  const unsigned int m_match_search_depth;
+};
+
+/*
+Description:
+  Select the codec ON_BlockCompressedBuffer::WriteCompressedBuffer()
+  uses for an archive while the scope exists.
+Remarks:
+  Only buffers written with ON_BlockCompressedBuffer::WriteCompressedBuffer()
+  use the codec. ONX_Model::Write() and the Write() functions of the
+  openNURBS classes use ON_BinaryArchive::WriteCompressedBuffer() and
+  always write deflate compressed buffers.
+Example:
+
+        // In the Write() of user data or of a custom object
+        archive.BeginWrite3dmChunk(TCODE_ANONYMOUS_CHUNK, 2, 0);
+        {
+          ON_ArchiveCompressionCodecScope codec_scope(archive, ON_CompressionCodec::FastCodecId);
+          ON_BlockCompressedBuffer::WriteCompressedBuffer(archive, true, sizeof_buffer, buffer, 0);
+        }
+        archive.EndWrite3dmChunk();
+
+*/
+class ON_ArchiveCompressionCodecScope
+{
+public:
+  ON_ArchiveCompressionCodecScope(
+    const class ON_BinaryArchive& archive,
+    unsigned int codec_id
+    );
+  ~ON_ArchiveCompressionCodecScope();
+
+private:
+  const class ON_BinaryArchive* m_archive;
+  unsigned int m_previous_codec_id;
+
+private:
+  ON_ArchiveCompressionCodecScope() = delete;
+  ON_ArchiveCompressionCodecScope(const ON_ArchiveCompressionCodecScope&) = delete;
+  ON_ArchiveCompressionCodecScope& operator=(const ON_ArchiveCompressionCodecScope&) = delete;
+};
+
+#include "opennurbs_compress_codec_defs.h"
+
+#endif
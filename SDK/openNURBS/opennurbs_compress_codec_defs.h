@@ -0,0 +1,441 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_COMPRESS_CODEC_DEFS_INC_)
+#define OPENNURBS_COMPRESS_CODEC_DEFS_INC_
+
+inline std::mutex& ON_CompressionCodec::Internal_Mutex()
+{
+  static std::mutex registry_mutex;
+  return registry_mutex;
+}
+
+inline ON_SimpleArray<const ON_CompressionCodec*>& ON_CompressionCodec::Internal_Registry()
+{
+  // The built in codecs are registered the first time the registry is used.
+  static const ON_DeflateCompressionCodec deflate_codec;
+  static const ON_LZCompressionCodec fast_codec(ON_CompressionCodec::FastCodecId, 1);
+  static ON_SimpleArray<const ON_CompressionCodec*> registry;
+  if (0 == registry.Count())
+  {
+    registry.Append(&deflate_codec);
+    registry.Append(&fast_codec);
+  }
+  return registry;
+}
+
+inline ON_SimpleArray<ON_CompressionCodec::Internal_ArchiveCodec>& ON_CompressionCodec::Internal_ArchiveCodecs()
+{
+  static ON_SimpleArray<Internal_ArchiveCodec> archive_codecs;
+  return archive_codecs;
+}
+
+inline bool ON_CompressionCodec::Register(
+  const ON_CompressionCodec* codec
+  )
+{
+  if (nullptr == codec || 0 == codec->CodecId())
+    return false;
+  std::lock_guard<std::mutex> lock(Internal_Mutex());
+  ON_SimpleArray<const ON_CompressionCodec*>& registry = Internal_Registry();
+  for (unsigned int i = 0; i < registry.UnsignedCount(); ++i)
+  {
+    if (registry[i]->CodecId() == codec->CodecId())
+      return false;
+  }
+  registry.Append(codec);
+  return true;
+}
+
+inline const ON_CompressionCodec* ON_CompressionCodec::FromId(
+  unsigned int codec_id
+  )
+{
+  std::lock_guard<std::mutex> lock(Internal_Mutex());
+  const ON_SimpleArray<const ON_CompressionCodec*>& registry = Internal_Registry();
+  for (unsigned int i = 0; i < registry.UnsignedCount(); ++i)
+  {
+    if (registry[i]->CodecId() == codec_id)
+      return registry[i];
+  }
+  return nullptr;
+}
+
+inline unsigned int ON_CompressionCodec::ArchiveCodecId(
+  const ON_BinaryArchive& archive
+  )
+{
+  std::lock_guard<std::mutex> lock(Internal_Mutex());
+  const ON_SimpleArray<Internal_ArchiveCodec>& archive_codecs = Internal_ArchiveCodecs();
+  for (unsigned int i = 0; i < archive_codecs.UnsignedCount(); ++i)
+  {
+    if (&archive == archive_codecs[i].m_archive)
+      return archive_codecs[i].m_codec_id;
+  }
+  return ON_CompressionCodec::DeflateCodecId;
+}
+
+inline unsigned int ON_DeflateCompressionCodec::CodecId() const
+{
+  return ON_CompressionCodec::DeflateCodecId;
+}
+
+inline const wchar_t* ON_DeflateCompressionCodec::Name() const
+{
+  return L"deflate";
+}
+
+inline size_t ON_DeflateCompressionCodec::CompressBound(size_t sizeof_uncompressed) const
+{
+  // zlib stored blocks add 5 bytes per 16 KB plus the stream header and trailer.
+  return sizeof_uncompressed + (sizeof_uncompressed >> 12) + 64;
+}
+
+inline size_t ON_DeflateCompressionCodec::Compress(
+  size_t sizeof_uncompressed,
+  const void* uncompressed,
+  size_t sizeof_compressed,
+  void* compressed
+  ) const
+{
+  if (0 == sizeof_uncompressed || nullptr == uncompressed || nullptr == compressed)
+    return 0;
+  ON_CompressedBuffer compressed_buffer;
+  if (false == compressed_buffer.Compress(sizeof_uncompressed, uncompressed, 1))
+    return 0;
+  // m_method = 0 means ON_CompressedBuffer copied the input.
+  if (1 != compressed_buffer.m_method || compressed_buffer.m_sizeof_compressed > sizeof_compressed)
+    return 0;
+  memcpy(compressed, compressed_buffer.m_buffer_compressed, compressed_buffer.m_sizeof_compressed);
+  return compressed_buffer.m_sizeof_compressed;
+}
+
+inline bool ON_DeflateCompressionCodec::Uncompress(
+  size_t sizeof_compressed,
+  const void* compressed,
+  size_t sizeof_uncompressed,
+  void* uncompressed
+  ) const
+{
+  if (0 == sizeof_uncompressed)
+    return true;
+  if (nullptr == compressed || nullptr == uncompressed)
+    return false;
+  return (sizeof_uncompressed == ON_UncompressBuffer(sizeof_compressed, compressed, sizeof_uncompressed, uncompressed));
+}
+
+inline ON_LZCompressionCodec::ON_LZCompressionCodec(
+  unsigned int codec_id,
+  unsigned int match_search_depth
+  )
+  : m_codec_id(codec_id)
+  , m_match_search_depth(match_search_depth > 0 ? match_search_depth : 1)
+{}
+
+inline unsigned int ON_LZCompressionCodec::CodecId() const
+{
+  return m_codec_id;
+}
+
+inline const wchar_t* ON_LZCompressionCodec::Name() const
+{
+  return (m_match_search_depth > 1) ? L"LZ deep search" : L"LZ fast";
+}
+
+inline size_t ON_LZCompressionCodec::CompressBound(size_t sizeof_uncompressed) const
+{
+  // One extra length byte per 255 literals plus a token.
+  return sizeof_uncompressed + sizeof_uncompressed / 255 + 16;
+}
+
+inline size_t ON_LZCompressionCodec::Compress(
+  size_t sizeof_uncompressed,
+  const void* uncompressed,
+  size_t sizeof_compressed,
+  void* compressed
+  ) const
+{
+  // The last match must start at least 12 bytes before the end and
+  // the last 5 bytes are always literals, as in LZ4. Uncompress()
+  // still checks every literal run and match against the ends of
+  // both buffers, so damaged input cannot read or write out of bounds.
+  const size_t min_match = 4;
+  const size_t match_start_limit = 12;
+  const size_t last_literals = 5;
+  const size_t max_offset = 65535;
+  const unsigned int hash_bits = 16;
+
+  if (sizeof_uncompressed <= match_start_limit || nullptr == uncompressed || nullptr == compressed)
+    return 0;
+
+  const ON__UINT8* in = (const ON__UINT8*)uncompressed;
+  ON__UINT8* out = (ON__UINT8*)compressed;
+  const size_t in_size = sizeof_uncompressed;
+  const size_t out_capacity = sizeof_compressed;
+
+  // head[h] = most recent position + 1 with hash h.
+  // chain[pos & 0xFFFF] = previous position + 1 with the same hash.
+  ON_SimpleArray<ON__UINT32> head((size_t)1 << hash_bits);
+  head.SetCount(1 << hash_bits);
+  head.Zero();
+  ON_SimpleArray<ON__UINT32> chain;
+  if (m_match_search_depth > 1)
+  {
+    chain.SetCapacity(max_offset + 1);
+    chain.SetCount((int)(max_offset + 1));
+    chain.Zero();
+  }
+
+  auto read32 = [in](size_t pos)
+  {
+    ON__UINT32 v;
+    memcpy(&v, in + pos, 4);
+    return v;
+  };
+  auto hash = [hash_bits](ON__UINT32 v)
+  {
+    return (unsigned int)((v * 2654435761U) >> (32 - hash_bits));
+  };
+  auto insert = [&](size_t pos)
+  {
+    const unsigned int h = hash(read32(pos));
+    if (m_match_search_depth > 1)
+      chain[(unsigned int)(pos & max_offset)] = head[h];
+    head[h] = (ON__UINT32)(pos + 1);
+  };
+  auto write_length = [&](size_t& op, size_t length) -> bool
+  {
+    for (; length >= 255; length -= 255)
+    {
+      if (op >= out_capacity)
+        return false;
+      out[op++] = 255;
+    }
+    if (op >= out_capacity)
+      return false;
+    out[op++] = (ON__UINT8)length;
+    return true;
+  };
+  auto write_sequence = [&](size_t& op, size_t literal_start, size_t literal_count, size_t offset, size_t match_length) -> bool
+  {
+    if (op >= out_capacity)
+      return false;
+    const size_t token_op = op++;
+    const size_t literal_code = (literal_count < 15) ? literal_count : 15;
+    const size_t match_code = (match_length > 0) ? (((match_length - min_match) < 15) ? (match_length - min_match) : 15) : 0;
+    out[token_op] = (ON__UINT8)((literal_code << 4) | match_code);
+    if (15 == literal_code && false == write_length(op, literal_count - 15))
+      return false;
+    if (literal_count > out_capacity - op)
+      return false;
+    memcpy(out + op, in + literal_start, literal_count);
+    op += literal_count;
+    if (0 == match_length)
+      return true;
+    if (2 > out_capacity - op)
+      return false;
+    out[op++] = (ON__UINT8)(offset & 0xFF);
+    out[op++] = (ON__UINT8)(offset >> 8);
+    if (15 == match_code && false == write_length(op, match_length - min_match - 15))
+      return false;
+    return true;
+  };
+
+  const size_t match_limit = in_size - last_literals;
+  const size_t start_limit = in_size - match_start_limit;
+  size_t ip = 0;
+  size_t anchor = 0;
+  size_t op = 0;
+  while (ip < start_limit)
+  {
+    // Find the longest match among the candidates.
+    const ON__UINT32 v = read32(ip);
+    size_t best_length = 0;
+    size_t best_offset = 0;
+    ON__UINT32 candidate = head[hash(v)];
+    for (unsigned int depth = 0; depth < m_match_search_depth && 0 != candidate; ++depth)
+    {
+      const size_t cpos = candidate - 1;
+      if (cpos >= ip || ip - cpos > max_offset)
+        break;
+      if (read32(cpos) == v)
+      {
+        size_t length = min_match;
+        while (ip + length < match_limit && in[cpos + length] == in[ip + length])
+          ++length;
+        if (length > best_length)
+        {
+          best_length = length;
+          best_offset = ip - cpos;
+        }
+      }
+      if (m_match_search_depth <= 1)
+        break;
+      const ON__UINT32 next = chain[(unsigned int)(cpos & max_offset)];
+      if (next >= candidate)
+        break;
+      candidate = next;
+    }
+    insert(ip);
+
+    if (best_length < min_match)
+    {
+      ++ip;
+      continue;
+    }
+
+    if (false == write_sequence(op, anchor, ip - anchor, best_offset, best_length))
+      return 0;
+
+    // Add positions inside the match to the tables. The fast codec adds
+    // only the last one.
+    const size_t match_end = ip + best_length;
+    if (m_match_search_depth > 1)
+    {
+      for (size_t pos = ip + 1; pos < match_end && pos < start_limit; ++pos)
+        insert(pos);
+    }
+    else if (match_end - 2 < start_limit)
+    {
+      insert(match_end - 2);
+    }
+    ip = match_end;
+    anchor = ip;
+  }
+
+  if (false == write_sequence(op, anchor, in_size - anchor, 0, 0))
+    return 0;
+
+  return (op < in_size) ? op : 0;
+}
+
+inline bool ON_LZCompressionCodec::Uncompress(
+  size_t sizeof_compressed,
+  const void* compressed,
+  size_t sizeof_uncompressed,
+  void* uncompressed
+  ) const
+{
+  if (0 == sizeof_uncompressed)
+    return true;
+  if (nullptr == compressed || nullptr == uncompressed)
+    return false;
+
+  const ON__UINT8* in = (const ON__UINT8*)compressed;
+  ON__UINT8* out = (ON__UINT8*)uncompressed;
+  const size_t in_size = sizeof_compressed;
+  const size_t out_size = sizeof_uncompressed;
+
+  auto read_length = [&](size_t& ip, size_t& length) -> bool
+  {
+    for (;;)
+    {
+      if (ip >= in_size)
+        return false;
+      const ON__UINT8 b = in[ip++];
+      length += b;
+      if (255 != b)
+        return true;
+    }
+  };
+
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < in_size)
+  {
+    const ON__UINT8 token = in[ip++];
+
+    size_t literal_count = token >> 4;
+    if (15 == literal_count && false == read_length(ip, literal_count))
+      return false;
+    if (literal_count > in_size - ip || literal_count > out_size - op)
+      return false;
+    memcpy(out + op, in + ip, literal_count);
+    ip += literal_count;
+    op += literal_count;
+
+    // The last sequence has literals and no match.
+    if (ip == in_size)
+      break;
+
+    if (2 > in_size - ip)
+      return false;
+    const size_t offset = (size_t)in[ip] | ((size_t)in[ip + 1] << 8);
+    ip += 2;
+    if (0 == offset || offset > op)
+      return false;
+
+    size_t match_length = token & 0x0F;
+    if (15 == match_length && false == read_length(ip, match_length))
+      return false;
+    match_length += 4;
+    if (match_length > out_size - op)
+      return false;
+
+    // Matches can overlap the bytes they produce.
+    const ON__UINT8* match = out + op - offset;
+    if (offset >= match_length)
+      memcpy(out + op, match, match_length);
+    else
+    {
+      for (size_t i = 0; i < match_length; ++i)
+        out[op + i] = match[i];
+    }
+    op += match_length;
+  }
+
+  return (op == out_size);
+}
+
+inline ON_ArchiveCompressionCodecScope::ON_ArchiveCompressionCodecScope(
+  const ON_BinaryArchive& archive,
+  unsigned int codec_id
+  )
+  : m_archive(&archive)
+  , m_previous_codec_id(0)
+{
+  std::lock_guard<std::mutex> lock(ON_CompressionCodec::Internal_Mutex());
+  ON_SimpleArray<ON_CompressionCodec::Internal_ArchiveCodec>& archive_codecs = ON_CompressionCodec::Internal_ArchiveCodecs();
+  for (unsigned int i = 0; i < archive_codecs.UnsignedCount(); ++i)
+  {
+    if (m_archive == archive_codecs[i].m_archive)
+    {
+      m_previous_codec_id = archive_codecs[i].m_codec_id;
+      archive_codecs[i].m_codec_id = codec_id;
+      return;
+    }
+  }
+  ON_CompressionCodec::Internal_ArchiveCodec& archive_codec = archive_codecs.AppendNew();
+  archive_codec.m_archive = m_archive;
+  archive_codec.m_codec_id = codec_id;
+}
+
+inline ON_ArchiveCompressionCodecScope::~ON_ArchiveCompressionCodecScope()
+{
+  std::lock_guard<std::mutex> lock(ON_CompressionCodec::Internal_Mutex());
+  ON_SimpleArray<ON_CompressionCodec::Internal_ArchiveCodec>& archive_codecs = ON_CompressionCodec::Internal_ArchiveCodecs();
+  for (unsigned int i = 0; i < archive_codecs.UnsignedCount(); ++i)
+  {
+    if (m_archive == archive_codecs[i].m_archive)
+    {
+      // 0 means the archive had no codec before the scope.
+      if (0 == m_previous_codec_id)
+        archive_codecs.Remove((int)i);
+      else
+        archive_codecs[i].m_codec_id = m_previous_codec_id;
+      return;
+    }
+  }
+}
+
+#endif
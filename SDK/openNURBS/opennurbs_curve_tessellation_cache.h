@@ -0,0 +1,403 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_CURVE_TESSELLATION_CACHE_INC_)
+#define OPENNURBS_CURVE_TESSELLATION_CACHE_INC_
+
+/*
+Description:
+  Identifies a cached curve tessellation.
+*/
+class ON_CurveTessellationKey
+{
+public:
+  ON_CurveTessellationKey() = default;
+  ~ON_CurveTessellationKey() = default;
+  ON_CurveTessellationKey(const ON_CurveTessellationKey&) = default;
+  ON_CurveTessellationKey& operator=(const ON_CurveTessellationKey&) = default;
+
+  /*
+  Returns:
+    True if m_curve_hash is not ON_SHA1_Hash::ZeroDigest.
+  */
+  bool IsSet() const;
+
+  // ON_CurveTessellationCache::CurveContentHash() of the curve.
+  ON_SHA1_Hash m_curve_hash = ON_SHA1_Hash::ZeroDigest;
+
+  // ON_CurveTessellationCache::ToleranceClass() of the distance tolerance.
+  int m_tolerance_class = 0;
+
+  // Angle tolerance in radians. 0 means no angle tolerance.
+  double m_angle_tolerance = 0.0;
+};
+
+bool operator==(const ON_CurveTessellationKey& a, const ON_CurveTessellationKey& b);
+bool operator!=(const ON_CurveTessellationKey& a, const ON_CurveTessellationKey& b);
+
+ON__UINT64 ON_FlatHashTableHash(const ON_CurveTessellationKey& key);
+
+/*
+Description:
+  ON_CurveTessellationCache keeps polyline approximations of curves so
+  display and export code can reuse them instead of tessellating the same
+  curve with the same tolerances again.
+
+  Polylines are stored by curve content hash, tolerance class and angle
+  tolerance. The content hash depends only on the curve's geometry, so
+  identical curves in different objects share one polyline and a modified
+  curve never finds the polyline of its previous geometry.
+
+  Distance tolerances are grouped into classes of powers of two. A
+  polyline in a class is made with the smallest tolerance in that class,
+  so it is within every tolerance in the class.
+
+  When the total number of cached points exceeds the capacity, the
+  least recently used polylines are removed.
+
+  Polylines are made by Tessellate() unless a different function is set
+  with SetTessellateFunction(). Rhino code can use the tessellation Rhino
+  displays, for example with a function that calls
+  RhinoConvertCurveToPolyline().
+Remarks:
+  Every member function may be called from multiple threads.
+  Tessellation is done without holding the cache lock.
+  Returned polylines are never modified and remain valid after they
+  are removed from the cache.
+*/
+class ON_CurveTessellationCache
+{
+public:
+  /*
+  Parameters:
+    point_capacity - [in]
+      Maximum total number of points in the cached polylines.
+  */
+  ON_CurveTessellationCache(
+    size_t point_capacity = ON_CurveTessellationCache::DefaultPointCapacity
+    );
+
+  ~ON_CurveTessellationCache();
+
+  enum : size_t
+  {
+    DefaultPointCapacity = 4 * 1024 * 1024
+  };
+
+  /*
+  Description:
+    A function that calculates a polyline approximation of a curve.
+  Parameters:
+    context - [in]
+      The context passed to SetTessellateFunction().
+    curve - [in]
+    tolerance - [in]
+      The smallest tolerance in the tolerance class.
+    angle_tolerance_radians - [in]
+      0 means no angle tolerance.
+    polyline - [out]
+  Returns:
+    True if successful.
+  Remarks:
+    The function is called from multiple threads.
+  */
+  typedef bool (*TessellateFunction)(
+    void* context,
+    const class ON_Curve& curve,
+    double tolerance,
+    double angle_tolerance_radians,
+    ON_Polyline& polyline
+    );
+
+  /*
+  Description:
+    Set the function used to tessellate curves. Cached polylines are
+    removed so every cached polyline comes from the same function.
+  Parameters:
+    tessellate_function - [in]
+      nullptr restores Tessellate().
+    context - [in]
+      Passed to tessellate_function.
+  */
+  void SetTessellateFunction(
+    TessellateFunction tessellate_function,
+    void* context
+    );
+
+  /*
+  Description:
+    Get a polyline approximation of a curve.
+  Parameters:
+    curve - [in]
+    tolerance - [in]
+      Maximum distance from the polyline to the curve. Must be > 0.
+    angle_tolerance_radians - [in]
+      Maximum angle between the curve tangents at the ends of a
+      polyline segment. 0 means no angle tolerance.
+  Returns:
+    The polyline or nullptr if the curve could not be tessellated.
+  */
+  std::shared_ptr<const ON_Polyline> Polyline(
+    const class ON_Curve& curve,
+    double tolerance,
+    double angle_tolerance_radians
+    );
+
+  /*
+  Description:
+    Same as Polyline(curve, tolerance, angle_tolerance_radians) for a
+    caller that has already calculated the key.
+  Parameters:
+    key - [in]
+      Key(curve, tolerance, angle_tolerance_radians)
+  */
+  std::shared_ptr<const ON_Polyline> Polyline(
+    const ON_CurveTessellationKey& key,
+    const class ON_Curve& curve
+    );
+
+  /*
+  Returns:
+    The cached polyline with key or nullptr if there is none.
+  */
+  std::shared_ptr<const ON_Polyline> CachedPolyline(
+    const ON_CurveTessellationKey& key
+    );
+
+  /*
+  Description:
+    Remove the polyline with key from the cache.
+  Returns:
+    True if a polyline was removed.
+  */
+  bool Remove(
+    const ON_CurveTessellationKey& key
+    );
+
+  /*
+  Description:
+    Remove every polyline from the cache.
+  */
+  void RemoveAll();
+
+  size_t PointCapacity() const;
+
+  /*
+  Description:
+    Set the point capacity. Least recently used polylines are removed
+    until the cache holds at most point_capacity points.
+  */
+  void SetPointCapacity(
+    size_t point_capacity
+    );
+
+  size_t PointCount() const;
+
+  unsigned int PolylineCount() const;
+
+  /*
+  Returns:
+    The key for a curve and tolerances.
+  */
+  static const ON_CurveTessellationKey Key(
+    const class ON_Curve& curve,
+    double tolerance,
+    double angle_tolerance_radians
+    );
+
+  /*
+  Returns:
+    The key for a curve with content hash curve_hash and tolerances.
+  */
+  static const ON_CurveTessellationKey Key(
+    const ON_SHA1_Hash& curve_hash,
+    double tolerance,
+    double angle_tolerance_radians
+    );
+
+  /*
+  Description:
+    Calculate a hash of the geometry of a curve.
+  Remarks:
+    ON_NurbsCurve, ON_ArcCurve, ON_LineCurve, ON_PolylineCurve and
+    ON_PolyCurve are hashed from their definitions. ON_CurveProxy curves,
+    like brep edges and trims, are hashed from the curve they use, the
+    sub-domain and the direction. Other curves are hashed from their
+    NURBS form.
+  */
+  static const ON_SHA1_Hash CurveContentHash(
+    const class ON_Curve& curve
+    );
+
+  /*
+  Returns:
+    The tolerance class of tolerance. The tolerance class c contains
+    the tolerances in [2^(c-1), 2^c).
+  */
+  static int ToleranceClass(
+    double tolerance
+    );
+
+  /*
+  Returns:
+    The smallest tolerance in the tolerance class, 2^(tolerance_class-1).
+  */
+  static double ClassTolerance(
+    int tolerance_class
+    );
+
+  /*
+  Description:
+    Calculate a polyline approximation of a curve. Each span of the
+    curve is divided until the distance tolerance and the angle
+    tolerance are satisfied.
+  Parameters:
+    curve - [in]
+    tolerance - [in]
+    angle_tolerance_radians - [in]
+    polyline - [out]
+  Returns:
+    True if successful.
+  */
+  static bool Tessellate(
+    const class ON_Curve& curve,
+    double tolerance,
+    double angle_tolerance_radians,
+    ON_Polyline& polyline
+    );
+
+private:
+  class Entry
+  {
+  public:
+    ON_CurveTessellationKey m_key;
+    std::shared_ptr<const ON_Polyline> m_polyline;
+    // doubly linked list in use order, most recently used first
+    Entry* m_prev = nullptr;
+    Entry* m_next = nullptr;
+  };
+
+  void Internal_MoveToFront(Entry* e);
+  void Internal_Unlink(Entry* e);
+  void Internal_Delete(Entry* e);
+  void Internal_Trim();
+
+  static void Internal_AccumulateCurve(
+    class ON_SHA1& sha1,
+    const class ON_Curve& curve,
+    int depth
+    );
+
+  static void Internal_AccumulateNurbsCurve(
+    class ON_SHA1& sha1,
+    const class ON_NurbsCurve& curve
+    );
+
+  static bool Internal_TessellateSpan(
+    const class ON_Curve& curve,
+    double t0,
+    double t1,
+    double tolerance,
+    double cos_angle_tolerance,
+    int depth,
+    ON_3dPoint P0,
+    ON_3dVector T0,
+    ON_3dPoint P1,
+    ON_3dVector T1,
+    ON_Polyline& polyline
+    );
+
+  mutable std::mutex m_mutex;
+  TessellateFunction m_tessellate_function = nullptr;
+  void* m_tessellate_context = nullptr;
+  ON_FlatHashTable<ON_CurveTessellationKey, Entry*> m_entries;
+  Entry* m_first = nullptr;
+  Entry* m_last = nullptr;
+  size_t m_point_capacity = 0;
+  size_t m_point_count = 0;
+
+private:
+  ON_CurveTessellationCache(const ON_CurveTessellationCache&) = delete;
+  ON_CurveTessellationCache& operator=(const ON_CurveTessellationCache&) = delete;
+};
+
+/*
+Description:
+  ON_CurveTessellationCacheHandle is runtime data kept with one curve,
+  for example next to the curve of a document object. It keeps the
+  curve's content hash, so the hash is calculated once per geometry, and
+  the polyline most recently returned for the curve, so repeated
+  requests with the same tolerances skip the cache lock.
+Remarks:
+  A handle is used by one thread at a time.
+  The owner must call Invalidate() when the curve is modified.
+  Polylines the handle no longer uses stay in the cache, because
+  identical curves may share them, and are removed when they are the
+  least recently used.
+Example:
+          // When the curve is drawn
+          std::shared_ptr<const ON_Polyline> pline
+            = m_tessellation.Polyline(cache, *curve, tolerance, angle_tolerance);
+
+          // When the curve is modified or deleted
+          m_tessellation.Invalidate();
+*/
+class ON_CurveTessellationCacheHandle
+{
+public:
+  ON_CurveTessellationCacheHandle() = default;
+  ~ON_CurveTessellationCacheHandle() = default;
+  ON_CurveTessellationCacheHandle(const ON_CurveTessellationCacheHandle&) = default;
+  ON_CurveTessellationCacheHandle& operator=(const ON_CurveTessellationCacheHandle&) = default;
+
+  /*
+  Description:
+    Get a polyline approximation of the curve.
+  Parameters:
+    cache - [in]
+      The same cache must be used for every call until Invalidate()
+      is called.
+    curve - [in]
+    tolerance - [in]
+    angle_tolerance_radians - [in]
+  Returns:
+    The polyline or nullptr if the curve could not be tessellated.
+  Remarks:
+    The content hash is calculated when the handle has none, which is
+    on the first call, after Invalidate() and when the curve pointer
+    changes. Otherwise the hash from the earlier call is used.
+  */
+  std::shared_ptr<const ON_Polyline> Polyline(
+    ON_CurveTessellationCache& cache,
+    const class ON_Curve& curve,
+    double tolerance,
+    double angle_tolerance_radians
+    );
+
+  /*
+  Description:
+    Call when the curve is modified or deleted. The handle forgets the
+    content hash and the polyline.
+  */
+  void Invalidate();
+
+private:
+  ON_CurveTessellationCache* m_cache = nullptr;
+  const class ON_Curve* m_curve = nullptr;
+  ON_CurveTessellationKey m_key;
+  std::shared_ptr<const ON_Polyline> m_polyline;
+};
+
+#include "opennurbs_curve_tessellation_cache_defs.h"
+
+#endif
@@ -0,0 +1,577 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_CURVE_TESSELLATION_CACHE_DEFS_INC_)
+#define OPENNURBS_CURVE_TESSELLATION_CACHE_DEFS_INC_
+
+// Maximum number of times a piece of a span is divided in half.
+#define ON_CURVE_TESSELLATION_MAX_DEPTH 20
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_CurveTessellationKey
+/////////////////////////////////////////////////////////////////////////////////////
+
+inline bool ON_CurveTessellationKey::IsSet() const
+{
+  return false == m_curve_hash.IsZeroDigest();
+}
+
+inline bool operator==(const ON_CurveTessellationKey& a, const ON_CurveTessellationKey& b)
+{
+  return a.m_tolerance_class == b.m_tolerance_class
+    && a.m_angle_tolerance == b.m_angle_tolerance
+    && a.m_curve_hash == b.m_curve_hash;
+}
+
+inline bool operator!=(const ON_CurveTessellationKey& a, const ON_CurveTessellationKey& b)
+{
+  return !(a == b);
+}
+
+inline ON__UINT64 ON_FlatHashTableHash(const ON_CurveTessellationKey& key)
+{
+  // The SHA-1 digest bytes are already well mixed.
+  ON__UINT64 h;
+  memcpy(&h, key.m_curve_hash.m_digest, sizeof(h));
+  ON__UINT64 a;
+  memcpy(&a, &key.m_angle_tolerance, sizeof(a));
+  return h ^ ON_FlatHashTableHash(a ^ ON_FlatHashTableHash(key.m_tolerance_class));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_CurveTessellationCache
+/////////////////////////////////////////////////////////////////////////////////////
+
+inline ON_CurveTessellationCache::ON_CurveTessellationCache(
+  size_t point_capacity
+  )
+  : m_point_capacity(point_capacity)
+{}
+
+inline ON_CurveTessellationCache::~ON_CurveTessellationCache()
+{
+  RemoveAll();
+}
+
+inline std::shared_ptr<const ON_Polyline> ON_CurveTessellationCache::Polyline(
+  const ON_Curve& curve,
+  double tolerance,
+  double angle_tolerance_radians
+  )
+{
+  return Polyline(Key(curve, tolerance, angle_tolerance_radians), curve);
+}
+
+inline std::shared_ptr<const ON_Polyline> ON_CurveTessellationCache::Polyline(
+  const ON_CurveTessellationKey& key,
+  const ON_Curve& curve
+  )
+{
+  if (false == key.IsSet())
+    return nullptr;
+
+  std::shared_ptr<const ON_Polyline> polyline = CachedPolyline(key);
+  if (nullptr != polyline)
+    return polyline;
+
+  TessellateFunction tessellate_function = nullptr;
+  void* tessellate_context = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    tessellate_function = m_tessellate_function;
+    tessellate_context = m_tessellate_context;
+  }
+
+  // Tessellate without holding the lock so other threads can use the cache.
+  ON_Polyline* new_polyline = new ON_Polyline();
+  const double tolerance = ClassTolerance(key.m_tolerance_class);
+  const bool rc = (nullptr != tessellate_function)
+    ? tessellate_function(tessellate_context, curve, tolerance, key.m_angle_tolerance, *new_polyline)
+    : Tessellate(curve, tolerance, key.m_angle_tolerance, *new_polyline);
+  if (false == rc || new_polyline->Count() < 2)
+  {
+    delete new_polyline;
+    return nullptr;
+  }
+  polyline = std::shared_ptr<const ON_Polyline>(new_polyline);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (tessellate_function != m_tessellate_function || tessellate_context != m_tessellate_context)
+    return polyline; // the function changed while tessellating
+  bool bAdded = false;
+  Entry** slot = m_entries.FindOrAdd(key, &bAdded);
+  if (nullptr == slot)
+    return polyline;
+  if (false == bAdded)
+  {
+    // Another thread added the same tessellation.
+    Internal_MoveToFront(*slot);
+    return (*slot)->m_polyline;
+  }
+  Entry* e = new Entry();
+  e->m_key = key;
+  e->m_polyline = polyline;
+  *slot = e;
+  Internal_MoveToFront(e);
+  m_point_count += (size_t)polyline->Count();
+  Internal_Trim();
+  return polyline;
+}
+
+inline std::shared_ptr<const ON_Polyline> ON_CurveTessellationCache::CachedPolyline(
+  const ON_CurveTessellationKey& key
+  )
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry** e = m_entries.Find(key);
+  if (nullptr == e)
+    return nullptr;
+  Internal_MoveToFront(*e);
+  return (*e)->m_polyline;
+}
+
+inline bool ON_CurveTessellationCache::Remove(
+  const ON_CurveTessellationKey& key
+  )
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry** e = m_entries.Find(key);
+  if (nullptr == e)
+    return false;
+  Internal_Delete(*e);
+  return true;
+}
+
+inline void ON_CurveTessellationCache::RemoveAll()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (Entry* e = m_first; nullptr != e; )
+  {
+    Entry* next = e->m_next;
+    delete e;
+    e = next;
+  }
+  m_first = nullptr;
+  m_last = nullptr;
+  m_point_count = 0;
+  m_entries.RemoveAllItems();
+}
+
+inline void ON_CurveTessellationCache::SetTessellateFunction(
+  TessellateFunction tessellate_function,
+  void* context
+  )
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tessellate_function = tessellate_function;
+    m_tessellate_context = (nullptr != tessellate_function) ? context : nullptr;
+  }
+  RemoveAll();
+}
+
+inline size_t ON_CurveTessellationCache::PointCapacity() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_point_capacity;
+}
+
+inline void ON_CurveTessellationCache::SetPointCapacity(
+  size_t point_capacity
+  )
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_point_capacity = point_capacity;
+  Internal_Trim();
+}
+
+inline size_t ON_CurveTessellationCache::PointCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_point_count;
+}
+
+inline unsigned int ON_CurveTessellationCache::PolylineCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.ItemCount();
+}
+
+inline const ON_CurveTessellationKey ON_CurveTessellationCache::Key(
+  const ON_Curve& curve,
+  double tolerance,
+  double angle_tolerance_radians
+  )
+{
+  if (!(tolerance > 0.0) || !ON_IsValid(tolerance))
+    return ON_CurveTessellationKey();
+  return Key(CurveContentHash(curve), tolerance, angle_tolerance_radians);
+}
+
+inline const ON_CurveTessellationKey ON_CurveTessellationCache::Key(
+  const ON_SHA1_Hash& curve_hash,
+  double tolerance,
+  double angle_tolerance_radians
+  )
+{
+  ON_CurveTessellationKey key;
+  if (!(tolerance > 0.0) || !ON_IsValid(tolerance))
+    return key;
+  key.m_curve_hash = curve_hash;
+  key.m_tolerance_class = ToleranceClass(tolerance);
+  key.m_angle_tolerance = (angle_tolerance_radians > 0.0 && angle_tolerance_radians < ON_PI)
+    ? angle_tolerance_radians
+    : 0.0;
+  return key;
+}
+
+inline const ON_SHA1_Hash ON_CurveTessellationCache::CurveContentHash(
+  const ON_Curve& curve
+  )
+{
+  ON_SHA1 sha1;
+  Internal_AccumulateCurve(sha1, curve, 0);
+  return sha1.Hash();
+}
+
+inline int ON_CurveTessellationCache::ToleranceClass(
+  double tolerance
+  )
+{
+  int e = 0;
+  frexp(tolerance, &e);
+  return e;
+}
+
+inline double ON_CurveTessellationCache::ClassTolerance(
+  int tolerance_class
+  )
+{
+  return ldexp(1.0, tolerance_class - 1);
+}
+
+inline bool ON_CurveTessellationCache::Tessellate(
+  const ON_Curve& curve,
+  double tolerance,
+  double angle_tolerance_radians,
+  ON_Polyline& polyline
+  )
+{
+  polyline.SetCount(0);
+  if (!(tolerance > 0.0) || !ON_IsValid(tolerance))
+    return false;
+  const int span_count = curve.SpanCount();
+  if (span_count < 1)
+    return false;
+  ON_SimpleArray<double> span_vector(span_count + 1);
+  span_vector.SetCount(span_count + 1);
+  if (false == curve.GetSpanVector(span_vector.Array()))
+    return false;
+
+  // cos_angle_tolerance < -1 turns off the angle test
+  const double cos_angle_tolerance = (angle_tolerance_radians > 0.0 && angle_tolerance_radians < ON_PI)
+    ? cos(angle_tolerance_radians)
+    : -2.0;
+
+  // Each span is first divided into degree pieces so the midpoint tests
+  // see the shape of the span.
+  const int degree = curve.Degree();
+  const int piece_count = (degree > 1) ? degree : 1;
+
+  for (int si = 0; si < span_count; ++si)
+  {
+    const double s0 = span_vector[si];
+    const double s1 = span_vector[si + 1];
+    if (!(s0 < s1))
+      continue;
+    ON_3dPoint P0;
+    ON_3dVector T0;
+    if (false == curve.EvTangent(s0, P0, T0, 1))
+      return false;
+    if (0 == polyline.Count())
+      polyline.Append(P0);
+    double t0 = s0;
+    for (int k = 1; k <= piece_count; ++k)
+    {
+      const double t1 = (k == piece_count) ? s1 : (s0 + (s1 - s0) * ((double)k) / ((double)piece_count));
+      ON_3dPoint P1;
+      ON_3dVector T1;
+      if (false == curve.EvTangent(t1, P1, T1, (k == piece_count) ? -1 : 0))
+        return false;
+      if (false == Internal_TessellateSpan(curve, t0, t1, tolerance, cos_angle_tolerance, 0, P0, T0, P1, T1, polyline))
+        return false;
+      t0 = t1;
+      P0 = P1;
+      T0 = T1;
+    }
+  }
+
+  return polyline.Count() >= 2;
+}
+
+inline bool ON_CurveTessellationCache::Internal_TessellateSpan(
+  const ON_Curve& curve,
+  double t0,
+  double t1,
+  double tolerance,
+  double cos_angle_tolerance,
+  int depth,
+  ON_3dPoint P0,
+  ON_3dVector T0,
+  ON_3dPoint P1,
+  ON_3dVector T1,
+  ON_Polyline& polyline
+  )
+{
+  const double tm = 0.5 * (t0 + t1);
+  if (depth < ON_CURVE_TESSELLATION_MAX_DEPTH && t0 < tm && tm < t1)
+  {
+    // Divide when the tangents turn too much or when the curve is too
+    // far from the chord at 1/4, 1/2 or 3/4 of the piece.
+    bool bDivide = (T0 * T1 < cos_angle_tolerance);
+
+    const ON_3dVector chord = P1 - P0;
+    const double chord_length2 = chord * chord;
+    const double tolerance2 = tolerance * tolerance;
+    auto DistanceToChord2 = [&P0, &chord, chord_length2](const ON_3dPoint& P)
+    {
+      ON_3dVector V = P - P0;
+      if (chord_length2 > 0.0)
+      {
+        double s = (V * chord) / chord_length2;
+        if (s < 0.0)
+          s = 0.0;
+        else if (s > 1.0)
+          s = 1.0;
+        V = V - s * chord;
+      }
+      return V * V;
+    };
+
+    ON_3dPoint Pm;
+    ON_3dVector Tm;
+    if (false == curve.EvTangent(tm, Pm, Tm))
+      return false;
+    if (false == bDivide)
+      bDivide = DistanceToChord2(Pm) > tolerance2;
+    if (false == bDivide)
+      bDivide = DistanceToChord2(curve.PointAt(t0 + 0.25 * (t1 - t0))) > tolerance2;
+    if (false == bDivide)
+      bDivide = DistanceToChord2(curve.PointAt(t0 + 0.75 * (t1 - t0))) > tolerance2;
+
+    if (bDivide)
+    {
+      return Internal_TessellateSpan(curve, t0, tm, tolerance, cos_angle_tolerance, depth + 1, P0, T0, Pm, Tm, polyline)
+        && Internal_TessellateSpan(curve, tm, t1, tolerance, cos_angle_tolerance, depth + 1, Pm, Tm, P1, T1, polyline);
+    }
+  }
+  polyline.Append(P1);
+  return true;
+}
+
+inline void ON_CurveTessellationCache::Internal_MoveToFront(Entry* e)
+{
+  if (m_first == e)
+    return;
+  Internal_Unlink(e);
+  e->m_next = m_first;
+  if (nullptr != m_first)
+    m_first->m_prev = e;
+  m_first = e;
+  if (nullptr == m_last)
+    m_last = e;
+}
+
+inline void ON_CurveTessellationCache::Internal_Unlink(Entry* e)
+{
+  if (nullptr != e->m_prev)
+    e->m_prev->m_next = e->m_next;
+  else if (m_first == e)
+    m_first = e->m_next;
+  if (nullptr != e->m_next)
+    e->m_next->m_prev = e->m_prev;
+  else if (m_last == e)
+    m_last = e->m_prev;
+  e->m_prev = nullptr;
+  e->m_next = nullptr;
+}
+
+inline void ON_CurveTessellationCache::Internal_Delete(Entry* e)
+{
+  Internal_Unlink(e);
+  m_entries.Remove(e->m_key, nullptr);
+  m_point_count -= (size_t)e->m_polyline->Count();
+  delete e;
+}
+
+inline void ON_CurveTessellationCache::Internal_Trim()
+{
+  while (m_point_count > m_point_capacity && nullptr != m_last)
+    Internal_Delete(m_last);
+}
+
+inline void ON_CurveTessellationCache::Internal_AccumulateNurbsCurve(
+  ON_SHA1& sha1,
+  const ON_NurbsCurve& curve
+  )
+{
+  sha1.AccumulateInteger32(curve.m_dim);
+  sha1.AccumulateInteger32(curve.m_is_rat);
+  sha1.AccumulateInteger32(curve.m_order);
+  sha1.AccumulateInteger32(curve.m_cv_count);
+  if (nullptr != curve.m_knot && curve.m_order >= 2 && curve.m_cv_count >= curve.m_order)
+    sha1.AccumulateDoubleArray((size_t)curve.KnotCount(), curve.m_knot);
+  if (nullptr != curve.m_cv)
+  {
+    const int cv_size = curve.CVSize();
+    for (int i = 0; i < curve.m_cv_count; ++i)
+      sha1.AccumulateDoubleArray((size_t)cv_size, curve.CV(i));
+  }
+}
+
+inline void ON_CurveTessellationCache::Internal_AccumulateCurve(
+  ON_SHA1& sha1,
+  const ON_Curve& curve,
+  int depth
+  )
+{
+  const ON_ClassId* class_id = curve.ClassId();
+  sha1.AccumulateId((nullptr != class_id) ? class_id->Uuid() : ON_nil_uuid);
+  const ON_Interval domain = curve.Domain();
+  sha1.AccumulateDouble(domain[0]);
+  sha1.AccumulateDouble(domain[1]);
+
+  const ON_NurbsCurve* nurbs_curve = ON_NurbsCurve::Cast(&curve);
+  if (nullptr != nurbs_curve)
+  {
+    Internal_AccumulateNurbsCurve(sha1, *nurbs_curve);
+    return;
+  }
+
+  const ON_ArcCurve* arc_curve = ON_ArcCurve::Cast(&curve);
+  if (nullptr != arc_curve)
+  {
+    const ON_Arc& arc = arc_curve->m_arc;
+    sha1.Accumulate3dPoint(arc.plane.origin);
+    sha1.Accumulate3dVector(arc.plane.xaxis);
+    sha1.Accumulate3dVector(arc.plane.yaxis);
+    sha1.AccumulateDouble(arc.radius);
+    const ON_Interval angle = arc.DomainRadians();
+    sha1.AccumulateDouble(angle[0]);
+    sha1.AccumulateDouble(angle[1]);
+    sha1.AccumulateInteger32(arc_curve->m_dim);
+    return;
+  }
+
+  const ON_LineCurve* line_curve = ON_LineCurve::Cast(&curve);
+  if (nullptr != line_curve)
+  {
+    sha1.Accumulate3dPoint(line_curve->m_line.from);
+    sha1.Accumulate3dPoint(line_curve->m_line.to);
+    sha1.AccumulateInteger32(line_curve->m_dim);
+    return;
+  }
+
+  const ON_PolylineCurve* polyline_curve = ON_PolylineCurve::Cast(&curve);
+  if (nullptr != polyline_curve)
+  {
+    const int point_count = polyline_curve->m_pline.Count();
+    sha1.AccumulateInteger32(point_count);
+    if (point_count > 0)
+      sha1.AccumulateDoubleArray(3 * (size_t)point_count, &polyline_curve->m_pline[0].x);
+    sha1.AccumulateDoubleArray((size_t)polyline_curve->m_t.Count(), polyline_curve->m_t.Array());
+    sha1.AccumulateInteger32(polyline_curve->m_dim);
+    return;
+  }
+
+  // Brep edges and trims are proxies. Hashing the curve they use is much
+  // cheaper than hashing their NURBS form.
+  const ON_CurveProxy* proxy_curve = ON_CurveProxy::Cast(&curve);
+  const ON_Curve* real_curve = (nullptr != proxy_curve) ? proxy_curve->ProxyCurve() : nullptr;
+  if (nullptr != real_curve && real_curve != &curve && depth < 32)
+  {
+    const ON_Interval proxy_domain = proxy_curve->ProxyCurveDomain();
+    sha1.AccumulateDouble(proxy_domain[0]);
+    sha1.AccumulateDouble(proxy_domain[1]);
+    sha1.AccumulateBool(proxy_curve->ProxyCurveIsReversed());
+    Internal_AccumulateCurve(sha1, *real_curve, depth + 1);
+    return;
+  }
+
+  const ON_PolyCurve* poly_curve = ON_PolyCurve::Cast(&curve);
+  if (nullptr != poly_curve && depth < 32)
+  {
+    const int segment_count = poly_curve->Count();
+    sha1.AccumulateInteger32(segment_count);
+    for (int i = 0; i < segment_count; ++i)
+    {
+      const ON_Interval segment_domain = poly_curve->SegmentDomain(i);
+      sha1.AccumulateDouble(segment_domain[0]);
+      sha1.AccumulateDouble(segment_domain[1]);
+      const ON_Curve* segment = poly_curve->SegmentCurve(i);
+      if (nullptr != segment)
+        Internal_AccumulateCurve(sha1, *segment, depth + 1);
+      else
+        sha1.AccumulateInteger32(0);
+    }
+    return;
+  }
+
+  ON_NurbsCurve nurbs_form;
+  if (0 != curve.GetNurbForm(nurbs_form))
+    Internal_AccumulateNurbsCurve(sha1, nurbs_form);
+  else
+    sha1.AccumulateUnsigned32(curve.DataCRC(0));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_CurveTessellationCacheHandle
+/////////////////////////////////////////////////////////////////////////////////////
+
+inline std::shared_ptr<const ON_Polyline> ON_CurveTessellationCacheHandle::Polyline(
+  ON_CurveTessellationCache& cache,
+  const ON_Curve& curve,
+  double tolerance,
+  double angle_tolerance_radians
+  )
+{
+  ON_CurveTessellationKey key;
+  if (&curve == m_curve && m_key.IsSet())
+  {
+    // Only the tolerances can change until Invalidate() is called.
+    key = ON_CurveTessellationCache::Key(m_key.m_curve_hash, tolerance, angle_tolerance_radians);
+  }
+  else
+    key = ON_CurveTessellationCache::Key(curve, tolerance, angle_tolerance_radians);
+  if (false == key.IsSet())
+    return nullptr;
+
+  if (key == m_key && &cache == m_cache && nullptr != m_polyline)
+    return m_polyline;
+
+  m_cache = &cache;
+  m_curve = &curve;
+  m_key = key;
+  m_polyline = cache.Polyline(key, curve);
+  return m_polyline;
+}
+
+inline void ON_CurveTessellationCacheHandle::Invalidate()
+{
+  m_cache = nullptr;
+  m_curve = nullptr;
+  m_key = ON_CurveTessellationKey();
+  m_polyline = nullptr;
+}
+
+#endif
@@ -0,0 +1,212 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_FLAT_HASH_ADAPTERS_INC_)
+#define OPENNURBS_FLAT_HASH_ADAPTERS_INC_
+
+/*
+Description:
+  ON_SubDComponentPtrPairFlatHashTable has the same member functions as
+  ON_SubDComponentPtrPairHashTable and stores the pairs in an
+  ON_FlatHashTable keyed by the second component.
+Remarks:
+  Pairs are found by the component the second ON_SubDComponentPtr
+  points to. The direction bit of the second component is ignored.
+*/
+class ON_SubDComponentPtrPairFlatHashTable
+{
+public:
+  ON_SubDComponentPtrPairFlatHashTable() = default;
+  ~ON_SubDComponentPtrPairFlatHashTable() = default;
+
+  /*
+  Parameters:
+    pair_count_estimate - [in]
+      A good estimate of the number of pairs that will be in this hash table.
+  */
+  ON_SubDComponentPtrPairFlatHashTable(
+    size_t pair_count_estimate
+    );
+
+  /*
+  Parameters:
+    subd - [in]
+      subd.VertexCount() + subd.EdgeCount() is used as the pair count estimate.
+  */
+  ON_SubDComponentPtrPairFlatHashTable(
+    const class ON_SubD& subd
+    );
+
+  /*
+  Returns:
+    True if the pair was added. False if second_component is null or
+    a pair with the same second component is already in the table.
+  */
+  bool AddComponentPair(
+    ON_SubDComponentPtr first_component,
+    ON_SubDComponentPtr second_component
+    );
+
+  bool AddVertexPair(
+    const class ON_SubDVertex* first_v,
+    const class ON_SubDVertex* second_v
+    );
+
+  bool AddEdgePair(
+    const class ON_SubDEdge* first_e,
+    const class ON_SubDEdge* second_e
+    );
+
+  bool AddEdgePair(
+    const class ON_SubDEdge* first_e,
+    const ON_SubDEdgePtr second_eptr
+    );
+
+  bool AddFacePair(
+    const class ON_SubDFace* first_f,
+    const class ON_SubDFace* second_f
+    );
+
+  /*
+  Returns:
+    The pair with the second component or ON_SubDComponentPtrPair::Null.
+  */
+  const ON_SubDComponentPtrPair PairFromSecondComponentPtr(
+    ON_SubDComponentPtr second_component
+    ) const;
+
+  const ON_SubDComponentPtrPair PairFromSecondVertex(
+    const class ON_SubDVertex* second_v
+    ) const;
+
+  const ON_SubDComponentPtrPair PairFromSecondEdge(
+    const class ON_SubDEdge* second_e
+    ) const;
+
+  const ON_SubDComponentPtrPair PairFromSecondFace(
+    const class ON_SubDFace* second_f
+    ) const;
+
+  unsigned int PairCount() const;
+
+private:
+  ON_FlatHashTable<const class ON_SubDComponentBase*, ON_SubDComponentPtrPair> m_pairs;
+
+private:
+  ON_SubDComponentPtrPairFlatHashTable(const ON_SubDComponentPtrPairFlatHashTable&) = delete;
+  ON_SubDComponentPtrPairFlatHashTable& operator=(const ON_SubDComponentPtrPairFlatHashTable&) = delete;
+};
+
+/*
+Description:
+  ON_SerialNumberFlatMap has the serial number and id lookup functions
+  of ON_SerialNumberMap. Elements are stored in an ON_FlatHashTable keyed
+  by serial number and ids are mapped to serial numbers by a second table.
+Remarks:
+  - The restrictions on returned ON_SerialNumberMap::SN_ELEMENT pointers
+    are the same as for ON_SerialNumberMap. A returned pointer may become
+    invalid after any subsequent call to a function in this class.
+  - The elements are not sorted. ON_SerialNumberMap functions that
+    depend on serial number order, like FirstElement() and
+    GetElements(), are not provided.
+*/
+class ON_SerialNumberFlatMap
+{
+public:
+  ON_SerialNumberFlatMap() = default;
+  ~ON_SerialNumberFlatMap() = default;
+
+  /*
+  Parameters:
+    sn_count_estimate - [in]
+      A good estimate of the number of serial numbers that will be in the map.
+  */
+  ON_SerialNumberFlatMap(
+    size_t sn_count_estimate
+    );
+
+  ON__UINT64 ActiveSerialNumberCount() const;
+
+  ON__UINT64 ActiveIdCount() const;
+
+  /*
+  Description:
+    See ON_SerialNumberMap::FindSerialNumber().
+  */
+  struct ON_SerialNumberMap::SN_ELEMENT* FindSerialNumber(
+    ON__UINT64 sn
+    ) const;
+
+  /*
+  Description:
+    See ON_SerialNumberMap::FindId().
+  */
+  struct ON_SerialNumberMap::SN_ELEMENT* FindId(
+    ON_UUID id
+    ) const;
+
+  /*
+  Description:
+    See ON_SerialNumberMap::AddSerialNumber().
+  */
+  struct ON_SerialNumberMap::SN_ELEMENT* AddSerialNumber(
+    ON__UINT64 sn
+    );
+
+  /*
+  Description:
+    See ON_SerialNumberMap::AddSerialNumberAndId().
+  */
+  struct ON_SerialNumberMap::SN_ELEMENT* AddSerialNumberAndId(
+    ON__UINT64 sn,
+    ON_UUID id
+    );
+
+  /*
+  Description:
+    See ON_SerialNumberMap::RemoveSerialNumberAndId().
+  */
+  struct ON_SerialNumberMap::SN_ELEMENT* RemoveSerialNumberAndId(
+    ON__UINT64 sn
+    );
+
+  /*
+  Description:
+    See ON_SerialNumberMap::RemoveId().
+  */
+  struct ON_SerialNumberMap::SN_ELEMENT* RemoveId(
+    ON__UINT64 sn,
+    ON_UUID id
+    );
+
+  /*
+  Description:
+    Remove every element.
+  */
+  void EmptyList();
+
+private:
+  mutable ON_FlatHashTable<ON__UINT64, struct ON_SerialNumberMap::SN_ELEMENT> m_sn;
+  ON_FlatHashTable<ON_UUID, ON__UINT64> m_id;
+
+  // The element returned by RemoveSerialNumberAndId().
+  struct ON_SerialNumberMap::SN_ELEMENT m_removed_element = {};
+
+private:
+  ON_SerialNumberFlatMap(const ON_SerialNumberFlatMap&) = delete;
+  ON_SerialNumberFlatMap& operator=(const ON_SerialNumberFlatMap&) = delete;
+};
+
+#include "opennurbs_flat_hash_adapters_defs.h"
+
+#endif
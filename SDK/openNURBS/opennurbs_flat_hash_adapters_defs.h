@@ -0,0 +1,222 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_FLAT_HASH_ADAPTERS_DEFS_INC_)
+#define OPENNURBS_FLAT_HASH_ADAPTERS_DEFS_INC_
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_SubDComponentPtrPairFlatHashTable
+/////////////////////////////////////////////////////////////////////////////////////
+
+inline ON_SubDComponentPtrPairFlatHashTable::ON_SubDComponentPtrPairFlatHashTable(
+  size_t pair_count_estimate
+  )
+  : m_pairs(pair_count_estimate)
+{}
+
+inline ON_SubDComponentPtrPairFlatHashTable::ON_SubDComponentPtrPairFlatHashTable(
+  const ON_SubD& subd
+  )
+  : m_pairs((size_t)subd.VertexCount() + (size_t)subd.EdgeCount())
+{}
+
+inline bool ON_SubDComponentPtrPairFlatHashTable::AddComponentPair(
+  ON_SubDComponentPtr first_component,
+  ON_SubDComponentPtr second_component
+  )
+{
+  const ON_SubDComponentBase* key = second_component.ComponentBase();
+  if (nullptr == key)
+    return false;
+  return nullptr != m_pairs.Add(key, ON_SubDComponentPtrPair::Create(first_component, second_component));
+}
+
+inline bool ON_SubDComponentPtrPairFlatHashTable::AddVertexPair(
+  const ON_SubDVertex* first_v,
+  const ON_SubDVertex* second_v
+  )
+{
+  return AddComponentPair(ON_SubDComponentPtr::Create(first_v), ON_SubDComponentPtr::Create(second_v));
+}
+
+inline bool ON_SubDComponentPtrPairFlatHashTable::AddEdgePair(
+  const ON_SubDEdge* first_e,
+  const ON_SubDEdge* second_e
+  )
+{
+  return AddComponentPair(ON_SubDComponentPtr::Create(first_e), ON_SubDComponentPtr::Create(second_e));
+}
+
+inline bool ON_SubDComponentPtrPairFlatHashTable::AddEdgePair(
+  const ON_SubDEdge* first_e,
+  const ON_SubDEdgePtr second_eptr
+  )
+{
+  return AddComponentPair(ON_SubDComponentPtr::Create(first_e), ON_SubDComponentPtr::Create(second_eptr));
+}
+
+inline bool ON_SubDComponentPtrPairFlatHashTable::AddFacePair(
+  const ON_SubDFace* first_f,
+  const ON_SubDFace* second_f
+  )
+{
+  return AddComponentPair(ON_SubDComponentPtr::Create(first_f), ON_SubDComponentPtr::Create(second_f));
+}
+
+inline const ON_SubDComponentPtrPair ON_SubDComponentPtrPairFlatHashTable::PairFromSecondComponentPtr(
+  ON_SubDComponentPtr second_component
+  ) const
+{
+  const ON_SubDComponentBase* key = second_component.ComponentBase();
+  const ON_SubDComponentPtrPair* pair = (nullptr != key) ? m_pairs.Find(key) : nullptr;
+  return (nullptr != pair) ? *pair : ON_SubDComponentPtrPair::Null;
+}
+
+inline const ON_SubDComponentPtrPair ON_SubDComponentPtrPairFlatHashTable::PairFromSecondVertex(
+  const ON_SubDVertex* second_v
+  ) const
+{
+  return PairFromSecondComponentPtr(ON_SubDComponentPtr::Create(second_v));
+}
+
+inline const ON_SubDComponentPtrPair ON_SubDComponentPtrPairFlatHashTable::PairFromSecondEdge(
+  const ON_SubDEdge* second_e
+  ) const
+{
+  return PairFromSecondComponentPtr(ON_SubDComponentPtr::Create(second_e));
+}
+
+inline const ON_SubDComponentPtrPair ON_SubDComponentPtrPairFlatHashTable::PairFromSecondFace(
+  const ON_SubDFace* second_f
+  ) const
+{
+  return PairFromSecondComponentPtr(ON_SubDComponentPtr::Create(second_f));
+}
+
+inline unsigned int ON_SubDComponentPtrPairFlatHashTable::PairCount() const
+{
+  return m_pairs.ItemCount();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_SerialNumberFlatMap
+/////////////////////////////////////////////////////////////////////////////////////
+
+inline ON_SerialNumberFlatMap::ON_SerialNumberFlatMap(
+  size_t sn_count_estimate
+  )
+  : m_sn(sn_count_estimate)
+  , m_id(sn_count_estimate)
+{}
+
+inline ON__UINT64 ON_SerialNumberFlatMap::ActiveSerialNumberCount() const
+{
+  return m_sn.ItemCount();
+}
+
+inline ON__UINT64 ON_SerialNumberFlatMap::ActiveIdCount() const
+{
+  return m_id.ItemCount();
+}
+
+inline struct ON_SerialNumberMap::SN_ELEMENT* ON_SerialNumberFlatMap::FindSerialNumber(
+  ON__UINT64 sn
+  ) const
+{
+  return (sn > 0) ? m_sn.Find(sn) : nullptr;
+}
+
+inline struct ON_SerialNumberMap::SN_ELEMENT* ON_SerialNumberFlatMap::FindId(
+  ON_UUID id
+  ) const
+{
+  const ON__UINT64* sn = m_id.Find(id);
+  return (nullptr != sn) ? m_sn.Find(*sn) : nullptr;
+}
+
+inline struct ON_SerialNumberMap::SN_ELEMENT* ON_SerialNumberFlatMap::AddSerialNumber(
+  ON__UINT64 sn
+  )
+{
+  if (0 == sn)
+    return nullptr;
+  bool bAdded = false;
+  struct ON_SerialNumberMap::SN_ELEMENT* e = m_sn.FindOrAdd(sn, &bAdded);
+  if (bAdded)
+  {
+    // FindOrAdd() zeroed every byte of the element.
+    e->m_sn = sn;
+    e->m_sn_active = 1;
+  }
+  return e;
+}
+
+inline struct ON_SerialNumberMap::SN_ELEMENT* ON_SerialNumberFlatMap::AddSerialNumberAndId(
+  ON__UINT64 sn,
+  ON_UUID id
+  )
+{
+  struct ON_SerialNumberMap::SN_ELEMENT* e = AddSerialNumber(sn);
+  if (nullptr == e || 0 != e->m_id_active)
+    return e;
+
+  if (ON_UuidIsNil(id) || nullptr != m_id.Find(id))
+    id = ON_CreateId();
+  if (nullptr == m_id.Add(id, sn))
+    return e;
+  e->m_id = id;
+  e->m_id_active = 1;
+  e->m_id_crc32 = ON_CRC32(0, sizeof(id), &id);
+  return e;
+}
+
+inline struct ON_SerialNumberMap::SN_ELEMENT* ON_SerialNumberFlatMap::RemoveSerialNumberAndId(
+  ON__UINT64 sn
+  )
+{
+  if (0 == sn || false == m_sn.Remove(sn, &m_removed_element))
+    return nullptr;
+  if (0 != m_removed_element.m_id_active)
+    m_id.Remove(m_removed_element.m_id, nullptr);
+  m_removed_element.m_sn_active = 0;
+  m_removed_element.m_id_active = 0;
+  return &m_removed_element;
+}
+
+inline struct ON_SerialNumberMap::SN_ELEMENT* ON_SerialNumberFlatMap::RemoveId(
+  ON__UINT64 sn,
+  ON_UUID id
+  )
+{
+  if (0 == sn)
+  {
+    const ON__UINT64* id_sn = m_id.Find(id);
+    if (nullptr == id_sn)
+      return nullptr;
+    sn = *id_sn;
+  }
+  struct ON_SerialNumberMap::SN_ELEMENT* e = m_sn.Find(sn);
+  if (nullptr == e || 0 == e->m_id_active || false == ON_FlatHashTableKeysAreEqual(e->m_id, id))
+    return nullptr;
+  m_id.Remove(id, nullptr);
+  e->m_id_active = 0;
+  return e;
+}
+
+inline void ON_SerialNumberFlatMap::EmptyList()
+{
+  m_sn.RemoveAllItems();
+  m_id.RemoveAllItems();
+}
+
+#endif
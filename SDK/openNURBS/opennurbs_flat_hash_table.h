@@ -0,0 +1,227 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_FLAT_HASH_TABLE_INC_)
+#define OPENNURBS_FLAT_HASH_TABLE_INC_
+
+/*
+Returns:
+  A 64-bit hash of the key with well mixed bits.
+Remarks:
+  ON_FlatHashTable<K,V> calls ON_FlatHashTableHash(key) and
+  ON_FlatHashTableKeysAreEqual(a,b). Add overloads for other key types.
+*/
+ON__UINT64 ON_FlatHashTableHash(ON__UINT64 key);
+ON__UINT64 ON_FlatHashTableHash(ON__INT64 key);
+ON__UINT64 ON_FlatHashTableHash(ON__UINT32 key);
+ON__UINT64 ON_FlatHashTableHash(ON__INT32 key);
+ON__UINT64 ON_FlatHashTableHash(const ON_UUID& key);
+template <class T> ON__UINT64 ON_FlatHashTableHash(const T* key);
+
+template <class K> bool ON_FlatHashTableKeysAreEqual(const K& a, const K& b);
+bool ON_FlatHashTableKeysAreEqual(const ON_UUID& a, const ON_UUID& b);
+
+/*
+Description:
+  ON_FlatHashTable<K,V> is an open addressing hash table that maps a
+  key to a value. Keys and values are stored in one flat array, so a
+  lookup does not follow linked lists like ON_Hash32Table.
+  - One control byte per slot holds 7 bits of the key hash or marks the
+    slot as empty or deleted.
+  - Lookups compare the control bytes of 16 slots at a time (with SSE2
+    when it is available) and only compare keys whose 7 hash bits match.
+  - The table grows when it is 7/8 full.
+Remarks:
+  - As with ON_SimpleArray, K and V must be types that can be copied
+    with memcpy(). Keys are unique.
+  - Pointers returned by Add(), Find() and FindOrAdd() become invalid
+    when the table grows or is rehashed. Remove() does not move items.
+  - ON_FlatHashTable is not thread safe.
+See Also:
+  ON_SubDComponentPtrPairFlatHashTable
+  ON_SerialNumberFlatMap
+*/
+template <class K, class V>
+class ON_FlatHashTable
+{
+public:
+  // Number of slots whose control bytes are tested together.
+  static const unsigned int GroupSize = 16;
+
+  ON_FlatHashTable() = default;
+
+  /*
+  Parameters:
+    item_count_estimate - [in]
+      The table is created large enough to hold this many items without growing.
+  */
+  ON_FlatHashTable(
+    size_t item_count_estimate
+    );
+
+  ~ON_FlatHashTable();
+
+  /*
+  Description:
+    Add an item to the hash table.
+  Returns:
+    A pointer to the value of the added item or nullptr if the key is
+    already in the table. When the key is in the table, the table is
+    not changed.
+  */
+  V* Add(
+    const K& key,
+    const V& value
+    );
+
+  /*
+  Parameters:
+    key - [in]
+    bAdded - [out]
+      If not nullptr, set to true if the key was added.
+  Returns:
+    A pointer to the value of the item with key. If the key was not in the
+    table, a new item is added and every byte of its value is set to 0.
+  */
+  V* FindOrAdd(
+    const K& key,
+    bool* bAdded
+    );
+
+  /*
+  Returns:
+    A pointer to the value of the item with key or nullptr if the key
+    is not in the table.
+  */
+  V* Find(
+    const K& key
+    );
+
+  const V* Find(
+    const K& key
+    ) const;
+
+  /*
+  Parameters:
+    key - [in]
+    removed_value - [out]
+      If not nullptr and the key was in the table, the value of the
+      removed item is copied here.
+  Returns:
+    True if the item was removed.
+  */
+  bool Remove(
+    const K& key,
+    V* removed_value
+    );
+
+  /*
+  Description:
+    Remove every item. The memory is kept.
+  */
+  void RemoveAllItems();
+
+  /*
+  Description:
+    Remove every item and free the memory.
+  */
+  void Destroy();
+
+  /*
+  Description:
+    Make the table large enough to hold item_count items without growing.
+  */
+  void Reserve(
+    size_t item_count
+    );
+
+  unsigned int ItemCount() const;
+
+  /*
+  Returns:
+    Number of slots in the table.
+  */
+  unsigned int SlotCapacity() const;
+
+  /*
+  Description:
+    Calls f(const K& key, V& value) for every item in the table.
+    f must not add or remove items.
+  */
+  template <class F>
+  void ForEachItem(
+    F f
+    );
+
+private:
+  struct Internal_Slot
+  {
+    K m_key;
+    V m_value;
+  };
+
+  static const ON__UINT8 Internal_Empty = 0x80;
+  static const ON__UINT8 Internal_Deleted = 0xFE;
+
+  // Bit i is set when control byte i of the group equals c.
+  static unsigned int Internal_MatchByte(
+    const ON__UINT8* group,
+    ON__UINT8 c
+    );
+
+  // Bit i is set when slot i of the group is empty or deleted.
+  static unsigned int Internal_MatchAvailable(
+    const ON__UINT8* group
+    );
+
+  // Index of the lowest set bit. mask must not be 0.
+  static unsigned int Internal_LowestBit(
+    unsigned int mask
+    );
+
+  static unsigned int Internal_CapacityForItemCount(
+    size_t item_count
+    );
+
+  // Returns the slot index or ON_UNSET_UINT_INDEX.
+  unsigned int Internal_FindSlot(
+    const K& key,
+    ON__UINT64 hash
+    ) const;
+
+  // The key must not be in the table and the table must have room.
+  unsigned int Internal_AddSlot(
+    const K& key,
+    ON__UINT64 hash
+    );
+
+  void Internal_Rehash(
+    unsigned int capacity
+    );
+
+private:
+  ON__UINT8* m_control = nullptr;
+  Internal_Slot* m_slots = nullptr;
+  // 0 or a power of 2 that is >= GroupSize
+  unsigned int m_capacity = 0;
+  unsigned int m_item_count = 0;
+  unsigned int m_deleted_count = 0;
+
+private:
+  ON_FlatHashTable(const ON_FlatHashTable<K, V>&) = delete;
+  ON_FlatHashTable<K, V>& operator=(const ON_FlatHashTable<K, V>&) = delete;
+};
+
+#include "opennurbs_flat_hash_table_defs.h"
+
+#endif
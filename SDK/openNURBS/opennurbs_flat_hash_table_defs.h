@@ -0,0 +1,421 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_FLAT_HASH_TABLE_DEFS_INC_)
+#define OPENNURBS_FLAT_HASH_TABLE_DEFS_INC_
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ON_FLAT_HASH_TABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(ON_COMPILER_MSC)
+#include <intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////
+//
+// Key hashing
+//
+
+inline ON__UINT64 ON_FlatHashTableHash(ON__UINT64 key)
+{
+  // 64-bit finalizer from MurmurHash3
+  key ^= key >> 33;
+  key *= 0xFF51AFD7ED558CCDULL;
+  key ^= key >> 33;
+  key *= 0xC4CEB9FE1A85EC53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+inline ON__UINT64 ON_FlatHashTableHash(ON__INT64 key)
+{
+  return ON_FlatHashTableHash((ON__UINT64)key);
+}
+
+inline ON__UINT64 ON_FlatHashTableHash(ON__UINT32 key)
+{
+  return ON_FlatHashTableHash((ON__UINT64)key);
+}
+
+inline ON__UINT64 ON_FlatHashTableHash(ON__INT32 key)
+{
+  return ON_FlatHashTableHash((ON__UINT64)(ON__UINT32)key);
+}
+
+inline ON__UINT64 ON_FlatHashTableHash(const ON_UUID& key)
+{
+  ON__UINT64 u[2];
+  memcpy(u, &key, sizeof(u));
+  return ON_FlatHashTableHash(u[0] ^ ON_FlatHashTableHash(u[1]));
+}
+
+template <class T>
+ON__UINT64 ON_FlatHashTableHash(const T* key)
+{
+  return ON_FlatHashTableHash((ON__UINT64)((ON__UINT_PTR)key));
+}
+
+template <class K>
+bool ON_FlatHashTableKeysAreEqual(const K& a, const K& b)
+{
+  return a == b;
+}
+
+inline bool ON_FlatHashTableKeysAreEqual(const ON_UUID& a, const ON_UUID& b)
+{
+  return 0 == memcmp(&a, &b, sizeof(ON_UUID));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_FlatHashTable<>
+/////////////////////////////////////////////////////////////////////////////////////
+
+// The low 7 bits of the hash go in the control byte of a full slot.
+// The remaining bits select the first group to probe. Groups are probed
+// in triangular order, which visits every group when the group count is
+// a power of 2. A search stops at the first group with an empty slot.
+
+template <class K, class V>
+ON_FlatHashTable<K, V>::ON_FlatHashTable(
+  size_t item_count_estimate
+  )
+{
+  Reserve(item_count_estimate);
+}
+
+template <class K, class V>
+ON_FlatHashTable<K, V>::~ON_FlatHashTable()
+{
+  Destroy();
+}
+
+template <class K, class V>
+V* ON_FlatHashTable<K, V>::Add(
+  const K& key,
+  const V& value
+  )
+{
+  const ON__UINT64 hash = ON_FlatHashTableHash(key);
+  if (ON_UNSET_UINT_INDEX != Internal_FindSlot(key, hash))
+    return nullptr;
+  const unsigned int i = Internal_AddSlot(key, hash);
+  if (ON_UNSET_UINT_INDEX == i)
+    return nullptr;
+  m_slots[i].m_value = value;
+  return &m_slots[i].m_value;
+}
+
+template <class K, class V>
+V* ON_FlatHashTable<K, V>::FindOrAdd(
+  const K& key,
+  bool* bAdded
+  )
+{
+  if (nullptr != bAdded)
+    *bAdded = false;
+  const ON__UINT64 hash = ON_FlatHashTableHash(key);
+  unsigned int i = Internal_FindSlot(key, hash);
+  if (ON_UNSET_UINT_INDEX != i)
+    return &m_slots[i].m_value;
+  i = Internal_AddSlot(key, hash);
+  if (ON_UNSET_UINT_INDEX == i)
+    return nullptr;
+  memset((void*)(&m_slots[i].m_value), 0, sizeof(V));
+  if (nullptr != bAdded)
+    *bAdded = true;
+  return &m_slots[i].m_value;
+}
+
+template <class K, class V>
+V* ON_FlatHashTable<K, V>::Find(
+  const K& key
+  )
+{
+  const unsigned int i = Internal_FindSlot(key, ON_FlatHashTableHash(key));
+  return (ON_UNSET_UINT_INDEX != i) ? &m_slots[i].m_value : nullptr;
+}
+
+template <class K, class V>
+const V* ON_FlatHashTable<K, V>::Find(
+  const K& key
+  ) const
+{
+  const unsigned int i = Internal_FindSlot(key, ON_FlatHashTableHash(key));
+  return (ON_UNSET_UINT_INDEX != i) ? &m_slots[i].m_value : nullptr;
+}
+
+template <class K, class V>
+bool ON_FlatHashTable<K, V>::Remove(
+  const K& key,
+  V* removed_value
+  )
+{
+  const unsigned int i = Internal_FindSlot(key, ON_FlatHashTableHash(key));
+  if (ON_UNSET_UINT_INDEX == i)
+    return false;
+  if (nullptr != removed_value)
+    *removed_value = m_slots[i].m_value;
+
+  // A search that reaches a group with an empty slot stops there,
+  // so the slot can be marked empty instead of deleted.
+  const ON__UINT8* group = m_control + (i & ~(GroupSize - 1));
+  if (0 != Internal_MatchByte(group, Internal_Empty))
+    m_control[i] = Internal_Empty;
+  else
+  {
+    m_control[i] = Internal_Deleted;
+    m_deleted_count++;
+  }
+  m_item_count--;
+  return true;
+}
+
+template <class K, class V>
+void ON_FlatHashTable<K, V>::RemoveAllItems()
+{
+  if (nullptr != m_control)
+    memset(m_control, Internal_Empty, m_capacity);
+  m_item_count = 0;
+  m_deleted_count = 0;
+}
+
+template <class K, class V>
+void ON_FlatHashTable<K, V>::Destroy()
+{
+  if (nullptr != m_control)
+    onfree(m_control);
+  if (nullptr != m_slots)
+    onfree(m_slots);
+  m_control = nullptr;
+  m_slots = nullptr;
+  m_capacity = 0;
+  m_item_count = 0;
+  m_deleted_count = 0;
+}
+
+template <class K, class V>
+void ON_FlatHashTable<K, V>::Reserve(
+  size_t item_count
+  )
+{
+  const unsigned int capacity = Internal_CapacityForItemCount(item_count);
+  if (capacity > m_capacity)
+    Internal_Rehash(capacity);
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::ItemCount() const
+{
+  return m_item_count;
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::SlotCapacity() const
+{
+  return m_capacity;
+}
+
+template <class K, class V>
+template <class F>
+void ON_FlatHashTable<K, V>::ForEachItem(
+  F f
+  )
+{
+  for (unsigned int i = 0; i < m_capacity; ++i)
+  {
+    if (0 == (m_control[i] & 0x80))
+      f((const K&)m_slots[i].m_key, m_slots[i].m_value);
+  }
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::Internal_MatchByte(
+  const ON__UINT8* group,
+  ON__UINT8 c
+  )
+{
+#if defined(ON_FLAT_HASH_TABLE_SSE2)
+  const __m128i g = _mm_loadu_si128((const __m128i*)group);
+  return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)c)));
+#else
+  unsigned int mask = 0;
+  for (unsigned int i = 0; i < GroupSize; ++i)
+  {
+    if (c == group[i])
+      mask |= (1U << i);
+  }
+  return mask;
+#endif
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::Internal_MatchAvailable(
+  const ON__UINT8* group
+  )
+{
+#if defined(ON_FLAT_HASH_TABLE_SSE2)
+  // Empty and deleted control bytes have the high bit set.
+  return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+  unsigned int mask = 0;
+  for (unsigned int i = 0; i < GroupSize; ++i)
+  {
+    if (0 != (group[i] & 0x80))
+      mask |= (1U << i);
+  }
+  return mask;
+#endif
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::Internal_LowestBit(
+  unsigned int mask
+  )
+{
+#if defined(ON_COMPILER_MSC)
+  unsigned long i = 0;
+  _BitScanForward(&i, mask);
+  return (unsigned int)i;
+#elif defined(__GNUC__) || defined(__clang__)
+  return (unsigned int)__builtin_ctz(mask);
+#else
+  unsigned int i = 0;
+  while (0 == (mask & (1U << i)))
+    ++i;
+  return i;
+#endif
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::Internal_CapacityForItemCount(
+  size_t item_count
+  )
+{
+  if (0 == item_count)
+    return 0;
+  if (item_count > 0x70000000U)
+    item_count = 0x70000000U;
+  unsigned int capacity = GroupSize;
+  while ((size_t)(capacity - capacity / 8) < item_count)
+    capacity *= 2;
+  return capacity;
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::Internal_FindSlot(
+  const K& key,
+  ON__UINT64 hash
+  ) const
+{
+  if (0 == m_item_count)
+    return ON_UNSET_UINT_INDEX;
+  const ON__UINT8 h7 = (ON__UINT8)(hash & 0x7F);
+  const unsigned int group_mask = m_capacity / GroupSize - 1;
+  unsigned int g = (unsigned int)(hash >> 7) & group_mask;
+  for (unsigned int probe = 1; probe <= group_mask + 1; ++probe)
+  {
+    const unsigned int i0 = g * GroupSize;
+    const ON__UINT8* group = m_control + i0;
+    for (unsigned int mask = Internal_MatchByte(group, h7); 0 != mask; mask &= (mask - 1))
+    {
+      const unsigned int i = i0 + Internal_LowestBit(mask);
+      if (ON_FlatHashTableKeysAreEqual(m_slots[i].m_key, key))
+        return i;
+    }
+    if (0 != Internal_MatchByte(group, Internal_Empty))
+      break;
+    g = (g + probe) & group_mask;
+  }
+  return ON_UNSET_UINT_INDEX;
+}
+
+template <class K, class V>
+unsigned int ON_FlatHashTable<K, V>::Internal_AddSlot(
+  const K& key,
+  ON__UINT64 hash
+  )
+{
+  if ((size_t)m_item_count + m_deleted_count + 1 > (size_t)(m_capacity - m_capacity / 8))
+  {
+    // Grow when more than half of the usable slots hold items.
+    // Otherwise rehash in place to clear the deleted slots.
+    const bool bGrow = ((size_t)m_item_count + 1 > (size_t)(m_capacity - m_capacity / 8) / 2);
+    Internal_Rehash(bGrow ? (0 == m_capacity ? GroupSize : 2 * m_capacity) : m_capacity);
+    if (0 == m_capacity)
+      return ON_UNSET_UINT_INDEX;
+  }
+
+  const unsigned int group_mask = m_capacity / GroupSize - 1;
+  unsigned int g = (unsigned int)(hash >> 7) & group_mask;
+  for (unsigned int probe = 1; probe <= group_mask + 1; ++probe)
+  {
+    const unsigned int i0 = g * GroupSize;
+    const unsigned int mask = Internal_MatchAvailable(m_control + i0);
+    if (0 != mask)
+    {
+      const unsigned int i = i0 + Internal_LowestBit(mask);
+      if (Internal_Deleted == m_control[i])
+        m_deleted_count--;
+      m_control[i] = (ON__UINT8)(hash & 0x7F);
+      m_slots[i].m_key = key;
+      m_item_count++;
+      return i;
+    }
+    g = (g + probe) & group_mask;
+  }
+  return ON_UNSET_UINT_INDEX;
+}
+
+template <class K, class V>
+void ON_FlatHashTable<K, V>::Internal_Rehash(
+  unsigned int capacity
+  )
+{
+  ON__UINT8* control = (ON__UINT8*)onmalloc(capacity);
+  Internal_Slot* slots = (Internal_Slot*)onmalloc(capacity * sizeof(Internal_Slot));
+  if (nullptr == control || nullptr == slots)
+  {
+    if (nullptr != control)
+      onfree(control);
+    if (nullptr != slots)
+      onfree(slots);
+    return;
+  }
+  memset(control, Internal_Empty, capacity);
+
+  ON__UINT8* old_control = m_control;
+  Internal_Slot* old_slots = m_slots;
+  const unsigned int old_capacity = m_capacity;
+  m_control = control;
+  m_slots = slots;
+  m_capacity = capacity;
+  m_item_count = 0;
+  m_deleted_count = 0;
+
+  for (unsigned int i = 0; i < old_capacity; ++i)
+  {
+    if (0 != (old_control[i] & 0x80))
+      continue;
+    const unsigned int j = Internal_AddSlot(old_slots[i].m_key, ON_FlatHashTableHash(old_slots[i].m_key));
+    m_slots[j].m_value = old_slots[i].m_value;
+  }
+
+  if (nullptr != old_control)
+    onfree(old_control);
+  if (nullptr != old_slots)
+    onfree(old_slots);
+}
+
+#endif
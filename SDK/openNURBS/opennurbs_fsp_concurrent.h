@@ -0,0 +1,170 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_FSP_CONCURRENT_INC_)
+#define OPENNURBS_FSP_CONCURRENT_INC_
+
+/*
+Description:
+  ON_ConcurrentFixedSizePool lets many threads allocate and return
+  elements of an ON_FixedSizePool without taking the pool lock for
+  every call.
+  - Each thread has a magazine of free elements. Allocating and
+    returning use the magazine and do not wait on other threads.
+  - When a magazine has 2*MagazineCapacity elements, MagazineCapacity of
+    them are pushed as one batch on a list shared by all threads. Pushing
+    is lock-free. An empty magazine pops one batch from the shared list;
+    pops hold a spin lock for a few instructions.
+  - When the shared list is empty, MagazineCapacity elements are
+    allocated from the pool while holding the pool lock once.
+Remarks:
+  - The elements are allocated by the ON_FixedSizePool, so
+    ON_FixedSizePool::ElementFromId(), ElementIndex(), InPool() and
+    ON_FixedSizePoolIterator work as before. Elements in magazines and
+    in the shared list are active elements of the pool. As with
+    ON_FixedSizePool::ReturnElement(), iterating code must mark returned
+    elements so they can be skipped.
+  - The first 2*sizeof(void*) bytes of a returned element are used for
+    bookkeeping. Ids and marks must be stored after them. When
+    SizeofElement() is smaller than 2*sizeof(void*) or is not a multiple
+    of sizeof(void*), every call uses the ON_FixedSizePool ThreadSafe...()
+    functions.
+  - More than MagazineCount threads share magazines. A thread that finds
+    its magazine in use by another thread uses the ThreadSafe...() functions.
+  - Flush(), the destructor, and ON_FixedSizePool::ReturnAll() and
+    Destroy() must not be called while other threads use the pool.
+    Call Flush() before ON_FixedSizePool::ReturnAll().
+  - The magazines are 64 byte aligned to keep them on separate cache
+    lines. Before C++17, operator new ignores that alignment, so prefer
+    local, static or member instances to ones allocated with new.
+Example:
+
+        ON_FixedSizePool fsp;
+        fsp.Create(sizeof(MyElement), 0, 0);
+        ON_ConcurrentFixedSizePool concurrent_fsp(fsp);
+        ON_Parallel::For(count, 0,
+          [&](size_t i, unsigned int)
+          {
+            MyElement* e = (MyElement*)concurrent_fsp.AllocateElement();
+            ...
+            concurrent_fsp.ReturnElement(e);
+          }
+        );
+
+*/
+class ON_ConcurrentFixedSizePool
+{
+public:
+  static const unsigned int MagazineCount = 64;
+  static const unsigned int MagazineCapacity = 32;
+
+  /*
+  Parameters:
+    fsp - [in]
+      A pool that has been created. It must exist until this
+      ON_ConcurrentFixedSizePool is destroyed.
+  */
+  ON_ConcurrentFixedSizePool(
+    ON_FixedSizePool& fsp
+    );
+
+  /*
+  Description:
+    Calls Flush().
+  */
+  ~ON_ConcurrentFixedSizePool();
+
+  /*
+  Returns:
+    A pointer to SizeofElement() bytes. The memory is zeroed.
+  */
+  void* AllocateElement();
+
+  /*
+  Returns:
+    A pointer to SizeofElement() bytes. The values in the returned block are undefined.
+  */
+  void* AllocateDirtyElement();
+
+  /*
+  Parameters:
+    p - [in]
+      A pointer returned by AllocateElement() or by the pool.
+      It is critical that p be from this pool and that
+      you return a pointer no more than one time.
+  */
+  void ReturnElement(
+    void* p
+    );
+
+  /*
+  Description:
+    Return the elements in the magazines and the shared list to the pool
+    with ON_FixedSizePool::ReturnElement().
+    Must not be called while other threads use this pool.
+  */
+  void Flush();
+
+  /*
+  Returns:
+    Number of free elements in the magazines and the shared list.
+    Must not be called while other threads use this pool.
+  */
+  size_t CachedElementCount() const;
+
+  /*
+  Returns:
+    True if elements are cached. False if every call uses the
+    ON_FixedSizePool ThreadSafe...() functions.
+  */
+  bool IsCaching() const;
+
+  ON_FixedSizePool& FixedSizePool() const;
+
+private:
+  // Each magazine is on its own cache line so threads that use
+  // different magazines do not share lines.
+  class alignas(64) Internal_Magazine
+  {
+  public:
+    std::atomic<bool> m_busy;
+    unsigned int m_count;
+    void* m_first;
+  };
+
+  static unsigned int Internal_ThreadMagazineIndex();
+
+  static void*& Internal_Next(void* p);
+  static void*& Internal_NextBatch(void* p);
+
+  void Internal_Refill(Internal_Magazine& magazine);
+  void Internal_PushBatch(void* batch);
+  void* Internal_PopBatch();
+
+private:
+  ON_FixedSizePool& m_fsp;
+  const bool m_bCaching;
+  std::atomic<void*> m_batches;
+  // Only the thread holding m_batch_pop_lock pops from m_batches.
+  std::atomic<bool> m_batch_pop_lock;
+  Internal_Magazine m_magazine[MagazineCount];
+
+private:
+  ON_ConcurrentFixedSizePool() = delete;
+  ON_ConcurrentFixedSizePool(const ON_ConcurrentFixedSizePool&) = delete;
+  ON_ConcurrentFixedSizePool& operator=(const ON_ConcurrentFixedSizePool&) = delete;
+};
+
+#include "opennurbs_fsp_concurrent_defs.h"
+
+#endif
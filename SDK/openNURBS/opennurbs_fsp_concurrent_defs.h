@@ -0,0 +1,241 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_FSP_CONCURRENT_DEFS_INC_)
+#define OPENNURBS_FSP_CONCURRENT_DEFS_INC_
+
+// Free elements are linked through their first pointer. The first
+// element of a batch on the shared list links to the next batch
+// through its second pointer. Every batch has MagazineCapacity elements.
+// Batches are pushed with compare_exchange by any thread. Batches are
+// popped one at a time by the thread holding m_batch_pop_lock. A batch
+// can only leave the list through that thread, so the head it read
+// cannot be popped and pushed again before its compare_exchange, which
+// is the ABA problem of a lock-free stack with many poppers.
+
+inline ON_ConcurrentFixedSizePool::ON_ConcurrentFixedSizePool(
+  ON_FixedSizePool& fsp
+  )
+  : m_fsp(fsp)
+  , m_bCaching(
+    fsp.SizeofElement() >= 2 * sizeof(void*)
+    && 0 == fsp.SizeofElement() % sizeof(void*)
+    )
+  , m_batches(nullptr)
+  , m_batch_pop_lock(false)
+{
+  for (unsigned int i = 0; i < MagazineCount; ++i)
+  {
+    m_magazine[i].m_busy = false;
+    m_magazine[i].m_count = 0;
+    m_magazine[i].m_first = nullptr;
+  }
+}
+
+inline ON_ConcurrentFixedSizePool::~ON_ConcurrentFixedSizePool()
+{
+  Flush();
+}
+
+inline void* ON_ConcurrentFixedSizePool::AllocateElement()
+{
+  void* p = AllocateDirtyElement();
+  if (nullptr != p)
+    memset(p, 0, m_fsp.SizeofElement());
+  return p;
+}
+
+inline void* ON_ConcurrentFixedSizePool::AllocateDirtyElement()
+{
+  if (false == m_bCaching)
+    return m_fsp.ThreadSafeAllocateDirtyElement();
+
+  Internal_Magazine& magazine = m_magazine[Internal_ThreadMagazineIndex()];
+  if (magazine.m_busy.exchange(true, std::memory_order_acquire))
+    return m_fsp.ThreadSafeAllocateDirtyElement();
+
+  if (nullptr == magazine.m_first)
+    Internal_Refill(magazine);
+  void* p = magazine.m_first;
+  if (nullptr != p)
+  {
+    magazine.m_first = Internal_Next(p);
+    magazine.m_count--;
+  }
+
+  magazine.m_busy.store(false, std::memory_order_release);
+  return (nullptr != p) ? p : m_fsp.ThreadSafeAllocateDirtyElement();
+}
+
+inline void ON_ConcurrentFixedSizePool::ReturnElement(
+  void* p
+  )
+{
+  if (nullptr == p)
+    return;
+  if (false == m_bCaching)
+  {
+    m_fsp.ThreadSafeReturnElement(p);
+    return;
+  }
+
+  Internal_Magazine& magazine = m_magazine[Internal_ThreadMagazineIndex()];
+  if (magazine.m_busy.exchange(true, std::memory_order_acquire))
+  {
+    m_fsp.ThreadSafeReturnElement(p);
+    return;
+  }
+
+  Internal_Next(p) = magazine.m_first;
+  magazine.m_first = p;
+  if (++magazine.m_count >= 2 * MagazineCapacity)
+  {
+    // Keep the most recently returned elements and share the rest.
+    void* last = magazine.m_first;
+    for (unsigned int i = 1; i < MagazineCapacity; ++i)
+      last = Internal_Next(last);
+    void* batch = Internal_Next(last);
+    Internal_Next(last) = nullptr;
+    magazine.m_count = MagazineCapacity;
+    Internal_PushBatch(batch);
+  }
+
+  magazine.m_busy.store(false, std::memory_order_release);
+}
+
+inline void ON_ConcurrentFixedSizePool::Flush()
+{
+  for (unsigned int i = 0; i < MagazineCount; ++i)
+  {
+    Internal_Magazine& magazine = m_magazine[i];
+    while (nullptr != magazine.m_first)
+    {
+      void* p = magazine.m_first;
+      magazine.m_first = Internal_Next(p);
+      m_fsp.ReturnElement(p);
+    }
+    magazine.m_count = 0;
+  }
+
+  void* batch = m_batches.exchange(nullptr, std::memory_order_acquire);
+  while (nullptr != batch)
+  {
+    void* next_batch = Internal_NextBatch(batch);
+    void* p = batch;
+    while (nullptr != p)
+    {
+      void* next = Internal_Next(p);
+      m_fsp.ReturnElement(p);
+      p = next;
+    }
+    batch = next_batch;
+  }
+}
+
+inline size_t ON_ConcurrentFixedSizePool::CachedElementCount() const
+{
+  size_t count = 0;
+  for (unsigned int i = 0; i < MagazineCount; ++i)
+    count += m_magazine[i].m_count;
+  for (void* batch = m_batches.load(std::memory_order_acquire); nullptr != batch; batch = Internal_NextBatch(batch))
+    count += MagazineCapacity;
+  return count;
+}
+
+inline bool ON_ConcurrentFixedSizePool::IsCaching() const
+{
+  return m_bCaching;
+}
+
+inline ON_FixedSizePool& ON_ConcurrentFixedSizePool::FixedSizePool() const
+{
+  return m_fsp;
+}
+
+inline unsigned int ON_ConcurrentFixedSizePool::Internal_ThreadMagazineIndex()
+{
+  static std::atomic<unsigned int> thread_counter(0);
+  static thread_local const unsigned int magazine_index = (thread_counter++) % MagazineCount;
+  return magazine_index;
+}
+
+inline void*& ON_ConcurrentFixedSizePool::Internal_Next(void* p)
+{
+  return ((void**)p)[0];
+}
+
+inline void*& ON_ConcurrentFixedSizePool::Internal_NextBatch(void* p)
+{
+  return ((void**)p)[1];
+}
+
+inline void ON_ConcurrentFixedSizePool::Internal_Refill(
+  Internal_Magazine& magazine
+  )
+{
+  void* batch = Internal_PopBatch();
+  if (nullptr != batch)
+  {
+    magazine.m_first = batch;
+    magazine.m_count = MagazineCapacity;
+    return;
+  }
+
+  // Allocate a magazine full of elements with one lock.
+  ON_SleepLockGuard guard(m_fsp);
+  if (false == guard.IsManagingLock())
+    return;
+  void* last = nullptr;
+  for (unsigned int i = 0; i < MagazineCapacity; ++i)
+  {
+    void* p = m_fsp.AllocateDirtyElement();
+    if (nullptr == p)
+      break;
+    Internal_Next(p) = nullptr;
+    if (nullptr == last)
+      magazine.m_first = p;
+    else
+      Internal_Next(last) = p;
+    last = p;
+    magazine.m_count++;
+  }
+}
+
+inline void ON_ConcurrentFixedSizePool::Internal_PushBatch(
+  void* batch
+  )
+{
+  void* head = m_batches.load(std::memory_order_relaxed);
+  do
+  {
+    Internal_NextBatch(batch) = head;
+  } while (false == m_batches.compare_exchange_weak(head, batch, std::memory_order_release, std::memory_order_relaxed));
+}
+
+inline void* ON_ConcurrentFixedSizePool::Internal_PopBatch()
+{
+  if (nullptr == m_batches.load(std::memory_order_relaxed))
+    return nullptr;
+  while (m_batch_pop_lock.exchange(true, std::memory_order_acquire))
+    std::this_thread::yield();
+  void* batch = m_batches.load(std::memory_order_acquire);
+  while (nullptr != batch
+    && false == m_batches.compare_exchange_weak(batch, Internal_NextBatch(batch), std::memory_order_acquire, std::memory_order_acquire))
+  {
+    // A push changed the head. batch is the new head.
+  }
+  m_batch_pop_lock.store(false, std::memory_order_release);
+  return batch;
+}
+
+#endif
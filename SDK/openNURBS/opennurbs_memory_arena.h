@@ -0,0 +1,311 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MEMORY_ARENA_INC_)
+#define OPENNURBS_MEMORY_ARENA_INC_
+
+/*
+Description:
+  ON_MemoryArena is a size class allocator for code that makes many
+  short lived allocations. Memory is taken from large blocks that are
+  allocated with onmalloc(). Freed allocations are kept on a free list
+  for their size class and all the memory is returned at once by
+  Reset() or ReturnAll().
+  - Requests are rounded up to a power of 2 (16 bytes to 32 KB).
+    Larger requests get their own block.
+  - Allocations are 16 byte aligned.
+  - An ON_MemoryArena is not thread safe. Use one arena per thread.
+See Also:
+  ON_MemoryArenaScope
+  ON_ArenaSimpleArray
+*/
+class ON_MemoryArena
+{
+public:
+  // Default size of the blocks used for small allocations.
+  static const size_t DefaultBlockSize = 256 * 1024;
+
+  // Requests larger than 16 << (SizeClassCount-1) bytes get their own block.
+  static const unsigned int SizeClassCount = 12;
+
+  ON_MemoryArena() = default;
+
+  /*
+  Parameters:
+    block_size - [in]
+      Size of the blocks used for small allocations.
+      0 = DefaultBlockSize. Values below 64 KB are increased to 64 KB.
+  */
+  ON_MemoryArena(
+    size_t block_size
+    );
+
+  ~ON_MemoryArena();
+
+  /*
+  Returns:
+    A 16 byte aligned buffer with at least sizeof_buffer bytes or
+    nullptr if sizeof_buffer is 0 or onmalloc() fails.
+  */
+  void* Allocate(
+    size_t sizeof_buffer
+    );
+
+  /*
+  Description:
+    Same as onrealloc() for buffers allocated by this arena.
+  */
+  void* Reallocate(
+    void* buffer,
+    size_t sizeof_buffer
+    );
+
+  /*
+  Description:
+    Put a buffer allocated by this arena on its free list.
+  */
+  void Free(
+    void* buffer
+    );
+
+  /*
+  Description:
+    Free every allocation. The blocks for small allocations are kept
+    and reused.
+  */
+  void Reset();
+
+  /*
+  Description:
+    Free every allocation and return all blocks to the heap.
+  */
+  void ReturnAll();
+
+  /*
+  Returns:
+    Number of calls to Allocate() and of Reallocate() calls that
+    moved a buffer since the arena was created.
+  */
+  ON__UINT64 AllocationCount() const;
+
+  /*
+  Returns:
+    Number of bytes currently allocated with onmalloc().
+  */
+  size_t SizeOfBlocks() const;
+
+  /*
+  Returns:
+    Largest value of SizeOfBlocks() since the arena was created.
+  */
+  size_t PeakSizeOfBlocks() const;
+
+private:
+  class Internal_Block
+  {
+  public:
+    Internal_Block* m_prev;
+    Internal_Block* m_next;
+    // number of bytes after the block header
+    size_t m_sizeof_data;
+    size_t m_used;
+  };
+
+  // The block header and the allocation header keep allocations 16 byte aligned.
+  static const size_t Internal_BlockHeaderSize = 32;
+  static const size_t Internal_AllocationHeaderSize = 16;
+
+  Internal_Block* Internal_NewBlock(
+    size_t sizeof_data
+    );
+
+  void Internal_DeleteBlock(
+    Internal_Block* block
+    );
+
+private:
+  size_t m_block_size = DefaultBlockSize;
+
+  // Blocks for small allocations. m_current is the block in use.
+  Internal_Block* m_first = nullptr;
+  Internal_Block* m_last = nullptr;
+  Internal_Block* m_current = nullptr;
+
+  // Blocks for large allocations.
+  Internal_Block* m_large = nullptr;
+
+  void* m_free[SizeClassCount] = {};
+
+  ON__UINT64 m_allocation_count = 0;
+  size_t m_sizeof_blocks = 0;
+  size_t m_peak_sizeof_blocks = 0;
+
+private:
+  ON_MemoryArena(const ON_MemoryArena&) = delete;
+  ON_MemoryArena& operator=(const ON_MemoryArena&) = delete;
+};
+
+/*
+Description:
+  ON_MemoryArenaScope makes an ON_MemoryArena the current arena of the
+  calling thread. ON_ArenaSimpleArray and other code that calls
+  ON_MemoryArenaScope::CurrentArena() allocate from it while the scope
+  exists. When the scope ends, the previous current arena is restored
+  and the memory allocated in the scope is freed in bulk.
+Remarks:
+  - onmalloc(), onrealloc() and onfree() are part of the opennurbs
+    library and always use the heap. Only code that asks for the
+    current arena uses it.
+  - Memory allocated from the arena must not be used after the scope
+    ends. In particular, ON_ArenaSimpleArray instances must be
+    destroyed before the scope.
+  - Scopes nest. Other threads, including ON_Parallel worker threads,
+    do not see the scope.
+Example:
+
+        {
+          ON_MemoryArenaScope arena_scope;
+          for (...)
+          {
+            ON_ArenaSimpleArray<ON_3dPoint> points;
+            ...
+          }
+        } // all arena memory is freed here
+
+*/
+class ON_MemoryArenaScope
+{
+public:
+  /*
+  Description:
+    Use an arena owned by the scope. The arena returns its memory
+    to the heap when the scope ends.
+  Parameters:
+    block_size - [in]
+      See ON_MemoryArena(size_t).
+    bEnableAllocationTracking - [in]
+      Passed to an ON_MemoryAllocationTracking that exists while the
+      scope exists. Windows debug builds run much faster while
+      allocation tracking is disabled.
+  */
+  ON_MemoryArenaScope(
+    size_t block_size = 0,
+    bool bEnableAllocationTracking = true
+    );
+
+  /*
+  Description:
+    Use arena. When the scope ends, arena.Reset() is called so its blocks
+    can be used by the next scope without going to the heap.
+  */
+  ON_MemoryArenaScope(
+    ON_MemoryArena& arena,
+    bool bEnableAllocationTracking = true
+    );
+
+  ~ON_MemoryArenaScope();
+
+  /*
+  Returns:
+    The arena of the innermost ON_MemoryArenaScope on the calling
+    thread or nullptr if there is none.
+  */
+  static ON_MemoryArena* CurrentArena();
+
+  ON_MemoryArena& Arena();
+
+private:
+  static ON_MemoryArena*& Internal_CurrentArena();
+
+private:
+  ON_MemoryAllocationTracking m_allocation_tracking;
+  ON_MemoryArena m_scope_arena;
+  ON_MemoryArena* m_arena;
+  ON_MemoryArena* m_previous_arena;
+
+private:
+  ON_MemoryArenaScope(const ON_MemoryArenaScope&) = delete;
+  ON_MemoryArenaScope& operator=(const ON_MemoryArenaScope&) = delete;
+};
+
+/*
+Description:
+  An ON_SimpleArray that gets its memory from ON_MemoryArenaScope::CurrentArena()
+  when its memory is first allocated. If no arena scope is active, it
+  uses onrealloc() like ON_SimpleArray.
+Remarks:
+  - WARNING: ON_SimpleArray<T>::SetArray() and KeepArray() are not virtual.
+    Called through an ON_SimpleArray pointer or reference, SetArray() frees
+    arena memory with onfree() and KeepArray() returns arena memory that the
+    caller would free with onfree(). Both crash or corrupt the heap. Call
+    them on the ON_ArenaSimpleArray, where they are replaced by versions
+    that handle arena memory.
+  - Do not move an ON_ArenaSimpleArray into an ON_SimpleArray or call
+    HarvestArray(). The ON_SimpleArray would free arena memory with onfree().
+  - Delete ON_ArenaSimpleArray instances as ON_ArenaSimpleArray.
+*/
+template <class T>
+class ON_ArenaSimpleArray : public ON_SimpleArray<T>
+{
+public:
+  ON_ArenaSimpleArray() ON_NOEXCEPT;
+
+  // initial capacity
+  ON_ArenaSimpleArray(
+    size_t capacity
+    );
+
+  ~ON_ArenaSimpleArray();
+
+  ON_ArenaSimpleArray(const ON_ArenaSimpleArray<T>& src);
+  ON_ArenaSimpleArray<T>& operator=(const ON_ArenaSimpleArray<T>& src);
+
+  ON_ArenaSimpleArray(const ON_SimpleArray<T>& src);
+  ON_ArenaSimpleArray<T>& operator=(const ON_SimpleArray<T>& src);
+
+  /*
+  Returns:
+    The arena that holds the array memory or nullptr if the
+    memory is from onrealloc().
+  */
+  ON_MemoryArena* Arena() const;
+
+  T* Realloc(T* ptr, int capacity) override;
+
+  /*
+  Description:
+    Same as ON_SimpleArray<T>::SetArray(). Arena memory that the array
+    was using is returned to the arena instead of being passed to onfree().
+    The pointer must be from onmalloc(), so the array stops using the arena.
+  */
+  void SetArray(T* p);
+  void SetArray(T* p, int count, int capacity);
+
+  /*
+  Description:
+    Same as ON_SimpleArray<T>::KeepArray(). When the array memory is
+    from an arena, it is copied to memory from onmalloc() first, so the
+    returned pointer can always be freed with onfree().
+  */
+  T* KeepArray();
+
+private:
+  // Returns arena memory to the arena when p is not the array memory.
+  void Internal_ReleaseArenaArray(const T* p);
+
+  ON_MemoryArena* m_arena = nullptr;
+};
+
+#include "opennurbs_memory_arena_defs.h"
+
+#endif
@@ -0,0 +1,395 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MEMORY_ARENA_DEFS_INC_)
+#define OPENNURBS_MEMORY_ARENA_DEFS_INC_
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_MemoryArena
+/////////////////////////////////////////////////////////////////////////////////////
+
+// Each allocation is preceded by a 16 byte header:
+//   size_t [0] = size class or SizeClassCount for a large allocation
+//   size_t [1] = capacity in bytes
+
+inline ON_MemoryArena::ON_MemoryArena(
+  size_t block_size
+  )
+  : m_block_size(0 == block_size ? DefaultBlockSize : (block_size < 64 * 1024 ? 64 * 1024 : block_size))
+{}
+
+inline ON_MemoryArena::~ON_MemoryArena()
+{
+  ReturnAll();
+}
+
+inline void* ON_MemoryArena::Allocate(
+  size_t sizeof_buffer
+  )
+{
+  if (0 == sizeof_buffer)
+    return nullptr;
+
+  unsigned int size_class = 0;
+  size_t capacity = 16;
+  while (capacity < sizeof_buffer && size_class < SizeClassCount)
+  {
+    capacity <<= 1;
+    ++size_class;
+  }
+
+  size_t* header = nullptr;
+  if (size_class < SizeClassCount)
+  {
+    void* buffer = m_free[size_class];
+    if (nullptr != buffer)
+    {
+      m_free[size_class] = *((void**)buffer);
+      ++m_allocation_count;
+      return buffer;
+    }
+
+    const size_t sizeof_allocation = Internal_AllocationHeaderSize + capacity;
+    if (nullptr == m_current || m_current->m_used + sizeof_allocation > m_current->m_sizeof_data)
+    {
+      // Blocks after m_current are empty after Reset().
+      Internal_Block* block = (nullptr == m_current) ? m_first : m_current->m_next;
+      if (nullptr == block)
+      {
+        block = Internal_NewBlock(m_block_size);
+        if (nullptr == block)
+          return nullptr;
+        block->m_prev = m_last;
+        if (nullptr == m_last)
+          m_first = block;
+        else
+          m_last->m_next = block;
+        m_last = block;
+      }
+      m_current = block;
+    }
+    header = (size_t*)(((char*)m_current) + Internal_BlockHeaderSize + m_current->m_used);
+    m_current->m_used += sizeof_allocation;
+  }
+  else
+  {
+    capacity = (sizeof_buffer + 15) & ~((size_t)15);
+    Internal_Block* block = Internal_NewBlock(Internal_AllocationHeaderSize + capacity);
+    if (nullptr == block)
+      return nullptr;
+    block->m_next = m_large;
+    if (nullptr != m_large)
+      m_large->m_prev = block;
+    m_large = block;
+    header = (size_t*)(((char*)block) + Internal_BlockHeaderSize);
+  }
+
+  header[0] = size_class;
+  header[1] = capacity;
+  ++m_allocation_count;
+  return ((char*)header) + Internal_AllocationHeaderSize;
+}
+
+inline void* ON_MemoryArena::Reallocate(
+  void* buffer,
+  size_t sizeof_buffer
+  )
+{
+  if (nullptr == buffer)
+    return Allocate(sizeof_buffer);
+  if (0 == sizeof_buffer)
+  {
+    Free(buffer);
+    return nullptr;
+  }
+  const size_t capacity = ((const size_t*)(((const char*)buffer) - Internal_AllocationHeaderSize))[1];
+  if (sizeof_buffer <= capacity)
+    return buffer;
+  void* new_buffer = Allocate(sizeof_buffer);
+  if (nullptr != new_buffer)
+  {
+    memcpy(new_buffer, buffer, capacity);
+    Free(buffer);
+  }
+  return new_buffer;
+}
+
+inline void ON_MemoryArena::Free(
+  void* buffer
+  )
+{
+  if (nullptr == buffer)
+    return;
+  const size_t* header = (const size_t*)(((const char*)buffer) - Internal_AllocationHeaderSize);
+  const size_t size_class = header[0];
+  if (size_class < SizeClassCount)
+  {
+    *((void**)buffer) = m_free[size_class];
+    m_free[size_class] = buffer;
+    return;
+  }
+
+  Internal_Block* block = (Internal_Block*)(((char*)header) - Internal_BlockHeaderSize);
+  if (nullptr != block->m_prev)
+    block->m_prev->m_next = block->m_next;
+  else
+    m_large = block->m_next;
+  if (nullptr != block->m_next)
+    block->m_next->m_prev = block->m_prev;
+  Internal_DeleteBlock(block);
+}
+
+inline void ON_MemoryArena::Reset()
+{
+  while (nullptr != m_large)
+  {
+    Internal_Block* block = m_large;
+    m_large = block->m_next;
+    Internal_DeleteBlock(block);
+  }
+  for (Internal_Block* block = m_first; nullptr != block; block = block->m_next)
+    block->m_used = 0;
+  m_current = m_first;
+  for (unsigned int i = 0; i < SizeClassCount; ++i)
+    m_free[i] = nullptr;
+}
+
+inline void ON_MemoryArena::ReturnAll()
+{
+  Reset();
+  while (nullptr != m_first)
+  {
+    Internal_Block* block = m_first;
+    m_first = block->m_next;
+    Internal_DeleteBlock(block);
+  }
+  m_last = nullptr;
+  m_current = nullptr;
+}
+
+inline ON__UINT64 ON_MemoryArena::AllocationCount() const
+{
+  return m_allocation_count;
+}
+
+inline size_t ON_MemoryArena::SizeOfBlocks() const
+{
+  return m_sizeof_blocks;
+}
+
+inline size_t ON_MemoryArena::PeakSizeOfBlocks() const
+{
+  return m_peak_sizeof_blocks;
+}
+
+inline ON_MemoryArena::Internal_Block* ON_MemoryArena::Internal_NewBlock(
+  size_t sizeof_data
+  )
+{
+  static_assert(sizeof(Internal_Block) <= Internal_BlockHeaderSize, "Internal_BlockHeaderSize is too small.");
+  Internal_Block* block = (Internal_Block*)onmalloc(Internal_BlockHeaderSize + sizeof_data);
+  if (nullptr == block)
+    return nullptr;
+  block->m_prev = nullptr;
+  block->m_next = nullptr;
+  block->m_sizeof_data = sizeof_data;
+  block->m_used = 0;
+  m_sizeof_blocks += Internal_BlockHeaderSize + sizeof_data;
+  if (m_peak_sizeof_blocks < m_sizeof_blocks)
+    m_peak_sizeof_blocks = m_sizeof_blocks;
+  return block;
+}
+
+inline void ON_MemoryArena::Internal_DeleteBlock(
+  Internal_Block* block
+  )
+{
+  m_sizeof_blocks -= Internal_BlockHeaderSize + block->m_sizeof_data;
+  onfree(block);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_MemoryArenaScope
+/////////////////////////////////////////////////////////////////////////////////////
+
+inline ON_MemoryArenaScope::ON_MemoryArenaScope(
+  size_t block_size,
+  bool bEnableAllocationTracking
+  )
+  : m_allocation_tracking(bEnableAllocationTracking)
+  , m_scope_arena(block_size)
+  , m_arena(&m_scope_arena)
+  , m_previous_arena(Internal_CurrentArena())
+{
+  Internal_CurrentArena() = m_arena;
+}
+
+inline ON_MemoryArenaScope::ON_MemoryArenaScope(
+  ON_MemoryArena& arena,
+  bool bEnableAllocationTracking
+  )
+  : m_allocation_tracking(bEnableAllocationTracking)
+  , m_arena(&arena)
+  , m_previous_arena(Internal_CurrentArena())
+{
+  Internal_CurrentArena() = m_arena;
+}
+
+inline ON_MemoryArenaScope::~ON_MemoryArenaScope()
+{
+  Internal_CurrentArena() = m_previous_arena;
+  if (m_arena != &m_scope_arena)
+    m_arena->Reset();
+  // m_scope_arena returns its memory when it is destroyed.
+}
+
+inline ON_MemoryArena* ON_MemoryArenaScope::CurrentArena()
+{
+  return Internal_CurrentArena();
+}
+
+inline ON_MemoryArena& ON_MemoryArenaScope::Arena()
+{
+  return *m_arena;
+}
+
+inline ON_MemoryArena*& ON_MemoryArenaScope::Internal_CurrentArena()
+{
+  static thread_local ON_MemoryArena* current_arena = nullptr;
+  return current_arena;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_ArenaSimpleArray<>
+/////////////////////////////////////////////////////////////////////////////////////
+
+// The ON_SimpleArray constructors and destructor call the ON_SimpleArray
+// version of Realloc(), so the memory is allocated and freed in the
+// ON_ArenaSimpleArray constructor and destructor bodies.
+
+template <class T>
+ON_ArenaSimpleArray<T>::ON_ArenaSimpleArray() ON_NOEXCEPT
+  : ON_SimpleArray<T>()
+{}
+
+template <class T>
+ON_ArenaSimpleArray<T>::ON_ArenaSimpleArray(
+  size_t capacity
+  )
+  : ON_SimpleArray<T>()
+{
+  if (capacity > 0)
+    this->SetCapacity(capacity);
+}
+
+template <class T>
+ON_ArenaSimpleArray<T>::~ON_ArenaSimpleArray()
+{
+  this->SetCapacity(0);
+}
+
+template <class T>
+ON_ArenaSimpleArray<T>::ON_ArenaSimpleArray(const ON_ArenaSimpleArray<T>& src)
+  : ON_SimpleArray<T>()
+{
+  ON_SimpleArray<T>::operator=(src);
+}
+
+template <class T>
+ON_ArenaSimpleArray<T>& ON_ArenaSimpleArray<T>::operator=(const ON_ArenaSimpleArray<T>& src)
+{
+  ON_SimpleArray<T>::operator=(src);
+  return *this;
+}
+
+template <class T>
+ON_ArenaSimpleArray<T>::ON_ArenaSimpleArray(const ON_SimpleArray<T>& src)
+  : ON_SimpleArray<T>()
+{
+  ON_SimpleArray<T>::operator=(src);
+}
+
+template <class T>
+ON_ArenaSimpleArray<T>& ON_ArenaSimpleArray<T>::operator=(const ON_SimpleArray<T>& src)
+{
+  ON_SimpleArray<T>::operator=(src);
+  return *this;
+}
+
+template <class T>
+ON_MemoryArena* ON_ArenaSimpleArray<T>::Arena() const
+{
+  return m_arena;
+}
+
+template <class T>
+T* ON_ArenaSimpleArray<T>::Realloc(T* ptr, int capacity)
+{
+  if (nullptr == ptr)
+  {
+    if (capacity <= 0)
+      return nullptr;
+    m_arena = ON_MemoryArenaScope::CurrentArena();
+  }
+  if (nullptr == m_arena)
+    return ON_SimpleArray<T>::Realloc(ptr, capacity);
+  return (T*)m_arena->Reallocate(ptr, (capacity > 0) ? capacity * sizeof(T) : 0);
+}
+
+template <class T>
+void ON_ArenaSimpleArray<T>::Internal_ReleaseArenaArray(const T* p)
+{
+  if (this->m_a == p)
+    return;
+  if (nullptr != m_arena && nullptr != this->m_a)
+  {
+    m_arena->Reallocate(this->m_a, 0);
+    this->m_a = nullptr;
+  }
+  m_arena = nullptr;
+}
+
+template <class T>
+void ON_ArenaSimpleArray<T>::SetArray(T* p)
+{
+  Internal_ReleaseArenaArray(p);
+  ON_SimpleArray<T>::SetArray(p);
+}
+
+template <class T>
+void ON_ArenaSimpleArray<T>::SetArray(T* p, int count, int capacity)
+{
+  Internal_ReleaseArenaArray(p);
+  ON_SimpleArray<T>::SetArray(p, count, capacity);
+}
+
+template <class T>
+T* ON_ArenaSimpleArray<T>::KeepArray()
+{
+  if (nullptr != m_arena && nullptr != this->m_a)
+  {
+    const size_t sizeof_array = (size_t)this->m_capacity * sizeof(T);
+    T* p = (T*)onmalloc(sizeof_array);
+    if (nullptr == p)
+      return nullptr;
+    memcpy((void*)p, (const void*)this->m_a, sizeof_array);
+    Internal_ReleaseArenaArray(nullptr);
+    this->m_count = 0;
+    this->m_capacity = 0;
+    return p;
+  }
+  m_arena = nullptr;
+  return ON_SimpleArray<T>::KeepArray();
+}
+
+#endif
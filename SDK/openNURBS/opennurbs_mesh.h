@@ -9987,4 +9987,95 @@ private:
 
 #endif
 
+inline bool ON_RTree::BulkLoadMeshFaceTree(
+  const ON_Mesh* mesh,
+  bool bMultithreaded
+  )
+{
+  RemoveAll();
+  if (nullptr == mesh)
+    return false;
+
+  const unsigned int vertex_count = mesh->VertexUnsignedCount();
+  const unsigned int face_count = mesh->FaceUnsignedCount();
+  if (0 == face_count)
+    return true;
+
+  const ON_3dPoint* dV = mesh->HasDoublePrecisionVertices() ? mesh->m_dV.Array() : nullptr;
+  const ON_3fPoint* fV = (nullptr == dV) ? mesh->m_V.Array() : nullptr;
+  const ON_MeshFace* F = mesh->m_F.Array();
+
+  ON_SimpleArray<ON_RTreeBBox> rect(face_count);
+  ON_SimpleArray<ON__INT_PTR> face_index(face_count);
+  for (unsigned int fi = 0; fi < face_count; ++fi)
+  {
+    const int* fvi = F[fi].vi;
+    if ((unsigned int)fvi[0] >= vertex_count || (unsigned int)fvi[1] >= vertex_count
+      || (unsigned int)fvi[2] >= vertex_count || (unsigned int)fvi[3] >= vertex_count)
+      continue;
+    ON_RTreeBBox& r = rect.AppendNew();
+    for (int k = 0; k < 4; ++k)
+    {
+      const double P[3]
+        = { (nullptr != dV) ? dV[fvi[k]].x : (double)fV[fvi[k]].x,
+            (nullptr != dV) ? dV[fvi[k]].y : (double)fV[fvi[k]].y,
+            (nullptr != dV) ? dV[fvi[k]].z : (double)fV[fvi[k]].z };
+      for (int j = 0; j < 3; ++j)
+      {
+        if (0 == k || P[j] < r.m_min[j])
+          r.m_min[j] = P[j];
+        if (0 == k || P[j] > r.m_max[j])
+          r.m_max[j] = P[j];
+      }
+    }
+    face_index.Append((ON__INT_PTR)fi);
+  }
+
+  return BulkLoad(rect.Array(), face_index.Array(), rect.UnsignedCount(), bMultithreaded);
+}
+
+inline ON_SHA1_Hash ON_RTree::MeshFaceTreeGeometryHash(
+  const ON_Mesh* mesh
+  )
+{
+  if (nullptr == mesh)
+    return ON_SHA1_Hash::ZeroDigest;
+
+  // Hash the same vertex locations BulkLoadMeshFaceTree() uses.
+  ON_SHA1 sha1;
+  const unsigned int vertex_count = mesh->VertexUnsignedCount();
+  const unsigned int face_count = mesh->FaceUnsignedCount();
+  sha1.AccumulateUnsigned32(vertex_count);
+  sha1.AccumulateUnsigned32(face_count);
+  if (vertex_count > 0 && mesh->HasDoublePrecisionVertices())
+    sha1.AccumulateDoubleArray(3 * (size_t)vertex_count, &mesh->m_dV.Array()[0].x);
+  else if (vertex_count > 0)
+    sha1.AccumulateFloatArray(3 * (size_t)vertex_count, &mesh->m_V.Array()[0].x);
+  if (face_count > 0)
+    sha1.AccumulateInteger32Array(4 * (size_t)face_count, mesh->m_F.Array()[0].vi);
+  return sha1.Hash();
+}
+
+inline bool ON_RTree::WriteMeshFaceTree(
+  ON_BinaryArchive& archive,
+  const ON_Mesh* mesh
+  ) const
+{
+  return Write(archive, ON_RTree::MeshFaceTreeGeometryHash(mesh));
+}
+
+inline bool ON_RTree::ReadMeshFaceTree(
+  ON_BinaryArchive& archive,
+  const ON_Mesh* mesh,
+  bool bMultithreaded
+  )
+{
+  if (nullptr == mesh)
+    return false;
+  if (Read(archive, ON_RTree::MeshFaceTreeGeometryHash(mesh)))
+    return true;
+  // The saved tree is stale or damaged.
+  return BulkLoadMeshFaceTree(mesh, bMultithreaded);
+}
+
 #endif
@@ -0,0 +1,221 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_MESHLET_INC_)
+#define OPENNURBS_MESH_MESHLET_INC_
+
+/*
+Description:
+  An ON_Meshlet is a small spatially coherent cluster of mesh triangles.
+  Meshlets are created by ON_MeshletPartition::Create().
+Remarks:
+  The vertices used by the meshlet are
+
+    partition.m_vertex_index[m_vertex_offset] ... partition.m_vertex_index[m_vertex_offset + m_vertex_count - 1]
+
+  and triangle t, 0 <= t < m_triangle_count, uses the meshlet vertices
+
+    partition.m_triangle[3*(m_triangle_offset+t) + 0,1,2].
+*/
+struct ON_Meshlet
+{
+  unsigned int m_vertex_offset;
+  unsigned int m_triangle_offset;
+  unsigned int m_vertex_count;
+  unsigned int m_triangle_count;
+
+  // Bounding sphere
+  float m_center[3];
+  float m_radius;
+
+  // Bounding box
+  float m_bbox_min[3];
+  float m_bbox_max[3];
+
+  // Normal cone. m_cone_axis is a unit vector and every unit triangle
+  // normal N satisfies N o m_cone_axis >= sqrt(1 - m_cone_cutoff^2).
+  // The triangle normals are unitized when the cone is calculated.
+  // When the triangle normals are too spread out to make a useful cone,
+  // m_cone_axis is zero and m_cone_cutoff is 1 so backface tests never cull.
+  float m_cone_apex[3];
+  float m_cone_axis[3];
+  float m_cone_cutoff;
+};
+
+/*
+Description:
+  ON_MeshletPartition divides a mesh into meshlets. Unlike ON_MeshPartition,
+  whose parts are ranges of vertices and faces, meshlets are grown from
+  adjacent triangles, so each meshlet is spatially tight and has a useful
+  bounding sphere and normal cone. Meshlets can be used to cull triangles
+  on the CPU before they are drawn and to order ray queries.
+Remarks:
+  Quads are split into two triangles along the 0-2 diagonal.
+  Invalid faces and triangles with repeated vertex indices are ignored.
+Example:
+
+        ON_MeshletPartition meshlets;
+        meshlets.Create(mesh);
+        for (unsigned int i = 0; i < meshlets.m_meshlet.UnsignedCount(); i++)
+        {
+          const ON_Meshlet& m = meshlets.m_meshlet[i];
+          if (ON_MeshletPartition::IsOutside(m, frustum_planes, 6))
+            continue;
+          if (ON_MeshletPartition::IsBackfacing(m, camera_location))
+            continue;
+          ... draw meshlet ...
+        }
+
+*/
+class ON_MeshletPartition
+{
+public:
+  ON_MeshletPartition() = default;
+  ~ON_MeshletPartition() = default;
+  ON_MeshletPartition(const ON_MeshletPartition&) = default;
+  ON_MeshletPartition& operator=(const ON_MeshletPartition&) = default;
+
+  /*
+  Description:
+    Partition a mesh into meshlets.
+  Parameters:
+    mesh - [in]
+      When the mesh has double precision vertices, m_dV[] is used.
+    max_vertex_count - [in]
+      Maximum number of vertices in a meshlet. 3 <= max_vertex_count <= 256.
+    max_triangle_count - [in]
+      Maximum number of triangles in a meshlet. 1 <= max_triangle_count <= 512.
+    bMultithreaded - [in]
+      If true and the mesh is large, sorting and the meshlet bounds are
+      calculated on multiple threads. The meshlets do not depend on the
+      number of threads.
+  Returns:
+    True if successful.
+  Remarks:
+    The defaults, 64 vertices and 124 triangles, fit the limits most
+    GPU mesh shader pipelines recommend.
+  */
+  bool Create(
+    const class ON_Mesh& mesh,
+    unsigned int max_vertex_count = 64,
+    unsigned int max_triangle_count = 124,
+    bool bMultithreaded = true
+    );
+
+  void Destroy();
+
+  unsigned int MeshletCount() const;
+
+  /*
+  Returns:
+    Pointer to the mesh vertex indices used by the meshlet.
+  */
+  const unsigned int* VertexIndices(
+    const ON_Meshlet& meshlet
+    ) const;
+
+  /*
+  Returns:
+    Pointer to the 3*meshlet.m_triangle_count meshlet vertex indices
+    of the meshlet triangles.
+  */
+  const ON__UINT8* Triangles(
+    const ON_Meshlet& meshlet
+    ) const;
+
+  /*
+  Description:
+    Create a frozen R-tree of the meshlet bounding boxes.
+    The element id is the meshlet index.
+  Parameters:
+    rtree - [out]
+    bMultithreaded - [in]
+  Returns:
+    True if successful.
+  */
+  bool CreateRTree(
+    class ON_FrozenRTree& rtree,
+    bool bMultithreaded = true
+    ) const;
+
+  /*
+  Description:
+    Test a meshlet's bounding sphere against a set of planes.
+  Parameters:
+    meshlet - [in]
+    planes - [in]
+      Plane equations with normals pointing into the visible region,
+      for example the 6 planes of a view frustum. The plane normals
+      do not have to be unit vectors.
+    plane_count - [in]
+  Returns:
+    True if the bounding sphere is completely on the negative side
+    of one of the planes.
+  */
+  static bool IsOutside(
+    const ON_Meshlet& meshlet,
+    const ON_PlaneEquation* planes,
+    unsigned int plane_count
+    );
+
+  /*
+  Description:
+    Test a meshlet's normal cone against a perspective camera.
+  Parameters:
+    meshlet - [in]
+    camera_location - [in]
+  Returns:
+    True if every triangle in the meshlet faces away from camera_location.
+  */
+  static bool IsBackfacing(
+    const ON_Meshlet& meshlet,
+    const ON_3dPoint& camera_location
+    );
+
+  /*
+  Description:
+    Test a meshlet's normal cone against a parallel projection.
+  Parameters:
+    meshlet - [in]
+    camera_direction - [in]
+      Vector pointing from the camera into the scene. It does not have
+      to be a unit vector.
+  Returns:
+    True if every triangle in the meshlet faces away from the camera.
+  */
+  static bool IsBackfacingParallel(
+    const ON_Meshlet& meshlet,
+    const ON_3dVector& camera_direction
+    );
+
+  // Maximum number of vertices and triangles in a meshlet.
+  unsigned int m_max_vertex_count = 0;
+  unsigned int m_max_triangle_count = 0;
+
+  ON_SimpleArray<ON_Meshlet> m_meshlet;
+
+  // Mesh vertex indices used by the meshlets.
+  ON_SimpleArray<unsigned int> m_vertex_index;
+
+  // 3 meshlet vertex indices per triangle.
+  ON_SimpleArray<ON__UINT8> m_triangle;
+
+  // m_triangle_face[t] = 2*fi + h where fi is the index of the mesh face
+  // the triangle came from. h = 0 for face corners (0,1,2) and h = 1 for
+  // the second triangle, corners (0,2,3), of a quad.
+  ON_SimpleArray<unsigned int> m_triangle_face;
+};
+
+#include "opennurbs_mesh_meshlet_defs.h"
+
+#endif
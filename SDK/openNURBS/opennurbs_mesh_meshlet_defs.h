@@ -0,0 +1,620 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_MESHLET_DEFS_INC_)
+#define OPENNURBS_MESH_MESHLET_DEFS_INC_
+
+// Minimum number of triangles or meshlets per thread.
+#define ON_MESHLET_MIN_COUNT_PER_THREAD 0x4000
+
+// Spread the low 10 bits of x so there are two zero bits between them.
+inline ON__UINT32 ON_MeshletMortonSpread(ON__UINT32 x)
+{
+  x &= 0x3FFU;
+  x = (x | (x << 16)) & 0x030000FFU;
+  x = (x | (x << 8)) & 0x0300F00FU;
+  x = (x | (x << 4)) & 0x030C30C3U;
+  x = (x | (x << 2)) & 0x09249249U;
+  return x;
+}
+
+// Float values that are <= and >= t.
+inline float ON_MeshletFloatDown(double t)
+{
+  float f = (float)t;
+  if ((double)f > t)
+    f = nextafterf(f, -FLT_MAX);
+  return f;
+}
+
+inline float ON_MeshletFloatUp(double t)
+{
+  float f = (float)t;
+  if ((double)f < t)
+    f = nextafterf(f, FLT_MAX);
+  return f;
+}
+
+inline void ON_MeshletPartition::Destroy()
+{
+  *this = ON_MeshletPartition();
+}
+
+inline unsigned int ON_MeshletPartition::MeshletCount() const
+{
+  return m_meshlet.UnsignedCount();
+}
+
+inline const unsigned int* ON_MeshletPartition::VertexIndices(const ON_Meshlet& meshlet) const
+{
+  return m_vertex_index.Array() + meshlet.m_vertex_offset;
+}
+
+inline const ON__UINT8* ON_MeshletPartition::Triangles(const ON_Meshlet& meshlet) const
+{
+  return m_triangle.Array() + 3 * (size_t)meshlet.m_triangle_offset;
+}
+
+inline bool ON_MeshletPartition::Create(
+  const ON_Mesh& mesh,
+  unsigned int max_vertex_count,
+  unsigned int max_triangle_count,
+  bool bMultithreaded
+  )
+{
+  Destroy();
+
+  if (max_vertex_count < 3 || max_vertex_count > 256)
+    return false;
+  if (max_triangle_count < 1 || max_triangle_count > 512)
+    return false;
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (0 == vertex_count || 0 == face_count || face_count > 0x7FFFFFFFU)
+    return false;
+
+  const ON_3dPoint* dV = mesh.HasDoublePrecisionVertices() ? mesh.m_dV.Array() : nullptr;
+  const ON_3fPoint* fV = (nullptr == dV) ? mesh.m_V.Array() : nullptr;
+  auto get_point = [dV, fV](unsigned int vi, double P[3])
+  {
+    if (nullptr != dV)
+    {
+      P[0] = dV[vi].x; P[1] = dV[vi].y; P[2] = dV[vi].z;
+    }
+    else
+    {
+      P[0] = fV[vi].x; P[1] = fV[vi].y; P[2] = fV[vi].z;
+    }
+  };
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Triangles
+  //
+  ON_SimpleArray<unsigned int> tri_v(6 * (size_t)face_count);
+  ON_SimpleArray<unsigned int> tri_f(2 * (size_t)face_count);
+  {
+    const ON_MeshFace* F = mesh.m_F.Array();
+    for (unsigned int fi = 0; fi < face_count; ++fi)
+    {
+      const int* fvi = F[fi].vi;
+      if (fvi[0] < 0 || fvi[1] < 0 || fvi[2] < 0 || fvi[3] < 0)
+        continue;
+      if ((unsigned int)fvi[0] >= vertex_count || (unsigned int)fvi[1] >= vertex_count
+        || (unsigned int)fvi[2] >= vertex_count || (unsigned int)fvi[3] >= vertex_count)
+        continue;
+      const int corners[2][3] = { { fvi[0], fvi[1], fvi[2] }, { fvi[0], fvi[2], fvi[3] } };
+      const unsigned int half_count = (fvi[2] != fvi[3]) ? 2U : 1U;
+      for (unsigned int h = 0; h < half_count; ++h)
+      {
+        const int* c = corners[h];
+        if (c[0] == c[1] || c[1] == c[2] || c[2] == c[0])
+          continue;
+        for (int k = 0; k < 3; ++k)
+          tri_v.Append((unsigned int)c[k]);
+        tri_f.Append(2 * fi + h);
+      }
+    }
+  }
+  const unsigned int triangle_count = tri_f.UnsignedCount();
+  if (0 == triangle_count)
+    return false;
+
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(triangle_count, ON_MESHLET_MIN_COUNT_PER_THREAD)
+    : 1U;
+
+  const unsigned int* TV = tri_v.Array();
+
+  // triangle centroids
+  ON_SimpleArray<double> tri_c(3 * (size_t)triangle_count);
+  tri_c.SetCount((int)(3 * triangle_count));
+  double* TC = tri_c.Array();
+  ON_Parallel::ForRanges(triangle_count, thread_count,
+    [TV, TC, &get_point](size_t t0, size_t t1, unsigned int)
+    {
+      double P[3][3];
+      for (size_t t = t0; t < t1; ++t)
+      {
+        for (int k = 0; k < 3; ++k)
+          get_point(TV[3 * t + k], P[k]);
+        for (int j = 0; j < 3; ++j)
+          TC[3 * t + j] = (P[0][j] + P[1][j] + P[2][j]) / 3.0;
+      }
+    });
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Sort the triangles by the Morton code of their centroids.
+  // The low 32 bits hold the triangle index so the order is unique.
+  //
+  ON_SimpleArray<ON__UINT64> order(triangle_count);
+  order.SetCount((int)triangle_count);
+  {
+    double cmin[3], cmax[3];
+    for (int j = 0; j < 3; ++j)
+      cmin[j] = cmax[j] = TC[j];
+    for (unsigned int t = 1; t < triangle_count; ++t)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        const double c = TC[3 * t + j];
+        if (c < cmin[j])
+          cmin[j] = c;
+        else if (c > cmax[j])
+          cmax[j] = c;
+      }
+    }
+    double cscale = 0.0;
+    for (int j = 0; j < 3; ++j)
+    {
+      if (cmax[j] - cmin[j] > cscale)
+        cscale = cmax[j] - cmin[j];
+    }
+    // one scale for all 3 directions keeps the cells cubes
+    cscale = (cscale > 0.0) ? (1023.0 / cscale) : 0.0;
+    ON__UINT64* O = order.Array();
+    ON_Parallel::ForRanges(triangle_count, thread_count,
+      [TC, O, &cmin, cscale](size_t t0, size_t t1, unsigned int)
+      {
+        for (size_t t = t0; t < t1; ++t)
+        {
+          ON__UINT32 q[3];
+          for (int j = 0; j < 3; ++j)
+          {
+            const double s = (TC[3 * t + j] - cmin[j]) * cscale;
+            q[j] = (s <= 0.0) ? 0U : ((s >= 1023.0) ? 1023U : (ON__UINT32)s);
+          }
+          const ON__UINT64 code
+            = ON_MeshletMortonSpread(q[0])
+            | (ON_MeshletMortonSpread(q[1]) << 1)
+            | (ON_MeshletMortonSpread(q[2]) << 2);
+          O[t] = (code << 32) | (ON__UINT64)t;
+        }
+      });
+    ON_Parallel::Sort(O, O + triangle_count,
+      [](ON__UINT64 a, ON__UINT64 b) { return a < b; },
+      thread_count);
+  }
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Vertex to triangle map. The triangles that use vertex v are
+  // VT[VT_offset[v]] ... VT[VT_offset[v+1]-1].
+  //
+  ON_SimpleArray<unsigned int> vt_offset((size_t)vertex_count + 1);
+  vt_offset.SetCount((int)vertex_count + 1);
+  vt_offset.Zero();
+  ON_SimpleArray<unsigned int> vt(3 * (size_t)triangle_count);
+  vt.SetCount((int)(3 * triangle_count));
+  unsigned int* VT_offset = vt_offset.Array();
+  unsigned int* VT = vt.Array();
+  for (unsigned int i = 0; i < 3 * triangle_count; ++i)
+    VT_offset[TV[i] + 1]++;
+  for (unsigned int vi = 0; vi < vertex_count; ++vi)
+    VT_offset[vi + 1] += VT_offset[vi];
+  {
+    ON_SimpleArray<unsigned int> fill(vt_offset);
+    unsigned int* next = fill.Array();
+    for (unsigned int i = 0; i < 3 * triangle_count; ++i)
+      VT[next[TV[i]]++] = i / 3;
+  }
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Grow the meshlets. A meshlet starts at the first unused triangle in
+  // Morton order. Then, while the limits permit, the unused triangle that
+  // shares a vertex with the meshlet, adds the fewest new vertices and is
+  // closest to the meshlet's center is added. When no triangle shares a
+  // vertex, the next triangle in Morton order is added if it is near the
+  // meshlet. This part is serial so the result does not depend on the
+  // number of threads.
+  //
+  m_max_vertex_count = max_vertex_count;
+  m_max_triangle_count = max_triangle_count;
+  m_meshlet.Reserve(triangle_count / max_triangle_count + 1);
+  m_vertex_index.Reserve(triangle_count);
+  m_triangle.Reserve(3 * (size_t)triangle_count);
+  m_triangle_face.Reserve(triangle_count);
+
+  ON_SimpleArray<ON__UINT8> used(triangle_count);
+  used.SetCount((int)triangle_count);
+  used.Zero();
+  ON__UINT8* U = used.Array();
+
+  // local_index[vi] = meshlet vertex index or -1
+  ON_SimpleArray<int> local_index(vertex_count);
+  local_index.SetCount((int)vertex_count);
+  memset(local_index.Array(), 0xFF, vertex_count * sizeof(int));
+  int* L = local_index.Array();
+
+  const ON__UINT64* O = order.Array();
+  unsigned int cursor = 0;
+  ON_Meshlet cur;
+  memset(&cur, 0, sizeof(cur));
+  double csum[3] = { 0.0, 0.0, 0.0 };
+  double box_min[3] = { 0.0, 0.0, 0.0 };
+  double box_max[3] = { 0.0, 0.0, 0.0 };
+
+  // live[vi] = number of unused triangles that use vertex vi
+  ON_SimpleArray<unsigned int> live(vertex_count);
+  live.SetCount((int)vertex_count);
+  unsigned int* LIVE = live.Array();
+  for (unsigned int vi = 0; vi < vertex_count; ++vi)
+    LIVE[vi] = VT_offset[vi + 1] - VT_offset[vi];
+
+  auto new_vertex_count = [TV, L](unsigned int t)
+  {
+    return (L[TV[3 * t]] < 0 ? 1U : 0U) + (L[TV[3 * t + 1]] < 0 ? 1U : 0U) + (L[TV[3 * t + 2]] < 0 ? 1U : 0U);
+  };
+
+  auto add_triangle = [&](unsigned int t)
+  {
+    U[t] = 1;
+    for (int k = 0; k < 3; ++k)
+    {
+      const unsigned int vi = TV[3 * t + k];
+      LIVE[vi]--;
+      if (L[vi] < 0)
+      {
+        L[vi] = (int)cur.m_vertex_count++;
+        m_vertex_index.Append(vi);
+        double P[3];
+        get_point(vi, P);
+        for (int j = 0; j < 3; ++j)
+        {
+          if (1 == cur.m_vertex_count || P[j] < box_min[j])
+            box_min[j] = P[j];
+          if (1 == cur.m_vertex_count || P[j] > box_max[j])
+            box_max[j] = P[j];
+        }
+      }
+      m_triangle.Append((ON__UINT8)L[vi]);
+    }
+    m_triangle_face.Append(tri_f[t]);
+    cur.m_triangle_count++;
+    for (int j = 0; j < 3; ++j)
+      csum[j] += TC[3 * t + j];
+  };
+
+  auto finish_meshlet = [&]()
+  {
+    for (unsigned int i = 0; i < cur.m_vertex_count; ++i)
+      L[m_vertex_index[cur.m_vertex_offset + i]] = -1;
+    m_meshlet.Append(cur);
+    memset(&cur, 0, sizeof(cur));
+    cur.m_vertex_offset = m_vertex_index.UnsignedCount();
+    cur.m_triangle_offset = m_triangle_face.UnsignedCount();
+    csum[0] = csum[1] = csum[2] = 0.0;
+  };
+
+  // Find the best unused triangle that uses a meshlet vertex. Triangles that
+  // are the last unused triangle of a vertex are preferred so the meshlets
+  // do not leave small islands of unused triangles behind.
+  unsigned int best_t;
+  unsigned int best_new;
+  double best_score;
+  auto search = [&](const unsigned int* vertex_list, unsigned int list_count)
+  {
+    const double s = 1.0 / cur.m_triangle_count;
+    const double center[3] = { s * csum[0], s * csum[1], s * csum[2] };
+    for (unsigned int i = 0; i < list_count; ++i)
+    {
+      const unsigned int vi = vertex_list[i];
+      for (unsigned int j = VT_offset[vi]; j < VT_offset[vi + 1]; ++j)
+      {
+        const unsigned int t = VT[j];
+        if (0 != U[t])
+          continue;
+        const unsigned int n = new_vertex_count(t);
+        if (cur.m_vertex_count + n > max_vertex_count || n > best_new)
+          continue;
+        const double* c = TC + 3 * (size_t)t;
+        const double d2
+          = (c[0] - center[0]) * (c[0] - center[0])
+          + (c[1] - center[1]) * (c[1] - center[1])
+          + (c[2] - center[2]) * (c[2] - center[2]);
+        const unsigned int finished_count
+          = (1 == LIVE[TV[3 * t]] ? 1U : 0U) + (1 == LIVE[TV[3 * t + 1]] ? 1U : 0U) + (1 == LIVE[TV[3 * t + 2]] ? 1U : 0U);
+        const double score = d2 / (1.0 + finished_count);
+        if (n < best_new || score < best_score || (score == best_score && t < best_t))
+        {
+          best_t = t;
+          best_new = n;
+          best_score = score;
+        }
+      }
+    }
+  };
+
+  for (;;)
+  {
+    if (0 == cur.m_triangle_count)
+    {
+      while (cursor < triangle_count && 0 != U[(unsigned int)O[cursor]])
+        cursor++;
+      if (cursor >= triangle_count)
+        break;
+      add_triangle((unsigned int)O[cursor]);
+      continue;
+    }
+
+    if (cur.m_triangle_count >= max_triangle_count)
+    {
+      finish_meshlet();
+      continue;
+    }
+
+    best_t = ON_UNSET_UINT_INDEX;
+    best_new = 4;
+    best_score = 0.0;
+    search(m_vertex_index.Array() + cur.m_vertex_offset, cur.m_vertex_count);
+    if (ON_UNSET_UINT_INDEX == best_t)
+    {
+      while (cursor < triangle_count && 0 != U[(unsigned int)O[cursor]])
+        cursor++;
+      if (cursor < triangle_count)
+      {
+        const unsigned int t = (unsigned int)O[cursor];
+        const double* c = TC + 3 * (size_t)t;
+        bool bNear = (cur.m_vertex_count + new_vertex_count(t) <= max_vertex_count);
+        for (int j = 0; j < 3 && bNear; ++j)
+        {
+          const double pad = 0.5 * (box_max[j] - box_min[j]);
+          bNear = (c[j] >= box_min[j] - pad && c[j] <= box_max[j] + pad);
+        }
+        if (bNear)
+          best_t = t;
+      }
+    }
+
+    if (ON_UNSET_UINT_INDEX == best_t)
+      finish_meshlet();
+    else
+      add_triangle(best_t);
+  }
+  if (cur.m_triangle_count > 0)
+    finish_meshlet();
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Bounding spheres, boxes and normal cones
+  //
+  const unsigned int meshlet_count = m_meshlet.UnsignedCount();
+  ON_Meshlet* M = m_meshlet.Array();
+  const unsigned int* MV = m_vertex_index.Array();
+  const ON__UINT8* MT = m_triangle.Array();
+  const unsigned int bounds_thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(meshlet_count, ON_MESHLET_MIN_COUNT_PER_THREAD / 64)
+    : 1U;
+  ON_Parallel::ForRanges(meshlet_count, bounds_thread_count,
+    [M, MV, MT, &get_point](size_t m0, size_t m1, unsigned int)
+    {
+      double N[512][3];
+      for (size_t mi = m0; mi < m1; ++mi)
+      {
+        ON_Meshlet& m = M[mi];
+        const unsigned int* mv = MV + m.m_vertex_offset;
+        const ON__UINT8* mt = MT + 3 * (size_t)m.m_triangle_offset;
+
+        double bmin[3], bmax[3], P[3];
+        get_point(mv[0], bmin);
+        get_point(mv[0], bmax);
+        for (unsigned int i = 1; i < m.m_vertex_count; ++i)
+        {
+          get_point(mv[i], P);
+          for (int j = 0; j < 3; ++j)
+          {
+            if (P[j] < bmin[j])
+              bmin[j] = P[j];
+            else if (P[j] > bmax[j])
+              bmax[j] = P[j];
+          }
+        }
+        const double center[3] = { 0.5 * (bmin[0] + bmax[0]), 0.5 * (bmin[1] + bmax[1]), 0.5 * (bmin[2] + bmax[2]) };
+        double r2 = 0.0;
+        for (unsigned int i = 0; i < m.m_vertex_count; ++i)
+        {
+          get_point(mv[i], P);
+          const double d2
+            = (P[0] - center[0]) * (P[0] - center[0])
+            + (P[1] - center[1]) * (P[1] - center[1])
+            + (P[2] - center[2]) * (P[2] - center[2]);
+          if (d2 > r2)
+            r2 = d2;
+        }
+        // pad the radius to cover rounding the center to float
+        const double cmax = fabs(center[0]) + fabs(center[1]) + fabs(center[2]);
+        const double r = sqrt(r2);
+        m.m_radius = ON_MeshletFloatUp(r + 1.0e-6 * (r + cmax));
+        for (int j = 0; j < 3; ++j)
+        {
+          m.m_center[j] = (float)center[j];
+          m.m_bbox_min[j] = ON_MeshletFloatDown(bmin[j]);
+          m.m_bbox_max[j] = ON_MeshletFloatUp(bmax[j]);
+        }
+
+        // unit triangle normals and their average
+        double axis[3] = { 0.0, 0.0, 0.0 };
+        unsigned int normal_count = 0;
+        double T[3][3];
+        for (unsigned int t = 0; t < m.m_triangle_count; ++t)
+        {
+          for (int k = 0; k < 3; ++k)
+            get_point(mv[mt[3 * t + k]], T[k]);
+          const double a[3] = { T[1][0] - T[0][0], T[1][1] - T[0][1], T[1][2] - T[0][2] };
+          const double b[3] = { T[2][0] - T[0][0], T[2][1] - T[0][1], T[2][2] - T[0][2] };
+          double* n = N[normal_count];
+          n[0] = a[1] * b[2] - a[2] * b[1];
+          n[1] = a[2] * b[0] - a[0] * b[2];
+          n[2] = a[0] * b[1] - a[1] * b[0];
+          const double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+          if (!(len > 0.0))
+            continue;
+          for (int j = 0; j < 3; ++j)
+          {
+            n[j] /= len;
+            axis[j] += n[j];
+          }
+          normal_count++;
+        }
+
+        // no useful cone
+        m.m_cone_cutoff = 1.0f;
+        for (int j = 0; j < 3; ++j)
+        {
+          m.m_cone_axis[j] = 0.0f;
+          m.m_cone_apex[j] = m.m_center[j];
+        }
+
+        const double axis_len = sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        if (0 == normal_count || !(axis_len > 0.0))
+          continue;
+        for (int j = 0; j < 3; ++j)
+          axis[j] /= axis_len;
+        double mindp = 1.0;
+        for (unsigned int i = 0; i < normal_count; ++i)
+        {
+          const double dp = N[i][0] * axis[0] + N[i][1] * axis[1] + N[i][2] * axis[2];
+          if (dp < mindp)
+            mindp = dp;
+        }
+        if (mindp <= 0.1)
+          continue;
+
+        // Move the apex back along the axis until it is behind every triangle's plane.
+        double maxt = 0.0;
+        for (unsigned int t = 0; t < m.m_triangle_count; ++t)
+        {
+          for (int k = 0; k < 3; ++k)
+            get_point(mv[mt[3 * t + k]], T[k]);
+          const double a[3] = { T[1][0] - T[0][0], T[1][1] - T[0][1], T[1][2] - T[0][2] };
+          const double b[3] = { T[2][0] - T[0][0], T[2][1] - T[0][1], T[2][2] - T[0][2] };
+          const double n[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+          const double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+          if (!(len > 0.0))
+            continue;
+          const double dn = (n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]) / len;
+          const double dc
+            = ((center[0] - T[0][0]) * n[0] + (center[1] - T[0][1]) * n[1] + (center[2] - T[0][2]) * n[2]) / len;
+          const double s = dc / dn;
+          if (s > maxt)
+            maxt = s;
+        }
+
+        for (int j = 0; j < 3; ++j)
+        {
+          m.m_cone_axis[j] = (float)axis[j];
+          m.m_cone_apex[j] = (float)(center[j] - maxt * axis[j]);
+        }
+        // round the cutoff up so rounding never makes the tests cull more
+        m.m_cone_cutoff = ON_MeshletFloatUp(sqrt(1.0 - mindp * mindp) + 1.0e-6);
+      }
+    });
+
+  return true;
+}
+
+inline bool ON_MeshletPartition::CreateRTree(ON_FrozenRTree& rtree, bool bMultithreaded) const
+{
+  const unsigned int meshlet_count = m_meshlet.UnsignedCount();
+  if (0 == meshlet_count)
+  {
+    rtree.Destroy();
+    return false;
+  }
+  ON_SimpleArray<ON_RTreeBBox> boxes(meshlet_count);
+  boxes.SetCount((int)meshlet_count);
+  for (unsigned int i = 0; i < meshlet_count; ++i)
+  {
+    const ON_Meshlet& m = m_meshlet[i];
+    for (int j = 0; j < 3; ++j)
+    {
+      boxes[i].m_min[j] = m.m_bbox_min[j];
+      boxes[i].m_max[j] = m.m_bbox_max[j];
+    }
+  }
+  return rtree.Create(boxes.Array(), nullptr, meshlet_count, bMultithreaded);
+}
+
+inline bool ON_MeshletPartition::IsOutside(
+  const ON_Meshlet& meshlet,
+  const ON_PlaneEquation* planes,
+  unsigned int plane_count
+  )
+{
+  if (nullptr == planes)
+    return false;
+  for (unsigned int i = 0; i < plane_count; ++i)
+  {
+    // h is the signed distance times the length of the plane normal,
+    // so the radius is scaled the same way.
+    const ON_PlaneEquation& e = planes[i];
+    const double h = e.x * meshlet.m_center[0] + e.y * meshlet.m_center[1] + e.z * meshlet.m_center[2] + e.d;
+    const double normal_length = sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+    if (h < -meshlet.m_radius * normal_length)
+      return true;
+  }
+  return false;
+}
+
+inline bool ON_MeshletPartition::IsBackfacing(
+  const ON_Meshlet& meshlet,
+  const ON_3dPoint& camera_location
+  )
+{
+  const double v[3] = {
+    meshlet.m_cone_apex[0] - camera_location.x,
+    meshlet.m_cone_apex[1] - camera_location.y,
+    meshlet.m_cone_apex[2] - camera_location.z };
+  const double len = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  const double dp = v[0] * meshlet.m_cone_axis[0] + v[1] * meshlet.m_cone_axis[1] + v[2] * meshlet.m_cone_axis[2];
+  return (len > 0.0 && dp >= meshlet.m_cone_cutoff * len);
+}
+
+inline bool ON_MeshletPartition::IsBackfacingParallel(
+  const ON_Meshlet& meshlet,
+  const ON_3dVector& camera_direction
+  )
+{
+  const double dp
+    = camera_direction.x * meshlet.m_cone_axis[0]
+    + camera_direction.y * meshlet.m_cone_axis[1]
+    + camera_direction.z * meshlet.m_cone_axis[2];
+  const double len = camera_direction.Length();
+  return (len > 0.0 && dp >= meshlet.m_cone_cutoff * len);
+}
+
+#endif
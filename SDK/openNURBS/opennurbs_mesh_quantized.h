@@ -0,0 +1,224 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_QUANTIZED_INC_)
+#define OPENNURBS_MESH_QUANTIZED_INC_
+
+// Number of faces in a ON_QuantizedMesh face block.
+#define ON_QuantizedMesh_FACE_BLOCK_SIZE 256
+
+/*
+Description:
+  ON_QuantizedMesh is a compact read-only copy of a mesh that is intended
+  for meshes that are only displayed.
+  - Vertex locations are stored as 16 bit integers relative to the bounding box.
+  - Vertex normals are octahedral encoded in two 16 bit integers.
+  - Texture coordinates are stored as 16 bit integers relative to their range.
+  - Vertex colors are stored as they are.
+  - Faces are stored in blocks of ON_QuantizedMesh_FACE_BLOCK_SIZE faces.
+    In each block the vertex indices are delta encoded and written as
+    variable length integers.
+  A vertex with a normal and texture coordinates uses 14 bytes instead
+  of the 32 bytes in ON_Mesh m_V[], m_N[] and m_T[], or 56 bytes when
+  the mesh also has m_dV[]. An ON_Mesh face uses 16 bytes. The size of
+  an encoded face depends on how far apart its vertex indices are.
+Remarks:
+  Vertex(), Normal(), Color() and TextureCoordinate() decode a single
+  value. Use an ON_QuantizedMeshRef to read faces; it decodes one face
+  block at a time. GetMesh() decodes everything into an ON_Mesh.
+  N-gons, face normals, surface parameters, curvatures and other
+  optional mesh information are not saved.
+*/
+class ON_QuantizedMesh
+{
+public:
+  ON_QuantizedMesh() = default;
+  ~ON_QuantizedMesh() = default;
+  ON_QuantizedMesh(const ON_QuantizedMesh&) = default;
+  ON_QuantizedMesh& operator=(const ON_QuantizedMesh&) = default;
+
+  /*
+  Description:
+    Create a quantized copy of a mesh.
+  Parameters:
+    mesh - [in]
+      When the mesh has double precision vertices, m_dV[] is used.
+    bMultithreaded - [in]
+      If true and the mesh is large, the encoding is done on multiple threads.
+  Returns:
+    True if successful.
+  */
+  bool Create(
+    const class ON_Mesh& mesh,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Decode the quantized mesh.
+  Parameters:
+    mesh - [out]
+      The mesh is destroyed and then m_V[], m_F[] and, when present,
+      m_N[], m_T[] and m_C[] are set.
+    bMultithreaded - [in]
+  Returns:
+    True if successful.
+  */
+  bool GetMesh(
+    class ON_Mesh& mesh,
+    bool bMultithreaded = true
+    ) const;
+
+  void Destroy();
+
+  unsigned int VertexCount() const;
+  unsigned int FaceCount() const;
+  bool HasVertexNormals() const;
+  bool HasTextureCoordinates() const;
+  bool HasVertexColors() const;
+
+  /*
+  Returns:
+    Bounding box of the vertex locations of the original mesh.
+  */
+  ON_BoundingBox BoundingBox() const;
+
+  /*
+  Returns:
+    Maximum distance between a decoded vertex coordinate and
+    the original value.
+  */
+  double VertexTolerance() const;
+
+  /*
+  Description:
+    Decode a single vertex value.
+  Returns:
+    The decoded value. If vertex_index is not valid or the value is not
+    saved, ON_3fPoint::NanPoint, ON_3fVector::ZeroVector, ON_2fPoint::Origin
+    or ON_Color::UnsetColor is returned.
+  */
+  ON_3fPoint Vertex(
+    unsigned int vertex_index
+    ) const;
+
+  ON_3fVector Normal(
+    unsigned int vertex_index
+    ) const;
+
+  ON_2fPoint TextureCoordinate(
+    unsigned int vertex_index
+    ) const;
+
+  ON_Color Color(
+    unsigned int vertex_index
+    ) const;
+
+  /*
+  Parameters:
+    block_index - [in]
+      0 <= block_index < FaceBlockCount()
+    faces - [out]
+      Must have room for ON_QuantizedMesh_FACE_BLOCK_SIZE faces.
+  Returns:
+    Number of faces in the block.
+  */
+  unsigned int GetFaceBlock(
+    unsigned int block_index,
+    ON_MeshFace* faces
+    ) const;
+
+  unsigned int FaceBlockCount() const;
+
+  /*
+  Returns:
+    Number of bytes of heap memory used by this quantized mesh.
+  */
+  size_t SizeOf() const;
+
+private:
+  unsigned int m_vertex_count = 0;
+  unsigned int m_face_count = 0;
+
+  // vertex location = m_V_min + m_V_scale*m_V[]
+  double m_V_min[3] = { 0.0, 0.0, 0.0 };
+  double m_V_scale[3] = { 0.0, 0.0, 0.0 };
+  ON_SimpleArray<ON__UINT16> m_V; // 3 per vertex
+
+  ON_SimpleArray<ON__INT16> m_N;  // 2 per vertex (octahedral encoding)
+
+  // texture coordinate = m_T_min + m_T_scale*m_T[]
+  double m_T_min[2] = { 0.0, 0.0 };
+  double m_T_scale[2] = { 0.0, 0.0 };
+  ON_SimpleArray<ON__UINT16> m_T; // 2 per vertex
+
+  ON_SimpleArray<ON_Color> m_C;
+
+  // Face block b is m_F[m_F_block[b]] ... m_F[m_F_block[b+1]-1].
+  ON_SimpleArray<ON__UINT8> m_F;
+  ON_SimpleArray<ON__UINT32> m_F_block;
+};
+
+/*
+Description:
+  ON_QuantizedMeshRef provides face access to an ON_QuantizedMesh.
+  The face block that contains the requested face is decoded on demand
+  and kept until a face from another block is requested, so sequential
+  access decodes every block once.
+Remarks:
+  An ON_QuantizedMeshRef is not thread safe. Use one per thread.
+  The ON_QuantizedMesh must exist while the ON_QuantizedMeshRef is used.
+*/
+class ON_QuantizedMeshRef
+{
+public:
+  ON_QuantizedMeshRef() = default;
+  ~ON_QuantizedMeshRef() = default;
+  ON_QuantizedMeshRef(const ON_QuantizedMeshRef&) = default;
+  ON_QuantizedMeshRef& operator=(const ON_QuantizedMeshRef&) = default;
+
+  ON_QuantizedMeshRef(
+    const ON_QuantizedMesh* quantized_mesh
+    );
+
+  const ON_QuantizedMesh* QuantizedMesh() const;
+
+  unsigned int VertexCount() const;
+  unsigned int FaceCount() const;
+
+  ON_3fPoint Vertex(
+    unsigned int vertex_index
+    ) const;
+
+  ON_3fVector Normal(
+    unsigned int vertex_index
+    ) const;
+
+  /*
+  Returns:
+    The face. If face_index is not valid, ON_MeshFace::UnsetMeshFace is returned.
+  */
+  const ON_MeshFace& Face(
+    unsigned int face_index
+    );
+
+private:
+  const ON_QuantizedMesh* m_quantized_mesh = nullptr;
+  unsigned int m_block_index = ON_UNSET_UINT_INDEX;
+  unsigned int m_block_face_count = 0;
+  ON_MeshFace m_block_faces[ON_QuantizedMesh_FACE_BLOCK_SIZE];
+};
+
+#include "opennurbs_mesh_quantized_defs.h"
+
+#endif
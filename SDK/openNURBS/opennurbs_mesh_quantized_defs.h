@@ -0,0 +1,574 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_QUANTIZED_DEFS_INC_)
+#define OPENNURBS_MESH_QUANTIZED_DEFS_INC_
+
+////////////////////////////////////////////////////////////////
+//
+// Encoding tools
+//
+
+// Minimum number of vertices or faces per thread.
+#define ON_QUANTIZED_MESH_MIN_COUNT_PER_THREAD 0x4000
+
+inline ON__UINT16 ON_QuantizedMeshQuantize(double t, double t_min, double t_scale)
+{
+  if (!(t_scale > 0.0))
+    return 0;
+  const double q = (t - t_min) / t_scale + 0.5;
+  return (q <= 0.0) ? (ON__UINT16)0 : ((q >= 65535.0) ? (ON__UINT16)65535 : (ON__UINT16)q);
+}
+
+inline ON__INT16 ON_QuantizedMeshSnorm16(double t)
+{
+  const double q = t * 32767.0;
+  if (q >= 32767.0)
+    return 32767;
+  if (q <= -32767.0)
+    return -32767;
+  return (ON__INT16)((q >= 0.0) ? (q + 0.5) : (q - 0.5));
+}
+
+// Octahedral encoding of a unit vector. A zero vector is encoded as (0,0,1).
+inline void ON_QuantizedMeshOctEncode(double x, double y, double z, ON__INT16 e[2])
+{
+  const double s = fabs(x) + fabs(y) + fabs(z);
+  if (!(s > 0.0))
+  {
+    e[0] = 0;
+    e[1] = 0;
+    return;
+  }
+  double u = x / s;
+  double v = y / s;
+  if (z < 0.0)
+  {
+    // fold the lower hemisphere over the diagonals
+    const double u1 = (1.0 - fabs(v)) * ((u >= 0.0) ? 1.0 : -1.0);
+    const double v1 = (1.0 - fabs(u)) * ((v >= 0.0) ? 1.0 : -1.0);
+    u = u1;
+    v = v1;
+  }
+  e[0] = ON_QuantizedMeshSnorm16(u);
+  e[1] = ON_QuantizedMeshSnorm16(v);
+}
+
+inline ON_3fVector ON_QuantizedMeshOctDecode(const ON__INT16 e[2])
+{
+  double u = e[0] / 32767.0;
+  double v = e[1] / 32767.0;
+  const double z = 1.0 - fabs(u) - fabs(v);
+  if (z < 0.0)
+  {
+    const double u1 = (1.0 - fabs(v)) * ((u >= 0.0) ? 1.0 : -1.0);
+    const double v1 = (1.0 - fabs(u)) * ((v >= 0.0) ? 1.0 : -1.0);
+    u = u1;
+    v = v1;
+  }
+  const double s = 1.0 / sqrt(u * u + v * v + z * z);
+  return ON_3fVector((float)(s * u), (float)(s * v), (float)(s * z));
+}
+
+inline ON__UINT64 ON_QuantizedMeshZigZag(ON__INT64 i)
+{
+  return (((ON__UINT64)i) << 1) ^ ((i < 0) ? 0xFFFFFFFFFFFFFFFFULL : 0ULL);
+}
+
+inline ON__INT64 ON_QuantizedMeshUnZigZag(ON__UINT64 u)
+{
+  const ON__INT64 i = (ON__INT64)(u >> 1);
+  return (0 != (u & 1)) ? (-i - 1) : i;
+}
+
+inline void ON_QuantizedMeshWriteVarint(ON__UINT64 u, ON_SimpleArray<ON__UINT8>& bytes)
+{
+  while (u >= 0x80)
+  {
+    bytes.Append((ON__UINT8)(u | 0x80));
+    u >>= 7;
+  }
+  bytes.Append((ON__UINT8)u);
+}
+
+// Returns false if the varint runs past end.
+inline bool ON_QuantizedMeshReadVarint(const ON__UINT8*& p, const ON__UINT8* end, ON__UINT64& u)
+{
+  u = 0;
+  for (int shift = 0; p < end && shift < 64; shift += 7)
+  {
+    const ON__UINT8 b = *p++;
+    u |= ((ON__UINT64)(b & 0x7F)) << shift;
+    if (0 == (b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+inline unsigned int ON_QuantizedMeshVarintSize(ON__UINT64 u)
+{
+  unsigned int size = 1;
+  for (u >>= 7; 0 != u; u >>= 7)
+    ++size;
+  return size;
+}
+
+/*
+Description:
+  Encode a block of faces. Each face begins with
+    zigzag(vi[0] - previous vi[0])*4 + (corner mode ? 2 : 0) + (quad ? 1 : 0)
+  followed by zigzag(d1), zigzag(d2) and, for quads, zigzag(d3).
+  When the corner mode is 0, dk = vi[k] - vi[0]. When the corner mode is 1,
+  dk = vi[k] - previous vi[k], which is smaller for faces in strips.
+  The encoder uses the mode that needs fewer bytes. All values are written
+  as variable length integers. The previous face indices are 0 at the start
+  of a block.
+*/
+inline void ON_QuantizedMeshEncodeFaces(const ON_MeshFace* F, unsigned int count, ON_SimpleArray<ON__UINT8>& bytes)
+{
+  ON__INT64 prev[4] = { 0, 0, 0, 0 };
+  for (unsigned int fi = 0; fi < count; ++fi)
+  {
+    const int* vi = F[fi].vi;
+    const bool bQuad = (vi[2] != vi[3]);
+    const int n = bQuad ? 4 : 3;
+    ON__UINT64 d[2][4];
+    unsigned int size[2] = { 0, 0 };
+    for (int k = 1; k < n; ++k)
+    {
+      d[0][k] = ON_QuantizedMeshZigZag((ON__INT64)vi[k] - (ON__INT64)vi[0]);
+      d[1][k] = ON_QuantizedMeshZigZag((ON__INT64)vi[k] - prev[k]);
+      size[0] += ON_QuantizedMeshVarintSize(d[0][k]);
+      size[1] += ON_QuantizedMeshVarintSize(d[1][k]);
+    }
+    const int mode = (size[1] < size[0]) ? 1 : 0;
+    ON_QuantizedMeshWriteVarint(4 * ON_QuantizedMeshZigZag((ON__INT64)vi[0] - prev[0]) + 2 * mode + (bQuad ? 1 : 0), bytes);
+    for (int k = 1; k < n; ++k)
+      ON_QuantizedMeshWriteVarint(d[mode][k], bytes);
+    for (int k = 0; k < 4; ++k)
+      prev[k] = vi[k];
+  }
+}
+
+// Returns the number of faces decoded.
+inline unsigned int ON_QuantizedMeshDecodeFaces(const ON__UINT8* p, const ON__UINT8* end, unsigned int count, ON_MeshFace* F)
+{
+  ON__INT64 prev[4] = { 0, 0, 0, 0 };
+  for (unsigned int fi = 0; fi < count; ++fi)
+  {
+    ON__UINT64 u;
+    if (!ON_QuantizedMeshReadVarint(p, end, u))
+      return fi;
+    const bool bQuad = (0 != (u & 1));
+    const bool bCornerMode = (0 != (u & 2));
+    ON__INT64 vi[4];
+    vi[0] = prev[0] + ON_QuantizedMeshUnZigZag(u >> 2);
+    const int n = bQuad ? 4 : 3;
+    for (int k = 1; k < n; ++k)
+    {
+      if (!ON_QuantizedMeshReadVarint(p, end, u))
+        return fi;
+      vi[k] = (bCornerMode ? prev[k] : vi[0]) + ON_QuantizedMeshUnZigZag(u);
+    }
+    if (!bQuad)
+      vi[3] = vi[2];
+    for (int k = 0; k < 4; ++k)
+    {
+      F[fi].vi[k] = (int)vi[k];
+      prev[k] = vi[k];
+    }
+  }
+  return count;
+}
+
+////////////////////////////////////////////////////////////////
+//
+// ON_QuantizedMesh implementation
+//
+
+inline void ON_QuantizedMesh::Destroy()
+{
+  *this = ON_QuantizedMesh();
+}
+
+inline bool ON_QuantizedMesh::Create(const ON_Mesh& mesh, bool bMultithreaded)
+{
+  Destroy();
+
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (0 == vertex_count)
+    return false;
+  if (vertex_count > 0x7FFFFFFFU || face_count > 0x7FFFFFFFU)
+    return false;
+
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount((size_t)vertex_count + (size_t)face_count, ON_QUANTIZED_MESH_MIN_COUNT_PER_THREAD)
+    : 1U;
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Vertex locations
+  //
+  const ON_3dPoint* dV = mesh.HasDoublePrecisionVertices() ? mesh.m_dV.Array() : nullptr;
+  const ON_3fPoint* fV = (nullptr == dV) ? mesh.m_V.Array() : nullptr;
+  double bmin[3], bmax[3];
+  for (int j = 0; j < 3; ++j)
+    bmin[j] = bmax[j] = (nullptr != dV) ? (&dV[0].x)[j] : (double)((&fV[0].x)[j]);
+  for (unsigned int i = 1; i < vertex_count; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      const double t = (nullptr != dV) ? (&dV[i].x)[j] : (double)((&fV[i].x)[j]);
+      if (t < bmin[j])
+        bmin[j] = t;
+      else if (t > bmax[j])
+        bmax[j] = t;
+    }
+  }
+  for (int j = 0; j < 3; ++j)
+  {
+    m_V_min[j] = bmin[j];
+    m_V_scale[j] = (bmax[j] - bmin[j]) / 65535.0;
+  }
+
+  m_V.Reserve(3 * (size_t)vertex_count);
+  m_V.SetCount((int)(3 * vertex_count));
+  ON__UINT16* qV = m_V.Array();
+  const double* V_min = m_V_min;
+  const double* V_scale = m_V_scale;
+  ON_Parallel::ForRanges(vertex_count, thread_count,
+    [dV, fV, qV, V_min, V_scale](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t i = i0; i < i1; ++i)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          const double t = (nullptr != dV) ? (&dV[i].x)[j] : (double)((&fV[i].x)[j]);
+          qV[3 * i + j] = ON_QuantizedMeshQuantize(t, V_min[j], V_scale[j]);
+        }
+      }
+    }
+  );
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Vertex normals
+  //
+  if (vertex_count == mesh.m_N.UnsignedCount())
+  {
+    m_N.Reserve(2 * (size_t)vertex_count);
+    m_N.SetCount((int)(2 * vertex_count));
+    ON__INT16* qN = m_N.Array();
+    const ON_3fVector* N = mesh.m_N.Array();
+    ON_Parallel::ForRanges(vertex_count, thread_count,
+      [N, qN](size_t i0, size_t i1, unsigned int)
+      {
+        for (size_t i = i0; i < i1; ++i)
+          ON_QuantizedMeshOctEncode(N[i].x, N[i].y, N[i].z, qN + 2 * i);
+      }
+    );
+  }
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Texture coordinates
+  //
+  if (vertex_count == mesh.m_T.UnsignedCount())
+  {
+    const ON_2fPoint* T = mesh.m_T.Array();
+    double tmin[2] = { T[0].x, T[0].y };
+    double tmax[2] = { T[0].x, T[0].y };
+    for (unsigned int i = 1; i < vertex_count; ++i)
+    {
+      for (int j = 0; j < 2; ++j)
+      {
+        const double t = (0 == j) ? T[i].x : T[i].y;
+        if (t < tmin[j])
+          tmin[j] = t;
+        else if (t > tmax[j])
+          tmax[j] = t;
+      }
+    }
+    for (int j = 0; j < 2; ++j)
+    {
+      m_T_min[j] = tmin[j];
+      m_T_scale[j] = (tmax[j] - tmin[j]) / 65535.0;
+    }
+    m_T.Reserve(2 * (size_t)vertex_count);
+    m_T.SetCount((int)(2 * vertex_count));
+    ON__UINT16* qT = m_T.Array();
+    for (unsigned int i = 0; i < vertex_count; ++i)
+    {
+      qT[2 * i] = ON_QuantizedMeshQuantize(T[i].x, m_T_min[0], m_T_scale[0]);
+      qT[2 * i + 1] = ON_QuantizedMeshQuantize(T[i].y, m_T_min[1], m_T_scale[1]);
+    }
+  }
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Vertex colors
+  //
+  if (vertex_count == mesh.m_C.UnsignedCount())
+    m_C = mesh.m_C;
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Faces
+  //
+  const unsigned int block_count = (face_count + ON_QuantizedMesh_FACE_BLOCK_SIZE - 1) / ON_QuantizedMesh_FACE_BLOCK_SIZE;
+  ON_ClassArray< ON_SimpleArray<ON__UINT8> > block_bytes(block_count);
+  for (unsigned int b = 0; b < block_count; ++b)
+    block_bytes.AppendNew();
+  const ON_MeshFace* F = mesh.m_F.Array();
+  ON_SimpleArray<ON__UINT8>* block = block_bytes.Array();
+  ON_Parallel::For(block_count, thread_count,
+    [F, face_count, block](size_t b, unsigned int)
+    {
+      const unsigned int fi0 = (unsigned int)b * ON_QuantizedMesh_FACE_BLOCK_SIZE;
+      const unsigned int n
+        = (face_count - fi0 < ON_QuantizedMesh_FACE_BLOCK_SIZE)
+        ? (face_count - fi0)
+        : ON_QuantizedMesh_FACE_BLOCK_SIZE;
+      block[b].Reserve(6 * n);
+      ON_QuantizedMeshEncodeFaces(F + fi0, n, block[b]);
+    }
+  );
+  size_t byte_count = 0;
+  m_F_block.Reserve(block_count + 1);
+  for (unsigned int b = 0; b < block_count; ++b)
+  {
+    m_F_block.Append((ON__UINT32)byte_count);
+    byte_count += block[b].UnsignedCount();
+  }
+  m_F_block.Append((ON__UINT32)byte_count);
+  if (byte_count > 0xFFFFFFFFU)
+  {
+    Destroy();
+    return false;
+  }
+  m_F.Reserve(byte_count);
+  for (unsigned int b = 0; b < block_count; ++b)
+    m_F.Append(block[b].Count(), block[b].Array());
+
+  m_vertex_count = vertex_count;
+  m_face_count = face_count;
+  return true;
+}
+
+inline bool ON_QuantizedMesh::GetMesh(ON_Mesh& mesh, bool bMultithreaded) const
+{
+  mesh.Destroy();
+  if (0 == m_vertex_count)
+    return false;
+
+  const unsigned int vertex_count = m_vertex_count;
+  const unsigned int face_count = m_face_count;
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount((size_t)vertex_count + (size_t)face_count, ON_QUANTIZED_MESH_MIN_COUNT_PER_THREAD)
+    : 1U;
+
+  mesh.m_V.Reserve(vertex_count);
+  mesh.m_V.SetCount((int)vertex_count);
+  if (HasVertexNormals())
+  {
+    mesh.m_N.Reserve(vertex_count);
+    mesh.m_N.SetCount((int)vertex_count);
+  }
+  if (HasTextureCoordinates())
+  {
+    mesh.m_T.Reserve(vertex_count);
+    mesh.m_T.SetCount((int)vertex_count);
+  }
+  if (HasVertexColors())
+    mesh.m_C = m_C;
+  ON_3fPoint* V = mesh.m_V.Array();
+  ON_3fVector* N = HasVertexNormals() ? mesh.m_N.Array() : nullptr;
+  ON_2fPoint* T = HasTextureCoordinates() ? mesh.m_T.Array() : nullptr;
+  ON_Parallel::ForRanges(vertex_count, thread_count,
+    [this, V, N, T](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t i = i0; i < i1; ++i)
+      {
+        V[i] = Vertex((unsigned int)i);
+        if (nullptr != N)
+          N[i] = Normal((unsigned int)i);
+        if (nullptr != T)
+          T[i] = TextureCoordinate((unsigned int)i);
+      }
+    }
+  );
+
+  mesh.m_F.Reserve(face_count);
+  mesh.m_F.SetCount((int)face_count);
+  ON_MeshFace* F = mesh.m_F.Array();
+  std::atomic<bool> rc(true);
+  ON_Parallel::For(FaceBlockCount(), thread_count,
+    [this, F, face_count, &rc](size_t b, unsigned int)
+    {
+      const unsigned int fi0 = (unsigned int)b * ON_QuantizedMesh_FACE_BLOCK_SIZE;
+      const unsigned int n
+        = (face_count - fi0 < ON_QuantizedMesh_FACE_BLOCK_SIZE)
+        ? (face_count - fi0)
+        : ON_QuantizedMesh_FACE_BLOCK_SIZE;
+      if (n != GetFaceBlock((unsigned int)b, F + fi0))
+        rc = false;
+    }
+  );
+  if (!rc)
+  {
+    mesh.Destroy();
+    return false;
+  }
+  return true;
+}
+
+inline unsigned int ON_QuantizedMesh::VertexCount() const { return m_vertex_count; }
+inline unsigned int ON_QuantizedMesh::FaceCount() const { return m_face_count; }
+inline bool ON_QuantizedMesh::HasVertexNormals() const { return m_vertex_count > 0 && 2 * m_vertex_count == m_N.UnsignedCount(); }
+inline bool ON_QuantizedMesh::HasTextureCoordinates() const { return m_vertex_count > 0 && 2 * m_vertex_count == m_T.UnsignedCount(); }
+inline bool ON_QuantizedMesh::HasVertexColors() const { return m_vertex_count > 0 && m_vertex_count == m_C.UnsignedCount(); }
+inline unsigned int ON_QuantizedMesh::FaceBlockCount() const { return (m_F_block.UnsignedCount() > 0) ? (m_F_block.UnsignedCount() - 1) : 0U; }
+
+inline ON_BoundingBox ON_QuantizedMesh::BoundingBox() const
+{
+  if (0 == m_vertex_count)
+    return ON_BoundingBox::EmptyBoundingBox;
+  return ON_BoundingBox(
+    ON_3dPoint(m_V_min[0], m_V_min[1], m_V_min[2]),
+    ON_3dPoint(m_V_min[0] + 65535.0 * m_V_scale[0], m_V_min[1] + 65535.0 * m_V_scale[1], m_V_min[2] + 65535.0 * m_V_scale[2])
+    );
+}
+
+inline double ON_QuantizedMesh::VertexTolerance() const
+{
+  double s = m_V_scale[0];
+  if (m_V_scale[1] > s)
+    s = m_V_scale[1];
+  if (m_V_scale[2] > s)
+    s = m_V_scale[2];
+  return 0.5 * s;
+}
+
+inline ON_3fPoint ON_QuantizedMesh::Vertex(unsigned int vertex_index) const
+{
+  if (vertex_index >= m_vertex_count)
+    return ON_3fPoint::NanPoint;
+  const ON__UINT16* q = m_V.Array() + 3 * (size_t)vertex_index;
+  return ON_3fPoint(
+    (float)(m_V_min[0] + m_V_scale[0] * q[0]),
+    (float)(m_V_min[1] + m_V_scale[1] * q[1]),
+    (float)(m_V_min[2] + m_V_scale[2] * q[2])
+    );
+}
+
+inline ON_3fVector ON_QuantizedMesh::Normal(unsigned int vertex_index) const
+{
+  if (vertex_index >= m_vertex_count || !HasVertexNormals())
+    return ON_3fVector::ZeroVector;
+  return ON_QuantizedMeshOctDecode(m_N.Array() + 2 * (size_t)vertex_index);
+}
+
+inline ON_2fPoint ON_QuantizedMesh::TextureCoordinate(unsigned int vertex_index) const
+{
+  if (vertex_index >= m_vertex_count || !HasTextureCoordinates())
+    return ON_2fPoint::Origin;
+  const ON__UINT16* q = m_T.Array() + 2 * (size_t)vertex_index;
+  return ON_2fPoint(
+    (float)(m_T_min[0] + m_T_scale[0] * q[0]),
+    (float)(m_T_min[1] + m_T_scale[1] * q[1])
+    );
+}
+
+inline ON_Color ON_QuantizedMesh::Color(unsigned int vertex_index) const
+{
+  return (vertex_index < m_vertex_count && HasVertexColors())
+    ? m_C[vertex_index]
+    : ON_Color::UnsetColor;
+}
+
+inline unsigned int ON_QuantizedMesh::GetFaceBlock(unsigned int block_index, ON_MeshFace* faces) const
+{
+  if (block_index >= FaceBlockCount() || nullptr == faces)
+    return 0;
+  const unsigned int fi0 = block_index * ON_QuantizedMesh_FACE_BLOCK_SIZE;
+  const unsigned int n
+    = (m_face_count - fi0 < ON_QuantizedMesh_FACE_BLOCK_SIZE)
+    ? (m_face_count - fi0)
+    : ON_QuantizedMesh_FACE_BLOCK_SIZE;
+  const ON__UINT8* bytes = m_F.Array();
+  return ON_QuantizedMeshDecodeFaces(bytes + m_F_block[block_index], bytes + m_F_block[block_index + 1], n, faces);
+}
+
+inline size_t ON_QuantizedMesh::SizeOf() const
+{
+  return sizeof(*this)
+    + m_V.SizeOfArray()
+    + m_N.SizeOfArray()
+    + m_T.SizeOfArray()
+    + m_C.SizeOfArray()
+    + m_F.SizeOfArray()
+    + m_F_block.SizeOfArray();
+}
+
+////////////////////////////////////////////////////////////////
+//
+// ON_QuantizedMeshRef implementation
+//
+
+inline ON_QuantizedMeshRef::ON_QuantizedMeshRef(const ON_QuantizedMesh* quantized_mesh)
+  : m_quantized_mesh(quantized_mesh)
+{}
+
+inline const ON_QuantizedMesh* ON_QuantizedMeshRef::QuantizedMesh() const
+{
+  return m_quantized_mesh;
+}
+
+inline unsigned int ON_QuantizedMeshRef::VertexCount() const
+{
+  return (nullptr != m_quantized_mesh) ? m_quantized_mesh->VertexCount() : 0U;
+}
+
+inline unsigned int ON_QuantizedMeshRef::FaceCount() const
+{
+  return (nullptr != m_quantized_mesh) ? m_quantized_mesh->FaceCount() : 0U;
+}
+
+inline ON_3fPoint ON_QuantizedMeshRef::Vertex(unsigned int vertex_index) const
+{
+  return (nullptr != m_quantized_mesh) ? m_quantized_mesh->Vertex(vertex_index) : ON_3fPoint::NanPoint;
+}
+
+inline ON_3fVector ON_QuantizedMeshRef::Normal(unsigned int vertex_index) const
+{
+  return (nullptr != m_quantized_mesh) ? m_quantized_mesh->Normal(vertex_index) : ON_3fVector::ZeroVector;
+}
+
+inline const ON_MeshFace& ON_QuantizedMeshRef::Face(unsigned int face_index)
+{
+  if (nullptr == m_quantized_mesh || face_index >= m_quantized_mesh->FaceCount())
+    return ON_MeshFace::UnsetMeshFace;
+  const unsigned int block_index = face_index / ON_QuantizedMesh_FACE_BLOCK_SIZE;
+  if (block_index != m_block_index)
+  {
+    m_block_face_count = m_quantized_mesh->GetFaceBlock(block_index, m_block_faces);
+    m_block_index = block_index;
+  }
+  const unsigned int i = face_index % ON_QuantizedMesh_FACE_BLOCK_SIZE;
+  return (i < m_block_face_count) ? m_block_faces[i] : ON_MeshFace::UnsetMeshFace;
+}
+
+#endif
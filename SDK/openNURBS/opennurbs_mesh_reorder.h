@@ -0,0 +1,165 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_REORDER_INC_)
+#define OPENNURBS_MESH_REORDER_INC_
+
+/*
+Description:
+  ON_MeshReorder changes the order of mesh faces and vertices so the mesh
+  is faster to draw and to process.
+  - The faces are put in an order that reuses recently used vertices
+    (the Tipsify algorithm by Sander, Nehab and Barczak). This improves
+    the hit rate of a GPU post-transform vertex cache.
+  - The vertices are put in the order they are first used by the faces,
+    so loops over the faces access vertex memory almost sequentially.
+  Neither changes the shape of the mesh.
+Example:
+
+        double acmr0 = 0.0, acmr1 = 0.0;
+        ON_MeshReorder::Optimize(mesh, 16, &acmr0, &acmr1);
+        // acmr1 is typically 0.6 to 0.7 for a triangle mesh
+
+*/
+class ON_MeshReorder
+{
+public:
+  /*
+  Description:
+    Calculate the average cache miss ratio of a mesh.
+  Parameters:
+    mesh - [in]
+    cache_size - [in]
+      Number of vertices in the simulated FIFO vertex cache.
+  Returns:
+    Number of vertex cache misses divided by the number of triangles.
+    Quads count as 2 triangles. The value is between 0.5 for an ideal
+    large mesh and 3.0 when no vertex is reused.
+    0.0 is returned if the mesh has no faces.
+  */
+  static double ACMR(
+    const class ON_Mesh& mesh,
+    unsigned int cache_size = 16
+    );
+
+  /*
+  Description:
+    Reorder the faces and then the vertices of a mesh.
+  Parameters:
+    mesh - [in/out]
+    cache_size - [in]
+      Size of the vertex cache to optimize for. 16 is a good choice for
+      most graphics hardware.
+    acmr_before - [out]
+    acmr_after - [out]
+      If not null, the value of ACMR(mesh,cache_size) before and after
+      the faces were reordered is returned here.
+  Returns:
+    True if successful.
+  */
+  static bool Optimize(
+    class ON_Mesh& mesh,
+    unsigned int cache_size = 16,
+    double* acmr_before = nullptr,
+    double* acmr_after = nullptr
+    );
+
+  /*
+  Description:
+    Get a face order that improves vertex cache use.
+  Parameters:
+    mesh - [in]
+    cache_size - [in]
+    face_order - [out]
+      face_order[i] is the index of the face that should be the i-th face.
+  Returns:
+    True if successful.
+  */
+  static bool GetFaceOrder(
+    const class ON_Mesh& mesh,
+    unsigned int cache_size,
+    ON_SimpleArray<unsigned int>& face_order
+    );
+
+  /*
+  Description:
+    Get the order vertices are first used by the faces.
+  Parameters:
+    mesh - [in]
+    vertex_order - [out]
+      vertex_order[i] is the index of the vertex that should be the i-th vertex.
+      Vertices that are not used by a face are put at the end.
+  Returns:
+    True if successful.
+  */
+  static bool GetVertexOrder(
+    const class ON_Mesh& mesh,
+    ON_SimpleArray<unsigned int>& vertex_order
+    );
+
+  /*
+  Description:
+    Change the order of the mesh faces. m_F[], m_FN[], the n-gon map
+    and the n-gon face lists are updated. An n-gon map whose count is
+    not the face count is out of date; it is rebuilt from the n-gon
+    face lists, or removed when the mesh has no n-gons.
+  Parameters:
+    mesh - [in/out]
+    face_order - [in]
+      A permutation of the face indices. After the call, face i is the
+      face that was face_order[i].
+  Returns:
+    True if successful.
+  */
+  static bool PermuteFaces(
+    class ON_Mesh& mesh,
+    const unsigned int* face_order
+    );
+
+  /*
+  Description:
+    Change the order of the mesh vertices. m_V[], m_dV[], m_N[], m_T[],
+    m_TC[], m_S[], m_K[], m_C[], m_H[], the face vertex indices and the
+    n-gon vertex lists are updated.
+  Parameters:
+    mesh - [in/out]
+    vertex_order - [in]
+      A permutation of the vertex indices. After the call, vertex i is the
+      vertex that was vertex_order[i].
+  Returns:
+    True if successful.
+  */
+  static bool PermuteVertices(
+    class ON_Mesh& mesh,
+    const unsigned int* vertex_order
+    );
+
+private:
+  // Returns the inverse of a permutation or false if order[] is not a permutation.
+  static bool Internal_Invert(
+    const unsigned int* order,
+    unsigned int count,
+    ON_SimpleArray<unsigned int>& inverse
+    );
+
+  template <class T>
+  static void Internal_Permute(
+    ON_SimpleArray<T>& a,
+    const unsigned int* order,
+    unsigned int count
+    );
+};
+
+#include "opennurbs_mesh_reorder_defs.h"
+
+#endif
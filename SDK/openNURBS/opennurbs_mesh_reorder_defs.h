@@ -0,0 +1,409 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_REORDER_DEFS_INC_)
+#define OPENNURBS_MESH_REORDER_DEFS_INC_
+
+// Number of distinct vertices of a face that has valid vertex indices or 0.
+inline unsigned int ON_MeshReorderFaceVertexCount(const ON_MeshFace& f, unsigned int vertex_count)
+{
+  for (int k = 0; k < 4; ++k)
+  {
+    if (f.vi[k] < 0 || (unsigned int)f.vi[k] >= vertex_count)
+      return 0;
+  }
+  return (f.vi[2] != f.vi[3]) ? 4U : 3U;
+}
+
+inline double ON_MeshReorder::ACMR(const ON_Mesh& mesh, unsigned int cache_size)
+{
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (0 == vertex_count || 0 == face_count || cache_size < 1)
+    return 0.0;
+
+  // A vertex is in the FIFO cache when time - cache_time[vi] < cache_size.
+  ON_SimpleArray<ON__UINT64> cache_time(vertex_count);
+  cache_time.SetCount((int)vertex_count);
+  cache_time.Zero();
+  ON__UINT64* C = cache_time.Array();
+  ON__UINT64 time = cache_size + 1;
+  ON__UINT64 miss_count = 0;
+  ON__UINT64 triangle_count = 0;
+
+  const ON_MeshFace* F = mesh.m_F.Array();
+  for (unsigned int fi = 0; fi < face_count; ++fi)
+  {
+    const unsigned int n = ON_MeshReorderFaceVertexCount(F[fi], vertex_count);
+    if (0 == n)
+      continue;
+    triangle_count += n - 2;
+    for (unsigned int k = 0; k < n; ++k)
+    {
+      const unsigned int vi = (unsigned int)F[fi].vi[k];
+      if (time - C[vi] >= cache_size)
+      {
+        C[vi] = time++;
+        miss_count++;
+      }
+    }
+  }
+  return (triangle_count > 0) ? ((double)miss_count / (double)triangle_count) : 0.0;
+}
+
+inline bool ON_MeshReorder::GetFaceOrder(
+  const ON_Mesh& mesh,
+  unsigned int cache_size,
+  ON_SimpleArray<unsigned int>& face_order
+  )
+{
+  face_order.SetCount(0);
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (0 == vertex_count || 0 == face_count || cache_size < 4)
+    return false;
+  const ON_MeshFace* F = mesh.m_F.Array();
+
+  // Vertex to face map. The faces that use vertex vi are
+  // VF[VF_offset[vi]] ... VF[VF_offset[vi+1]-1].
+  ON_SimpleArray<unsigned int> vf_offset((size_t)vertex_count + 1);
+  vf_offset.SetCount((int)vertex_count + 1);
+  vf_offset.Zero();
+  unsigned int* VF_offset = vf_offset.Array();
+  for (unsigned int fi = 0; fi < face_count; ++fi)
+  {
+    const unsigned int n = ON_MeshReorderFaceVertexCount(F[fi], vertex_count);
+    for (unsigned int k = 0; k < n; ++k)
+      VF_offset[F[fi].vi[k] + 1]++;
+  }
+  for (unsigned int vi = 0; vi < vertex_count; ++vi)
+    VF_offset[vi + 1] += VF_offset[vi];
+  ON_SimpleArray<unsigned int> vf(VF_offset[vertex_count]);
+  vf.SetCount((int)VF_offset[vertex_count]);
+  unsigned int* VF = vf.Array();
+  {
+    ON_SimpleArray<unsigned int> fill(vf_offset);
+    unsigned int* next = fill.Array();
+    for (unsigned int fi = 0; fi < face_count; ++fi)
+    {
+      const unsigned int n = ON_MeshReorderFaceVertexCount(F[fi], vertex_count);
+      for (unsigned int k = 0; k < n; ++k)
+        VF[next[F[fi].vi[k]]++] = fi;
+    }
+  }
+
+  // live[vi] = number of faces that use vi and are not in face_order[] yet
+  ON_SimpleArray<unsigned int> live((size_t)vertex_count);
+  live.SetCount((int)vertex_count);
+  unsigned int* L = live.Array();
+  for (unsigned int vi = 0; vi < vertex_count; ++vi)
+    L[vi] = VF_offset[vi + 1] - VF_offset[vi];
+
+  ON_SimpleArray<ON__UINT64> cache_time(vertex_count);
+  cache_time.SetCount((int)vertex_count);
+  cache_time.Zero();
+  ON__UINT64* C = cache_time.Array();
+  ON__UINT64 time = cache_size + 1;
+
+  ON_SimpleArray<ON__UINT8> emitted(face_count);
+  emitted.SetCount((int)face_count);
+  emitted.Zero();
+  ON__UINT8* E = emitted.Array();
+
+  face_order.Reserve(face_count);
+  ON_SimpleArray<unsigned int> dead_end(VF_offset[vertex_count]);
+  ON_SimpleArray<unsigned int> candidates(64);
+
+  // Tipsify: emit every remaining face around the fanning vertex and then
+  // pick the next fanning vertex from the vertices of those faces,
+  // preferring a vertex that will still be in the cache after its
+  // remaining faces are emitted.
+  unsigned int cursor = 0;
+  unsigned int fan = 0;
+  for (;;)
+  {
+    candidates.SetCount(0);
+    for (unsigned int j = VF_offset[fan]; j < VF_offset[fan + 1]; ++j)
+    {
+      const unsigned int fi = VF[j];
+      if (0 != E[fi])
+        continue;
+      E[fi] = 1;
+      face_order.Append(fi);
+      const unsigned int n = ON_MeshReorderFaceVertexCount(F[fi], vertex_count);
+      for (unsigned int k = 0; k < n; ++k)
+      {
+        const unsigned int vi = (unsigned int)F[fi].vi[k];
+        dead_end.Append(vi);
+        candidates.Append(vi);
+        L[vi]--;
+        if (time - C[vi] >= cache_size)
+          C[vi] = time++;
+      }
+    }
+
+    fan = ON_UNSET_UINT_INDEX;
+    ON__UINT64 best_priority = 0;
+    for (unsigned int i = 0; i < candidates.UnsignedCount(); ++i)
+    {
+      const unsigned int vi = candidates[i];
+      if (0 == L[vi])
+        continue;
+      // vertices that stay in the cache are preferred, oldest first
+      ON__UINT64 priority = 1;
+      if (time - C[vi] + 2 * (ON__UINT64)L[vi] <= cache_size)
+        priority += time - C[vi];
+      if (priority > best_priority)
+      {
+        best_priority = priority;
+        fan = vi;
+      }
+    }
+
+    if (ON_UNSET_UINT_INDEX == fan)
+    {
+      // dead end - use a recently used vertex or the next unfinished vertex
+      while (dead_end.UnsignedCount() > 0)
+      {
+        const unsigned int vi = *dead_end.Last();
+        dead_end.Remove();
+        if (L[vi] > 0)
+        {
+          fan = vi;
+          break;
+        }
+      }
+      while (ON_UNSET_UINT_INDEX == fan && cursor < vertex_count)
+      {
+        if (L[cursor] > 0)
+          fan = cursor;
+        cursor++;
+      }
+      if (ON_UNSET_UINT_INDEX == fan)
+        break;
+    }
+  }
+
+  // faces with invalid vertex indices go at the end
+  for (unsigned int fi = 0; fi < face_count; ++fi)
+  {
+    if (0 == E[fi])
+      face_order.Append(fi);
+  }
+
+  return (face_order.UnsignedCount() == face_count);
+}
+
+inline bool ON_MeshReorder::GetVertexOrder(
+  const ON_Mesh& mesh,
+  ON_SimpleArray<unsigned int>& vertex_order
+  )
+{
+  vertex_order.SetCount(0);
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (0 == vertex_count)
+    return false;
+
+  ON_SimpleArray<ON__UINT8> used(vertex_count);
+  used.SetCount((int)vertex_count);
+  used.Zero();
+  ON__UINT8* U = used.Array();
+  vertex_order.Reserve(vertex_count);
+
+  const ON_MeshFace* F = mesh.m_F.Array();
+  for (unsigned int fi = 0; fi < face_count; ++fi)
+  {
+    const unsigned int n = ON_MeshReorderFaceVertexCount(F[fi], vertex_count);
+    for (unsigned int k = 0; k < n; ++k)
+    {
+      const unsigned int vi = (unsigned int)F[fi].vi[k];
+      if (0 == U[vi])
+      {
+        U[vi] = 1;
+        vertex_order.Append(vi);
+      }
+    }
+  }
+  for (unsigned int vi = 0; vi < vertex_count; ++vi)
+  {
+    if (0 == U[vi])
+      vertex_order.Append(vi);
+  }
+
+  return true;
+}
+
+inline bool ON_MeshReorder::Internal_Invert(
+  const unsigned int* order,
+  unsigned int count,
+  ON_SimpleArray<unsigned int>& inverse
+  )
+{
+  inverse.SetCount(0);
+  if (nullptr == order)
+    return false;
+  inverse.Reserve(count);
+  inverse.SetCount((int)count);
+  memset(inverse.Array(), 0xFF, count * sizeof(unsigned int));
+  unsigned int* inv = inverse.Array();
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    if (order[i] >= count || ON_UNSET_UINT_INDEX != inv[order[i]])
+    {
+      inverse.SetCount(0);
+      return false;
+    }
+    inv[order[i]] = i;
+  }
+  return true;
+}
+
+template <class T>
+inline void ON_MeshReorder::Internal_Permute(
+  ON_SimpleArray<T>& a,
+  const unsigned int* order,
+  unsigned int count
+  )
+{
+  if (a.UnsignedCount() != count)
+    return;
+  ON_SimpleArray<T> tmp(count);
+  tmp.SetCount((int)count);
+  const T* src = a.Array();
+  T* dst = tmp.Array();
+  for (unsigned int i = 0; i < count; ++i)
+    dst[i] = src[order[i]];
+  memcpy((void*)a.Array(), (const void*)dst, count * sizeof(T));
+}
+
+inline bool ON_MeshReorder::PermuteFaces(ON_Mesh& mesh, const unsigned int* face_order)
+{
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  ON_SimpleArray<unsigned int> inverse;
+  if (!Internal_Invert(face_order, face_count, inverse))
+    return false;
+
+  Internal_Permute(mesh.m_F, face_order, face_count);
+  Internal_Permute<ON_3fVector>(mesh.m_FN, face_order, face_count);
+  const bool bNgonMapIsValid = (mesh.m_NgonMap.UnsignedCount() == face_count);
+  if (bNgonMapIsValid)
+    Internal_Permute(mesh.m_NgonMap, face_order, face_count);
+
+  const unsigned int* inv = inverse.Array();
+  const unsigned int ngon_count = mesh.m_Ngon.UnsignedCount();
+  for (unsigned int ni = 0; ni < ngon_count; ++ni)
+  {
+    ON_MeshNgon* ngon = mesh.m_Ngon[ni];
+    if (nullptr == ngon || nullptr == ngon->m_fi)
+      continue;
+    for (unsigned int j = 0; j < ngon->m_Fcount; ++j)
+    {
+      if (ngon->m_fi[j] < face_count)
+        ngon->m_fi[j] = inv[ngon->m_fi[j]];
+    }
+  }
+
+  if (!bNgonMapIsValid && mesh.m_NgonMap.Count() > 0)
+  {
+    // The stale map cannot be permuted.
+    if (ngon_count > 0)
+      mesh.CreateNgonMap();
+    else
+      mesh.RemoveNgonMap();
+  }
+
+  mesh.DestroyTopology();
+  mesh.DestroyPartition();
+  mesh.DestroyTree();
+  return true;
+}
+
+inline bool ON_MeshReorder::PermuteVertices(ON_Mesh& mesh, const unsigned int* vertex_order)
+{
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  ON_SimpleArray<unsigned int> inverse;
+  if (!Internal_Invert(vertex_order, vertex_count, inverse))
+    return false;
+
+  Internal_Permute<ON_3fPoint>(mesh.m_V, vertex_order, vertex_count);
+  Internal_Permute<ON_3dPoint>(mesh.m_dV, vertex_order, vertex_count);
+  Internal_Permute<ON_3fVector>(mesh.m_N, vertex_order, vertex_count);
+  Internal_Permute<ON_2fPoint>(mesh.m_T, vertex_order, vertex_count);
+  Internal_Permute<ON_2dPoint>(mesh.m_S, vertex_order, vertex_count);
+  Internal_Permute(mesh.m_K, vertex_order, vertex_count);
+  Internal_Permute(mesh.m_C, vertex_order, vertex_count);
+  Internal_Permute(mesh.m_H, vertex_order, vertex_count);
+  for (int i = 0; i < mesh.m_TC.Count(); ++i)
+    Internal_Permute(mesh.m_TC[i].m_T, vertex_order, vertex_count);
+
+  const unsigned int* inv = inverse.Array();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  ON_MeshFace* F = mesh.m_F.Array();
+  for (unsigned int fi = 0; fi < face_count; ++fi)
+  {
+    for (int k = 0; k < 4; ++k)
+    {
+      if (F[fi].vi[k] >= 0 && (unsigned int)F[fi].vi[k] < vertex_count)
+        F[fi].vi[k] = (int)inv[F[fi].vi[k]];
+    }
+  }
+
+  const unsigned int ngon_count = mesh.m_Ngon.UnsignedCount();
+  for (unsigned int ni = 0; ni < ngon_count; ++ni)
+  {
+    ON_MeshNgon* ngon = mesh.m_Ngon[ni];
+    if (nullptr == ngon || nullptr == ngon->m_vi)
+      continue;
+    for (unsigned int j = 0; j < ngon->m_Vcount; ++j)
+    {
+      if (ngon->m_vi[j] < vertex_count)
+        ngon->m_vi[j] = inv[ngon->m_vi[j]];
+    }
+  }
+
+  mesh.DestroyTopology();
+  mesh.DestroyPartition();
+  mesh.DestroyTree();
+  return true;
+}
+
+inline bool ON_MeshReorder::Optimize(
+  ON_Mesh& mesh,
+  unsigned int cache_size,
+  double* acmr_before,
+  double* acmr_after
+  )
+{
+  if (nullptr != acmr_before)
+    *acmr_before = ACMR(mesh, cache_size);
+  if (nullptr != acmr_after)
+    *acmr_after = (nullptr != acmr_before) ? *acmr_before : ACMR(mesh, cache_size);
+
+  ON_SimpleArray<unsigned int> order;
+  if (!GetFaceOrder(mesh, cache_size, order))
+    return false;
+  if (!PermuteFaces(mesh, order.Array()))
+    return false;
+  if (!GetVertexOrder(mesh, order))
+    return false;
+  if (!PermuteVertices(mesh, order.Array()))
+    return false;
+
+  // The vertex order does not change the cache misses.
+  if (nullptr != acmr_after)
+    *acmr_after = ACMR(mesh, cache_size);
+  return true;
+}
+
+#endif
@@ -0,0 +1,299 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_SOA_INC_)
+#define OPENNURBS_MESH_SOA_INC_
+
+/*
+Description:
+  ON_MeshVertexSoA is a structure of arrays copy of mesh vertex
+  locations. The x, y and z coordinates are stored in three separate
+  double precision arrays that are aligned on 32 byte boundaries.
+  GetBoundingBox(), Transform(), ComputeFaceNormals() and the
+  TransformPointList() functions process two values per instruction
+  with SSE2 or NEON when they are available. ComputeVertexNormals()
+  gathers the face normals of each vertex on multiple threads and
+  does not use SIMD instructions. Every function with a bMultithreaded
+  parameter runs on the calling thread when it is false.
+Remarks:
+  SetFromMesh() copies the mesh vertices, Synchronize() copies them
+  when the copy may be out of date and CopyToMesh() copies the values
+  back to m_V[] and m_dV[]. Checking whether the copy is out of date
+  does not read the vertices, so code that changes the mesh vertex
+  locations in place must call Invalidate().
+Example:
+
+        ON_MeshVertexSoA soa;
+        soa.Synchronize(mesh);
+        soa.Transform(xform);
+        soa.CopyToMesh(mesh);
+
+        // After mesh.m_V[] or mesh.m_dV[] is modified
+        soa.Invalidate();
+
+*/
+class ON_MeshVertexSoA
+{
+public:
+  ON_MeshVertexSoA() = default;
+  ~ON_MeshVertexSoA();
+  ON_MeshVertexSoA(const ON_MeshVertexSoA& src);
+  ON_MeshVertexSoA& operator=(const ON_MeshVertexSoA& src);
+  ON_MeshVertexSoA(ON_MeshVertexSoA&& src) ON_NOEXCEPT;
+  ON_MeshVertexSoA& operator=(ON_MeshVertexSoA&& src) ON_NOEXCEPT;
+
+  /*
+  Description:
+    Free the coordinate arrays and set the count to zero.
+  */
+  void Destroy();
+
+  /*
+  Description:
+    Set the number of points. Existing coordinates are kept,
+    new coordinates are not initialized.
+  Returns:
+    True if successful.
+  */
+  bool SetCount(
+    size_t count
+    );
+
+  size_t Count() const;
+
+  /*
+  Returns:
+    Pointers to the coordinate arrays. The arrays are aligned on 32
+    byte boundaries and have room for at least Count() rounded up
+    to a multiple of 4 values.
+  */
+  double* X();
+  double* Y();
+  double* Z();
+  const double* X() const;
+  const double* Y() const;
+  const double* Z() const;
+
+  ON_3dPoint Point(
+    size_t i
+    ) const;
+
+  void SetPoint(
+    size_t i,
+    const ON_3dPoint& P
+    );
+
+  /*
+  Description:
+    Copy the mesh vertex locations. When the mesh has double precision
+    vertices, m_dV[] is copied, otherwise m_V[] is copied.
+  Parameters:
+    mesh - [in]
+    bMultithreaded - [in]
+      If true and the mesh is large, the copy is done on multiple threads.
+  Returns:
+    True if successful.
+  */
+  bool SetFromMesh(
+    const class ON_Mesh& mesh,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Returns:
+    True if the last SetFromMesh() or CopyToMesh() used this mesh, the
+    vertex count is the same, the vertex array has not been reallocated
+    and Invalidate() has not been called since.
+  Remarks:
+    This is a constant time test. Vertex locations that are changed in
+    place are not detected; call Invalidate() after changing them.
+  */
+  bool IsSynchronized(
+    const class ON_Mesh& mesh
+    ) const;
+
+  /*
+  Description:
+    Call when the mesh vertex locations are changed. The next
+    Synchronize() copies the vertices again.
+  */
+  void Invalidate();
+
+  /*
+  Description:
+    Calls SetFromMesh() if IsSynchronized() is false.
+  Returns:
+    True if successful.
+  */
+  bool Synchronize(
+    const class ON_Mesh& mesh,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Copy the coordinates to mesh.m_V[] and, if the mesh has double precision
+    vertices, to mesh.m_dV[]. The mesh bounding boxes and mesh tree are
+    invalidated.
+  Parameters:
+    mesh - [in/out]
+    bMultithreaded - [in]
+      If true and the mesh is large, the copy is done on multiple threads.
+  Returns:
+    True if successful. False if Count() is not the mesh vertex count.
+  */
+  bool CopyToMesh(
+    class ON_Mesh& mesh,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Get the bounding box of the points.
+  Parameters:
+    bbox - [in/out]
+    bGrowBox - [in]
+      If true and bbox is valid, the input bbox is enlarged.
+    bMultithreaded - [in]
+      If true and Count() is large, the work is done on multiple threads.
+  Returns:
+    True if Count() > 0 or the input bbox was grown.
+  */
+  bool GetBoundingBox(
+    ON_BoundingBox& bbox,
+    bool bGrowBox = false,
+    bool bMultithreaded = true
+    ) const;
+
+  /*
+  Description:
+    Apply a transformation to the points.
+  Parameters:
+    xform - [in]
+    bMultithreaded - [in]
+  Returns:
+    True if successful.
+  */
+  bool Transform(
+    const ON_Xform& xform,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Calculate mesh.m_FN[] from these points and mesh.m_F[].
+    The face normal is the unitized cross product of the face diagonals,
+    the same as ON_MeshFace::ComputeFaceNormal().
+  Parameters:
+    mesh - [in/out]
+      The mesh vertex count must be Count().
+    bMultithreaded - [in]
+  Returns:
+    True if every face normal could be calculated.
+    Degenerate faces get a zero normal.
+  */
+  bool ComputeFaceNormals(
+    class ON_Mesh& mesh,
+    bool bMultithreaded = true
+    ) const;
+
+  /*
+  Description:
+    Calculate mesh.m_N[]. The vertex normal is the unitized sum of the
+    normals of the faces that use the vertex. If mesh.m_FN[] is not
+    set, ComputeFaceNormals() is called first. The face normals of a
+    vertex are added in face order, so the result does not depend on
+    the thread count.
+  Parameters:
+    mesh - [in/out]
+      The mesh vertex count must be Count().
+    bMultithreaded - [in]
+  Returns:
+    True if successful.
+  */
+  bool ComputeVertexNormals(
+    class ON_Mesh& mesh,
+    bool bMultithreaded = true
+    ) const;
+
+  /*
+  Description:
+    Transform points stored as separate x, y and z arrays.
+  Parameters:
+    xform - [in]
+    count - [in]
+    x - [in/out]
+    y - [in/out]
+    z - [in/out]
+    bMultithreaded - [in]
+  Returns:
+    True if successful.
+  Remarks:
+    When the bottom row of xform is not (0,0,0,1), the results are
+    divided by the homogeneous coordinate, like ON_TransformPointList().
+  */
+  static bool TransformPointList(
+    const ON_Xform& xform,
+    size_t count,
+    double* x,
+    double* y,
+    double* z,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    A faster version of ON_TransformPointList(3,false,count,3,points,xform)
+    for large arrays of 3d points. For affine transformations, x and y of
+    each point are calculated with one two lane SIMD operation.
+  */
+  static bool TransformPointList(
+    const ON_Xform& xform,
+    size_t count,
+    ON_3dPoint* points,
+    bool bMultithreaded = true
+    );
+
+  static bool TransformPointList(
+    const ON_Xform& xform,
+    size_t count,
+    ON_3fPoint* points,
+    bool bMultithreaded = true
+    );
+
+private:
+  void Internal_SetSource(
+    const class ON_Mesh& mesh
+    );
+
+  // The vertex array that SetFromMesh() copies.
+  static const void* Internal_SourceVertices(
+    const class ON_Mesh& mesh
+    );
+
+  void* m_buffer = nullptr;
+  double* m_x = nullptr;
+  double* m_y = nullptr;
+  double* m_z = nullptr;
+  size_t m_count = 0;
+  size_t m_capacity = 0;
+
+  // values used by IsSynchronized()
+  unsigned int m_source_count = 0;
+  const class ON_Mesh* m_source_mesh = nullptr;
+  const void* m_source_vertices = nullptr;
+};
+
+#include "opennurbs_mesh_soa_defs.h"
+
+#endif
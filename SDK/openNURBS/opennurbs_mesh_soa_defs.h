@@ -0,0 +1,838 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_SOA_DEFS_INC_)
+#define OPENNURBS_MESH_SOA_DEFS_INC_
+
+////////////////////////////////////////////////////////////////
+//
+// Two lane double precision tools used by the ON_MeshVertexSoA kernels.
+//
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ON_MESH_SOA_SSE2
+#include <emmintrin.h>
+
+typedef __m128d ON_MeshSoA2d;
+inline ON_MeshSoA2d ON_MeshSoA2dLoad(const double* p) { return _mm_loadu_pd(p); }
+inline void ON_MeshSoA2dStore(double* p, ON_MeshSoA2d a) { _mm_storeu_pd(p, a); }
+inline ON_MeshSoA2d ON_MeshSoA2dSet(double a0, double a1) { return _mm_set_pd(a1, a0); }
+inline ON_MeshSoA2d ON_MeshSoA2dSet1(double a) { return _mm_set1_pd(a); }
+inline ON_MeshSoA2d ON_MeshSoA2dAdd(ON_MeshSoA2d a, ON_MeshSoA2d b) { return _mm_add_pd(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dSub(ON_MeshSoA2d a, ON_MeshSoA2d b) { return _mm_sub_pd(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dMul(ON_MeshSoA2d a, ON_MeshSoA2d b) { return _mm_mul_pd(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dMin(ON_MeshSoA2d a, ON_MeshSoA2d b) { return _mm_min_pd(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dMax(ON_MeshSoA2d a, ON_MeshSoA2d b) { return _mm_max_pd(a, b); }
+
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ON_MESH_SOA_NEON
+#include <arm_neon.h>
+
+typedef float64x2_t ON_MeshSoA2d;
+inline ON_MeshSoA2d ON_MeshSoA2dLoad(const double* p) { return vld1q_f64(p); }
+inline void ON_MeshSoA2dStore(double* p, ON_MeshSoA2d a) { vst1q_f64(p, a); }
+inline ON_MeshSoA2d ON_MeshSoA2dSet(double a0, double a1) { return vcombine_f64(vdup_n_f64(a0), vdup_n_f64(a1)); }
+inline ON_MeshSoA2d ON_MeshSoA2dSet1(double a) { return vdupq_n_f64(a); }
+inline ON_MeshSoA2d ON_MeshSoA2dAdd(ON_MeshSoA2d a, ON_MeshSoA2d b) { return vaddq_f64(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dSub(ON_MeshSoA2d a, ON_MeshSoA2d b) { return vsubq_f64(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dMul(ON_MeshSoA2d a, ON_MeshSoA2d b) { return vmulq_f64(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dMin(ON_MeshSoA2d a, ON_MeshSoA2d b) { return vminq_f64(a, b); }
+inline ON_MeshSoA2d ON_MeshSoA2dMax(ON_MeshSoA2d a, ON_MeshSoA2d b) { return vmaxq_f64(a, b); }
+
+#else
+
+struct ON_MeshSoA2d { double v[2]; };
+inline ON_MeshSoA2d ON_MeshSoA2dLoad(const double* p) { ON_MeshSoA2d r = { { p[0], p[1] } }; return r; }
+inline void ON_MeshSoA2dStore(double* p, ON_MeshSoA2d a) { p[0] = a.v[0]; p[1] = a.v[1]; }
+inline ON_MeshSoA2d ON_MeshSoA2dSet(double a0, double a1) { ON_MeshSoA2d r = { { a0, a1 } }; return r; }
+inline ON_MeshSoA2d ON_MeshSoA2dSet1(double a) { ON_MeshSoA2d r = { { a, a } }; return r; }
+inline ON_MeshSoA2d ON_MeshSoA2dAdd(ON_MeshSoA2d a, ON_MeshSoA2d b) { ON_MeshSoA2d r = { { a.v[0] + b.v[0], a.v[1] + b.v[1] } }; return r; }
+inline ON_MeshSoA2d ON_MeshSoA2dSub(ON_MeshSoA2d a, ON_MeshSoA2d b) { ON_MeshSoA2d r = { { a.v[0] - b.v[0], a.v[1] - b.v[1] } }; return r; }
+inline ON_MeshSoA2d ON_MeshSoA2dMul(ON_MeshSoA2d a, ON_MeshSoA2d b) { ON_MeshSoA2d r = { { a.v[0] * b.v[0], a.v[1] * b.v[1] } }; return r; }
+inline ON_MeshSoA2d ON_MeshSoA2dMin(ON_MeshSoA2d a, ON_MeshSoA2d b) { ON_MeshSoA2d r = { { (b.v[0] < a.v[0]) ? b.v[0] : a.v[0], (b.v[1] < a.v[1]) ? b.v[1] : a.v[1] } }; return r; }
+inline ON_MeshSoA2d ON_MeshSoA2dMax(ON_MeshSoA2d a, ON_MeshSoA2d b) { ON_MeshSoA2d r = { { (b.v[0] > a.v[0]) ? b.v[0] : a.v[0], (b.v[1] > a.v[1]) ? b.v[1] : a.v[1] } }; return r; }
+
+#endif
+
+// Minimum number of points per thread used by the ON_MeshVertexSoA kernels.
+#define ON_MESH_SOA_MIN_POINTS_PER_THREAD 0x8000
+
+/*
+Description:
+  Unitize (x,y,z) the same way ON_3dVector::Unitize() does.
+Returns:
+  False and sets (x,y,z) to zero when the vector cannot be unitized.
+*/
+inline bool ON_MeshSoAUnitize(double& x, double& y, double& z)
+{
+  const double len2 = x * x + y * y + z * z;
+  if (len2 > ON_DBL_MIN && len2 < ON_DBL_MAX)
+  {
+    const double s = 1.0 / sqrt(len2);
+    x *= s;
+    y *= s;
+    z *= s;
+    return true;
+  }
+  // tiny or huge components need the careful scaling in Unitize()
+  ON_3dVector V(x, y, z);
+  const bool rc = V.Unitize();
+  if (!rc)
+    V = ON_3dVector::ZeroVector;
+  x = V.x;
+  y = V.y;
+  z = V.z;
+  return rc;
+}
+
+// Transform x[i0,i1), y[i0,i1), z[i0,i1) by an affine xform.
+inline void ON_MeshSoATransformAffine(
+  const ON_Xform& xform,
+  size_t i0,
+  size_t i1,
+  double* x,
+  double* y,
+  double* z
+  )
+{
+  const double(*m)[4] = xform.m_xform;
+  ON_MeshSoA2d M[3][4];
+  for (int r = 0; r < 3; ++r)
+    for (int c = 0; c < 4; ++c)
+      M[r][c] = ON_MeshSoA2dSet1(m[r][c]);
+
+  size_t i = i0;
+  for (/*empty*/; i + 2 <= i1; i += 2)
+  {
+    const ON_MeshSoA2d X = ON_MeshSoA2dLoad(x + i);
+    const ON_MeshSoA2d Y = ON_MeshSoA2dLoad(y + i);
+    const ON_MeshSoA2d Z = ON_MeshSoA2dLoad(z + i);
+    ON_MeshSoA2d R[3];
+    for (int r = 0; r < 3; ++r)
+    {
+      R[r] = ON_MeshSoA2dAdd(
+        ON_MeshSoA2dAdd(ON_MeshSoA2dMul(M[r][0], X), ON_MeshSoA2dMul(M[r][1], Y)),
+        ON_MeshSoA2dAdd(ON_MeshSoA2dMul(M[r][2], Z), M[r][3])
+      );
+    }
+    ON_MeshSoA2dStore(x + i, R[0]);
+    ON_MeshSoA2dStore(y + i, R[1]);
+    ON_MeshSoA2dStore(z + i, R[2]);
+  }
+  for (/*empty*/; i < i1; ++i)
+  {
+    const double X = x[i], Y = y[i], Z = z[i];
+    x[i] = (m[0][0] * X + m[0][1] * Y) + (m[0][2] * Z + m[0][3]);
+    y[i] = (m[1][0] * X + m[1][1] * Y) + (m[1][2] * Z + m[1][3]);
+    z[i] = (m[2][0] * X + m[2][1] * Y) + (m[2][2] * Z + m[2][3]);
+  }
+}
+
+// Transform one point by a projective xform the way ON_TransformPointList() does.
+inline void ON_MeshSoATransformProjective(
+  const ON_Xform& xform,
+  double& x,
+  double& y,
+  double& z
+  )
+{
+  const double(*m)[4] = xform.m_xform;
+  const double X = x, Y = y, Z = z;
+  double w = m[3][0] * X + m[3][1] * Y + m[3][2] * Z + m[3][3];
+  w = (0.0 != w) ? 1.0 / w : 1.0;
+  x = w * (m[0][0] * X + m[0][1] * Y + m[0][2] * Z + m[0][3]);
+  y = w * (m[1][0] * X + m[1][1] * Y + m[1][2] * Z + m[1][3]);
+  z = w * (m[2][0] * X + m[2][1] * Y + m[2][2] * Z + m[2][3]);
+}
+
+inline bool ON_MeshSoAIsAffine(
+  const ON_Xform& xform
+  )
+{
+  return (0.0 == xform.m_xform[3][0] && 0.0 == xform.m_xform[3][1]
+    && 0.0 == xform.m_xform[3][2] && 1.0 == xform.m_xform[3][3]);
+}
+
+////////////////////////////////////////////////////////////////
+//
+// ON_MeshVertexSoA implementation
+//
+
+inline ON_MeshVertexSoA::~ON_MeshVertexSoA()
+{
+  Destroy();
+}
+
+inline ON_MeshVertexSoA::ON_MeshVertexSoA(const ON_MeshVertexSoA& src)
+{
+  *this = src;
+}
+
+inline ON_MeshVertexSoA& ON_MeshVertexSoA::operator=(const ON_MeshVertexSoA& src)
+{
+  if (this != &src)
+  {
+    if (SetCount(src.m_count) && m_count > 0)
+    {
+      memcpy(m_x, src.m_x, m_count * sizeof(m_x[0]));
+      memcpy(m_y, src.m_y, m_count * sizeof(m_y[0]));
+      memcpy(m_z, src.m_z, m_count * sizeof(m_z[0]));
+    }
+    m_source_count = src.m_source_count;
+    m_source_mesh = src.m_source_mesh;
+    m_source_vertices = src.m_source_vertices;
+  }
+  return *this;
+}
+
+inline ON_MeshVertexSoA::ON_MeshVertexSoA(ON_MeshVertexSoA&& src) ON_NOEXCEPT
+{
+  *this = std::move(src);
+}
+
+inline ON_MeshVertexSoA& ON_MeshVertexSoA::operator=(ON_MeshVertexSoA&& src) ON_NOEXCEPT
+{
+  if (this != &src)
+  {
+    Destroy();
+    m_buffer = src.m_buffer;
+    m_x = src.m_x;
+    m_y = src.m_y;
+    m_z = src.m_z;
+    m_count = src.m_count;
+    m_capacity = src.m_capacity;
+    m_source_count = src.m_source_count;
+    m_source_mesh = src.m_source_mesh;
+    m_source_vertices = src.m_source_vertices;
+    src.m_buffer = nullptr;
+    src.m_x = nullptr;
+    src.m_y = nullptr;
+    src.m_z = nullptr;
+    src.m_count = 0;
+    src.m_capacity = 0;
+    src.m_source_count = 0;
+    src.m_source_mesh = nullptr;
+    src.m_source_vertices = nullptr;
+  }
+  return *this;
+}
+
+inline void ON_MeshVertexSoA::Destroy()
+{
+  if (nullptr != m_buffer)
+    onfree(m_buffer);
+  m_buffer = nullptr;
+  m_x = nullptr;
+  m_y = nullptr;
+  m_z = nullptr;
+  m_count = 0;
+  m_capacity = 0;
+  Invalidate();
+}
+
+inline bool ON_MeshVertexSoA::SetCount(size_t count)
+{
+  if (count > m_capacity)
+  {
+    // Each array holds a multiple of 4 doubles, so all three arrays
+    // start on a 32 byte boundary.
+    const size_t capacity = (count + 3) & ~((size_t)3);
+    void* buffer = onmalloc(3 * capacity * sizeof(double) + 31);
+    if (nullptr == buffer)
+      return false;
+    double* x = (double*)((((ON__UINT_PTR)buffer) + 31) & ~((ON__UINT_PTR)31));
+    double* y = x + capacity;
+    double* z = y + capacity;
+    if (m_count > 0)
+    {
+      memcpy(x, m_x, m_count * sizeof(x[0]));
+      memcpy(y, m_y, m_count * sizeof(y[0]));
+      memcpy(z, m_z, m_count * sizeof(z[0]));
+    }
+    if (nullptr != m_buffer)
+      onfree(m_buffer);
+    m_buffer = buffer;
+    m_x = x;
+    m_y = y;
+    m_z = z;
+    m_capacity = capacity;
+  }
+  m_count = count;
+  return true;
+}
+
+inline size_t ON_MeshVertexSoA::Count() const { return m_count; }
+inline double* ON_MeshVertexSoA::X() { return m_x; }
+inline double* ON_MeshVertexSoA::Y() { return m_y; }
+inline double* ON_MeshVertexSoA::Z() { return m_z; }
+inline const double* ON_MeshVertexSoA::X() const { return m_x; }
+inline const double* ON_MeshVertexSoA::Y() const { return m_y; }
+inline const double* ON_MeshVertexSoA::Z() const { return m_z; }
+
+inline ON_3dPoint ON_MeshVertexSoA::Point(size_t i) const
+{
+  return (i < m_count) ? ON_3dPoint(m_x[i], m_y[i], m_z[i]) : ON_3dPoint::UnsetPoint;
+}
+
+inline void ON_MeshVertexSoA::SetPoint(size_t i, const ON_3dPoint& P)
+{
+  if (i < m_count)
+  {
+    m_x[i] = P.x;
+    m_y[i] = P.y;
+    m_z[i] = P.z;
+  }
+}
+
+inline const void* ON_MeshVertexSoA::Internal_SourceVertices(const ON_Mesh& mesh)
+{
+  return mesh.HasDoublePrecisionVertices()
+    ? (const void*)mesh.m_dV.Array()
+    : (const void*)mesh.m_V.Array();
+}
+
+inline void ON_MeshVertexSoA::Internal_SetSource(const ON_Mesh& mesh)
+{
+  m_source_count = mesh.VertexUnsignedCount();
+  m_source_mesh = &mesh;
+  m_source_vertices = ON_MeshVertexSoA::Internal_SourceVertices(mesh);
+}
+
+inline void ON_MeshVertexSoA::Invalidate()
+{
+  m_source_count = 0;
+  m_source_mesh = nullptr;
+  m_source_vertices = nullptr;
+}
+
+inline bool ON_MeshVertexSoA::SetFromMesh(const ON_Mesh& mesh, bool bMultithreaded)
+{
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  if (!SetCount(vertex_count))
+    return false;
+  const ON_3dPoint* dV = mesh.HasDoublePrecisionVertices() ? mesh.m_dV.Array() : nullptr;
+  const ON_3fPoint* fV = (nullptr == dV) ? mesh.m_V.Array() : nullptr;
+  double* x = m_x;
+  double* y = m_y;
+  double* z = m_z;
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(vertex_count, ON_MESH_SOA_MIN_POINTS_PER_THREAD)
+    : 1U;
+  ON_Parallel::ForRanges(vertex_count, thread_count,
+    [dV, fV, x, y, z](size_t i0, size_t i1, unsigned int)
+    {
+      if (nullptr != dV)
+      {
+        for (size_t i = i0; i < i1; ++i)
+        {
+          x[i] = dV[i].x;
+          y[i] = dV[i].y;
+          z[i] = dV[i].z;
+        }
+      }
+      else
+      {
+        for (size_t i = i0; i < i1; ++i)
+        {
+          x[i] = fV[i].x;
+          y[i] = fV[i].y;
+          z[i] = fV[i].z;
+        }
+      }
+    }
+  );
+  Internal_SetSource(mesh);
+  return true;
+}
+
+inline bool ON_MeshVertexSoA::IsSynchronized(const ON_Mesh& mesh) const
+{
+  return m_count == (size_t)mesh.VertexUnsignedCount()
+    && m_source_count == mesh.VertexUnsignedCount()
+    && m_source_mesh == &mesh
+    && m_source_vertices == ON_MeshVertexSoA::Internal_SourceVertices(mesh);
+}
+
+inline bool ON_MeshVertexSoA::Synchronize(const ON_Mesh& mesh, bool bMultithreaded)
+{
+  return IsSynchronized(mesh) ? true : SetFromMesh(mesh, bMultithreaded);
+}
+
+inline bool ON_MeshVertexSoA::CopyToMesh(ON_Mesh& mesh, bool bMultithreaded)
+{
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  if (m_count != (size_t)vertex_count)
+  {
+    ON_ERROR("Count() is not the mesh vertex count.");
+    return false;
+  }
+  if (0 == vertex_count)
+    return true;
+
+  const bool bDoublePrecision = mesh.HasDoublePrecisionVertices();
+  ON_3dPoint* dV = bDoublePrecision ? mesh.m_dV.Array() : nullptr;
+  ON_3fPoint* fV = bDoublePrecision ? nullptr : mesh.m_V.Array();
+  const double* x = m_x;
+  const double* y = m_y;
+  const double* z = m_z;
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(vertex_count, ON_MESH_SOA_MIN_POINTS_PER_THREAD)
+    : 1U;
+  ON_Parallel::ForRanges(vertex_count, thread_count,
+    [dV, fV, x, y, z](size_t i0, size_t i1, unsigned int)
+    {
+      if (nullptr != dV)
+      {
+        for (size_t i = i0; i < i1; ++i)
+        {
+          dV[i].x = x[i];
+          dV[i].y = y[i];
+          dV[i].z = z[i];
+        }
+      }
+      else
+      {
+        for (size_t i = i0; i < i1; ++i)
+        {
+          fV[i].x = (float)x[i];
+          fV[i].y = (float)y[i];
+          fV[i].z = (float)z[i];
+        }
+      }
+    }
+  );
+  if (bDoublePrecision)
+    mesh.UpdateSinglePrecisionVertices();
+  mesh.InvalidateBoundingBoxes();
+  mesh.DestroyTree();
+  Internal_SetSource(mesh);
+  return true;
+}
+
+inline bool ON_MeshVertexSoA::GetBoundingBox(ON_BoundingBox& bbox, bool bGrowBox, bool bMultithreaded) const
+{
+  if (bGrowBox && !bbox.IsValid())
+    bGrowBox = false;
+  if (0 == m_count)
+    return bGrowBox;
+
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(m_count, ON_MESH_SOA_MIN_POINTS_PER_THREAD)
+    : 1U;
+  double range_box[64][6];
+  const unsigned int range_count = (thread_count <= 64U) ? thread_count : 64U;
+  const double* x = m_x;
+  const double* y = m_y;
+  const double* z = m_z;
+  ON_Parallel::ForRanges(m_count, range_count,
+    [x, y, z, &range_box](size_t i0, size_t i1, unsigned int k)
+    {
+      double bmin[3] = { x[i0], y[i0], z[i0] };
+      double bmax[3] = { x[i0], y[i0], z[i0] };
+      size_t i = i0;
+      if (i + 2 <= i1)
+      {
+        ON_MeshSoA2d min_x = ON_MeshSoA2dLoad(x + i);
+        ON_MeshSoA2d min_y = ON_MeshSoA2dLoad(y + i);
+        ON_MeshSoA2d min_z = ON_MeshSoA2dLoad(z + i);
+        ON_MeshSoA2d max_x = min_x;
+        ON_MeshSoA2d max_y = min_y;
+        ON_MeshSoA2d max_z = min_z;
+        for (i += 2; i + 2 <= i1; i += 2)
+        {
+          const ON_MeshSoA2d X = ON_MeshSoA2dLoad(x + i);
+          const ON_MeshSoA2d Y = ON_MeshSoA2dLoad(y + i);
+          const ON_MeshSoA2d Z = ON_MeshSoA2dLoad(z + i);
+          min_x = ON_MeshSoA2dMin(min_x, X);
+          min_y = ON_MeshSoA2dMin(min_y, Y);
+          min_z = ON_MeshSoA2dMin(min_z, Z);
+          max_x = ON_MeshSoA2dMax(max_x, X);
+          max_y = ON_MeshSoA2dMax(max_y, Y);
+          max_z = ON_MeshSoA2dMax(max_z, Z);
+        }
+        double lanes[6][2];
+        ON_MeshSoA2dStore(lanes[0], min_x);
+        ON_MeshSoA2dStore(lanes[1], min_y);
+        ON_MeshSoA2dStore(lanes[2], min_z);
+        ON_MeshSoA2dStore(lanes[3], max_x);
+        ON_MeshSoA2dStore(lanes[4], max_y);
+        ON_MeshSoA2dStore(lanes[5], max_z);
+        for (int j = 0; j < 3; ++j)
+        {
+          bmin[j] = (lanes[j][1] < lanes[j][0]) ? lanes[j][1] : lanes[j][0];
+          bmax[j] = (lanes[3 + j][1] > lanes[3 + j][0]) ? lanes[3 + j][1] : lanes[3 + j][0];
+        }
+      }
+      for (/*empty*/; i < i1; ++i)
+      {
+        const double P[3] = { x[i], y[i], z[i] };
+        for (int j = 0; j < 3; ++j)
+        {
+          if (P[j] < bmin[j])
+            bmin[j] = P[j];
+          if (P[j] > bmax[j])
+            bmax[j] = P[j];
+        }
+      }
+      for (int j = 0; j < 3; ++j)
+      {
+        range_box[k][j] = bmin[j];
+        range_box[k][3 + j] = bmax[j];
+      }
+    }
+  );
+
+  const unsigned int used_range_count = (m_count < (size_t)range_count) ? (unsigned int)m_count : range_count;
+  double bmin[3], bmax[3];
+  for (int j = 0; j < 3; ++j)
+  {
+    bmin[j] = range_box[0][j];
+    bmax[j] = range_box[0][3 + j];
+  }
+  for (unsigned int k = 1; k < used_range_count; ++k)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      if (range_box[k][j] < bmin[j])
+        bmin[j] = range_box[k][j];
+      if (range_box[k][3 + j] > bmax[j])
+        bmax[j] = range_box[k][3 + j];
+    }
+  }
+  if (bGrowBox)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      if (bbox.m_min[j] < bmin[j])
+        bmin[j] = bbox.m_min[j];
+      if (bbox.m_max[j] > bmax[j])
+        bmax[j] = bbox.m_max[j];
+    }
+  }
+  bbox.m_min = ON_3dPoint(bmin);
+  bbox.m_max = ON_3dPoint(bmax);
+  return true;
+}
+
+inline bool ON_MeshVertexSoA::Transform(const ON_Xform& xform, bool bMultithreaded)
+{
+  return ON_MeshVertexSoA::TransformPointList(xform, m_count, m_x, m_y, m_z, bMultithreaded);
+}
+
+inline bool ON_MeshVertexSoA::TransformPointList(
+  const ON_Xform& xform,
+  size_t count,
+  double* x,
+  double* y,
+  double* z,
+  bool bMultithreaded
+  )
+{
+  if (0 == count)
+    return true;
+  if (nullptr == x || nullptr == y || nullptr == z)
+    return false;
+  const bool bAffine = ON_MeshSoAIsAffine(xform);
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(count, ON_MESH_SOA_MIN_POINTS_PER_THREAD)
+    : 1U;
+  ON_Parallel::ForRanges(count, thread_count,
+    [&xform, bAffine, x, y, z](size_t i0, size_t i1, unsigned int)
+    {
+      if (bAffine)
+        ON_MeshSoATransformAffine(xform, i0, i1, x, y, z);
+      else
+      {
+        for (size_t i = i0; i < i1; ++i)
+          ON_MeshSoATransformProjective(xform, x[i], y[i], z[i]);
+      }
+    }
+  );
+  return true;
+}
+
+inline bool ON_MeshVertexSoA::TransformPointList(
+  const ON_Xform& xform,
+  size_t count,
+  ON_3dPoint* points,
+  bool bMultithreaded
+  )
+{
+  if (0 == count)
+    return true;
+  if (nullptr == points)
+    return false;
+  const bool bAffine = ON_MeshSoAIsAffine(xform);
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(count, ON_MESH_SOA_MIN_POINTS_PER_THREAD)
+    : 1U;
+  ON_Parallel::ForRanges(count, thread_count,
+    [&xform, bAffine, points](size_t i0, size_t i1, unsigned int)
+    {
+      if (bAffine)
+      {
+        // Lanes are (x,y). C[j] is column j of the top two rows.
+        const double(*m)[4] = xform.m_xform;
+        const ON_MeshSoA2d C[4] = {
+          ON_MeshSoA2dSet(m[0][0], m[1][0]),
+          ON_MeshSoA2dSet(m[0][1], m[1][1]),
+          ON_MeshSoA2dSet(m[0][2], m[1][2]),
+          ON_MeshSoA2dSet(m[0][3], m[1][3])
+        };
+        for (size_t i = i0; i < i1; ++i)
+        {
+          double* P = &points[i].x;
+          const double X = P[0], Y = P[1], Z = P[2];
+          const ON_MeshSoA2d XY = ON_MeshSoA2dAdd(
+            ON_MeshSoA2dAdd(ON_MeshSoA2dMul(C[0], ON_MeshSoA2dSet1(X)), ON_MeshSoA2dMul(C[1], ON_MeshSoA2dSet1(Y))),
+            ON_MeshSoA2dAdd(ON_MeshSoA2dMul(C[2], ON_MeshSoA2dSet1(Z)), C[3])
+          );
+          ON_MeshSoA2dStore(P, XY);
+          P[2] = (m[2][0] * X + m[2][1] * Y) + (m[2][2] * Z + m[2][3]);
+        }
+      }
+      else
+      {
+        for (size_t i = i0; i < i1; ++i)
+          ON_MeshSoATransformProjective(xform, points[i].x, points[i].y, points[i].z);
+      }
+    }
+  );
+  return true;
+}
+
+inline bool ON_MeshVertexSoA::TransformPointList(
+  const ON_Xform& xform,
+  size_t count,
+  ON_3fPoint* points,
+  bool bMultithreaded
+  )
+{
+  if (0 == count)
+    return true;
+  if (nullptr == points)
+    return false;
+  const bool bAffine = ON_MeshSoAIsAffine(xform);
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(count, ON_MESH_SOA_MIN_POINTS_PER_THREAD)
+    : 1U;
+  ON_Parallel::ForRanges(count, thread_count,
+    [&xform, bAffine, points](size_t i0, size_t i1, unsigned int)
+    {
+      // Work on blocks of points converted to double precision SoA.
+      double x[256], y[256], z[256];
+      for (size_t b0 = i0; b0 < i1; b0 += 256)
+      {
+        const size_t n = (i1 - b0 < 256) ? (i1 - b0) : 256;
+        ON_3fPoint* P = points + b0;
+        for (size_t i = 0; i < n; ++i)
+        {
+          x[i] = P[i].x;
+          y[i] = P[i].y;
+          z[i] = P[i].z;
+        }
+        if (bAffine)
+          ON_MeshSoATransformAffine(xform, 0, n, x, y, z);
+        else
+        {
+          for (size_t i = 0; i < n; ++i)
+            ON_MeshSoATransformProjective(xform, x[i], y[i], z[i]);
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+          P[i].x = (float)x[i];
+          P[i].y = (float)y[i];
+          P[i].z = (float)z[i];
+        }
+      }
+    }
+  );
+  return true;
+}
+
+inline bool ON_MeshVertexSoA::ComputeFaceNormals(ON_Mesh& mesh, bool bMultithreaded) const
+{
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (m_count != (size_t)vertex_count)
+  {
+    ON_ERROR("Count() is not the mesh vertex count.");
+    return false;
+  }
+
+  mesh.m_FN.SetCount(0);
+  mesh.m_FN.Reserve(face_count);
+  mesh.m_FN.SetCount((int)face_count);
+  if (0 == face_count)
+    return true;
+
+  const ON_MeshFace* F = mesh.m_F.Array();
+  ON_3fVector* FN = mesh.m_FN.Array();
+  const double* x = m_x;
+  const double* y = m_y;
+  const double* z = m_z;
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(face_count, ON_MESH_SOA_MIN_POINTS_PER_THREAD / 2)
+    : 1U;
+  std::atomic<bool> rc(true);
+  ON_Parallel::ForRanges(face_count, thread_count,
+    [vertex_count, F, FN, x, y, z, &rc](size_t i0, size_t i1, unsigned int)
+    {
+      bool range_rc = true;
+      for (size_t fi = i0; fi < i1; fi += 2)
+      {
+        // Two faces at a time. A face with invalid vertex indices
+        // uses vertex 0 and gets a zero normal below.
+        int vi[2][4];
+        bool bValid[2] = { false, false };
+        const size_t n = (fi + 1 < i1) ? 2 : 1;
+        for (size_t k = 0; k < 2; ++k)
+        {
+          const int* fvi = F[fi + ((k < n) ? k : 0)].vi;
+          bValid[k] = (k < n)
+            && (unsigned int)fvi[0] < vertex_count && (unsigned int)fvi[1] < vertex_count
+            && (unsigned int)fvi[2] < vertex_count && (unsigned int)fvi[3] < vertex_count;
+          for (int j = 0; j < 4; ++j)
+            vi[k][j] = bValid[k] ? fvi[j] : 0;
+        }
+
+        // a = V[2] - V[0], b = V[3] - V[1], N = a x b
+        const ON_MeshSoA2d ax = ON_MeshSoA2dSub(ON_MeshSoA2dSet(x[vi[0][2]], x[vi[1][2]]), ON_MeshSoA2dSet(x[vi[0][0]], x[vi[1][0]]));
+        const ON_MeshSoA2d ay = ON_MeshSoA2dSub(ON_MeshSoA2dSet(y[vi[0][2]], y[vi[1][2]]), ON_MeshSoA2dSet(y[vi[0][0]], y[vi[1][0]]));
+        const ON_MeshSoA2d az = ON_MeshSoA2dSub(ON_MeshSoA2dSet(z[vi[0][2]], z[vi[1][2]]), ON_MeshSoA2dSet(z[vi[0][0]], z[vi[1][0]]));
+        const ON_MeshSoA2d bx = ON_MeshSoA2dSub(ON_MeshSoA2dSet(x[vi[0][3]], x[vi[1][3]]), ON_MeshSoA2dSet(x[vi[0][1]], x[vi[1][1]]));
+        const ON_MeshSoA2d by = ON_MeshSoA2dSub(ON_MeshSoA2dSet(y[vi[0][3]], y[vi[1][3]]), ON_MeshSoA2dSet(y[vi[0][1]], y[vi[1][1]]));
+        const ON_MeshSoA2d bz = ON_MeshSoA2dSub(ON_MeshSoA2dSet(z[vi[0][3]], z[vi[1][3]]), ON_MeshSoA2dSet(z[vi[0][1]], z[vi[1][1]]));
+        double N[3][2];
+        ON_MeshSoA2dStore(N[0], ON_MeshSoA2dSub(ON_MeshSoA2dMul(ay, bz), ON_MeshSoA2dMul(az, by)));
+        ON_MeshSoA2dStore(N[1], ON_MeshSoA2dSub(ON_MeshSoA2dMul(az, bx), ON_MeshSoA2dMul(ax, bz)));
+        ON_MeshSoA2dStore(N[2], ON_MeshSoA2dSub(ON_MeshSoA2dMul(ax, by), ON_MeshSoA2dMul(ay, bx)));
+
+        for (size_t k = 0; k < n; ++k)
+        {
+          double nx = N[0][k], ny = N[1][k], nz = N[2][k];
+          if (!bValid[k] || !ON_MeshSoAUnitize(nx, ny, nz))
+          {
+            nx = ny = nz = 0.0;
+            range_rc = false;
+          }
+          FN[fi + k].x = (float)nx;
+          FN[fi + k].y = (float)ny;
+          FN[fi + k].z = (float)nz;
+        }
+      }
+      if (!range_rc)
+        rc = false;
+    }
+  );
+  return rc;
+}
+
+inline bool ON_MeshVertexSoA::ComputeVertexNormals(ON_Mesh& mesh, bool bMultithreaded) const
+{
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (m_count != (size_t)vertex_count)
+  {
+    ON_ERROR("Count() is not the mesh vertex count.");
+    return false;
+  }
+  if (0 == vertex_count || 0 == face_count)
+    return false;
+  if (face_count > 0x1FFFFFFFU)
+  {
+    ON_ERROR("Mesh is too large.");
+    return false;
+  }
+  if (face_count != mesh.m_FN.UnsignedCount())
+    ComputeFaceNormals(mesh, bMultithreaded);
+
+  // vertex_face[vertex_face_start[vi],...,vertex_face_start[vi+1]-1] lists
+  // the faces that use vertex vi in increasing order. A face that uses
+  // a vertex at two corners is listed twice.
+  const ON_MeshFace* F = mesh.m_F.Array();
+  const ON_3fVector* FN = mesh.m_FN.Array();
+  auto face_corner_count = [F, vertex_count](unsigned int fi)
+  {
+    const int* fvi = F[fi].vi;
+    if ((unsigned int)fvi[0] >= vertex_count || (unsigned int)fvi[1] >= vertex_count
+      || (unsigned int)fvi[2] >= vertex_count || (unsigned int)fvi[3] >= vertex_count)
+      return 0;
+    return (fvi[2] != fvi[3]) ? 4 : 3;
+  };
+  ON_SimpleArray<unsigned int> vertex_face_start_array(vertex_count + 1);
+  vertex_face_start_array.SetCount((int)(vertex_count + 1));
+  vertex_face_start_array.Zero();
+  unsigned int* vertex_face_start = vertex_face_start_array.Array();
+  for (unsigned int fi = 0; fi < face_count; ++fi)
+  {
+    const int n = face_corner_count(fi);
+    for (int j = 0; j < n; ++j)
+      vertex_face_start[F[fi].vi[j] + 1]++;
+  }
+  for (unsigned int vi = 0; vi < vertex_count; ++vi)
+    vertex_face_start[vi + 1] += vertex_face_start[vi];
+  ON_SimpleArray<unsigned int> vertex_face_array(vertex_face_start[vertex_count]);
+  vertex_face_array.SetCount((int)vertex_face_start[vertex_count]);
+  unsigned int* vertex_face = vertex_face_array.Array();
+  {
+    ON_SimpleArray<unsigned int> next(vertex_face_start_array);
+    for (unsigned int fi = 0; fi < face_count; ++fi)
+    {
+      const int n = face_corner_count(fi);
+      for (int j = 0; j < n; ++j)
+        vertex_face[next[F[fi].vi[j]]++] = fi;
+    }
+  }
+
+  // Each vertex adds its face normals in face order, so the sums do not
+  // depend on the thread count.
+  mesh.m_N.SetCount(0);
+  mesh.m_N.Reserve(vertex_count);
+  mesh.m_N.SetCount((int)vertex_count);
+  ON_3fVector* N = mesh.m_N.Array();
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(vertex_count, ON_MESH_SOA_MIN_POINTS_PER_THREAD)
+    : 1U;
+  ON_Parallel::ForRanges(vertex_count, thread_count,
+    [vertex_face_start, vertex_face, FN, N](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t i = i0; i < i1; ++i)
+      {
+        double nx = 0.0, ny = 0.0, nz = 0.0;
+        for (unsigned int k = vertex_face_start[i]; k < vertex_face_start[i + 1]; ++k)
+        {
+          const ON_3fVector& fn = FN[vertex_face[k]];
+          nx += fn.x;
+          ny += fn.y;
+          nz += fn.z;
+        }
+        ON_MeshSoAUnitize(nx, ny, nz);
+        N[i].x = (float)nx;
+        N[i].y = (float)ny;
+        N[i].z = (float)nz;
+      }
+    }
+  );
+  return true;
+}
+
+#endif
@@ -0,0 +1,657 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MESH_TOPOLOGY_BUILDER_INC_)
+#define OPENNURBS_MESH_TOPOLOGY_BUILDER_INC_
+
+/*
+Description:
+  ON_MeshTopologyBuilder fills in the m_topv_map[], m_topv[], m_tope[]
+  and m_topf[] arrays of an ON_MeshTopology using multiple threads.
+  Every step is a sort with a total order or a scan over sorted data, so
+  the result does not depend on the number of threads. The multi-threaded
+  and single threaded builds are bit-identical.
+
+  Numbering:
+    Topology vertices are numbered in increasing (x,y,z) order of their
+    locations. m_topv[].m_vi[] lists mesh vertex indices in increasing order.
+    Topology edges are numbered in increasing (m_topvi[0],m_topvi[1]) order
+    with m_topvi[0] <= m_topvi[1]. m_tope[].m_topfi[] lists face indices in
+    increasing order. m_topv[].m_topei[] lists edge indices in increasing
+    order. Use ON_MeshTopology::SortVertexEdges() to get radial order.
+Remarks:
+  The mesh's cached topology, ON_Mesh::Topology(), is created by the
+  library's ON_MeshTopology::Create(). That function is compiled into the
+  library and its vertex and edge order within groups of equal keys comes
+  from its own sort, which is not documented and is not stable across
+  versions, so it cannot be reproduced here. ON_MeshTopologyBuilder uses
+  the total order above instead, so its numbering is reproducible for any
+  thread count. Both describe the same topology: the same partition of
+  the mesh vertices, the same edges and the same face sides.
+  ON_MeshTopologyBuilder::IsEquivalent() verifies this, for example
+  against mesh.Topology() in a debug build.
+
+  ON_MeshTopology::m_b32IsValid is private and only the library's
+  ON_MeshTopology::Create() sets it, so ON_MeshTopology::IsValid() reports
+  a topology created by ON_MeshTopologyBuilder as not valid. Use
+  IsEquivalent() to check one.
+*/
+class ON_MeshTopologyBuilder
+{
+public:
+  /*
+  Description:
+    Create mesh topology information.
+  Parameters:
+    mesh - [in]
+      When the mesh has double precision vertices, coincident m_dV[] locations
+      are merged, otherwise coincident m_V[] locations are merged.
+      The mesh must exist while top is in use.
+    top - [out]
+      A newly constructed ON_MeshTopology. The m_topv_map[], m_topv[],
+      m_tope[] and m_topf[] arrays of an existing topology are destroyed.
+      Memory from earlier ON_MeshTopology::GetIntArray() calls is only
+      freed by ~ON_MeshTopology(), so reusing top for many meshes keeps
+      that memory until top is destroyed.
+    bMultithreaded - [in]
+      If true, ForceSerial() is false, and the mesh is large, the work is
+      done on multiple threads.
+  Returns:
+    True if successful.
+  Remarks:
+    Faces with invalid vertex indices get m_topei[] values of -1.
+    A face side that begins and ends at the same topology vertex
+    becomes an edge with m_topvi[0] = m_topvi[1].
+  */
+  static bool Create(
+    const class ON_Mesh& mesh,
+    class ON_MeshTopology& top,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Force every ON_MeshTopologyBuilder::Create() call to run on the calling
+    thread. This is a debugging tool.
+  Parameters:
+    bForceSerial - [in]
+  */
+  static void SetForceSerial(
+    bool bForceSerial
+    );
+
+  static bool ForceSerial();
+
+  /*
+  Description:
+    Compare two topologies of the same mesh when their numbering may differ.
+  Parameters:
+    a - [in]
+    b - [in]
+  Returns:
+    True if there is a one to one map between the topology vertices
+    of a and b that maps a.m_topv_map[] to b.m_topv_map[], a one to one
+    map between the topology edges that maps the endpoints and the
+    m_topf[].m_topei[] values of a to those of b, and the m_topf[].m_reve[]
+    values agree with the mapped edge directions.
+  Remarks:
+    The mesh faces are not renumbered by either topology, so m_topf[] is
+    compared face by face.
+  */
+  static bool IsEquivalent(
+    const class ON_MeshTopology& a,
+    const class ON_MeshTopology& b
+    );
+
+private:
+  static std::atomic<bool>& Internal_ForceSerial();
+
+  template <class IsFirst, class Assign>
+  static size_t Internal_GroupScan(
+    size_t count,
+    unsigned int thread_count,
+    const IsFirst& is_first,
+    const Assign& assign
+    );
+
+  template <class Point>
+  static size_t Internal_SetVertices(
+    const Point* V,
+    unsigned int vertex_count,
+    unsigned int thread_count,
+    class ON_MeshTopology& top
+    );
+};
+
+inline std::atomic<bool>& ON_MeshTopologyBuilder::Internal_ForceSerial()
+{
+  static std::atomic<bool> bForceSerial(false);
+  return bForceSerial;
+}
+
+inline void ON_MeshTopologyBuilder::SetForceSerial(bool bForceSerial)
+{
+  Internal_ForceSerial() = bForceSerial;
+}
+
+inline bool ON_MeshTopologyBuilder::ForceSerial()
+{
+  return Internal_ForceSerial();
+}
+
+/*
+Description:
+  Scan a sorted array where groups of equal values are contiguous.
+Parameters:
+  is_first - [in]
+    bool is_first(size_t i) returns true if element i begins a group.
+    is_first(0) must be true.
+  assign - [in]
+    void assign(size_t i, size_t group_index, bool bFirst) is called once
+    for every element.
+Returns:
+  Number of groups.
+*/
+template <class IsFirst, class Assign>
+inline size_t ON_MeshTopologyBuilder::Internal_GroupScan(
+  size_t count,
+  unsigned int thread_count,
+  const IsFirst& is_first,
+  const Assign& assign
+  )
+{
+  if (0 == count)
+    return 0;
+  if (thread_count < 1U)
+    thread_count = 1U;
+
+  // Both passes use the same ranges, so range k of the second pass
+  // starts with the group count of ranges 0,...,k-1.
+  ON_SimpleArray<size_t> range_group_count((int)thread_count);
+  range_group_count.SetCount((int)thread_count);
+  range_group_count.Zero();
+  size_t* range_group = range_group_count.Array();
+  ON_Parallel::ForRanges(count, thread_count,
+    [&is_first, range_group](size_t i0, size_t i1, unsigned int k)
+    {
+      size_t c = 0;
+      for (size_t i = i0; i < i1; ++i)
+      {
+        if (is_first(i))
+          ++c;
+      }
+      range_group[k] = c;
+    }
+  );
+  size_t group_count = 0;
+  for (unsigned int k = 0; k < thread_count; ++k)
+  {
+    const size_t c = range_group[k];
+    range_group[k] = group_count;
+    group_count += c;
+  }
+  ON_Parallel::ForRanges(count, thread_count,
+    [&is_first, &assign, range_group](size_t i0, size_t i1, unsigned int k)
+    {
+      size_t g = range_group[k];
+      for (size_t i = i0; i < i1; ++i)
+      {
+        const bool bFirst = is_first(i);
+        if (bFirst)
+          ++g;
+        assign(i, g - 1, bFirst);
+      }
+    }
+  );
+  return group_count;
+}
+
+// Sets top.m_topv_map[] and the m_v_count and m_vi values in top.m_topv[].
+// Returns the number of topology vertices.
+template <class Point>
+inline size_t ON_MeshTopologyBuilder::Internal_SetVertices(
+  const Point* V,
+  unsigned int vertex_count,
+  unsigned int thread_count,
+  ON_MeshTopology& top
+  )
+{
+  // vi_list[] = vertex indices sorted by location and then by index.
+  int* vi_list = top.GetIntArray((int)vertex_count);
+  if (nullptr == vi_list)
+    return 0;
+  ON_Parallel::ForRanges(vertex_count, thread_count,
+    [vi_list](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t i = i0; i < i1; ++i)
+        vi_list[i] = (int)i;
+    }
+  );
+  ON_Parallel::Sort(vi_list, vi_list + vertex_count,
+    [V](int a, int b)
+    {
+      if (V[a].x < V[b].x) return true;
+      if (V[b].x < V[a].x) return false;
+      if (V[a].y < V[b].y) return true;
+      if (V[b].y < V[a].y) return false;
+      if (V[a].z < V[b].z) return true;
+      if (V[b].z < V[a].z) return false;
+      return a < b;
+    },
+    thread_count
+  );
+
+  top.m_topv_map.Reserve(vertex_count);
+  top.m_topv_map.SetCount((int)vertex_count);
+  int* topv_map = top.m_topv_map.Array();
+
+  // topv_start[] is a temporary copy of the group starts
+  ON_SimpleArray<unsigned int> topv_start(vertex_count);
+  topv_start.SetCount((int)vertex_count);
+  unsigned int* start = topv_start.Array();
+
+  const size_t topv_count = ON_MeshTopologyBuilder::Internal_GroupScan(
+    vertex_count, thread_count,
+    [V, vi_list](size_t i)
+    {
+      if (0 == i)
+        return true;
+      const Point& A = V[vi_list[i - 1]];
+      const Point& B = V[vi_list[i]];
+      return !(A.x == B.x && A.y == B.y && A.z == B.z);
+    },
+    [vi_list, topv_map, start](size_t i, size_t topvi, bool bFirst)
+    {
+      topv_map[vi_list[i]] = (int)topvi;
+      if (bFirst)
+        start[topvi] = (unsigned int)i;
+    }
+  );
+
+  top.m_topv.Reserve(topv_count);
+  top.m_topv.SetCount((int)topv_count);
+  ON_MeshTopologyVertex* topv = top.m_topv.Array();
+  ON_Parallel::ForRanges(topv_count, thread_count,
+    [topv, start, vi_list, topv_count, vertex_count](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t i = i0; i < i1; ++i)
+      {
+        const unsigned int s1 = (i + 1 < topv_count) ? start[i + 1] : vertex_count;
+        topv[i].m_tope_count = 0;
+        topv[i].m_topei = nullptr;
+        topv[i].m_v_count = (int)(s1 - start[i]);
+        topv[i].m_vi = vi_list + start[i];
+      }
+    }
+  );
+
+  return topv_count;
+}
+
+// One side of a mesh face. m_key = (topvi0 << 32) | topvi1 with
+// topvi0 <= topvi1 identifies the edge. m_fk = 8*face index + 2*side + reversed.
+struct ON_MeshTopologyBuilderSide
+{
+  ON__UINT64 m_key;
+  ON__UINT32 m_fk;
+};
+
+inline bool ON_MeshTopologyBuilder::Create(
+  const ON_Mesh& mesh,
+  ON_MeshTopology& top,
+  bool bMultithreaded
+  )
+{
+  // ON_MeshTopology::Destroy() is private. The public arrays are reset
+  // here and GetIntArray() memory is freed by ~ON_MeshTopology().
+  top.m_mesh = &mesh;
+  top.m_topv_map.Destroy();
+  top.m_topv.Destroy();
+  top.m_tope.Destroy();
+  top.m_topf.Destroy();
+
+  const unsigned int vertex_count = mesh.VertexUnsignedCount();
+  const unsigned int face_count = mesh.FaceUnsignedCount();
+  if (0 == vertex_count)
+    return false;
+  if (vertex_count > 0x7FFFFFFFU || face_count > 0x1FFFFFFFU)
+  {
+    ON_ERROR("Mesh is too large.");
+    return false;
+  }
+
+  const unsigned int thread_count
+    = (bMultithreaded && !ON_MeshTopologyBuilder::ForceSerial())
+    ? ON_Parallel::ThreadCount((size_t)vertex_count + (size_t)face_count, 0x4000)
+    : 1U;
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Topology vertices
+  //
+  const size_t topv_count
+    = mesh.HasDoublePrecisionVertices()
+    ? ON_MeshTopologyBuilder::Internal_SetVertices(mesh.m_dV.Array(), vertex_count, thread_count, top)
+    : ON_MeshTopologyBuilder::Internal_SetVertices(mesh.m_V.Array(), vertex_count, thread_count, top);
+  if (0 == topv_count)
+    return false;
+  const int* topv_map = top.m_topv_map.Array();
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Face sides sorted by edge
+  //
+  top.m_topf.Reserve(face_count);
+  top.m_topf.SetCount((int)face_count);
+  if (0 == face_count)
+    return true;
+  ON_MeshTopologyFace* topf = top.m_topf.Array();
+  const ON_MeshFace* F = mesh.m_F.Array();
+
+  // Every face gets 4 slots. Unused slots have m_key = 0xFFFFFFFFFFFFFFFF
+  // and sort to the end.
+  const ON__UINT64 unused_key = 0xFFFFFFFFFFFFFFFFULL;
+  ON_SimpleArray<ON_MeshTopologyBuilderSide> side_array(4 * (size_t)face_count);
+  side_array.SetCount((int)(4 * face_count));
+  ON_MeshTopologyBuilderSide* side = side_array.Array();
+  ON_Parallel::ForRanges(face_count, thread_count,
+    [F, topv_map, side, vertex_count, unused_key](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t fi = i0; fi < i1; ++fi)
+      {
+        const int* fvi = F[fi].vi;
+        ON_MeshTopologyBuilderSide* s = side + 4 * fi;
+        const bool bValid
+          = (unsigned int)fvi[0] < vertex_count && (unsigned int)fvi[1] < vertex_count
+          && (unsigned int)fvi[2] < vertex_count && (unsigned int)fvi[3] < vertex_count;
+        const int side_count = bValid ? ((fvi[2] != fvi[3]) ? 4 : 3) : 0;
+        for (int k = 0; k < 4; ++k)
+        {
+          if (k >= side_count)
+          {
+            s[k].m_key = unused_key;
+            s[k].m_fk = 0;
+            continue;
+          }
+          // side k ends at vi[k] and starts at the previous corner
+          const ON__UINT32 t0 = (ON__UINT32)topv_map[fvi[(k + side_count - 1) % side_count]];
+          const ON__UINT32 t1 = (ON__UINT32)topv_map[fvi[k]];
+          const bool bReversed = (t0 > t1);
+          s[k].m_key = bReversed ? ((((ON__UINT64)t1) << 32) | t0) : ((((ON__UINT64)t0) << 32) | t1);
+          s[k].m_fk = (ON__UINT32)(8 * fi + 2 * k + (bReversed ? 1 : 0));
+        }
+      }
+    }
+  );
+  ON_Parallel::Sort(side, side + 4 * (size_t)face_count,
+    [](const ON_MeshTopologyBuilderSide& a, const ON_MeshTopologyBuilderSide& b)
+    {
+      return (a.m_key < b.m_key) || (a.m_key == b.m_key && a.m_fk < b.m_fk);
+    },
+    thread_count
+  );
+  size_t side_count = 4 * (size_t)face_count;
+  while (side_count > 0 && unused_key == side[side_count - 1].m_key)
+    --side_count;
+
+  // Faces with invalid vertex indices keep these values.
+  ON_Parallel::ForRanges(face_count, thread_count,
+    [topf](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t fi = i0; fi < i1; ++fi)
+      {
+        for (int k = 0; k < 4; ++k)
+        {
+          topf[fi].m_topei[k] = -1;
+          topf[fi].m_reve[k] = 0;
+        }
+      }
+    }
+  );
+  if (0 == side_count)
+    return true;
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Topology edges
+  //
+  ON_SimpleArray<unsigned int> edge_start_array(side_count);
+  edge_start_array.SetCount((int)side_count);
+  unsigned int* edge_start = edge_start_array.Array();
+  const size_t tope_count = ON_MeshTopologyBuilder::Internal_GroupScan(
+    side_count, thread_count,
+    [side](size_t i)
+    {
+      return (0 == i || side[i - 1].m_key != side[i].m_key);
+    },
+    [side, topf, edge_start](size_t i, size_t topei, bool bFirst)
+    {
+      if (bFirst)
+        edge_start[topei] = (unsigned int)i;
+      const ON__UINT32 fk = side[i].m_fk;
+      const unsigned int fi = fk / 8;
+      const unsigned int k = (fk / 2) % 4;
+      topf[fi].m_topei[k] = (int)topei;
+      topf[fi].m_reve[k] = (char)(fk % 2);
+    }
+  );
+
+  // triangles: m_topei[3] = m_topei[2]
+  ON_Parallel::ForRanges(face_count, thread_count,
+    [F, topf](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t fi = i0; fi < i1; ++fi)
+      {
+        if (F[fi].vi[2] == F[fi].vi[3] && topf[fi].m_topei[2] >= 0)
+        {
+          topf[fi].m_topei[3] = topf[fi].m_topei[2];
+          topf[fi].m_reve[3] = topf[fi].m_reve[2];
+        }
+      }
+    }
+  );
+
+  // m_tope[e].m_topfi[] points into topfi_list[] at the edge's first side.
+  int* topfi_list = top.GetIntArray((int)side_count);
+  if (nullptr == topfi_list)
+    return false;
+  top.m_tope.Reserve(tope_count);
+  top.m_tope.SetCount((int)tope_count);
+  ON_MeshTopologyEdge* tope = top.m_tope.Array();
+  ON_Parallel::ForRanges(tope_count, thread_count,
+    [side, side_count, edge_start, tope, tope_count, topfi_list](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t ei = i0; ei < i1; ++ei)
+      {
+        const size_t s0 = edge_start[ei];
+        const size_t s1 = (ei + 1 < tope_count) ? edge_start[ei + 1] : side_count;
+        tope[ei].m_topvi[0] = (int)(side[s0].m_key >> 32);
+        tope[ei].m_topvi[1] = (int)(side[s0].m_key & 0xFFFFFFFFU);
+        int* topfi = topfi_list + s0;
+        int topf_count = 0;
+        for (size_t s = s0; s < s1; ++s)
+        {
+          const int fi = (int)(side[s].m_fk / 8);
+          if (0 == topf_count || topfi[topf_count - 1] != fi)
+            topfi[topf_count++] = fi;
+        }
+        tope[ei].m_topf_count = topf_count;
+        tope[ei].m_topfi = topfi;
+      }
+    }
+  );
+
+  //////////////////////////////////////////////////////////////
+  //
+  // Topology vertex edge lists
+  //
+  // (topvi << 32) | topei for both ends of every edge, sorted.
+  ON_SimpleArray<ON__UINT64> vertex_edge_array(2 * tope_count);
+  vertex_edge_array.SetCount((int)(2 * tope_count));
+  ON__UINT64* vertex_edge = vertex_edge_array.Array();
+  ON_Parallel::ForRanges(tope_count, thread_count,
+    [tope, vertex_edge, unused_key](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t ei = i0; ei < i1; ++ei)
+      {
+        vertex_edge[2 * ei] = (((ON__UINT64)tope[ei].m_topvi[0]) << 32) | (ON__UINT64)ei;
+        vertex_edge[2 * ei + 1]
+          = (tope[ei].m_topvi[0] != tope[ei].m_topvi[1])
+          ? ((((ON__UINT64)tope[ei].m_topvi[1]) << 32) | (ON__UINT64)ei)
+          : unused_key;
+      }
+    }
+  );
+  ON_Parallel::Sort(vertex_edge, vertex_edge + 2 * tope_count,
+    [](ON__UINT64 a, ON__UINT64 b) { return a < b; },
+    thread_count
+  );
+  size_t vertex_edge_count = 2 * tope_count;
+  while (vertex_edge_count > 0 && unused_key == vertex_edge[vertex_edge_count - 1])
+    --vertex_edge_count;
+
+  int* topei_list = top.GetIntArray((int)vertex_edge_count);
+  if (nullptr == topei_list)
+    return false;
+  ON_MeshTopologyVertex* topv = top.m_topv.Array();
+  ON_Parallel::ForRanges(vertex_edge_count, thread_count,
+    [vertex_edge, vertex_edge_count, topei_list, topv](size_t i0, size_t i1, unsigned int)
+    {
+      for (size_t i = i0; i < i1; ++i)
+      {
+        const unsigned int topvi = (unsigned int)(vertex_edge[i] >> 32);
+        topei_list[i] = (int)(vertex_edge[i] & 0xFFFFFFFFU);
+        if (0 == i || (unsigned int)(vertex_edge[i - 1] >> 32) != topvi)
+        {
+          size_t i2 = i + 1;
+          while (i2 < vertex_edge_count && (unsigned int)(vertex_edge[i2] >> 32) == topvi)
+            ++i2;
+          topv[topvi].m_tope_count = (int)(i2 - i);
+          topv[topvi].m_topei = topei_list + i;
+        }
+      }
+    }
+  );
+
+  return true;
+}
+
+inline bool ON_MeshTopologyBuilder::IsEquivalent(
+  const ON_MeshTopology& a,
+  const ON_MeshTopology& b
+  )
+{
+  const int vertex_count = a.m_topv_map.Count();
+  const int topv_count = a.m_topv.Count();
+  const int tope_count = a.m_tope.Count();
+  const int face_count = a.m_topf.Count();
+  if (vertex_count != b.m_topv_map.Count()
+    || topv_count != b.m_topv.Count()
+    || tope_count != b.m_tope.Count()
+    || face_count != b.m_topf.Count())
+    return false;
+
+  // topv_ab[] maps a topology vertex indices to b and topv_ba[] is the inverse.
+  ON_SimpleArray<int> topv_ab(topv_count);
+  ON_SimpleArray<int> topv_ba(topv_count);
+  topv_ab.SetCount(topv_count);
+  topv_ba.SetCount(topv_count);
+  for (int i = 0; i < topv_count; ++i)
+  {
+    topv_ab[i] = -1;
+    topv_ba[i] = -1;
+  }
+  for (int vi = 0; vi < vertex_count; ++vi)
+  {
+    const int va = a.m_topv_map[vi];
+    const int vb = b.m_topv_map[vi];
+    if (va < 0 || va >= topv_count || vb < 0 || vb >= topv_count)
+      return false;
+    if (topv_ab[va] < 0 && topv_ba[vb] < 0)
+    {
+      topv_ab[va] = vb;
+      topv_ba[vb] = va;
+    }
+    else if (topv_ab[va] != vb || topv_ba[vb] != va)
+      return false;
+  }
+  for (int va = 0; va < topv_count; ++va)
+  {
+    const int vb = topv_ab[va];
+    if (vb < 0
+      || a.m_topv[va].m_v_count != b.m_topv[vb].m_v_count
+      || a.m_topv[va].m_tope_count != b.m_topv[vb].m_tope_count)
+      return false;
+  }
+
+  // tope_ab[] and tope_ba[] are found from the face sides.
+  ON_SimpleArray<int> tope_ab(tope_count);
+  ON_SimpleArray<int> tope_ba(tope_count);
+  tope_ab.SetCount(tope_count);
+  tope_ba.SetCount(tope_count);
+  for (int i = 0; i < tope_count; ++i)
+  {
+    tope_ab[i] = -1;
+    tope_ba[i] = -1;
+  }
+  for (int fi = 0; fi < face_count; ++fi)
+  {
+    const ON_MeshTopologyFace& fa = a.m_topf[fi];
+    const ON_MeshTopologyFace& fb = b.m_topf[fi];
+    for (int k = 0; k < 4; ++k)
+    {
+      const int ea = fa.m_topei[k];
+      const int eb = fb.m_topei[k];
+      if (ea < 0 || eb < 0)
+      {
+        if (ea != eb)
+          return false;
+        continue;
+      }
+      if (ea >= tope_count || eb >= tope_count)
+        return false;
+      if (tope_ab[ea] < 0 && tope_ba[eb] < 0)
+      {
+        const int* ta = a.m_tope[ea].m_topvi;
+        const int* tb = b.m_tope[eb].m_topvi;
+        if (ta[0] < 0 || ta[0] >= topv_count || ta[1] < 0 || ta[1] >= topv_count)
+          return false;
+        const int t0 = topv_ab[ta[0]];
+        const int t1 = topv_ab[ta[1]];
+        if (!((t0 == tb[0] && t1 == tb[1]) || (t0 == tb[1] && t1 == tb[0])))
+          return false;
+        if (a.m_tope[ea].m_topf_count != b.m_tope[eb].m_topf_count)
+          return false;
+        tope_ab[ea] = eb;
+        tope_ba[eb] = ea;
+      }
+      else if (tope_ab[ea] != eb || tope_ba[eb] != ea)
+        return false;
+      // m_reve[] is relative to the edge direction, which may be flipped in b.
+      const bool bFlipped
+        = (a.m_tope[ea].m_topvi[0] != a.m_tope[ea].m_topvi[1])
+        && (topv_ab[a.m_tope[ea].m_topvi[0]] != b.m_tope[eb].m_topvi[0]);
+      if (((0 != fa.m_reve[k]) != bFlipped) != (0 != fb.m_reve[k]))
+        return false;
+    }
+  }
+  for (int ea = 0; ea < tope_count; ++ea)
+  {
+    if (tope_ab[ea] < 0)
+      return false;
+  }
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,340 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MODEL_INCREMENTAL_SAVE_INC_)
+#define OPENNURBS_MODEL_INCREMENTAL_SAVE_INC_
+
+/*
+Description:
+  ONX_ModelIncrementalSave saves an ONX_Model as a 3dm file and a
+  revision file. The first save writes the whole model with
+  ONX_Model::Write(). Later saves append one revision segment to the
+  revision file. A segment contains only the components that were
+  added, changed or deleted since the previous save, so the time to
+  save a small edit does not depend on the size of the model.
+  - Changes are found by comparing each component with the
+    ON_ModelComponentContentMark saved at the previous save. Set
+    CompareContentCRC() to also compare ON_Object::DataCRC() values,
+    which finds geometry that was modified in place without changing
+    the component content version number.
+  - Every segment starts with an index of the components it contains.
+    Read() uses the indices so that it reads only the last revision
+    of each component.
+  - Compact() writes the whole model to the 3dm file and deletes the
+    revision file. Save() compacts automatically when the revision file
+    is larger than CompactionRatio() times the 3dm file.
+  - A renamed layer, material or other table component keeps its model
+    index when a revision is read, so references to it from the 3dm
+    file remain valid.
+Remarks:
+  - The 3dm file is an ordinary 3dm file with the model as it was at
+    the last compaction. Applications that do not use
+    ONX_ModelIncrementalSave see that model.
+  - The revision file name is the 3dm file name with ".3dmrev" appended.
+  - Segments are written by appending to the revision file. If writing
+    is interrupted, Read() ignores the incomplete segment and the next
+    Save() compacts.
+  - Segments contain model components and m_settings. Save() compacts
+    when other model information (m_properties, m_sStartSectionComments),
+    history records, render content or embedded files have changed.
+  - ONX_ModelIncrementalSave is not thread safe.
+Example:
+
+        ONX_Model model;
+        ONX_ModelIncrementalSave saver;
+        saver.Read(model, L"large_model.3dm", nullptr);
+        ... edit model ...
+        saver.Save(model, L"large_model.3dm", nullptr);
+        ... edit model ...
+        saver.Save(model, L"large_model.3dm", nullptr);
+
+*/
+class ONX_ModelIncrementalSave
+{
+public:
+  ONX_ModelIncrementalSave() = default;
+  ~ONX_ModelIncrementalSave() = default;
+
+  /*
+  Returns:
+    Name of the revision file used with filename.
+  */
+  static const ON_wString RevisionFileName(
+    const wchar_t* filename
+    );
+
+  /*
+  Description:
+    Read a model saved by Save() and remember its content so the next
+    Save() to filename writes only the changes.
+  Parameters:
+    model - [out]
+    filename - [in]
+      Name of the 3dm file. The revision file is read if it exists.
+    error_log - [out]
+      Pass nullptr if you don't want to log errors.
+  Returns:
+    True if the 3dm file was read. An incomplete revision segment at
+    the end of the revision file is logged and ignored.
+  */
+  bool Read(
+    ONX_Model& model,
+    const wchar_t* filename,
+    ON_TextLog* error_log
+    );
+
+  /*
+  Description:
+    Save model to filename.
+  Parameters:
+    model - [in]
+    filename - [in]
+    error_log - [out]
+      Pass nullptr if you don't want to log errors.
+  Returns:
+    True if the model was saved.
+  Remarks:
+    When model was not read from or saved to filename by this
+    ONX_ModelIncrementalSave, or when it cannot be saved as a revision
+    segment, Compact() is called.
+  */
+  bool Save(
+    const ONX_Model& model,
+    const wchar_t* filename,
+    ON_TextLog* error_log
+    );
+
+  /*
+  Description:
+    Write model to filename with ONX_Model::Write() and delete the
+    revision file.
+  Remarks:
+    The model is written to a temporary file that replaces filename
+    when the write is complete. If writing fails, filename and the
+    revision file are not changed.
+  */
+  bool Compact(
+    const ONX_Model& model,
+    const wchar_t* filename,
+    ON_TextLog* error_log
+    );
+
+  /*
+  Description:
+    Forget the model content saved by Read(), Save() or Compact().
+    The next Save() compacts.
+  */
+  void ClearBaseline();
+
+  /*
+  Returns:
+    Number of revision segments in the revision file.
+  */
+  unsigned int RevisionCount() const;
+
+  /*
+  Returns:
+    Size of the revision file in bytes.
+  */
+  ON__UINT64 SizeOfRevisions() const;
+
+  /*
+  Description:
+    When the revision file is larger than compaction_ratio times
+    the 3dm file, Save() calls Compact(). The default is 0.5.
+    0 disables automatic compaction.
+  */
+  void SetCompactionRatio(
+    double compaction_ratio
+    );
+
+  double CompactionRatio() const;
+
+  /*
+  Description:
+    When true, Save() compares ON_Object::DataCRC() values as well as
+    content version numbers. This takes time proportional to the size
+    of the model. The default is false.
+  */
+  void SetCompareContentCRC(
+    bool bCompareContentCRC
+    );
+
+  bool CompareContentCRC() const;
+
+private:
+  class Internal_BaselineItem
+  {
+  public:
+    ON_ModelComponentContentMark m_mark;
+    ON__UINT32 m_content_crc;
+  };
+
+  class Internal_Change
+  {
+  public:
+    ON_ModelComponent::Type m_type;
+    ON_UUID m_id;
+    // nullptr when the component was deleted
+    const ON_ModelComponent* m_component;
+  };
+
+  class Internal_IndexEntry
+  {
+  public:
+    unsigned int m_segment;
+    ON_ModelComponent::Type m_type;
+    ON_UUID m_id;
+    bool m_bDeleted;
+    bool m_bSuperseded;
+    ON__UINT64 m_record_offset;
+  };
+
+  class Internal_Reference
+  {
+  public:
+    unsigned int m_segment;
+    ON_ModelComponent::Type m_type;
+    int m_index;
+    ON_UUID m_id;
+  };
+
+  class Internal_Segment
+  {
+  public:
+    int m_archive_3dm_version = 0;
+    unsigned int m_archive_opennurbs_version = 0;
+    ON_SimpleArray<ON__UINT8> m_index;
+    ON_SimpleArray<ON__UINT8> m_records;
+  };
+
+  static const ON_ModelComponent::Type* Internal_SegmentTypes(
+    unsigned int* count
+    );
+
+  static bool Internal_IsSegmentType(
+    ON_ModelComponent::Type type
+    );
+
+  static bool Internal_IsGeometryType(
+    ON_ModelComponent::Type type
+    );
+
+  static int Internal_CompareBaselineId(
+    const Internal_BaselineItem* a,
+    const Internal_BaselineItem* b
+    );
+
+  ON__UINT32 Internal_ContentCRC(
+    const ON_ModelComponent* model_component
+    ) const;
+
+  static ON__UINT32 Internal_SettingsCRC(
+    const ONX_Model& model
+    );
+
+  // CRC of the model information that is not in revision segments.
+  static ON__UINT32 Internal_ModelInfoCRC(
+    const ONX_Model& model
+    );
+
+  void Internal_SetBaseline(
+    const ONX_Model& model
+    );
+
+  bool Internal_FindChanges(
+    const ONX_Model& model,
+    ON_SimpleArray<Internal_Change>& changes
+    ) const;
+
+  static bool Internal_WriteRecord(
+    ON_BinaryArchive& archive,
+    const ON_ModelComponent* model_component
+    );
+
+  // Ids of renamed table components are appended to renamed_ids.
+  static bool Internal_ReadRecord(
+    ON_BinaryArchive& archive,
+    ONX_Model& model,
+    ON_ModelComponent::Type type,
+    const ON_UUID& id,
+    ON_SimpleArray<ON_UUID>& renamed_ids
+    );
+
+  static bool Internal_RenameManifestItems(
+    ONX_Model& model,
+    ON_ModelComponent::Type type,
+    const ON_SimpleArray<ON_UUID>& renamed_ids
+    );
+
+  static bool Internal_ReadSegments(
+    const wchar_t* revision_filename,
+    ON_ClassArray<Internal_Segment>& segments,
+    ON__UINT64* sizeof_segments
+    );
+
+  static bool Internal_ReadIndex(
+    unsigned int segment_index,
+    Internal_Segment& segment,
+    ON_SimpleArray<Internal_IndexEntry>& entries,
+    ON_SimpleArray<Internal_Reference>& references
+    );
+
+  static bool Internal_ApplySegment(
+    ONX_Model& model,
+    const Internal_Segment& segment,
+    const Internal_IndexEntry* entries,
+    unsigned int entry_count,
+    const Internal_Reference* references,
+    unsigned int reference_count
+    );
+
+  static bool Internal_AppendSegment(
+    const wchar_t* revision_filename,
+    unsigned int revision,
+    const ON_Write3dmBufferArchive& index,
+    const ON_Write3dmBufferArchive& records
+    );
+
+  static ON__UINT64 Internal_FileSize(
+    const wchar_t* filename
+    );
+
+  // Rename source to destination, replacing destination if it exists.
+  static bool Internal_ReplaceFile(
+    const wchar_t* source,
+    const wchar_t* destination
+    );
+
+private:
+  ON_wString m_filename;
+  bool m_bBaselineIsSet = false;
+  bool m_bCompareContentCRC = false;
+  double m_compaction_ratio = 0.5;
+  unsigned int m_revision_count = 0;
+  ON__UINT64 m_sizeof_revisions = 0;
+  ON__UINT64 m_sizeof_base = 0;
+  ON__UINT32 m_settings_crc = 0;
+  ON__UINT32 m_model_info_crc = 0;
+
+  // Sorted by component id.
+  ON_SimpleArray<Internal_BaselineItem> m_baseline;
+
+private:
+  ONX_ModelIncrementalSave(const ONX_ModelIncrementalSave&) = delete;
+  ONX_ModelIncrementalSave& operator=(const ONX_ModelIncrementalSave&) = delete;
+};
+
+#include "opennurbs_model_incremental_save_defs.h"
+
+#endif
@@ -0,0 +1,928 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MODEL_INCREMENTAL_SAVE_DEFS_INC_)
+#define OPENNURBS_MODEL_INCREMENTAL_SAVE_DEFS_INC_
+
+// Revision file segment header. Values are little endian.
+//   [0,8)   "ON3DMREV"
+//   [8,12)  segment format version (1)
+//   [12,16) revision number
+//   [16,24) index size in bytes
+//   [24,32) records size in bytes
+//   [32,36) CRC of the index and records
+//   [36,40) CRC of bytes [0,36)
+// The index and the records are ON_Write3dmBufferArchive contents.
+#define ONX_MODEL_INCREMENTAL_SAVE_HEADER_SIZE 40
+
+inline const ON_wString ONX_ModelIncrementalSave::RevisionFileName(
+  const wchar_t* filename
+  )
+{
+  ON_wString revision_filename(filename);
+  if (revision_filename.IsNotEmpty())
+    revision_filename += L".3dmrev";
+  return revision_filename;
+}
+
+inline bool ONX_ModelIncrementalSave::Read(
+  ONX_Model& model,
+  const wchar_t* filename,
+  ON_TextLog* error_log
+  )
+{
+  ClearBaseline();
+  const ON_wString path(filename);
+  if (path.IsEmpty())
+    return false;
+  if (false == model.Read(filename, 0, 0, error_log))
+    return false;
+
+  ON_ClassArray<Internal_Segment> segments;
+  ON__UINT64 sizeof_segments = 0;
+  if (false == Internal_ReadSegments(RevisionFileName(filename), segments, &sizeof_segments))
+  {
+    if (nullptr != error_log)
+      error_log->Print("ONX_ModelIncrementalSave::Read - ignored an incomplete revision segment.\n");
+  }
+
+  ON_SimpleArray<Internal_IndexEntry> entries;
+  ON_SimpleArray<Internal_Reference> references;
+  ON_SimpleArray<unsigned int> entry_start(segments.Count() + 1);
+  ON_SimpleArray<unsigned int> reference_start(segments.Count() + 1);
+  unsigned int segment_count = 0;
+  for (/*empty init*/; segment_count < segments.UnsignedCount(); ++segment_count)
+  {
+    entry_start.Append(entries.UnsignedCount());
+    reference_start.Append(references.UnsignedCount());
+    if (false == Internal_ReadIndex(segment_count, segments[segment_count], entries, references))
+    {
+      entries.SetCount(entry_start[segment_count]);
+      references.SetCount(reference_start[segment_count]);
+      entry_start.Remove();
+      reference_start.Remove();
+      if (nullptr != error_log)
+        error_log->Print("ONX_ModelIncrementalSave::Read - revision %u index is corrupt.\n", segment_count + 1);
+      break;
+    }
+  }
+  entry_start.Append(entries.UnsignedCount());
+  reference_start.Append(references.UnsignedCount());
+
+  // Entries are in segment order. When a component is in several
+  // segments, only the entry in the last segment is applied.
+  ON_SimpleArray<unsigned int> order(entries.Count());
+  for (unsigned int i = 0; i < entries.UnsignedCount(); ++i)
+    order.Append(i);
+  const Internal_IndexEntry* e = entries.Array();
+  std::sort(order.Array(), order.Array() + order.Count(),
+    [e](unsigned int a, unsigned int b)
+    {
+      const int rc = ON_UuidCompare(e[a].m_id, e[b].m_id);
+      return (rc < 0 || (0 == rc && a < b));
+    }
+  );
+  for (unsigned int i = 1; i < order.UnsignedCount(); ++i)
+  {
+    if (e[order[i - 1]].m_id == e[order[i]].m_id)
+      entries[order[i - 1]].m_bSuperseded = true;
+  }
+
+  for (unsigned int s = 0; s < segment_count; ++s)
+  {
+    const bool rc = Internal_ApplySegment(
+      model,
+      segments[s],
+      entries.Array() + entry_start[s],
+      entry_start[s + 1] - entry_start[s],
+      references.Array() + reference_start[s],
+      reference_start[s + 1] - reference_start[s]
+      );
+    if (false == rc)
+    {
+      if (nullptr != error_log)
+        error_log->Print("ONX_ModelIncrementalSave::Read - revision %u could not be applied.\n", s + 1);
+      return false;
+    }
+  }
+
+  m_filename = path;
+  m_revision_count = segment_count;
+  // A revision file that is not completely used is replaced by the next Save().
+  m_sizeof_revisions = (segment_count == segments.UnsignedCount()) ? sizeof_segments : 0;
+  m_sizeof_base = Internal_FileSize(filename);
+  Internal_SetBaseline(model);
+  return true;
+}
+
+inline bool ONX_ModelIncrementalSave::Save(
+  const ONX_Model& model,
+  const wchar_t* filename,
+  ON_TextLog* error_log
+  )
+{
+  const ON_wString path(filename);
+  if (path.IsEmpty())
+  {
+    if (nullptr != error_log)
+      error_log->Print("ONX_ModelIncrementalSave::Save - filename is empty.\n");
+    return false;
+  }
+
+  if (false == m_bBaselineIsSet || m_filename != path)
+    return Compact(model, filename, error_log);
+  if (m_compaction_ratio > 0.0 && (double)m_sizeof_revisions > m_compaction_ratio * (double)m_sizeof_base)
+    return Compact(model, filename, error_log);
+  const ON_wString revision_filename = RevisionFileName(filename);
+  if (false == ON_FileSystem::IsFile(filename) || Internal_FileSize(revision_filename) != m_sizeof_revisions)
+    return Compact(model, filename, error_log);
+  if (Internal_ModelInfoCRC(model) != m_model_info_crc)
+    return Compact(model, filename, error_log);
+
+  ON_SimpleArray<Internal_Change> changes;
+  if (false == Internal_FindChanges(model, changes))
+    return Compact(model, filename, error_log);
+  if (0 == changes.Count() && Internal_SettingsCRC(model) == m_settings_crc)
+    return true;
+
+  // Index references to other components are written as model indices.
+  // The index lists the model index of every table component so Read()
+  // can map them to the indices in the model being read.
+  ON_Write3dmBufferArchive records(0, 0, ON_BinaryArchive::CurrentArchiveVersion(), ON::Version());
+  records.SetReferencedComponentIndexMapping(false);
+  records.SetReferencedComponentIdMapping(false);
+  bool rc = records.BeginWrite3dmAnonymousChunk(0);
+  if (rc)
+  {
+    rc = model.m_settings.Write(records);
+    if (false == records.EndWrite3dmChunk())
+      rc = false;
+  }
+
+  ON_SimpleArray<ON__UINT64> record_offset(changes.Count());
+  for (unsigned int i = 0; rc && i < changes.UnsignedCount(); ++i)
+  {
+    record_offset.Append(records.CurrentPosition());
+    if (nullptr != changes[i].m_component)
+      rc = Internal_WriteRecord(records, changes[i].m_component);
+  }
+
+  ON_SimpleArray<Internal_Reference> references;
+  unsigned int type_count = 0;
+  const ON_ModelComponent::Type* types = Internal_SegmentTypes(&type_count);
+  for (unsigned int t = 0; rc && t < type_count; ++t)
+  {
+    if (Internal_IsGeometryType(types[t]))
+      continue;
+    ONX_ModelComponentIterator it(model, types[t]);
+    for (const ON_ModelComponent* model_component = it.FirstComponent(); nullptr != model_component; model_component = it.NextComponent())
+    {
+      if (model_component->IsSystemComponent())
+        continue;
+      Internal_Reference& reference = references.AppendNew();
+      reference.m_type = types[t];
+      reference.m_index = model_component->Index();
+      reference.m_id = model_component->Id();
+    }
+  }
+
+  const unsigned int revision = m_revision_count + 1;
+  ON_Write3dmBufferArchive index(0, 0, ON_BinaryArchive::CurrentArchiveVersion(), ON::Version());
+  if (rc)
+    rc = index.BeginWrite3dmAnonymousChunk(0);
+  if (rc)
+  {
+    rc = index.WriteInt(revision)
+      && index.WriteInt(records.Archive3dmVersion())
+      && index.WriteInt(ON::Version())
+      && index.WriteInt(references.UnsignedCount());
+    for (unsigned int i = 0; rc && i < references.UnsignedCount(); ++i)
+    {
+      rc = index.WriteInt(static_cast<unsigned int>(references[i].m_type))
+        && index.WriteInt(references[i].m_index)
+        && index.WriteUuid(references[i].m_id);
+    }
+    if (rc)
+      rc = index.WriteInt(changes.UnsignedCount());
+    for (unsigned int i = 0; rc && i < changes.UnsignedCount(); ++i)
+    {
+      rc = index.WriteInt(static_cast<unsigned int>(changes[i].m_type))
+        && index.WriteUuid(changes[i].m_id)
+        && index.WriteBool(nullptr == changes[i].m_component)
+        && index.WriteBigSize((size_t)record_offset[i]);
+    }
+    if (false == index.EndWrite3dmChunk())
+      rc = false;
+  }
+
+  if (false == rc)
+  {
+    if (nullptr != error_log)
+      error_log->Print("ONX_ModelIncrementalSave::Save - unable to write revision %u.\n", revision);
+    return false;
+  }
+
+  if (false == Internal_AppendSegment(revision_filename, revision, index, records))
+  {
+    // The file size no longer matches m_sizeof_revisions,
+    // so the next Save() compacts.
+    if (nullptr != error_log)
+      error_log->Print("ONX_ModelIncrementalSave::Save - unable to append revision %u.\n", revision);
+    return false;
+  }
+
+  m_revision_count = revision;
+  m_sizeof_revisions += ONX_MODEL_INCREMENTAL_SAVE_HEADER_SIZE + index.SizeOfArchive() + records.SizeOfArchive();
+  Internal_SetBaseline(model);
+  return true;
+}
+
+inline bool ONX_ModelIncrementalSave::Compact(
+  const ONX_Model& model,
+  const wchar_t* filename,
+  ON_TextLog* error_log
+  )
+{
+  ClearBaseline();
+  const ON_wString path(filename);
+  if (path.IsEmpty())
+    return false;
+
+  // Until the new 3dm file replaces filename, filename and the revision
+  // file are the only good copy of the model.
+  const ON_wString temporary_filename = path + L".tmp";
+  if (false == model.Write(temporary_filename, 0, error_log))
+  {
+    ON_FileSystem::RemoveFile(temporary_filename);
+    return false;
+  }
+
+  // The revisions must never be applied to the new 3dm file. They are
+  // moved aside before it replaces filename and deleted after.
+  const ON_wString revision_filename = RevisionFileName(filename);
+  const ON_wString old_revision_filename = revision_filename + L".tmp";
+  const bool bHasRevisions = ON_FileSystem::IsFile(revision_filename);
+  if (bHasRevisions && false == Internal_ReplaceFile(revision_filename, old_revision_filename))
+  {
+    ON_FileSystem::RemoveFile(temporary_filename);
+    if (nullptr != error_log)
+      error_log->Print("ONX_ModelIncrementalSave::Compact - unable to move the revision file.\n");
+    return false;
+  }
+  if (false == Internal_ReplaceFile(temporary_filename, filename))
+  {
+    if (bHasRevisions)
+      Internal_ReplaceFile(old_revision_filename, revision_filename);
+    ON_FileSystem::RemoveFile(temporary_filename);
+    if (nullptr != error_log)
+      error_log->Print("ONX_ModelIncrementalSave::Compact - unable to replace the 3dm file.\n");
+    return false;
+  }
+  if (bHasRevisions)
+    ON_FileSystem::RemoveFile(old_revision_filename);
+
+  m_filename = path;
+  m_sizeof_base = Internal_FileSize(filename);
+  Internal_SetBaseline(model);
+  return true;
+}
+
+inline void ONX_ModelIncrementalSave::ClearBaseline()
+{
+  m_filename = ON_wString::EmptyString;
+  m_bBaselineIsSet = false;
+  m_revision_count = 0;
+  m_sizeof_revisions = 0;
+  m_sizeof_base = 0;
+  m_settings_crc = 0;
+  m_model_info_crc = 0;
+  m_baseline.SetCount(0);
+}
+
+inline unsigned int ONX_ModelIncrementalSave::RevisionCount() const
+{
+  return m_revision_count;
+}
+
+inline ON__UINT64 ONX_ModelIncrementalSave::SizeOfRevisions() const
+{
+  return m_sizeof_revisions;
+}
+
+inline void ONX_ModelIncrementalSave::SetCompactionRatio(
+  double compaction_ratio
+  )
+{
+  m_compaction_ratio = (compaction_ratio > 0.0) ? compaction_ratio : 0.0;
+}
+
+inline double ONX_ModelIncrementalSave::CompactionRatio() const
+{
+  return m_compaction_ratio;
+}
+
+inline void ONX_ModelIncrementalSave::SetCompareContentCRC(
+  bool bCompareContentCRC
+  )
+{
+  // The saved CRC values depend on this setting.
+  if (m_bCompareContentCRC != bCompareContentCRC)
+    ClearBaseline();
+  m_bCompareContentCRC = bCompareContentCRC;
+}
+
+inline bool ONX_ModelIncrementalSave::CompareContentCRC() const
+{
+  return m_bCompareContentCRC;
+}
+
+inline const ON_ModelComponent::Type* ONX_ModelIncrementalSave::Internal_SegmentTypes(
+  unsigned int* count
+  )
+{
+  // Components are applied in this order so that index references
+  // are mapped before they are read.
+  static const ON_ModelComponent::Type types[] =
+  {
+    ON_ModelComponent::Type::Image,
+    ON_ModelComponent::Type::TextureMapping,
+    ON_ModelComponent::Type::Material,
+    ON_ModelComponent::Type::LinePattern,
+    ON_ModelComponent::Type::Layer,
+    ON_ModelComponent::Type::Group,
+    ON_ModelComponent::Type::TextStyle,
+    ON_ModelComponent::Type::DimStyle,
+    ON_ModelComponent::Type::HatchPattern,
+    ON_ModelComponent::Type::SectionStyle,
+    ON_ModelComponent::Type::InstanceDefinition,
+    ON_ModelComponent::Type::RenderLight,
+    ON_ModelComponent::Type::ModelGeometry
+  };
+  *count = (unsigned int)(sizeof(types) / sizeof(types[0]));
+  return types;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_IsSegmentType(
+  ON_ModelComponent::Type type
+  )
+{
+  unsigned int type_count = 0;
+  const ON_ModelComponent::Type* types = Internal_SegmentTypes(&type_count);
+  for (unsigned int t = 0; t < type_count; ++t)
+  {
+    if (type == types[t])
+      return true;
+  }
+  return false;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_IsGeometryType(
+  ON_ModelComponent::Type type
+  )
+{
+  return (ON_ModelComponent::Type::ModelGeometry == type || ON_ModelComponent::Type::RenderLight == type);
+}
+
+inline int ONX_ModelIncrementalSave::Internal_CompareBaselineId(
+  const Internal_BaselineItem* a,
+  const Internal_BaselineItem* b
+  )
+{
+  return ON_UuidCompare(a->m_mark.ComponentId(), b->m_mark.ComponentId());
+}
+
+inline ON__UINT32 ONX_ModelIncrementalSave::Internal_ContentCRC(
+  const ON_ModelComponent* model_component
+  ) const
+{
+  if (false == m_bCompareContentCRC || nullptr == model_component)
+    return 0;
+  const ON_ModelGeometryComponent* model_geometry = ON_ModelGeometryComponent::Cast(model_component);
+  if (nullptr == model_geometry)
+    return model_component->DataCRC(0);
+  ON__UINT32 crc = 0;
+  const ON_Geometry* geometry = model_geometry->Geometry(nullptr);
+  if (nullptr != geometry)
+    crc = geometry->DataCRC(crc);
+  const ON_3dmObjectAttributes* attributes = model_geometry->Attributes(nullptr);
+  if (nullptr != attributes)
+    crc = attributes->DataCRC(crc);
+  return crc;
+}
+
+inline ON__UINT32 ONX_ModelIncrementalSave::Internal_SettingsCRC(
+  const ONX_Model& model
+  )
+{
+  ON_Write3dmBufferArchive archive(0, 0, ON_BinaryArchive::CurrentArchiveVersion(), ON::Version());
+  archive.SetReferencedComponentIndexMapping(false);
+  archive.SetReferencedComponentIdMapping(false);
+  if (false == model.m_settings.Write(archive))
+    return 0;
+  return ON_CRC32(0, archive.SizeOfArchive(), archive.Buffer());
+}
+
+inline ON__UINT32 ONX_ModelIncrementalSave::Internal_ModelInfoCRC(
+  const ONX_Model& model
+  )
+{
+  ON_Write3dmBufferArchive archive(0, 0, ON_BinaryArchive::CurrentArchiveVersion(), ON::Version());
+  ON__UINT32 crc = model.m_properties.Write(archive) ? ON_CRC32(0, archive.SizeOfArchive(), archive.Buffer()) : 0;
+  const ON_String& comments = model.m_sStartSectionComments;
+  crc = ON_CRC32(crc, (size_t)comments.Length(), static_cast<const char*>(comments));
+  return crc;
+}
+
+inline void ONX_ModelIncrementalSave::Internal_SetBaseline(
+  const ONX_Model& model
+  )
+{
+  m_baseline.SetCount(0);
+  for (unsigned int t = 1; t < static_cast<unsigned int>(ON_ModelComponent::Type::NumOf); ++t)
+  {
+    const ON_ModelComponent::Type type = ON_ModelComponent::ComponentTypeFromUnsigned(t);
+    if (ON_ModelComponent::Type::Unset == type || ON_ModelComponent::Type::ObsoleteValue == type)
+      continue;
+    ONX_ModelComponentIterator it(model, type);
+    for (const ON_ModelComponent* model_component = it.FirstComponent(); nullptr != model_component; model_component = it.NextComponent())
+    {
+      if (model_component->IsSystemComponent())
+        continue;
+      Internal_BaselineItem& item = m_baseline.AppendNew();
+      item.m_mark.Set(model_component);
+      item.m_content_crc = Internal_ContentCRC(model_component);
+    }
+  }
+  m_baseline.QuickSort(Internal_CompareBaselineId);
+  m_settings_crc = Internal_SettingsCRC(model);
+  m_model_info_crc = Internal_ModelInfoCRC(model);
+  m_bBaselineIsSet = true;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_FindChanges(
+  const ONX_Model& model,
+  ON_SimpleArray<Internal_Change>& changes
+  ) const
+{
+  changes.SetCount(0);
+  ON_SimpleArray<bool> found(m_baseline.Count());
+  found.SetCount(m_baseline.Count());
+  found.Zero();
+
+  for (unsigned int t = 1; t < static_cast<unsigned int>(ON_ModelComponent::Type::NumOf); ++t)
+  {
+    const ON_ModelComponent::Type type = ON_ModelComponent::ComponentTypeFromUnsigned(t);
+    if (ON_ModelComponent::Type::Unset == type || ON_ModelComponent::Type::ObsoleteValue == type)
+      continue;
+    const bool bSegmentType = Internal_IsSegmentType(type);
+    ONX_ModelComponentIterator it(model, type);
+    for (const ON_ModelComponent* model_component = it.FirstComponent(); nullptr != model_component; model_component = it.NextComponent())
+    {
+      if (model_component->IsSystemComponent())
+        continue;
+      Internal_BaselineItem key;
+      key.m_mark.Set(model_component);
+      const int i = m_baseline.BinarySearch(&key, Internal_CompareBaselineId);
+      if (i >= 0)
+      {
+        found[i] = true;
+        if (m_baseline[i].m_mark.EqualContent(model_component) && m_baseline[i].m_content_crc == Internal_ContentCRC(model_component))
+          continue;
+      }
+      if (false == bSegmentType)
+        return false;
+      Internal_Change& change = changes.AppendNew();
+      change.m_type = type;
+      change.m_id = model_component->Id();
+      change.m_component = model_component;
+    }
+  }
+
+  for (unsigned int i = 0; i < m_baseline.UnsignedCount(); ++i)
+  {
+    if (found[i])
+      continue;
+    const ON_ModelComponent::Type type = m_baseline[i].m_mark.ComponentType();
+    if (false == Internal_IsSegmentType(type))
+      return false;
+    Internal_Change& change = changes.AppendNew();
+    change.m_type = type;
+    change.m_id = m_baseline[i].m_mark.ComponentId();
+    change.m_component = nullptr;
+  }
+
+  return true;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_WriteRecord(
+  ON_BinaryArchive& archive,
+  const ON_ModelComponent* model_component
+  )
+{
+  if (false == archive.BeginWrite3dmAnonymousChunk(0))
+    return false;
+  bool rc = false;
+  const ON_ModelGeometryComponent* model_geometry = ON_ModelGeometryComponent::Cast(model_component);
+  if (nullptr != model_geometry)
+  {
+    const ON_Geometry* geometry = model_geometry->Geometry(nullptr);
+    const ON_3dmObjectAttributes* attributes = model_geometry->Attributes(nullptr);
+    rc = nullptr != geometry
+      && nullptr != attributes
+      && archive.WriteObject(geometry)
+      && archive.WriteObject(attributes);
+  }
+  else
+  {
+    rc = archive.WriteObject(model_component);
+  }
+  if (false == archive.EndWrite3dmChunk())
+    rc = false;
+  return rc;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_ReadRecord(
+  ON_BinaryArchive& archive,
+  ONX_Model& model,
+  ON_ModelComponent::Type type,
+  const ON_UUID& id,
+  ON_SimpleArray<ON_UUID>& renamed_ids
+  )
+{
+  int version = 0;
+  if (false == archive.BeginRead3dmAnonymousChunk(&version))
+    return false;
+
+  bool rc = false;
+  ON_Object* object = nullptr;
+  ON_Object* attributes_object = nullptr;
+  for (;;)
+  {
+    if (1 != archive.ReadObject(&object))
+      break;
+
+    if (Internal_IsGeometryType(type))
+    {
+      if (1 != archive.ReadObject(&attributes_object))
+        break;
+      ON_3dmObjectAttributes* attributes = ON_3dmObjectAttributes::Cast(attributes_object);
+      if (nullptr == attributes || id != attributes->m_uuid)
+        break;
+      model.RemoveModelComponent(type, id);
+      rc = false == model.AddManagedModelGeometryComponent(object, attributes, false).IsEmpty();
+      if (rc)
+      {
+        object = nullptr;
+        attributes_object = nullptr;
+      }
+      break;
+    }
+
+    ON_ModelComponent* model_component = ON_ModelComponent::Cast(object);
+    if (nullptr == model_component || id != model_component->Id())
+      break;
+
+    // Table components are updated in place so that their model index,
+    // and the references to it from components read earlier, do not
+    // change. A new name is set in the manifest by
+    // Internal_RenameManifestItems().
+    const ON__UINT64 sn = model.ComponentFromId(type, id).ModelComponentRuntimeSerialNumber();
+    if (0 != sn)
+    {
+      ON_ModelComponent* existing = model.ComponentFromRuntimeSerialNumber(sn).ExclusiveModelComponent();
+      if (nullptr != existing)
+      {
+        const bool bRenamed = !(existing->NameHash() == model_component->NameHash());
+        if (static_cast<ON_Object*>(existing)->CopyFrom(model_component))
+        {
+          if (bRenamed)
+            renamed_ids.Append(id);
+          rc = true;
+          break;
+        }
+      }
+      model.RemoveModelComponent(type, id);
+    }
+    rc = false == model.AddModelComponentForExperts(model_component, true, true, true).IsEmpty();
+    if (rc)
+      object = nullptr;
+    break;
+  }
+
+  if (false == archive.EndRead3dmChunk())
+    rc = false;
+  delete object;
+  delete attributes_object;
+  return rc;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_RenameManifestItems(
+  ONX_Model& model,
+  ON_ModelComponent::Type type,
+  const ON_SimpleArray<ON_UUID>& renamed_ids
+  )
+{
+  // ONX_Model has no function to rename a component, so the manifest,
+  // which model owns, is modified directly. The old names are released
+  // first so that names exchanged between components do not collide.
+  ON_ComponentManifest& manifest = const_cast<ON_ComponentManifest&>(model.Manifest());
+  for (unsigned int i = 0; i < renamed_ids.UnsignedCount(); ++i)
+    manifest.ChangeComponentNameHash(renamed_ids[i], ON_NameHash::EmptyNameHash);
+  for (unsigned int i = 0; i < renamed_ids.UnsignedCount(); ++i)
+  {
+    const ON_ModelComponent* model_component = model.ComponentFromId(type, renamed_ids[i]).ModelComponent();
+    if (nullptr == model_component || manifest.ChangeComponentName(*model_component).IsUnset())
+      return false;
+  }
+  return true;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_ReadSegments(
+  const wchar_t* revision_filename,
+  ON_ClassArray<Internal_Segment>& segments,
+  ON__UINT64* sizeof_segments
+  )
+{
+  static const ON__UINT8 magic[8] = { 'O','N','3','D','M','R','E','V' };
+
+  segments.SetCount(0);
+  *sizeof_segments = 0;
+  FILE* fp = ON_FileStream::Open(revision_filename, L"rb");
+  if (nullptr == fp)
+    return true;
+
+  bool rc = true;
+  for (;;)
+  {
+    ON__UINT8 header[ONX_MODEL_INCREMENTAL_SAVE_HEADER_SIZE];
+    const ON__UINT64 sizeof_header = ON_FileStream::Read(fp, sizeof(header), header);
+    if (0 == sizeof_header)
+      break;
+    rc = false;
+    if (sizeof(header) != sizeof_header
+      || 0 != memcmp(header, magic, sizeof(magic))
+      || ON_CRC32(0, 36, header) != (ON__UINT32)ON_LittleEndianValue(header + 36, 4)
+      || 1 != ON_LittleEndianValue(header + 8, 4)
+      )
+      break;
+    const ON__UINT64 sizeof_index = ON_LittleEndianValue(header + 16, 8);
+    const ON__UINT64 sizeof_records = ON_LittleEndianValue(header + 24, 8);
+    if (sizeof_index > 0x7FFFFFFF || sizeof_records > 0x7FFFFFFF)
+      break;
+
+    Internal_Segment& segment = segments.AppendNew();
+    segment.m_index.SetCapacity((size_t)sizeof_index);
+    segment.m_index.SetCount((int)sizeof_index);
+    segment.m_records.SetCapacity((size_t)sizeof_records);
+    segment.m_records.SetCount((int)sizeof_records);
+    ON__UINT32 crc = 0;
+    if (sizeof_index == ON_FileStream::Read(fp, sizeof_index, segment.m_index.Array())
+      && sizeof_records == ON_FileStream::Read(fp, sizeof_records, segment.m_records.Array())
+      )
+    {
+      crc = ON_CRC32(0, (size_t)sizeof_index, segment.m_index.Array());
+      crc = ON_CRC32(crc, (size_t)sizeof_records, segment.m_records.Array());
+    }
+    if (crc != (ON__UINT32)ON_LittleEndianValue(header + 32, 4))
+    {
+      segments.Remove();
+      break;
+    }
+    *sizeof_segments += sizeof(header) + sizeof_index + sizeof_records;
+    rc = true;
+  }
+
+  ON_FileStream::Close(fp);
+  return rc;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_ReadIndex(
+  unsigned int segment_index,
+  Internal_Segment& segment,
+  ON_SimpleArray<Internal_IndexEntry>& entries,
+  ON_SimpleArray<Internal_Reference>& references
+  )
+{
+  ON_Read3dmBufferArchive archive(
+    segment.m_index.UnsignedCount(),
+    segment.m_index.Array(),
+    false,
+    ON_BinaryArchive::CurrentArchiveVersion(),
+    ON::Version()
+    );
+
+  int version = 0;
+  if (false == archive.BeginRead3dmAnonymousChunk(&version))
+    return false;
+
+  bool rc = false;
+  for (;;)
+  {
+    unsigned int revision = 0;
+    unsigned int count = 0;
+    if (false == archive.ReadInt(&revision)
+      || false == archive.ReadInt(&segment.m_archive_3dm_version)
+      || false == archive.ReadInt(&segment.m_archive_opennurbs_version)
+      || false == archive.ReadInt(&count)
+      )
+      break;
+
+    unsigned int i;
+    for (i = 0; i < count; ++i)
+    {
+      unsigned int type = 0;
+      Internal_Reference& reference = references.AppendNew();
+      reference.m_segment = segment_index;
+      if (false == archive.ReadInt(&type)
+        || false == archive.ReadInt(&reference.m_index)
+        || false == archive.ReadUuid(reference.m_id)
+        )
+        break;
+      reference.m_type = ON_ModelComponent::ComponentTypeFromUnsigned(type);
+    }
+    if (i < count || false == archive.ReadInt(&count))
+      break;
+
+    for (i = 0; i < count; ++i)
+    {
+      unsigned int type = 0;
+      size_t record_offset = 0;
+      Internal_IndexEntry& entry = entries.AppendNew();
+      entry.m_segment = segment_index;
+      if (false == archive.ReadInt(&type)
+        || false == archive.ReadUuid(entry.m_id)
+        || false == archive.ReadBool(&entry.m_bDeleted)
+        || false == archive.ReadBigSize(&record_offset)
+        )
+        break;
+      entry.m_type = ON_ModelComponent::ComponentTypeFromUnsigned(type);
+      entry.m_record_offset = record_offset;
+      if (false == Internal_IsSegmentType(entry.m_type))
+        break;
+    }
+    rc = (i == count);
+    break;
+  }
+
+  if (false == archive.EndRead3dmChunk())
+    rc = false;
+  return rc;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_ApplySegment(
+  ONX_Model& model,
+  const Internal_Segment& segment,
+  const Internal_IndexEntry* entries,
+  unsigned int entry_count,
+  const Internal_Reference* references,
+  unsigned int reference_count
+  )
+{
+  for (unsigned int i = 0; i < entry_count; ++i)
+  {
+    if (entries[i].m_bDeleted && false == entries[i].m_bSuperseded)
+      model.RemoveModelComponent(entries[i].m_type, entries[i].m_id);
+  }
+
+  ON_Read3dmBufferArchive archive(
+    segment.m_records.UnsignedCount(),
+    segment.m_records.Array(),
+    false,
+    segment.m_archive_3dm_version,
+    segment.m_archive_opennurbs_version
+    );
+  archive.SetReferencedComponentIdMapping(false);
+
+  ON_SimpleArray<ON_UUID> renamed_ids;
+  unsigned int type_count = 0;
+  const ON_ModelComponent::Type* types = Internal_SegmentTypes(&type_count);
+  for (unsigned int t = 0; t < type_count; ++t)
+  {
+    for (unsigned int i = 0; i < entry_count; ++i)
+    {
+      const Internal_IndexEntry& entry = entries[i];
+      if (types[t] != entry.m_type || entry.m_bDeleted || entry.m_bSuperseded)
+        continue;
+      if (false == archive.SeekFromStart((ON__INT64)entry.m_record_offset))
+        return false;
+      if (false == Internal_ReadRecord(archive, model, entry.m_type, entry.m_id, renamed_ids))
+        return false;
+    }
+    if (renamed_ids.Count() > 0)
+    {
+      if (false == Internal_RenameManifestItems(model, types[t], renamed_ids))
+        return false;
+      renamed_ids.SetCount(0);
+    }
+
+    // Map the writer's model indices of this type to the indices in
+    // model before reading components that reference them.
+    for (unsigned int i = 0; i < reference_count; ++i)
+    {
+      if (types[t] != references[i].m_type)
+        continue;
+      const ON_ModelComponentReference model_component_reference = model.ComponentFromId(types[t], references[i].m_id);
+      const ON_ModelComponent* model_component = model_component_reference.ModelComponent();
+      if (nullptr == model_component)
+        continue;
+      ON_ManifestMapItem map_item;
+      if (map_item.SetSourceIdentification(types[t], references[i].m_id, references[i].m_index)
+        && map_item.SetDestinationIdentification(model_component)
+        )
+        archive.AddManifestMapItem(map_item);
+    }
+  }
+
+  // Settings are read last because they reference layers and materials.
+  int version = 0;
+  if (false == archive.SeekFromStart(0) || false == archive.BeginRead3dmAnonymousChunk(&version))
+    return false;
+  bool rc = model.m_settings.Read(archive);
+  if (false == archive.EndRead3dmChunk())
+    rc = false;
+  return rc;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_AppendSegment(
+  const wchar_t* revision_filename,
+  unsigned int revision,
+  const ON_Write3dmBufferArchive& index,
+  const ON_Write3dmBufferArchive& records
+  )
+{
+  const ON__UINT64 sizeof_index = index.SizeOfArchive();
+  const ON__UINT64 sizeof_records = records.SizeOfArchive();
+  ON__UINT32 crc = ON_CRC32(0, (size_t)sizeof_index, index.Buffer());
+  crc = ON_CRC32(crc, (size_t)sizeof_records, records.Buffer());
+
+  ON__UINT8 header[ONX_MODEL_INCREMENTAL_SAVE_HEADER_SIZE];
+  memcpy(header, "ON3DMREV", 8);
+  ON_SetLittleEndianValue(1, 4, header + 8);
+  ON_SetLittleEndianValue(revision, 4, header + 12);
+  ON_SetLittleEndianValue(sizeof_index, 8, header + 16);
+  ON_SetLittleEndianValue(sizeof_records, 8, header + 24);
+  ON_SetLittleEndianValue(crc, 4, header + 32);
+  ON_SetLittleEndianValue(ON_CRC32(0, 36, header), 4, header + 36);
+
+  FILE* fp = ON_FileStream::Open(revision_filename, L"ab");
+  if (nullptr == fp)
+    return false;
+  bool rc
+    = sizeof(header) == ON_FileStream::Write(fp, sizeof(header), header)
+    && sizeof_index == ON_FileStream::Write(fp, sizeof_index, index.Buffer())
+    && sizeof_records == ON_FileStream::Write(fp, sizeof_records, records.Buffer());
+  if (0 != ON_FileStream::Close(fp))
+    rc = false;
+  return rc;
+}
+
+inline ON__UINT64 ONX_ModelIncrementalSave::Internal_FileSize(
+  const wchar_t* filename
+  )
+{
+  FILE* fp = ON_FileStream::Open(filename, L"rb");
+  if (nullptr == fp)
+    return 0;
+  ON__UINT64 sizeof_file = 0;
+  if (ON_FileStream::SeekFromEnd(fp, 0))
+  {
+    const ON__INT64 position = ON_FileStream::CurrentPosition(fp);
+    if (position > 0)
+      sizeof_file = (ON__UINT64)position;
+  }
+  ON_FileStream::Close(fp);
+  return sizeof_file;
+}
+
+inline bool ONX_ModelIncrementalSave::Internal_ReplaceFile(
+  const wchar_t* source,
+  const wchar_t* destination
+  )
+{
+#if defined(ON_RUNTIME_WIN) && !defined(ON_NO_WINDOWS)
+  return 0 != ::MoveFileExW(source, destination, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#elif defined(ON_RUNTIME_WIN)
+  if (ON_FileSystem::IsFile(destination))
+    ON_FileSystem::RemoveFile(destination);
+  return 0 == ::_wrename(source, destination);
+#else
+  // rename() replaces destination atomically.
+  const ON_String utf8_source(source);
+  const ON_String utf8_destination(destination);
+  return 0 == ::rename(static_cast<const char*>(utf8_source), static_cast<const char*>(utf8_destination));
+#endif
+}
+
+#undef ONX_MODEL_INCREMENTAL_SAVE_HEADER_SIZE
+
+#endif
@@ -0,0 +1,279 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MODEL_LAZY_GEOMETRY_INC_)
+#define OPENNURBS_MODEL_LAZY_GEOMETRY_INC_
+
+/*
+Description:
+  An ONX_LazyModelGeometryItem is the index entry for one object record
+  in the object table of a 3dm file that is opened by ONX_LazyModelGeometry.
+*/
+class ONX_LazyModelGeometryItem
+{
+public:
+  ONX_LazyModelGeometryItem() = default;
+  ~ONX_LazyModelGeometryItem() = default;
+  ONX_LazyModelGeometryItem(const ONX_LazyModelGeometryItem&) = default;
+  ONX_LazyModelGeometryItem& operator=(const ONX_LazyModelGeometryItem&) = default;
+
+public:
+  // Archive offset of the object record.
+  ON__UINT64 m_record_offset = 0;
+
+  // Object id from the object attributes.
+  ON_UUID m_id = ON_nil_uuid;
+
+  ON::object_type m_object_type = ON::unknown_object_type;
+
+  // Model layer index from the object attributes.
+  int m_layer_index = ON_UNSET_INT_INDEX;
+
+  // 3dm files do not store object bounding boxes. m_bbox is set the
+  // first time the geometry is loaded or by
+  // ONX_LazyModelGeometry::ComputeBoundingBoxes().
+  ON_BoundingBox m_bbox = ON_BoundingBox::UnsetBoundingBox;
+};
+
+/*
+Description:
+  ONX_LazyModelGeometry opens a 3dm file and reads every table except
+  the model geometry. The object table is only indexed: for each object
+  record, the file offset, object type, id and layer are read. The
+  geometry of an object is read the first time it is requested, and is
+  then kept in a least recently used cache with a memory budget.
+  - Opening a large file takes the time needed to read the attributes
+    of the objects, not the time needed to read the geometry.
+  - Memory use is the size of the non-geometry tables, the index and
+    the cache budget.
+Remarks:
+  - The file is mapped with ON_MappedFileArchive and must stay unchanged
+    while it is open.
+  - Version 6 and later files can be opened lazily. Use ONX_Model::Read()
+    for earlier files.
+  - Model() contains every component except the model geometry.
+    ONX_ModelComponentIterator iterates the components in Model(), so
+    geometry has to be requested from this class with ModelGeometry().
+  - Loaded geometry is not added to Model(). Its index is the order
+    it was read from the worker archive, not a model index.
+  - An ON_ModelComponentReference returned by ModelGeometry() keeps
+    the geometry alive after it leaves the cache.
+  - ONX_LazyModelGeometry is not thread safe.
+Example:
+
+        ONX_LazyModelGeometry lazy;
+        lazy.SetMemoryBudget(512*1024*1024);
+        if (lazy.Open(L"large_model.3dm", 0, 0, nullptr))
+        {
+          for (unsigned int i = 0; i < lazy.Count(); ++i)
+          {
+            if (ON::mesh_object != lazy.Item(i).m_object_type)
+              continue;
+            ON_ModelComponentReference mg = lazy.ModelGeometry(i);
+            ...
+          }
+        }
+
+*/
+class ONX_LazyModelGeometry
+{
+public:
+  ONX_LazyModelGeometry() = default;
+  ~ONX_LazyModelGeometry();
+
+  /*
+  Description:
+    Open a 3dm file, read the tables that are not model geometry and
+    index the object table.
+  Parameters:
+    filename - [in]
+    model_object_type_filter - [in]
+      If not zero, a bitfield made by bitwise oring ON::object_type values
+      to select which types of objects are indexed.
+    thread_count - [in]
+      Maximum number of threads used to index the object table.
+      0 = use the hardware thread count.
+    error_log - [out]
+      Pass nullptr if you don't want to log errors.
+  Returns:
+    True if the file was opened.
+  */
+  bool Open(
+    const wchar_t* filename,
+    unsigned int model_object_type_filter,
+    unsigned int thread_count,
+    ON_TextLog* error_log
+    );
+
+  bool Open(
+    const char* filename,
+    unsigned int model_object_type_filter,
+    unsigned int thread_count,
+    ON_TextLog* error_log
+    );
+
+  /*
+  Description:
+    Close the file, clear the index and the cache and reset Model().
+    References returned by ModelGeometry() stay valid.
+  */
+  void Close();
+
+  bool IsOpen() const;
+
+  /*
+  Returns:
+    The model read from the file, without the model geometry.
+  */
+  const class ONX_Model& Model() const;
+  class ONX_Model& Model();
+
+  /*
+  Returns:
+    Number of indexed object records.
+  */
+  unsigned int Count() const;
+
+  /*
+  Returns:
+    The index item or an item with unset values if i is not valid.
+  */
+  const ONX_LazyModelGeometryItem& Item(
+    unsigned int i
+    ) const;
+
+  /*
+  Returns:
+    The index of the item with this object id or ON_UNSET_UINT_INDEX.
+  */
+  unsigned int ItemIndexFromId(
+    ON_UUID id
+    ) const;
+
+  /*
+  Description:
+    Get the model geometry for an index item. The geometry is read
+    if it is not in the cache.
+  Parameters:
+    i - [in]
+      0 <= i < Count()
+  Returns:
+    A reference to an ON_ModelGeometryComponent or an empty reference
+    if the record could not be read.
+  */
+  ON_ModelComponentReference ModelGeometry(
+    unsigned int i
+    );
+
+  /*
+  Returns:
+    True if the geometry for item i is in the cache.
+  */
+  bool IsCached(
+    unsigned int i
+    ) const;
+
+  /*
+  Description:
+    Set the cache memory budget in bytes. The default is 256 MB.
+    The most recently loaded geometry is always cached, even when it
+    is larger than the budget.
+  */
+  void SetMemoryBudget(
+    size_t memory_budget
+    );
+
+  size_t MemoryBudget() const;
+
+  /*
+  Returns:
+    Estimated number of bytes used by the cached geometry.
+  */
+  size_t CachedMemory() const;
+
+  /*
+  Description:
+    Remove everything from the cache.
+  */
+  void ClearCache();
+
+  /*
+  Description:
+    Read every object that does not have a bounding box, set
+    ONX_LazyModelGeometryItem::m_bbox and discard the geometry.
+    The cache is not changed.
+  Parameters:
+    thread_count - [in]
+      Maximum number of threads. 0 = use the hardware thread count.
+  Returns:
+    True if every object was read.
+  */
+  bool ComputeBoundingBoxes(
+    unsigned int thread_count
+    );
+
+private:
+  // Read the type and attributes of the object record at record_offset.
+  // Returns false if the record type is excluded by the filter.
+  bool Internal_IndexRecord(
+    class ON_Read3dmBufferArchive& table_archive,
+    ON__UINT64 record_offset,
+    unsigned int model_object_type_filter,
+    ONX_LazyModelGeometryItem& item
+    ) const;
+
+  void Internal_LinkFirst(unsigned int i);
+  void Internal_Unlink(unsigned int i);
+  void Internal_Evict(unsigned int keep);
+
+private:
+  class ON_MappedFileArchive m_archive;
+  class ONX_Model m_model;
+
+  ON__UINT64 m_table_offset = 0;
+  ON__UINT64 m_sizeof_table = 0;
+  ON__UINT64 m_end_of_table_offset = 0;
+
+  // Reads geometry for ModelGeometry().
+  class ON_Read3dmBufferArchive* m_loader = nullptr;
+
+  ON_SimpleArray<ONX_LazyModelGeometryItem> m_item;
+
+  // m_id_index[] is sorted by id.
+  ON_SimpleArray<ON_UuidIndex> m_id_index;
+
+  // Least recently used list of cached geometry. m_cache[i] is empty when
+  // item i is not cached. m_lru_first is the most recently used item.
+  class Internal_CacheLink
+  {
+  public:
+    unsigned int m_prev = ON_UNSET_UINT_INDEX;
+    unsigned int m_next = ON_UNSET_UINT_INDEX;
+    size_t m_sizeof_geometry = 0;
+  };
+  ON_ClassArray<ON_ModelComponentReference> m_cache;
+  ON_SimpleArray<Internal_CacheLink> m_cache_link;
+  unsigned int m_lru_first = ON_UNSET_UINT_INDEX;
+  unsigned int m_lru_last = ON_UNSET_UINT_INDEX;
+  size_t m_cached_memory = 0;
+  size_t m_memory_budget = 256 * 1024 * 1024;
+
+private:
+  // prohibit copy construction and operator=
+  ONX_LazyModelGeometry(const ONX_LazyModelGeometry&) = delete;
+  ONX_LazyModelGeometry& operator=(const ONX_LazyModelGeometry&) = delete;
+};
+
+#include "opennurbs_model_lazy_geometry_defs.h"
+
+#endif
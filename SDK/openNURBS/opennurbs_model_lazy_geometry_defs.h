@@ -0,0 +1,444 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MODEL_LAZY_GEOMETRY_DEFS_INC_)
+#define OPENNURBS_MODEL_LAZY_GEOMETRY_DEFS_INC_
+
+inline ONX_LazyModelGeometry::~ONX_LazyModelGeometry()
+{
+  Close();
+}
+
+inline bool ONX_LazyModelGeometry::Open(
+  const wchar_t* filename,
+  unsigned int model_object_type_filter,
+  unsigned int thread_count,
+  ON_TextLog* error_log
+  )
+{
+  Close();
+
+  if (false == m_archive.Open(filename))
+  {
+    if (nullptr != error_log)
+      error_log->Print("ONX_LazyModelGeometry::Open - unable to map the file.\n");
+    return false;
+  }
+  m_archive.SetArchiveFullPath(filename);
+
+  if (false == m_model.IncrementalReadBegin(m_archive, true, 0, error_log))
+  {
+    Close();
+    return false;
+  }
+
+  const bool bTableIsActive = (ON_3dmArchiveTableType::object_table == m_archive.Active3dmTable());
+  ON_SimpleArray<ON__UINT64> record_offset;
+  if (false == ONX_ModelParallelReader::Internal_FindObjectTable(m_archive, &m_table_offset)
+    || false == ONX_ModelParallelReader::Internal_ScanObjectTable(m_archive, m_table_offset, &m_sizeof_table, record_offset, &m_end_of_table_offset)
+    )
+  {
+    if (nullptr != error_log)
+      error_log->Print("ONX_LazyModelGeometry::Open - the object table cannot be indexed. Use ONX_Model::Read().\n");
+    Close();
+    return false;
+  }
+
+  m_loader = ONX_ModelParallelReader::Internal_NewObjectTableArchive(m_archive, m_table_offset, m_sizeof_table);
+  if (nullptr == m_loader)
+  {
+    if (nullptr != error_log)
+      error_log->Print("ONX_LazyModelGeometry::Open - the object table cannot be read out of order. Use ONX_Model::Read().\n");
+    Close();
+    return false;
+  }
+
+  // Index the records. Worker 0 is the loader.
+  const unsigned int record_count = record_offset.UnsignedCount();
+  thread_count = ON_Parallel::ThreadCount(record_count, 1024, thread_count);
+  ON_SimpleArray<ON_Read3dmBufferArchive*> worker(thread_count);
+  worker.Append(m_loader);
+  for (unsigned int k = 1; k < thread_count; ++k)
+  {
+    ON_Read3dmBufferArchive* w = ONX_ModelParallelReader::Internal_NewObjectTableArchive(m_archive, m_table_offset, m_sizeof_table);
+    if (nullptr == w)
+      break;
+    worker.Append(w);
+  }
+
+  ON_SimpleArray<ONX_LazyModelGeometryItem> item(record_count);
+  item.SetCount(record_count);
+  ON_SimpleArray<bool> bIndexed(record_count);
+  bIndexed.SetCount(record_count);
+  bIndexed.Zero();
+  ON_Parallel::For(
+    record_count,
+    worker.UnsignedCount(),
+    [&](size_t i, unsigned int k)
+    {
+      item[i] = ONX_LazyModelGeometryItem();
+      bIndexed[i] = Internal_IndexRecord(*worker[k], record_offset[i], model_object_type_filter, item[i]);
+    }
+  );
+
+  unsigned int bad_crc_count = 0;
+  for (unsigned int k = 1; k < worker.UnsignedCount(); ++k)
+    bad_crc_count += ONX_ModelParallelReader::Internal_DeleteObjectTableArchive(worker[k], m_table_offset, m_end_of_table_offset);
+  if (bad_crc_count > 0 && nullptr != error_log)
+    error_log->Print("ONX_LazyModelGeometry::Open - %u object attributes chunks have bad CRC values.\n", bad_crc_count);
+
+  m_item.Reserve(record_count);
+  for (unsigned int i = 0; i < record_count; ++i)
+  {
+    if (bIndexed[i])
+      m_item.Append(item[i]);
+  }
+
+  const unsigned int item_count = m_item.UnsignedCount();
+  m_id_index.Reserve(item_count);
+  for (unsigned int i = 0; i < item_count; ++i)
+  {
+    if (ON_nil_uuid != m_item[i].m_id)
+      m_id_index.Append(ON_UuidIndex(m_item[i].m_id, (int)i));
+  }
+  m_id_index.QuickSort(ON_UuidIndex::CompareId);
+
+  m_cache.SetCapacity(item_count);
+  m_cache.SetCount(item_count);
+  m_cache_link.SetCapacity(item_count);
+  m_cache_link.SetCount(item_count);
+  for (unsigned int i = 0; i < item_count; ++i)
+    m_cache_link[i] = Internal_CacheLink();
+
+  if (false == ONX_ModelParallelReader::Internal_SkipObjectTable(m_archive, bTableIsActive, m_end_of_table_offset)
+    || false == m_model.IncrementalReadFinish(m_archive, true, 0, error_log)
+    )
+  {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+inline bool ONX_LazyModelGeometry::Open(
+  const char* filename,
+  unsigned int model_object_type_filter,
+  unsigned int thread_count,
+  ON_TextLog* error_log
+  )
+{
+  const ON_wString wide_filename(filename);
+  return Open(static_cast<const wchar_t*>(wide_filename), model_object_type_filter, thread_count, error_log);
+}
+
+inline void ONX_LazyModelGeometry::Close()
+{
+  ClearCache();
+  if (nullptr != m_loader)
+  {
+    ONX_ModelParallelReader::Internal_DeleteObjectTableArchive(m_loader, m_table_offset, m_end_of_table_offset);
+    m_loader = nullptr;
+  }
+  m_item.Destroy();
+  m_id_index.Destroy();
+  m_cache.Destroy();
+  m_cache_link.Destroy();
+  m_table_offset = 0;
+  m_sizeof_table = 0;
+  m_end_of_table_offset = 0;
+  m_model.Reset();
+  m_archive.Close();
+}
+
+inline bool ONX_LazyModelGeometry::IsOpen() const
+{
+  return (nullptr != m_loader);
+}
+
+inline const ONX_Model& ONX_LazyModelGeometry::Model() const
+{
+  return m_model;
+}
+
+inline ONX_Model& ONX_LazyModelGeometry::Model()
+{
+  return m_model;
+}
+
+inline unsigned int ONX_LazyModelGeometry::Count() const
+{
+  return m_item.UnsignedCount();
+}
+
+inline const ONX_LazyModelGeometryItem& ONX_LazyModelGeometry::Item(
+  unsigned int i
+  ) const
+{
+  static const ONX_LazyModelGeometryItem unset;
+  return (i < m_item.UnsignedCount()) ? m_item[i] : unset;
+}
+
+inline unsigned int ONX_LazyModelGeometry::ItemIndexFromId(
+  ON_UUID id
+  ) const
+{
+  const ON_UuidIndex key(id, 0);
+  const int j = m_id_index.BinarySearch(&key, ON_UuidIndex::CompareId);
+  return (j >= 0) ? (unsigned int)m_id_index[j].m_i : ON_UNSET_UINT_INDEX;
+}
+
+inline ON_ModelComponentReference ONX_LazyModelGeometry::ModelGeometry(
+  unsigned int i
+  )
+{
+  if (i >= m_item.UnsignedCount() || nullptr == m_loader)
+    return ON_ModelComponentReference::Empty;
+
+  if (false == m_cache[i].IsEmpty())
+  {
+    Internal_Unlink(i);
+    Internal_LinkFirst(i);
+    return m_cache[i];
+  }
+
+  ON_ModelGeometryComponent* mg = nullptr;
+  int rc = -1;
+  if (m_loader->SeekFromStart((ON__INT64)(m_item[i].m_record_offset - m_table_offset)))
+    rc = m_loader->Read3dmModelGeometryForExperts(true, true, &mg, 0);
+  if (1 != rc || nullptr == mg)
+  {
+    if (nullptr != mg)
+      delete mg;
+    return ON_ModelComponentReference::Empty;
+  }
+
+  size_t sizeof_geometry = sizeof(*mg);
+  const ON_Geometry* geometry = mg->Geometry(nullptr);
+  if (nullptr != geometry)
+  {
+    m_item[i].m_bbox = geometry->BoundingBox();
+    sizeof_geometry += geometry->SizeOf();
+  }
+  const ON_3dmObjectAttributes* attributes = mg->Attributes(nullptr);
+  if (nullptr != attributes)
+    sizeof_geometry += attributes->SizeOf();
+
+  m_cache[i] = ON_ModelComponentReference::CreateForExperts(mg, true);
+  m_cache_link[i].m_sizeof_geometry = sizeof_geometry;
+  m_cached_memory += sizeof_geometry;
+  Internal_LinkFirst(i);
+  Internal_Evict(i);
+
+  return m_cache[i];
+}
+
+inline bool ONX_LazyModelGeometry::IsCached(
+  unsigned int i
+  ) const
+{
+  return (i < m_cache.UnsignedCount() && false == m_cache[i].IsEmpty());
+}
+
+inline void ONX_LazyModelGeometry::SetMemoryBudget(
+  size_t memory_budget
+  )
+{
+  m_memory_budget = memory_budget;
+  Internal_Evict(m_lru_first);
+}
+
+inline size_t ONX_LazyModelGeometry::MemoryBudget() const
+{
+  return m_memory_budget;
+}
+
+inline size_t ONX_LazyModelGeometry::CachedMemory() const
+{
+  return m_cached_memory;
+}
+
+inline void ONX_LazyModelGeometry::ClearCache()
+{
+  while (ON_UNSET_UINT_INDEX != m_lru_first)
+  {
+    const unsigned int i = m_lru_first;
+    Internal_Unlink(i);
+    m_cache_link[i].m_sizeof_geometry = 0;
+    m_cache[i] = ON_ModelComponentReference::Empty;
+  }
+  m_cached_memory = 0;
+}
+
+inline bool ONX_LazyModelGeometry::ComputeBoundingBoxes(
+  unsigned int thread_count
+  )
+{
+  if (nullptr == m_loader)
+    return false;
+
+  ON_SimpleArray<unsigned int> todo(m_item.UnsignedCount());
+  for (unsigned int i = 0; i < m_item.UnsignedCount(); ++i)
+  {
+    if (false == m_item[i].m_bbox.IsValid())
+      todo.Append(i);
+  }
+  const unsigned int todo_count = todo.UnsignedCount();
+  if (0 == todo_count)
+    return true;
+
+  // Worker 0 is the loader.
+  thread_count = ON_Parallel::ThreadCount(todo_count, 64, thread_count);
+  ON_SimpleArray<ON_Read3dmBufferArchive*> worker(thread_count);
+  worker.Append(m_loader);
+  for (unsigned int k = 1; k < thread_count; ++k)
+  {
+    ON_Read3dmBufferArchive* w = ONX_ModelParallelReader::Internal_NewObjectTableArchive(m_archive, m_table_offset, m_sizeof_table);
+    if (nullptr == w)
+      break;
+    worker.Append(w);
+  }
+
+  std::atomic<unsigned int> failed_count(0);
+  ON_Parallel::For(
+    todo_count,
+    worker.UnsignedCount(),
+    [&](size_t j, unsigned int k)
+    {
+      ONX_LazyModelGeometryItem& item = m_item[todo[j]];
+      ON_ModelGeometryComponent* mg = nullptr;
+      int rc = -1;
+      if (worker[k]->SeekFromStart((ON__INT64)(item.m_record_offset - m_table_offset)))
+        rc = worker[k]->Read3dmModelGeometryForExperts(true, true, &mg, 0);
+      const ON_Geometry* geometry = (1 == rc && nullptr != mg) ? mg->Geometry(nullptr) : nullptr;
+      if (nullptr != geometry)
+        item.m_bbox = geometry->BoundingBox();
+      else
+        failed_count++;
+      if (nullptr != mg)
+        delete mg;
+    }
+  );
+
+  for (unsigned int k = 1; k < worker.UnsignedCount(); ++k)
+    ONX_ModelParallelReader::Internal_DeleteObjectTableArchive(worker[k], m_table_offset, m_end_of_table_offset);
+
+  return (0 == failed_count);
+}
+
+inline bool ONX_LazyModelGeometry::Internal_IndexRecord(
+  ON_Read3dmBufferArchive& table_archive,
+  ON__UINT64 record_offset,
+  unsigned int model_object_type_filter,
+  ONX_LazyModelGeometryItem& item
+  ) const
+{
+  const ON__UINT64 sizeof_chunk_header = 12;
+  const ON__UINT8* buffer = m_archive.MappedBuffer();
+
+  // Object records end with a 4 byte CRC. The scan checked the record
+  // fits in the table.
+  const ON__INT64 record_length = (ON__INT64)ON_LittleEndianValue(buffer + record_offset + 4, 8);
+  if (record_length < 4)
+    return false;
+  const ON__UINT64 content_end = record_offset + sizeof_chunk_header + (ON__UINT64)record_length - 4;
+
+  item.m_record_offset = record_offset;
+
+  ON__UINT64 attributes_offset = 0;
+  for (ON__UINT64 pos = record_offset + sizeof_chunk_header; content_end - pos >= sizeof_chunk_header && pos < content_end; )
+  {
+    const ON__UINT32 typecode = (ON__UINT32)ON_LittleEndianValue(buffer + pos, 4);
+    const ON__INT64 value = (ON__INT64)ON_LittleEndianValue(buffer + pos + 4, 8);
+    if (TCODE_OBJECT_RECORD_END == typecode)
+      break;
+    if (TCODE_OBJECT_RECORD_TYPE == typecode)
+    {
+      item.m_object_type = ON::ObjectType((int)value);
+      if (0 != model_object_type_filter && 0 == (model_object_type_filter & (unsigned int)item.m_object_type))
+        return false;
+    }
+    else if (TCODE_OBJECT_RECORD_ATTRIBUTES == typecode)
+    {
+      attributes_offset = pos;
+    }
+    if (0 != (TCODE_SHORT & typecode))
+      pos += sizeof_chunk_header;
+    else if (value < 0 || (ON__UINT64)value > content_end - pos - sizeof_chunk_header)
+      break;
+    else
+      pos += sizeof_chunk_header + (ON__UINT64)value;
+  }
+
+  if (0 != model_object_type_filter && ON::unknown_object_type == item.m_object_type)
+    return false;
+
+  if (0 != attributes_offset && table_archive.SeekFromStart((ON__INT64)(attributes_offset - m_table_offset)))
+  {
+    ON__UINT32 typecode = 0;
+    ON__INT64 value = 0;
+    if (table_archive.BeginRead3dmBigChunk(&typecode, &value))
+    {
+      ON_3dmObjectAttributes attributes;
+      if (TCODE_OBJECT_RECORD_ATTRIBUTES == typecode && attributes.Read(table_archive))
+      {
+        item.m_id = attributes.m_uuid;
+        item.m_layer_index = attributes.m_layer_index;
+      }
+      table_archive.EndRead3dmChunk();
+    }
+  }
+
+  return true;
+}
+
+inline void ONX_LazyModelGeometry::Internal_LinkFirst(unsigned int i)
+{
+  Internal_CacheLink& link = m_cache_link[i];
+  link.m_prev = ON_UNSET_UINT_INDEX;
+  link.m_next = m_lru_first;
+  if (ON_UNSET_UINT_INDEX != m_lru_first)
+    m_cache_link[m_lru_first].m_prev = i;
+  else
+    m_lru_last = i;
+  m_lru_first = i;
+}
+
+inline void ONX_LazyModelGeometry::Internal_Unlink(unsigned int i)
+{
+  Internal_CacheLink& link = m_cache_link[i];
+  if (ON_UNSET_UINT_INDEX != link.m_prev)
+    m_cache_link[link.m_prev].m_next = link.m_next;
+  else
+    m_lru_first = link.m_next;
+  if (ON_UNSET_UINT_INDEX != link.m_next)
+    m_cache_link[link.m_next].m_prev = link.m_prev;
+  else
+    m_lru_last = link.m_prev;
+  link.m_prev = ON_UNSET_UINT_INDEX;
+  link.m_next = ON_UNSET_UINT_INDEX;
+}
+
+inline void ONX_LazyModelGeometry::Internal_Evict(unsigned int keep)
+{
+  while (m_cached_memory > m_memory_budget && ON_UNSET_UINT_INDEX != m_lru_last && keep != m_lru_last)
+  {
+    const unsigned int i = m_lru_last;
+    Internal_Unlink(i);
+    m_cached_memory -= m_cache_link[i].m_sizeof_geometry;
+    m_cache_link[i].m_sizeof_geometry = 0;
+    m_cache[i] = ON_ModelComponentReference::Empty;
+  }
+}
+
+#endif
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MODEL_PARALLEL_READ_INC_)
+#define OPENNURBS_MODEL_PARALLEL_READ_INC_
+
+/*
+Description:
+  ONX_ModelParallelReader reads a 3dm file into an ONX_Model and
+  decodes the model geometry table on several threads.
+  - Everything before the object table is read by ONX_Model::IncrementalReadBegin().
+  - The object table chunk is scanned in the mapped file to find
+    where each object record starts. No object is decoded by the scan.
+  - Worker threads decode the object records. Each worker reads from its
+    own ON_Read3dmBufferArchive that views the object table bytes in
+    the mapping. Nothing is copied.
+  - The decoded objects are added to the model in file order, so the
+    model's ON_ComponentManifest indices, ids and names are the same
+    as they are after ONX_Model::Read().
+  - Everything after the object table is read by ONX_Model::IncrementalReadFinish().
+Remarks:
+  Version 6 and later files are decoded in parallel. Earlier files
+  reference layers, materials and dimension styles by archive index
+  in ways that depend on archive reading state, and small object tables
+  are not worth the thread start up. In these cases the object table
+  is read sequentially with ONX_Model::IncrementalReadModelGeometry().
+Example:
+
+        ONX_Model model;
+        ON_TextLog error_log;
+        ONX_ModelParallelReader::Read(model, L"model.3dm", 0, 0, &error_log);
+
+*/
+class ONX_ModelParallelReader
+{
+public:
+  /*
+  Description:
+    Read a 3dm archive into a model.
+  Parameters:
+    model - [in/out]
+      An empty model.
+    archive - [in]
+      An open mapped archive positioned at the start of the file.
+    model_object_type_filter - [in]
+      If not zero, a bitfield made by bitwise oring ON::object_type values
+      to select which types of objects are read from the object table.
+    thread_count - [in]
+      Maximum number of threads used to decode objects. 0 = use the
+      hardware thread count.
+    error_log - [out]
+      Archive reading errors are logged here. Pass nullptr if you don't want
+      to log errors.
+  Returns:
+    True if the archive was read with no errors.
+  */
+  static bool Read(
+    class ONX_Model& model,
+    class ON_MappedFileArchive& archive,
+    unsigned int model_object_type_filter,
+    unsigned int thread_count,
+    ON_TextLog* error_log
+    );
+
+  /*
+  Description:
+    Map a 3dm file and read it into a model.
+    If the file cannot be mapped, ONX_Model::Read() is used.
+  */
+  static bool Read(
+    class ONX_Model& model,
+    const wchar_t* filename,
+    unsigned int model_object_type_filter,
+    unsigned int thread_count,
+    ON_TextLog* error_log
+    );
+
+  static bool Read(
+    class ONX_Model& model,
+    const char* filename,
+    unsigned int model_object_type_filter,
+    unsigned int thread_count,
+    ON_TextLog* error_log
+    );
+
+private:
+  friend class ONX_LazyModelGeometry;
+
+  static bool Internal_ReadObjectTable(
+    class ONX_Model& model,
+    class ON_MappedFileArchive& archive,
+    unsigned int model_object_type_filter,
+    unsigned int thread_count,
+    ON_TextLog* error_log
+    );
+
+  static bool Internal_ReadObjectTableSequentially(
+    class ONX_Model& model,
+    class ON_MappedFileArchive& archive,
+    unsigned int model_object_type_filter
+    );
+
+  // Get the archive offset of the object table chunk. The archive must be
+  // positioned at the start of the table or at the start of its content.
+  static bool Internal_FindObjectTable(
+    const class ON_MappedFileArchive& archive,
+    ON__UINT64* table_offset
+    );
+
+  // Find the object table chunk and the offsets of its object records.
+  // All offsets are archive offsets. end_of_table_offset is the offset
+  // of the TCODE_ENDOFTABLE chunk that ends the table.
+  static bool Internal_ScanObjectTable(
+    const class ON_MappedFileArchive& archive,
+    ON__UINT64 table_offset,
+    ON__UINT64* sizeof_table,
+    ON_SimpleArray<ON__UINT64>& record_offset,
+    ON__UINT64* end_of_table_offset
+    );
+
+  // Create an archive that views the object table bytes in the mapping and
+  // has begun reading the table. Returns nullptr if the table cannot be read
+  // out of order.
+  static class ON_Read3dmBufferArchive* Internal_NewObjectTableArchive(
+    const class ON_MappedFileArchive& archive,
+    ON__UINT64 table_offset,
+    ON__UINT64 sizeof_table
+    );
+
+  // Finish reading the table, delete the archive and return its bad CRC count.
+  static unsigned int Internal_DeleteObjectTableArchive(
+    class ON_Read3dmBufferArchive* table_archive,
+    ON__UINT64 table_offset,
+    ON__UINT64 end_of_table_offset
+    );
+
+  // Move the archive past the object table without reading the records.
+  static bool Internal_SkipObjectTable(
+    class ON_MappedFileArchive& archive,
+    bool bTableIsActive,
+    ON__UINT64 end_of_table_offset
+    );
+
+  // Copy the source to destination mapping of everything read before
+  // the object table so object attributes are mapped to model indices.
+  static void Internal_CopyManifestMap(
+    const class ON_BinaryArchive& source,
+    class ON_BinaryArchive& destination
+    );
+};
+
+#include "opennurbs_model_parallel_read_defs.h"
+
+#endif
@@ -0,0 +1,378 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_MODEL_PARALLEL_READ_DEFS_INC_)
+#define OPENNURBS_MODEL_PARALLEL_READ_DEFS_INC_
+
+inline bool ONX_ModelParallelReader::Read(
+  ONX_Model& model,
+  ON_MappedFileArchive& archive,
+  unsigned int model_object_type_filter,
+  unsigned int thread_count,
+  ON_TextLog* error_log
+  )
+{
+  if (false == archive.IsOpen())
+  {
+    if (nullptr != error_log)
+      error_log->Print("ONX_ModelParallelReader::Read - archive is not open.\n");
+    return false;
+  }
+
+  if (false == model.IncrementalReadBegin(archive, true, 0, error_log))
+    return false;
+
+  if (false == Internal_ReadObjectTable(model, archive, model_object_type_filter, thread_count, error_log))
+    return false;
+
+  return model.IncrementalReadFinish(archive, true, 0, error_log);
+}
+
+inline bool ONX_ModelParallelReader::Read(
+  ONX_Model& model,
+  const wchar_t* filename,
+  unsigned int model_object_type_filter,
+  unsigned int thread_count,
+  ON_TextLog* error_log
+  )
+{
+  ON_MappedFileArchive archive;
+  if (archive.Open(filename))
+  {
+    archive.SetArchiveFullPath(filename);
+    return Read(model, archive, model_object_type_filter, thread_count, error_log);
+  }
+  return model.Read(filename, 0, model_object_type_filter, error_log);
+}
+
+inline bool ONX_ModelParallelReader::Read(
+  ONX_Model& model,
+  const char* filename,
+  unsigned int model_object_type_filter,
+  unsigned int thread_count,
+  ON_TextLog* error_log
+  )
+{
+  const ON_wString wide_filename(filename);
+  return Read(model, static_cast<const wchar_t*>(wide_filename), model_object_type_filter, thread_count, error_log);
+}
+
+inline bool ONX_ModelParallelReader::Internal_ReadObjectTable(
+  ONX_Model& model,
+  ON_MappedFileArchive& archive,
+  unsigned int model_object_type_filter,
+  unsigned int thread_count,
+  ON_TextLog* error_log
+  )
+{
+  // The main archive is not moved until the object table is known to be
+  // readable in parallel. Any surprise falls back to sequential reading.
+  const bool bTableIsActive = (ON_3dmArchiveTableType::object_table == archive.Active3dmTable());
+  ON__UINT64 table_offset = 0;
+  ON__UINT64 sizeof_table = 0;
+  ON__UINT64 end_of_table_offset = 0;
+  ON_SimpleArray<ON__UINT64> record_offset;
+  if (false == Internal_FindObjectTable(archive, &table_offset)
+    || false == Internal_ScanObjectTable(archive, table_offset, &sizeof_table, record_offset, &end_of_table_offset)
+    )
+    return Internal_ReadObjectTableSequentially(model, archive, model_object_type_filter);
+
+  const unsigned int record_count = record_offset.UnsignedCount();
+  thread_count = ON_Parallel::ThreadCount(record_count, 64, thread_count);
+  if (thread_count <= 1)
+    return Internal_ReadObjectTableSequentially(model, archive, model_object_type_filter);
+
+  // One archive per thread. The archives share the mapped table bytes.
+  ON_SimpleArray<ON_Read3dmBufferArchive*> worker(thread_count);
+  for (unsigned int k = 0; k < thread_count; ++k)
+  {
+    ON_Read3dmBufferArchive* w = Internal_NewObjectTableArchive(archive, table_offset, sizeof_table);
+    if (nullptr == w)
+      break;
+    worker.Append(w);
+  }
+  if (worker.UnsignedCount() < thread_count)
+  {
+    for (unsigned int k = 0; k < worker.UnsignedCount(); ++k)
+      Internal_DeleteObjectTableArchive(worker[k], table_offset, end_of_table_offset);
+    return Internal_ReadObjectTableSequentially(model, archive, model_object_type_filter);
+  }
+
+  ON_SimpleArray<ON_ModelGeometryComponent*> model_geometry(record_count);
+  model_geometry.SetCount(record_count);
+  model_geometry.Zero();
+  ON_SimpleArray<int> read_rc(record_count);
+  read_rc.SetCount(record_count);
+  read_rc.Zero();
+
+  ON_Parallel::For(
+    record_count,
+    thread_count,
+    [&](size_t i, unsigned int k)
+    {
+      ON_Read3dmBufferArchive* w = worker[k];
+      ON_ModelGeometryComponent* mg = nullptr;
+      int rc = -1;
+      if (w->SeekFromStart((ON__INT64)(record_offset[i] - table_offset)))
+        rc = w->Read3dmModelGeometryForExperts(true, true, &mg, model_object_type_filter);
+      read_rc[i] = rc;
+      model_geometry[i] = mg;
+    }
+  );
+
+  unsigned int bad_crc_count = 0;
+  for (unsigned int k = 0; k < thread_count; ++k)
+    bad_crc_count += Internal_DeleteObjectTableArchive(worker[k], table_offset, end_of_table_offset);
+  worker.Destroy();
+
+  if (bad_crc_count > 0 && nullptr != error_log)
+    error_log->Print("ONX_ModelParallelReader::Read - %u object table chunks have bad CRC values.\n", bad_crc_count);
+
+  // Add the objects in file order. Like sequential reading, the first
+  // corrupt record ends the object table.
+  bool rc = true;
+  int archive_index = 0;
+  for (unsigned int i = 0; i < record_count; ++i)
+  {
+    ON_ModelGeometryComponent* mg = model_geometry[i];
+    model_geometry[i] = nullptr;
+    if (rc && read_rc[i] < 0)
+    {
+      rc = false;
+      if (nullptr != error_log)
+        error_log->Print("ONX_ModelParallelReader::Read - object record %u is corrupt.\n", i);
+    }
+    if (false == rc || 1 != read_rc[i] || nullptr == mg)
+    {
+      if (nullptr != mg)
+        delete mg;
+      continue;
+    }
+
+    const ON_UUID archive_id = mg->Id();
+    const ON_ModelComponentReference model_component_reference = model.AddModelComponentForExperts(mg, true, true, true);
+    const ON_ModelComponent* model_component = model_component_reference.ModelComponent();
+    if (nullptr == model_component)
+    {
+      delete mg;
+      continue;
+    }
+
+    ON_ManifestMapItem map_item;
+    if (map_item.SetSourceIdentification(ON_ModelComponent::Type::ModelGeometry, archive_id, archive_index)
+      && map_item.SetDestinationIdentification(model_component)
+      )
+      archive.AddManifestMapItem(map_item);
+    archive_index++;
+  }
+
+  if (false == rc)
+    return false;
+
+  return Internal_SkipObjectTable(archive, bTableIsActive, end_of_table_offset);
+}
+
+inline bool ONX_ModelParallelReader::Internal_FindObjectTable(
+  const ON_MappedFileArchive& archive,
+  ON__UINT64* table_offset
+  )
+{
+  // Size of a chunk typecode and 8 byte value in version 5 and later archives.
+  const ON__UINT64 sizeof_chunk_header = 12;
+
+  if (archive.Archive3dmVersion() < 60)
+    return false;
+
+  if (ON_3dmArchiveTableType::object_table == archive.Active3dmTable())
+  {
+    // The table was begun and no records were read.
+    ON_3DM_BIG_CHUNK chunk;
+    if (archive.GetCurrentChunk(chunk) <= 0
+      || TCODE_OBJECT_TABLE != chunk.m_typecode
+      || chunk.m_start_offset < sizeof_chunk_header
+      || archive.CurrentPosition() != chunk.m_start_offset
+      )
+      return false;
+    *table_offset = chunk.m_start_offset - sizeof_chunk_header;
+    return true;
+  }
+
+  if (ON_3dmArchiveTableType::Unset == archive.Active3dmTable())
+  {
+    *table_offset = archive.CurrentPosition();
+    return true;
+  }
+
+  return false;
+}
+
+inline ON_Read3dmBufferArchive* ONX_ModelParallelReader::Internal_NewObjectTableArchive(
+  const ON_MappedFileArchive& archive,
+  ON__UINT64 table_offset,
+  ON__UINT64 sizeof_table
+  )
+{
+  ON_Read3dmBufferArchive* table_archive = new ON_Read3dmBufferArchive(
+    (size_t)sizeof_table,
+    archive.MappedBuffer() + table_offset,
+    false,
+    archive.Archive3dmVersion(),
+    archive.ArchiveOpenNURBSVersion()
+  );
+  Internal_CopyManifestMap(archive, *table_archive);
+
+  // Records are read in any order, so the table chunk cannot have a CRC.
+  ON_3DM_BIG_CHUNK chunk;
+  const bool rc
+    = table_archive->BeginRead3dmObjectTable()
+    && table_archive->GetCurrentChunk(chunk) > 0
+    && 0 == chunk.m_do_crc16
+    && 0 == chunk.m_do_crc32;
+  if (false == rc)
+  {
+    delete table_archive;
+    table_archive = nullptr;
+  }
+  return table_archive;
+}
+
+inline unsigned int ONX_ModelParallelReader::Internal_DeleteObjectTableArchive(
+  ON_Read3dmBufferArchive* table_archive,
+  ON__UINT64 table_offset,
+  ON__UINT64 end_of_table_offset
+  )
+{
+  if (nullptr == table_archive)
+    return 0;
+  ON_ModelGeometryComponent* mg = nullptr;
+  if (table_archive->SeekFromStart((ON__INT64)(end_of_table_offset - table_offset)))
+    table_archive->Read3dmModelGeometry(&mg);
+  if (nullptr != mg)
+    delete mg;
+  table_archive->EndRead3dmObjectTable();
+  const unsigned int bad_crc_count = table_archive->BadCRCCount();
+  delete table_archive;
+  return bad_crc_count;
+}
+
+inline bool ONX_ModelParallelReader::Internal_SkipObjectTable(
+  ON_MappedFileArchive& archive,
+  bool bTableIsActive,
+  ON__UINT64 end_of_table_offset
+  )
+{
+  if (false == bTableIsActive && false == archive.BeginRead3dmObjectTable())
+    return false;
+  if (false == archive.SeekFromStart((ON__INT64)end_of_table_offset))
+    return false;
+  ON_ModelGeometryComponent* end_of_table = nullptr;
+  const int rc = archive.Read3dmModelGeometry(&end_of_table);
+  if (nullptr != end_of_table)
+    delete end_of_table;
+  if (0 != rc)
+    return false;
+  return archive.EndRead3dmObjectTable();
+}
+
+inline bool ONX_ModelParallelReader::Internal_ReadObjectTableSequentially(
+  ONX_Model& model,
+  ON_MappedFileArchive& archive,
+  unsigned int model_object_type_filter
+  )
+{
+  for (;;)
+  {
+    ON_ModelComponentReference model_geometry_reference;
+    if (false == model.IncrementalReadModelGeometry(archive, true, true, true, model_object_type_filter, model_geometry_reference))
+      return false;
+    if (model_geometry_reference.IsEmpty())
+      break;
+  }
+  return true;
+}
+
+inline bool ONX_ModelParallelReader::Internal_ScanObjectTable(
+  const ON_MappedFileArchive& archive,
+  ON__UINT64 table_offset,
+  ON__UINT64* sizeof_table,
+  ON_SimpleArray<ON__UINT64>& record_offset,
+  ON__UINT64* end_of_table_offset
+  )
+{
+  const ON__UINT64 sizeof_chunk_header = 12;
+  record_offset.SetCount(0);
+
+  const ON__UINT8* buffer = archive.MappedBuffer();
+  const ON__UINT64 sizeof_buffer = archive.MappedSize();
+  if (nullptr == buffer || table_offset > sizeof_buffer || sizeof_buffer - table_offset < sizeof_chunk_header)
+    return false;
+
+  const ON__UINT32 table_typecode = (ON__UINT32)ON_LittleEndianValue(buffer + table_offset, 4);
+  const ON__INT64 table_length = (ON__INT64)ON_LittleEndianValue(buffer + table_offset + 4, 8);
+  if (TCODE_OBJECT_TABLE != table_typecode || table_length < 0)
+    return false;
+  const ON__UINT64 content_offset = table_offset + sizeof_chunk_header;
+  if ((ON__UINT64)table_length > sizeof_buffer - content_offset)
+    return false;
+  const ON__UINT64 content_end = content_offset + (ON__UINT64)table_length;
+
+  // The table contains object records followed by a TCODE_ENDOFTABLE
+  // short chunk. Anything else is left to the sequential reader.
+  for (ON__UINT64 pos = content_offset; content_end - pos >= sizeof_chunk_header; )
+  {
+    const ON__UINT32 typecode = (ON__UINT32)ON_LittleEndianValue(buffer + pos, 4);
+    if (TCODE_ENDOFTABLE == typecode)
+    {
+      *sizeof_table = sizeof_chunk_header + (ON__UINT64)table_length;
+      *end_of_table_offset = pos;
+      return true;
+    }
+    const ON__INT64 length = (ON__INT64)ON_LittleEndianValue(buffer + pos + 4, 8);
+    if (TCODE_OBJECT_RECORD != typecode || length < 0)
+      break;
+    if ((ON__UINT64)length > content_end - pos - sizeof_chunk_header)
+      break;
+    record_offset.Append(pos);
+    pos += sizeof_chunk_header + (ON__UINT64)length;
+  }
+
+  record_offset.SetCount(0);
+  return false;
+}
+
+inline void ONX_ModelParallelReader::Internal_CopyManifestMap(
+  const ON_BinaryArchive& source,
+  ON_BinaryArchive& destination
+  )
+{
+  const ON_ComponentManifest& manifest = source.Manifest();
+  const ON_ManifestMap& manifest_map = source.ManifestMap();
+  for (unsigned int t = 1; t < static_cast<unsigned int>(ON_ModelComponent::Type::NumOf); ++t)
+  {
+    const ON_ModelComponent::Type type = ON_ModelComponent::ComponentTypeFromUnsigned(t);
+    if (ON_ModelComponent::Type::Unset == type
+      || ON_ModelComponent::Type::ModelGeometry == type
+      || ON_ModelComponent::Type::HistoryRecord == type
+      || ON_ModelComponent::Type::ObsoleteValue == type
+      )
+      continue;
+    for (const ON_ComponentManifestItem* item = manifest.FirstItem(type); nullptr != item; item = manifest.NextItem(item))
+    {
+      const ON_ManifestMapItem& map_item = manifest_map.MapItemFromSourceIndex(type, item->Index());
+      if (map_item.SourceIsSet())
+        destination.AddManifestMapItem(map_item);
+    }
+  }
+}
+
+#endif
@@ -556,6 +556,45 @@ public:
                          //            repeated evaluations
          ) const override;
 
+  /*
+  Description:
+    Evaluate the curve at many parameters with one call.
+  Parameters:
+    t - [in]
+      Array of count evaluation parameters. The parameters do not have
+      to be sorted. When consecutive parameters are in the same span,
+      the span search is skipped, so sorted parameters are faster.
+    count - [in]
+      Number of parameters.
+    der_count - [in]
+      Number of derivatives (>= 0).
+    side - [in]
+      Same as the side parameter of Evaluate().
+    v_stride - [in]
+      >= count
+    v - [out]
+      Array of length v_stride*Dimension()*(der_count+1).
+      The results are returned in structure of arrays form:
+      coordinate j of derivative k at t[i] is v[(k*Dimension() + j)*v_stride + i].
+      For example, when Dimension() = 3 and der_count = 0, the x coordinates
+      of the points are v[0], ..., v[count-1] and the y coordinates start
+      at v[v_stride].
+  Returns:
+    True if successful. False if the input is not valid or a rational
+    curve has a zero weight at one of the parameters.
+  Remarks:
+    The basis functions for 4 parameters are evaluated together in loops
+    that compilers vectorize. Working memory is allocated once per call.
+  */
+  bool EvaluateMany(
+    const double* t,
+    int count,
+    int der_count,
+    int side,
+    size_t v_stride,
+    double* v
+    ) const;
+
 #if defined(OPENNURBS_PLUS)
   bool GetClosestPoint( 
           const ON_3dPoint&, // test_point
@@ -1606,5 +1645,7 @@ ON_DECL
 bool ON_Adjust2ndPointToDomain(const ON_2dPoint& First, ON_2dPoint& Second, 
                                    const ON_Interval dom[2]);
 
+#include "opennurbs_nurbscurve_defs.h"
+
 
 #endif
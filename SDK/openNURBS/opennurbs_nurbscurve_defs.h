@@ -0,0 +1,336 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_NURBSCURVE_DEFS_INC_)
+#define OPENNURBS_NURBSCURVE_DEFS_INC_
+
+// Number of parameters whose basis functions are evaluated together.
+#define ON_EVALUATE_MANY_LANES 4
+
+/*
+Description:
+  Find the span used to evaluate a NURBS at t.
+Parameters:
+  order - [in]
+  cv_count - [in]
+  knot - [in]
+  t - [in]
+  side - [in]
+    < 0 to evaluate from below. Otherwise from above.
+  hint - [in]
+    A span index to test first.
+Returns:
+  The span index s (0 <= s <= cv_count-order). The span is
+  knot[s+order-2] to knot[s+order-1] and is never empty.
+*/
+inline int ON_EvaluateManySpanIndex(
+  int order,
+  int cv_count,
+  const double* knot,
+  double t,
+  int side,
+  int hint
+  )
+{
+  const double* k = knot + (order - 2);
+  const int span_count = cv_count - order + 1;
+  int s = (hint >= 0 && hint < span_count) ? hint : 0;
+  const bool bAboveStart = (0 == s) || k[s] < t || (k[s] == t && side >= 0);
+  const bool bBelowEnd = (span_count - 1 == s) || t < k[s + 1] || (t == k[s + 1] && side < 0);
+  if (bAboveStart && bBelowEnd)
+    return s;
+  const double* p = (side < 0)
+    ? std::lower_bound(k + 1, k + span_count, t)
+    : std::upper_bound(k + 1, k + span_count, t);
+  s = (int)(p - k) - 1;
+  return s;
+}
+
+/*
+Description:
+  Evaluate the B-spline basis functions and their derivatives for
+  ON_EVALUATE_MANY_LANES parameters. This is algorithm A2.3 from
+  The NURBS Book with the parameter lane as the inner loop.
+Parameters:
+  order - [in]
+  knot - [in]
+    knot[l] points to the 2*(order-1) knots of the span used by lane l.
+  t - [in]
+    t[l] is the parameter for lane l.
+  der_count - [in]
+    0 <= der_count <= order-1
+  work - [in]
+    order*(order + 4)*ON_EVALUATE_MANY_LANES doubles.
+  N - [out]
+    (der_count+1)*order*ON_EVALUATE_MANY_LANES doubles.
+    N[(k*order + i)*ON_EVALUATE_MANY_LANES + l] is the k-th derivative
+    of basis function i at t[l].
+*/
+inline void ON_EvaluateManyBasis(
+  int order,
+  const double* const* knot,
+  const double* t,
+  int der_count,
+  double* work,
+  double* N
+  )
+{
+  const int W = ON_EVALUATE_MANY_LANES;
+  const int d = order - 1;
+  double* ndu = work;                      // ndu[j][r][l]
+  double* left = ndu + order * order * W;  // left[j][l]
+  double* right = left + order * W;        // right[j][l]
+  double* a = right + order * W;           // a[2][j][l]
+
+  double saved[ON_EVALUATE_MANY_LANES];
+  double temp[ON_EVALUATE_MANY_LANES];
+
+  for (int l = 0; l < W; ++l)
+    ndu[l] = 1.0;
+  for (int j = 1; j <= d; ++j)
+  {
+    for (int l = 0; l < W; ++l)
+    {
+      left[j * W + l] = t[l] - knot[l][d - j];
+      right[j * W + l] = knot[l][d - 1 + j] - t[l];
+      saved[l] = 0.0;
+    }
+    for (int r = 0; r < j; ++r)
+    {
+      double* ndu_jr = ndu + (j * order + r) * W;
+      const double* ndu_rj1 = ndu + (r * order + j - 1) * W;
+      double* ndu_rj = ndu + (r * order + j) * W;
+      const double* right_r1 = right + (r + 1) * W;
+      const double* left_jr = left + (j - r) * W;
+      for (int l = 0; l < W; ++l)
+      {
+        ndu_jr[l] = right_r1[l] + left_jr[l];
+        temp[l] = ndu_rj1[l] / ndu_jr[l];
+        ndu_rj[l] = saved[l] + right_r1[l] * temp[l];
+        saved[l] = left_jr[l] * temp[l];
+      }
+    }
+    for (int l = 0; l < W; ++l)
+      ndu[(j * order + j) * W + l] = saved[l];
+  }
+
+  for (int j = 0; j <= d; ++j)
+  {
+    for (int l = 0; l < W; ++l)
+      N[j * W + l] = ndu[(j * order + d) * W + l];
+  }
+  if (der_count <= 0)
+    return;
+
+  for (int r = 0; r <= d; ++r)
+  {
+    double* a_s1 = a;
+    double* a_s2 = a + order * W;
+    for (int l = 0; l < W; ++l)
+      a_s1[l] = 1.0;
+    for (int k = 1; k <= der_count; ++k)
+    {
+      double dk[ON_EVALUATE_MANY_LANES] = {};
+      const int rk = r - k;
+      const int pk = d - k;
+      if (r >= k)
+      {
+        const double* x = ndu + ((pk + 1) * order + rk) * W;
+        const double* y = ndu + (rk * order + pk) * W;
+        for (int l = 0; l < W; ++l)
+        {
+          a_s2[l] = a_s1[l] / x[l];
+          dk[l] = a_s2[l] * y[l];
+        }
+      }
+      const int j1 = (rk >= -1) ? 1 : -rk;
+      const int j2 = (r - 1 <= pk) ? k - 1 : d - r;
+      for (int j = j1; j <= j2; ++j)
+      {
+        const double* x = ndu + ((pk + 1) * order + rk + j) * W;
+        const double* y = ndu + ((rk + j) * order + pk) * W;
+        for (int l = 0; l < W; ++l)
+        {
+          a_s2[j * W + l] = (a_s1[j * W + l] - a_s1[(j - 1) * W + l]) / x[l];
+          dk[l] += a_s2[j * W + l] * y[l];
+        }
+      }
+      if (r <= pk)
+      {
+        const double* x = ndu + ((pk + 1) * order + r) * W;
+        const double* y = ndu + (r * order + pk) * W;
+        for (int l = 0; l < W; ++l)
+        {
+          a_s2[k * W + l] = -a_s1[(k - 1) * W + l] / x[l];
+          dk[l] += a_s2[k * W + l] * y[l];
+        }
+      }
+      for (int l = 0; l < W; ++l)
+        N[(k * order + r) * W + l] = dk[l];
+      double* tmp = a_s1;
+      a_s1 = a_s2;
+      a_s2 = tmp;
+    }
+  }
+
+  double f = d;
+  for (int k = 1; k <= der_count; ++k)
+  {
+    double* Nk = N + k * order * W;
+    for (int i = 0; i < order * W; ++i)
+      Nk[i] *= f;
+    f *= (d - k);
+  }
+}
+
+inline bool ON_NurbsCurve::EvaluateMany(
+  const double* t,
+  int count,
+  int der_count,
+  int side,
+  size_t v_stride,
+  double* v
+  ) const
+{
+  if (count <= 0)
+    return (0 == count);
+  if (nullptr == t || nullptr == v || der_count < 0 || v_stride < (size_t)count)
+    return false;
+  if (m_dim < 1 || m_order < 2 || m_cv_count < m_order || nullptr == m_knot || nullptr == m_cv)
+    return false;
+
+  const int W = ON_EVALUATE_MANY_LANES;
+  const int dim = m_dim;
+  const int cvdim = m_is_rat ? (dim + 1) : dim;
+  const int order = m_order;
+  // Derivatives of the basis functions of order >= m_order are zero.
+  // Rational curves use the zero derivatives in the quotient rule.
+  const int basis_der_count = (der_count < order) ? der_count : (order - 1);
+  const int h_der_count = m_is_rat ? der_count : basis_der_count;
+
+  const size_t work_count = (size_t)order * (order + 4) * W;
+  const size_t basis_count = (size_t)(basis_der_count + 1) * order * W;
+  const size_t h_count = (size_t)(h_der_count + 1) * cvdim * W;
+  ON_SmallArray<double, 512> buffer(work_count + basis_count + h_count + (size_t)(h_der_count + 1));
+  double* work = buffer.Array();
+  double* N = work + work_count;
+  double* h = N + basis_count;  // h[k][c][l] homogeneous derivatives
+  double* binomial = h + h_count;
+
+  // zero the rows of derivatives that are identically zero
+  for (int k = h_der_count + 1; k <= der_count; ++k)
+  {
+    for (int j = 0; j < dim; ++j)
+      memset(v + ((size_t)k * dim + j) * v_stride, 0, count * sizeof(double));
+  }
+
+  bool rc = true;
+  int span_index = 0;
+  int lane_span[ON_EVALUATE_MANY_LANES];
+  const double* lane_knot[ON_EVALUATE_MANY_LANES];
+  double lane_t[ON_EVALUATE_MANY_LANES];
+  for (int i0 = 0; i0 < count; i0 += W)
+  {
+    const int lane_count = (count - i0 < W) ? (count - i0) : W;
+    for (int l = 0; l < W; ++l)
+    {
+      if (l < lane_count)
+      {
+        lane_t[l] = t[i0 + l];
+        span_index = ON_EvaluateManySpanIndex(order, m_cv_count, m_knot, lane_t[l], side, span_index);
+      }
+      else
+        lane_t[l] = lane_t[l - 1];
+      lane_span[l] = span_index;
+      lane_knot[l] = m_knot + span_index;
+    }
+
+    ON_EvaluateManyBasis(order, lane_knot, lane_t, basis_der_count, work, N);
+
+    // h[k][c] = sum of N[k][i]*CV(span + i)[c]
+    for (int l = 0; l < lane_count; ++l)
+    {
+      const double* cv0 = m_cv + (size_t)lane_span[l] * m_cv_stride;
+      for (int k = 0; k <= h_der_count; ++k)
+      {
+        double* hk = h + (size_t)k * cvdim * W;
+        for (int c = 0; c < cvdim; ++c)
+          hk[c * W + l] = 0.0;
+        if (k > basis_der_count)
+          continue;
+        const double* Nk = N + (size_t)k * order * W;
+        const double* cv = cv0;
+        for (int i = 0; i < order; ++i, cv += m_cv_stride)
+        {
+          const double b = Nk[i * W + l];
+          for (int c = 0; c < cvdim; ++c)
+            hk[c * W + l] += b * cv[c];
+        }
+      }
+    }
+
+    if (m_is_rat)
+    {
+      // Quotient rule: C(k) = (A(k) - sum(i=1..k, binomial(k,i)*w(i)*C(k-i)))/w
+      for (int l = 0; l < lane_count; ++l)
+      {
+        const double w = h[dim * W + l];
+        if (!(0.0 != w))
+        {
+          rc = false;
+          for (int k = 0; k <= h_der_count; ++k)
+          {
+            for (int c = 0; c < dim; ++c)
+              h[((size_t)k * cvdim + c) * W + l] = ON_DBL_QNAN;
+          }
+          continue;
+        }
+        const double one_over_w = 1.0 / w;
+        binomial[0] = 1.0;
+        for (int k = 0; k <= h_der_count; ++k)
+        {
+          // binomial[i] = binomial(k,i)
+          if (k > 0)
+          {
+            binomial[k] = 1.0;
+            for (int i = k - 1; i > 0; --i)
+              binomial[i] += binomial[i - 1];
+          }
+          double* hk = h + (size_t)k * cvdim * W;
+          for (int c = 0; c < dim; ++c)
+          {
+            double x = hk[c * W + l];
+            for (int i = 1; i <= k; ++i)
+              x -= binomial[i] * h[((size_t)i * cvdim + dim) * W + l] * h[((size_t)(k - i) * cvdim + c) * W + l];
+            hk[c * W + l] = x * one_over_w;
+          }
+        }
+      }
+    }
+
+    for (int k = 0; k <= h_der_count; ++k)
+    {
+      for (int c = 0; c < dim; ++c)
+      {
+        const double* hkc = h + ((size_t)k * cvdim + c) * W;
+        double* vkc = v + ((size_t)k * dim + c) * v_stride + i0;
+        for (int l = 0; l < lane_count; ++l)
+          vkc[l] = hkc[l];
+      }
+    }
+  }
+
+  return rc;
+}
+
+#endif
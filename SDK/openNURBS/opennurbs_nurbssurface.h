@@ -496,6 +496,50 @@ public:
                          //            repeated evaluations
          ) const override;
 
+  /*
+  Description:
+    Evaluate the surface on a grid of parameters.
+  Parameters:
+    u - [in]
+      Array of u_count u parameters.
+    u_count - [in]
+    v - [in]
+      Array of v_count v parameters.
+    v_count - [in]
+    der_count - [in]
+      Number of derivatives (>= 0).
+    quadrant - [in]
+      Same as the quadrant parameter of Evaluate().
+    point_stride - [in]
+      >= u_count*v_count
+    P - [out]
+      Array of length point_stride*Dimension()*(der_count+1)*(der_count+2)/2.
+      The results are returned in structure of arrays form. Grid point
+      (i,j) has index g = i*v_count + j. Coordinate c of partial derivative
+      d at (u[i],v[j]) is P[(d*Dimension() + c)*point_stride + g].
+      The partial derivatives are in the same order as Evaluate():
+      point, Du, Dv, Duu, Duv, Dvv, Duuu, Duuv, ...
+  Returns:
+    True if successful. False if the input is not valid or a rational
+    surface has a zero weight at one of the grid points.
+  Remarks:
+    The u basis functions are evaluated once per u parameter and the
+    v basis functions once per v parameter. For each u parameter, the
+    control net is reduced to the control points of an isocurve,
+    which are then combined with the v basis functions for every v
+    parameter.
+  */
+  bool EvaluateGrid(
+    const double* u,
+    int u_count,
+    const double* v,
+    int v_count,
+    int der_count,
+    int quadrant,
+    size_t point_stride,
+    double* P
+    ) const;
+
   /*
   Description:
     Get isoparametric curve.
@@ -2250,6 +2294,8 @@ private:
 };
 
 
+#include "opennurbs_nurbssurface_defs.h"
+
 #if defined(ON_DLL_TEMPLATE)
 ON_DLL_TEMPLATE template class ON_CLASS ON_ClassArray<ON_NurbsCurve>;
 ON_DLL_TEMPLATE template class ON_CLASS ON_ObjectArray<ON_NurbsCurve>;
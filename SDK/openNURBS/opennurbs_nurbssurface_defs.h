@@ -0,0 +1,266 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_NURBSSURFACE_DEFS_INC_)
+#define OPENNURBS_NURBSSURFACE_DEFS_INC_
+
+/*
+Description:
+  Evaluate the basis functions of one surface direction at every parameter.
+Parameters:
+  order - [in]
+  cv_count - [in]
+  knot - [in]
+  t - [in]
+    Array of count parameters.
+  count - [in]
+  side - [in]
+    < 0 to evaluate from below. Otherwise from above.
+  der_count - [in]
+    0 <= der_count <= order-1
+  work - [in]
+    order*(order + 4)*ON_EVALUATE_MANY_LANES doubles.
+  lane_N - [in]
+    (der_count+1)*order*ON_EVALUATE_MANY_LANES doubles.
+  span - [out]
+    span[i] is the span index of t[i].
+  N - [out]
+    count*(der_count+1)*order doubles. N[(i*(der_count+1) + k)*order + p]
+    is the k-th derivative of basis function p of span[i] at t[i].
+*/
+inline void ON_EvaluateGridBasis(
+  int order,
+  int cv_count,
+  const double* knot,
+  const double* t,
+  int count,
+  int side,
+  int der_count,
+  double* work,
+  double* lane_N,
+  int* span,
+  double* N
+  )
+{
+  const int W = ON_EVALUATE_MANY_LANES;
+  int span_index = 0;
+  const double* lane_knot[ON_EVALUATE_MANY_LANES];
+  double lane_t[ON_EVALUATE_MANY_LANES];
+  for (int i0 = 0; i0 < count; i0 += W)
+  {
+    const int lane_count = (count - i0 < W) ? (count - i0) : W;
+    for (int l = 0; l < W; ++l)
+    {
+      if (l < lane_count)
+      {
+        lane_t[l] = t[i0 + l];
+        span_index = ON_EvaluateManySpanIndex(order, cv_count, knot, lane_t[l], side, span_index);
+        span[i0 + l] = span_index;
+      }
+      else
+        lane_t[l] = lane_t[l - 1];
+      lane_knot[l] = knot + span_index;
+    }
+    ON_EvaluateManyBasis(order, lane_knot, lane_t, der_count, work, lane_N);
+    for (int l = 0; l < lane_count; ++l)
+    {
+      double* Ni = N + (size_t)(i0 + l) * (der_count + 1) * order;
+      for (int k = 0; k <= der_count; ++k)
+      {
+        for (int p = 0; p < order; ++p)
+          Ni[k * order + p] = lane_N[(k * order + p) * W + l];
+      }
+    }
+  }
+}
+
+inline bool ON_NurbsSurface::EvaluateGrid(
+  const double* u,
+  int u_count,
+  const double* v,
+  int v_count,
+  int der_count,
+  int quadrant,
+  size_t point_stride,
+  double* P
+  ) const
+{
+  if (u_count <= 0 || v_count <= 0)
+    return (0 == u_count || 0 == v_count) && u_count >= 0 && v_count >= 0;
+  if (nullptr == u || nullptr == v || nullptr == P || der_count < 0)
+    return false;
+  if (point_stride < (size_t)u_count * (size_t)v_count)
+    return false;
+  if (m_dim < 1 || nullptr == m_cv || nullptr == m_knot[0] || nullptr == m_knot[1])
+    return false;
+  if (m_order[0] < 2 || m_order[1] < 2 || m_cv_count[0] < m_order[0] || m_cv_count[1] < m_order[1])
+    return false;
+
+  const int W = ON_EVALUATE_MANY_LANES;
+  const int dim = m_dim;
+  const int cvdim = m_is_rat ? (dim + 1) : dim;
+  const int order0 = m_order[0];
+  const int order1 = m_order[1];
+  const int side0 = (2 == quadrant || 3 == quadrant) ? -1 : 1;
+  const int side1 = (3 == quadrant || 4 == quadrant) ? -1 : 1;
+
+  // Derivatives of the basis functions of order >= m_order[dir] are zero.
+  const int du = (der_count < order0) ? der_count : (order0 - 1);
+  const int dv = (der_count < order1) ? der_count : (order1 - 1);
+  const int partial_count = (der_count + 1) * (der_count + 2) / 2;
+  const int max_order = (order0 > order1) ? order0 : order1;
+
+  const size_t work_count = (size_t)max_order * (max_order + 4) * W;
+  const size_t lane_N_count = (size_t)(der_count + 1) * max_order * W;
+  const size_t Nu_count = (size_t)u_count * (du + 1) * order0;
+  const size_t Nv_count = (size_t)v_count * (dv + 1) * order1;
+  const size_t Q_count = (size_t)(du + 1) * m_cv_count[1] * cvdim;
+  const size_t H_count = (size_t)partial_count * cvdim;
+  const size_t binomial_count = (size_t)(der_count + 1) * (der_count + 1);
+  ON_SimpleArray<double> buffer(work_count + lane_N_count + Nu_count + Nv_count + Q_count + H_count + binomial_count);
+  ON_SimpleArray<int> span(u_count + v_count);
+  double* work = buffer.Array();
+  if (nullptr == work || nullptr == span.Array())
+    return false;
+  double* lane_N = work + work_count;
+  double* Nu = lane_N + lane_N_count;
+  double* Nv = Nu + Nu_count;
+  double* Q = Nv + Nv_count;       // Q[a][q][c] u derivative a of the isocurve control points
+  double* H = Q + Q_count;         // H[partial][c] homogeneous partial derivatives
+  double* binomial = H + H_count;  // binomial[n*(der_count+1) + k] = binomial(n,k)
+  int* span_u = span.Array();
+  int* span_v = span_u + u_count;
+
+  ON_EvaluateGridBasis(order0, m_cv_count[0], m_knot[0], u, u_count, side0, du, work, lane_N, span_u, Nu);
+  ON_EvaluateGridBasis(order1, m_cv_count[1], m_knot[1], v, v_count, side1, dv, work, lane_N, span_v, Nv);
+
+  if (m_is_rat)
+  {
+    for (int n = 0; n <= der_count; ++n)
+    {
+      double* b = binomial + n * (der_count + 1);
+      b[0] = 1.0;
+      for (int k = 1; k <= n; ++k)
+        b[k] = (k == n) ? 1.0 : (binomial[(n - 1) * (der_count + 1) + k - 1] + binomial[(n - 1) * (der_count + 1) + k]);
+    }
+  }
+
+  bool rc = true;
+  for (int i = 0; i < u_count; ++i)
+  {
+    // Q[a][q] = sum of Nu[i][a][p]*CV(span_u[i] + p, q)
+    const double* Nui = Nu + (size_t)i * (du + 1) * order0;
+    const double* cv_row = m_cv + (size_t)span_u[i] * m_cv_stride[0];
+    for (int a = 0; a <= du; ++a)
+    {
+      const double* Na = Nui + (size_t)a * order0;
+      double* Qa = Q + (size_t)a * m_cv_count[1] * cvdim;
+      for (int q = 0; q < m_cv_count[1]; ++q)
+      {
+        double* Qaq = Qa + (size_t)q * cvdim;
+        for (int c = 0; c < cvdim; ++c)
+          Qaq[c] = 0.0;
+        const double* cv = cv_row + (size_t)q * m_cv_stride[1];
+        for (int p = 0; p < order0; ++p, cv += m_cv_stride[0])
+        {
+          const double b = Na[p];
+          for (int c = 0; c < cvdim; ++c)
+            Qaq[c] += b * cv[c];
+        }
+      }
+    }
+
+    for (int j = 0; j < v_count; ++j)
+    {
+      const double* Nvj = Nv + (size_t)j * (dv + 1) * order1;
+      for (int n = 0, partial = 0; n <= der_count; ++n)
+      {
+        for (int bk = 0; bk <= n; ++bk, ++partial)
+        {
+          // partial derivative with n-bk u derivatives and bk v derivatives
+          const int a = n - bk;
+          double* Hd = H + (size_t)partial * cvdim;
+          for (int c = 0; c < cvdim; ++c)
+            Hd[c] = 0.0;
+          if (a > du || bk > dv)
+            continue;
+          const double* Nb = Nvj + (size_t)bk * order1;
+          const double* Qa = Q + ((size_t)a * m_cv_count[1] + span_v[j]) * cvdim;
+          for (int r = 0; r < order1; ++r, Qa += cvdim)
+          {
+            const double b = Nb[r];
+            for (int c = 0; c < cvdim; ++c)
+              Hd[c] += b * Qa[c];
+          }
+        }
+      }
+
+      if (m_is_rat)
+      {
+        // Quotient rule:
+        // S(a,b) = (A(a,b) - sum over (k,m) != (0,0) of
+        //   binomial(a,k)*binomial(b,m)*w(k,m)*S(a-k,b-m))/w
+        const double w = H[dim];
+        if (!(0.0 != w))
+        {
+          rc = false;
+          for (int d = 0; d < partial_count; ++d)
+          {
+            for (int c = 0; c < dim; ++c)
+              H[(size_t)d * cvdim + c] = ON_DBL_QNAN;
+          }
+        }
+        else
+        {
+          const double one_over_w = 1.0 / w;
+          for (int n = 0, partial = 0; n <= der_count; ++n)
+          {
+            for (int bk = 0; bk <= n; ++bk, ++partial)
+            {
+              const int a = n - bk;
+              double* S = H + (size_t)partial * cvdim;
+              for (int k = 0; k <= a; ++k)
+              {
+                for (int m = 0; m <= bk; ++m)
+                {
+                  if (0 == k && 0 == m)
+                    continue;
+                  // index of the (k,m) and (a-k,bk-m) partials
+                  const int km = (k + m) * (k + m + 1) / 2 + m;
+                  const int n1 = a - k + bk - m;
+                  const int rest = n1 * (n1 + 1) / 2 + (bk - m);
+                  const double f = binomial[a * (der_count + 1) + k] * binomial[bk * (der_count + 1) + m] * H[(size_t)km * cvdim + dim];
+                  for (int c = 0; c < dim; ++c)
+                    S[c] -= f * H[(size_t)rest * cvdim + c];
+                }
+              }
+              for (int c = 0; c < dim; ++c)
+                S[c] *= one_over_w;
+            }
+          }
+        }
+      }
+
+      const size_t g = (size_t)i * v_count + j;
+      for (int d = 0; d < partial_count; ++d)
+      {
+        for (int c = 0; c < dim; ++c)
+          P[((size_t)d * dim + c) * point_stride + g] = H[(size_t)d * cvdim + c];
+      }
+    }
+  }
+
+  return rc;
+}
+
+#endif
@@ -0,0 +1,242 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_PARALLEL_INC_)
+#define OPENNURBS_PARALLEL_INC_
+
+/*
+Description:
+  ON_Parallel is a small set of tools used to spread independent pieces
+  of work across std::thread workers. Every tool degrades to a plain
+  loop on the calling thread when the thread count is 1 or when
+  OPENNURBS_NO_STD_THREAD is defined.
+Remarks:
+  The task functions must not throw and must not call back into
+  code that expects to run on the main thread (user interface,
+  document tables, ...).
+*/
+class ON_Parallel
+{
+public:
+  /*
+  Returns:
+    Number of hardware threads. Always >= 1.
+  */
+  static unsigned int HardwareThreadCount()
+  {
+#if defined(OPENNURBS_NO_STD_THREAD)
+    return 1U;
+#else
+    const unsigned int n = std::thread::hardware_concurrency();
+    return (n > 0U) ? n : 1U;
+#endif
+  }
+
+  /*
+  Description:
+    Get a reasonable number of threads to use for a job.
+  Parameters:
+    task_count - [in]
+      number of independent tasks.
+    min_tasks_per_thread - [in]
+      Minimum number of tasks a thread must have before it is worth
+      starting the thread. 0 is treated as 1.
+    max_thread_count - [in]
+      If > 0, the returned value will be <= max_thread_count.
+  Returns:
+    A number between 1 and HardwareThreadCount().
+  */
+  static unsigned int ThreadCount(
+    size_t task_count,
+    size_t min_tasks_per_thread,
+    unsigned int max_thread_count = 0
+    )
+  {
+    if (min_tasks_per_thread < 1)
+      min_tasks_per_thread = 1;
+    unsigned int thread_count = ON_Parallel::HardwareThreadCount();
+    if (max_thread_count > 0 && thread_count > max_thread_count)
+      thread_count = max_thread_count;
+    const size_t useful = task_count / min_tasks_per_thread;
+    if (useful < (size_t)thread_count)
+      thread_count = (unsigned int)useful;
+    return (thread_count > 0U) ? thread_count : 1U;
+  }
+
+  /*
+  Description:
+    Call task(task_index, thread_index) once for every task_index in
+    0 <= task_index < task_count.
+  Parameters:
+    task_count - [in]
+    thread_count - [in]
+      Maximum number of threads to use. The calling thread is one of them
+      and has thread_index = 0. When thread_count <= 1 all tasks are
+      run in order on the calling thread.
+    task - [in]
+      Function object with signature void(size_t task_index, unsigned int thread_index).
+  Remarks:
+    Threads take the next unclaimed task index from a shared atomic
+    counter, so tasks that take different amounts of time are balanced
+    automatically. The order tasks are run in is not deterministic when
+    thread_count > 1. Use thread_index to address per-thread scratch
+    space or result buffers.
+  */
+  template <class TaskFunction>
+  static void For(
+    size_t task_count,
+    unsigned int thread_count,
+    const TaskFunction& task
+    )
+  {
+    if (task_count < (size_t)thread_count)
+      thread_count = (unsigned int)task_count;
+#if !defined(OPENNURBS_NO_STD_THREAD)
+    if (thread_count > 1U)
+    {
+      std::atomic<size_t> next_task(0);
+      auto worker = [&next_task, task_count, &task](unsigned int thread_index)
+      {
+        for (size_t i = next_task++; i < task_count; i = next_task++)
+          task(i, thread_index);
+      };
+      std::thread* threads = new std::thread[thread_count - 1];
+      for (unsigned int i = 1; i < thread_count; ++i)
+        threads[i - 1] = std::thread(worker, i);
+      worker(0U);
+      for (unsigned int i = 1; i < thread_count; ++i)
+        threads[i - 1].join();
+      delete[] threads;
+      return;
+    }
+#endif
+    for (size_t i = 0; i < task_count; ++i)
+      task(i, 0U);
+  }
+
+  /*
+  Description:
+    Split 0 <= i < count into contiguous ranges and call
+    range_task(i0, i1, thread_index) for each range.
+  Parameters:
+    count - [in]
+    thread_count - [in]
+      Maximum number of threads to use.
+    range_task - [in]
+      Function object with signature void(size_t i0, size_t i1, unsigned int thread_index)
+      that processes i0 <= i < i1.
+  Remarks:
+    Range k always covers the same indices for a given count and
+    thread_count, and range k is processed by thread k. This makes it
+    easy to produce results that do not depend on thread scheduling.
+  */
+  template <class RangeFunction>
+  static void ForRanges(
+    size_t count,
+    unsigned int thread_count,
+    const RangeFunction& range_task
+    )
+  {
+    if (count < (size_t)thread_count)
+      thread_count = (unsigned int)count;
+    if (thread_count < 1U)
+      thread_count = 1U;
+    auto range = [count, thread_count, &range_task](size_t k, unsigned int)
+    {
+      const size_t i0 = (count * k) / thread_count;
+      const size_t i1 = (count * (k + 1)) / thread_count;
+      if (i0 < i1)
+        range_task(i0, i1, (unsigned int)k);
+    };
+#if !defined(OPENNURBS_NO_STD_THREAD)
+    if (thread_count > 1U)
+    {
+      std::thread* threads = new std::thread[thread_count - 1];
+      for (unsigned int k = 1; k < thread_count; ++k)
+        threads[k - 1] = std::thread(range, (size_t)k, k);
+      range(0, 0U);
+      for (unsigned int k = 1; k < thread_count; ++k)
+        threads[k - 1].join();
+      delete[] threads;
+      return;
+    }
+#endif
+    range(0, 0U);
+  }
+
+  /*
+  Description:
+    Sort [first,last) using up to thread_count threads.
+    The range is split into thread_count pieces that are sorted
+    in parallel and then merged pairwise in parallel.
+  Parameters:
+    first - [in]
+    last - [in]
+      random access iterators
+    less - [in]
+      strict weak ordering
+    thread_count - [in]
+  Remarks:
+    Like std::sort(), the sort is not stable.
+  */
+  template <class RandomIterator, class Less>
+  static void Sort(
+    RandomIterator first,
+    RandomIterator last,
+    const Less& less,
+    unsigned int thread_count
+    )
+  {
+    const size_t count = (size_t)(last - first);
+    if (thread_count > count / 1024)
+      thread_count = (unsigned int)(count / 1024);
+    if (thread_count <= 1U)
+    {
+      std::sort(first, last, less);
+      return;
+    }
+
+    // sorted runs are [run[k], run[k+1])
+    size_t* run = new size_t[thread_count + 1];
+    for (unsigned int k = 0; k <= thread_count; ++k)
+      run[k] = (count * k) / thread_count;
+
+    ON_Parallel::For(thread_count, thread_count,
+      [first, run, &less](size_t k, unsigned int)
+      {
+        std::sort(first + run[k], first + run[k + 1], less);
+      }
+    );
+
+    for (unsigned int run_count = thread_count; run_count > 1U; )
+    {
+      const unsigned int merge_count = run_count / 2;
+      ON_Parallel::For(merge_count, merge_count,
+        [first, run, &less](size_t k, unsigned int)
+        {
+          std::inplace_merge(first + run[2 * k], first + run[2 * k + 1], first + run[2 * k + 2], less);
+        }
+      );
+      unsigned int j = 0;
+      for (unsigned int k = 0; k <= run_count; k += 2)
+        run[j++] = run[k];
+      if (0 != (run_count & 1U))
+        run[j++] = run[run_count];
+      run_count = j - 1;
+    }
+
+    delete[] run;
+  }
+};
+
+#endif
@@ -142,6 +142,13 @@ struct ON_RTreePolylineContext
   unsigned int m_polyline_pointindex;
 };
 
+// Result of ON_RTree::SearchNearest()
+struct ON_RTreeNeighbor
+{
+  ON__INT_PTR m_id;    // element id
+  double m_distance;   // distance from the search point to the element
+};
+
 struct ON_RTreeSearchResult
 {
   int m_capacity;   // m_id[] array capacity (search terminates when m_count == m_capacity)
@@ -424,6 +431,151 @@ public:
   */
   bool CreateMeshFaceTree( const class ON_Mesh* mesh );
 
+  /*
+  Description:
+    Construct a packed R-tree. See ON_RTree::BulkLoad() for details.
+  */
+  ON_RTree(
+    const ON_RTreeBBox* a_rect,
+    const ON__INT_PTR* a_element_id,
+    size_t a_count,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Replace the contents of this R-tree with a packed R-tree built
+    from a_rect[] in a single pass.
+  Parameters:
+    a_rect - [in]
+      Array of a_count element bounding boxes. Each box must satisfy
+      m_min[i] <= m_max[i].
+    a_element_id - [in]
+      If not null, a_element_id[i] is the id of the element with bounding box a_rect[i].
+      If null, the id of the element with bounding box a_rect[i] is i.
+    a_count - [in]
+      number of elements.
+    bMultithreaded - [in]
+      If true and a_count is large, the sorting is done on multiple threads.
+  Returns:
+    True if successful.
+  Remarks:
+    The elements are ordered with the Sort-Tile-Recursive (STR) method
+    and then packed into nodes that are as full as possible. Compared
+    to calling Insert() a_count times, the tree is built much faster,
+    uses about 2/3 of the nodes and the node boxes overlap less, so
+    searches visit fewer nodes.
+    When every box has the same z coordinates, as is the case for
+    trees built with Insert2d(), the tiling is done in 2d.
+    Insert() and Remove() can be used on a packed tree.
+  */
+  bool BulkLoad(
+    const ON_RTreeBBox* a_rect,
+    const ON__INT_PTR* a_element_id,
+    size_t a_count,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Create a packed R-tree with an element for each face in the mesh.
+    The element id is set to the index of the face.
+    This is the bulk loaded version of CreateMeshFaceTree().
+  Parameters:
+    mesh - [in]
+    bMultithreaded - [in]
+      If true and the mesh is large, the sorting is done on multiple threads.
+  Returns:
+    True if successful.
+  */
+  bool BulkLoadMeshFaceTree(
+    const class ON_Mesh* mesh,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Write the R-tree to an archive so it can be read back without
+    rebuilding it.
+  Parameters:
+    archive - [in]
+    geometry_hash - [in]
+      Hash of the geometry the element boxes were calculated from.
+      Read() compares this value with the hash of the current geometry
+      to detect stale trees.
+  Returns:
+    True if successful.
+  Remarks:
+    The nodes are written in depth first order as a flat list of
+    node levels, branch boxes and element ids followed by a CRC
+    of that data. Node pointers are not written.
+  */
+  bool Write(
+    class ON_BinaryArchive& archive,
+    const ON_SHA1_Hash& geometry_hash
+    ) const;
+
+  /*
+  Description:
+    Read an R-tree written by Write().
+  Parameters:
+    archive - [in]
+    geometry_hash - [in]
+      Hash of the current geometry. If it is not ON_SHA1_Hash::ZeroDigest
+      and is not equal to the value passed to Write(), the saved tree is
+      stale and is skipped.
+  Returns:
+    True if the saved tree was read and is valid.
+    False if the saved tree was stale, failed the CRC check or could
+    not be read. In this case the R-tree is empty and the caller should
+    rebuild it from the geometry.
+  Remarks:
+    The archive is positioned after the saved tree in all cases where
+    the saved chunk header could be read.
+  */
+  bool Read(
+    class ON_BinaryArchive& archive,
+    const ON_SHA1_Hash& geometry_hash
+    );
+
+  /*
+  Returns:
+    Hash of the mesh vertex locations and face vertex indices. This is
+    the geometry_hash used by WriteMeshFaceTree() and ReadMeshFaceTree().
+  */
+  static ON_SHA1_Hash MeshFaceTreeGeometryHash(
+    const class ON_Mesh* mesh
+    );
+
+  /*
+  Description:
+    Write a mesh face tree created by CreateMeshFaceTree() or
+    BulkLoadMeshFaceTree() with MeshFaceTreeGeometryHash(mesh).
+  */
+  bool WriteMeshFaceTree(
+    class ON_BinaryArchive& archive,
+    const class ON_Mesh* mesh
+    ) const;
+
+  /*
+  Description:
+    Read a mesh face tree saved by WriteMeshFaceTree(). If the saved tree
+    does not match the mesh or is damaged, the tree is rebuilt
+    with BulkLoadMeshFaceTree().
+  Parameters:
+    archive - [in]
+    mesh - [in]
+    bMultithreaded - [in]
+      passed to BulkLoadMeshFaceTree() when the tree is rebuilt.
+  Returns:
+    True if the tree was read or rebuilt.
+  */
+  bool ReadMeshFaceTree(
+    class ON_BinaryArchive& archive,
+    const class ON_Mesh* mesh,
+    bool bMultithreaded = true
+    );
+
 
   /*
   Description:
@@ -760,6 +912,47 @@ public:
     void* a_context
     );
 
+  /*
+  Description:
+    Multi-threaded search of two R-trees for all pairs of elements whose
+    bounding boxes overlap.
+  Parameters:
+    a_rtreeA - [in]
+    a_rtreeB - [in]
+    tolerance - [in]
+      If the distance between a pair of bounding boxes is <= tolerance,
+      then the pair is added to a_result[].
+    thread_count - [in]
+      Maximum number of threads to use. 0 uses every hardware thread.
+      1 does the entire search on the calling thread.
+    bDeterministic - [in]
+      If true, the pairs are appended to a_result[] in the same order
+      every time the search is run, regardless of thread_count and
+      thread scheduling.
+      If false, the order depends on thread scheduling and a little
+      less memory is used.
+    a_result - [out]
+      Pairs of ids of elements whose bounding boxes overlap are appended
+      to a_result[]. a_result[k].i is an element id from a_rtreeA and
+      a_result[k].j is an element id from a_rtreeB.
+  Returns:
+    True if entire tree was searched. It is possible no results were found.
+  Remarks:
+    The top levels of the two trees are expanded into a list of
+    overlapping subtree pairs on the calling thread. Worker threads
+    take the next unclaimed subtree pair from the list until it is empty,
+    so uneven subtrees are balanced across threads. Each thread or pair
+    writes to its own result buffer and the buffers are merged at the end.
+  */
+  static bool SearchMultithreaded(
+    const ON_RTree& a_rtreeA,
+    const ON_RTree& a_rtreeB,
+    double tolerance,
+    unsigned int thread_count,
+    bool bDeterministic,
+    ON_SimpleArray<ON_2dex>& a_result
+    );
+
 
   /*
   Description:
@@ -842,6 +1035,94 @@ public:
     void* a_context
     ) const;
 
+  /*
+  Description:
+    Find the a_k elements closest to a point with a best-first search.
+  Parameters:
+    a_point - [in]
+    a_k - [in]
+      maximum number of elements to find.
+    a_max_distance - [in]
+      Elements farther than a_max_distance from a_point are ignored.
+      Pass ON_DBL_MAX if there is no limit.
+    distanceCallback - [in]
+      If null, the distance to an element is the distance from a_point
+      to the element's bounding box.
+      If not null, distanceCallback(a_context,a_id) must return the distance
+      from a_point to the element or a negative value to ignore the element.
+      The returned distance must be >= the distance from a_point to the element's
+      bounding box. The callback is only called for elements that may be
+      among the a_k closest.
+    a_context - [in]
+      pointer passed to the distanceCallback() function.
+    a_result - [out]
+      The closest elements are appended to a_result[] sorted by
+      increasing distance.
+  Returns:
+    Number of elements appended to a_result[].
+  Remarks:
+    Nodes and elements are kept in one priority queue ordered by
+    distance, so only the nodes whose boxes are closer than the
+    a_k-th closest element are visited. This is much faster than
+    shrinking an ON_RTreeSphere in a Search() callback.
+  */
+  int SearchNearest(
+    const double a_point[3],
+    int a_k,
+    double a_max_distance,
+    double ON_CALLBACK_CDECL distanceCallback(void* a_context, ON__INT_PTR a_id),
+    void* a_context,
+    ON_SimpleArray<ON_RTreeNeighbor>& a_result
+    ) const;
+
+  /*
+  Description:
+    Search the R-tree for elements whose bounding boxes are hit by a ray
+    or line segment. The elements are reported in front to back order.
+  Parameters:
+    a_point - [in]
+    a_direction - [in]
+      The ray is a_point + t*a_direction.
+    a_t0 - [in]
+    a_t1 - [in]
+      The part of the ray with a_t0 <= t <= a_t1 is searched.
+      Use a_t0 = 0 and a_t1 = ON_DBL_MAX for a ray.
+    a_segment - [in]
+      The segment from a_segment.from to a_segment.to is searched.
+      (a_t0 = 0, a_t1 = 1, a_direction = a_segment.Direction()).
+    resultCallback - [in]
+      resultCallback(a_context, a_id, a_t, a_t1) is called for each element
+      whose bounding box is hit by the ray. a_t is the ray parameter where
+      the ray enters the bounding box. The callback is called in order of
+      increasing a_t. When the callback finds an intersection with the
+      element at parameter s, it can set *a_t1 = s, so the search
+      only continues with elements that could be hit before s.
+      Return true to continue the search and false to terminate it.
+    a_context - [in]
+      pointer passed to the resultCallback() function.
+  Returns:
+    True if the search finished and false if the callback terminated it.
+  Remarks:
+    Nodes are visited in order of the ray parameter where the ray enters
+    the node box. After the callback reduces *a_t1 every node and element
+    behind the new a_t1 is skipped, so closest hit picking and snapping visit
+    only the nodes in front of the closest hit.
+  */
+  bool SearchRay(
+    const double a_point[3],
+    const double a_direction[3],
+    double a_t0,
+    double a_t1,
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id, double a_t, double* a_t1),
+    void* a_context
+    ) const;
+
+  bool SearchRay(
+    const ON_Line& a_segment,
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id, double a_t, double* a_t1),
+    void* a_context
+    ) const;
+
   /*
   Returns:
     Number of elements (leaves).
@@ -885,4 +1166,235 @@ private:
   ON_RTreeMemPool m_mem_pool;
 };
 
+// Number of children in each ON_FrozenRTreeNode.
+#define ON_FrozenRTree_NODE_COUNT 8
+
+/*
+Description:
+  ON_FrozenRTreeNode is a node of an ON_FrozenRTree.
+  The child bounding boxes are stored in structure of arrays form
+  so the overlap tests for all children can be done with a few
+  SIMD instructions. The float values are rounded outwards, so
+  the float box of a child always contains the double precision
+  box it was created from.
+*/
+struct ON_FrozenRTreeNode
+{
+  // Child i has bounding box
+  // (m_min[0][i], m_min[1][i], m_min[2][i]) to (m_max[0][i], m_max[1][i], m_max[2][i]).
+  float m_min[3][ON_FrozenRTree_NODE_COUNT];
+  float m_max[3][ON_FrozenRTree_NODE_COUNT];
+
+  // When m_level > 0, m_child[i] is the index of a child node.
+  // When m_level = 0, m_child[i] is the index of a leaf element id.
+  ON__UINT32 m_child[ON_FrozenRTree_NODE_COUNT];
+
+  ON__INT32 m_level;  // =0 at leaf nodes, > 0 at branch nodes
+  ON__INT32 m_count;  // 1 <= m_count <= ON_FrozenRTree_NODE_COUNT
+
+  // sizeof(ON_FrozenRTreeNode) = 256 bytes = 4 cache lines.
+  ON__UINT32 m_reserved[6];
+};
+
+/*
+Description:
+  ON_FrozenRTree is a read only, cache compact copy of an ON_RTree.
+  Nodes have ON_FrozenRTree_NODE_COUNT children and the child boxes
+  are stored as floats in structure of arrays form. This makes
+  searching faster and a frozen tree uses about 1/3 of the memory
+  of an ON_RTree with the same elements.
+Remarks:
+  Since the boxes are rounded outwards to float precision, searches
+  are conservative. Every element an ON_RTree search would find is found,
+  and elements whose boxes are within float rounding error of the search
+  region may also be reported.
+  The SIMD overlap tests use SSE2 on x86 and NEON on 64-bit ARM.
+  Other platforms use equivalent scalar code.
+*/
+class ON_FrozenRTree
+{
+public:
+  ON_FrozenRTree() = default;
+  ~ON_FrozenRTree() = default;
+  ON_FrozenRTree(const ON_FrozenRTree&) = default;
+  ON_FrozenRTree& operator=(const ON_FrozenRTree&) = default;
+
+  /*
+  Description:
+    Create a frozen copy of an R-tree.
+  Parameters:
+    rtree - [in]
+    bMultithreaded - [in]
+      If true and the tree is large, the sorting is done on multiple threads.
+  Returns:
+    True if successful.
+  Remarks:
+    The frozen tree does not reference rtree. Changes to rtree
+    after Create() is called do not change the frozen tree.
+  */
+  bool Create(
+    const ON_RTree& rtree,
+    bool bMultithreaded = true
+    );
+
+  /*
+  Description:
+    Create a frozen R-tree from a list of elements.
+  Parameters:
+    a_rect - [in]
+      Array of a_count element bounding boxes.
+    a_element_id - [in]
+      If not null, a_element_id[i] is the id of the element with bounding box a_rect[i].
+      If null, the id of the element with bounding box a_rect[i] is i.
+    a_count - [in]
+    bMultithreaded - [in]
+      If true and a_count is large, the sorting is done on multiple threads.
+  Returns:
+    True if successful.
+  */
+  bool Create(
+    const ON_RTreeBBox* a_rect,
+    const ON__INT_PTR* a_element_id,
+    size_t a_count,
+    bool bMultithreaded = true
+    );
+
+  void Destroy();
+
+  /*
+  Description:
+    Search the frozen R-tree for all elements whose bounding boxes
+    overlap a box, sphere or capsule. These work like the corresponding
+    ON_RTree::Search() functions and accept the same callback functions.
+    The versions that take a non-const pointer to the search region
+    allow the callback to shrink the region as the search progresses.
+  Returns:
+    True if entire tree was searched. False if a callback
+    function terminated the search.
+  */
+  bool Search(
+    const double a_min[3],
+    const double a_max[3],
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+    void* a_context
+    ) const;
+
+  bool Search(
+    ON_RTreeBBox* a_rect,
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+    void* a_context
+    ) const;
+
+  bool Search(
+    ON_RTreeSphere* a_sphere,
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+    void* a_context
+    ) const;
+
+  /*
+  Remarks:
+    The capsule is the set of points within m_radius of the line segment
+    from m_point[0] to m_point[1]. If m_domain extends beyond [0,1],
+    the segment is extended to cover it.
+  */
+  bool Search(
+    ON_RTreeCapsule* a_capsule,
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+    void* a_context
+    ) const;
+
+  bool Search(
+    const double a_min[3],
+    const double a_max[3],
+    ON_SimpleArray<int>& a_result
+    ) const;
+
+  bool Search(
+    const double a_min[3],
+    const double a_max[3],
+    ON_SimpleArray<void*>& a_result
+    ) const;
+
+  bool Search2d(
+    const double a_min[2],
+    const double a_max[2],
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+    void* a_context
+    ) const;
+
+  bool Search2d(
+    const double a_min[2],
+    const double a_max[2],
+    ON_SimpleArray<int>& a_result
+    ) const;
+
+  bool Search2d(
+    const double a_min[2],
+    const double a_max[2],
+    ON_SimpleArray<void*>& a_result
+    ) const;
+
+  /*
+  Returns:
+    Number of elements (leaves).
+  */
+  unsigned int ElementCount() const;
+
+  /*
+  Returns:
+    Number of nodes.
+  */
+  unsigned int NodeCount() const;
+
+  /*
+  Returns:
+    Pointer to the root node or nullptr if the tree is empty.
+  */
+  const ON_FrozenRTreeNode* Root() const;
+
+  /*
+  Parameters:
+    node_index - [in]
+      A value from ON_FrozenRTreeNode.m_child[] in a node with m_level > 0.
+  Returns:
+    The node.
+  */
+  const ON_FrozenRTreeNode* Node(ON__UINT32 node_index) const;
+
+  /*
+  Parameters:
+    element_index - [in]
+      A value from ON_FrozenRTreeNode.m_child[] in a node with m_level = 0.
+  Returns:
+    The element id.
+  */
+  ON__INT_PTR ElementId(ON__UINT32 element_index) const;
+
+  /*
+  Returns:
+    Bounding box of the entire tree. The box is rounded outwards to float precision.
+  */
+  ON_BoundingBox BoundingBox() const;
+
+  /*
+  Returns:
+    Number of bytes of heap memory used by this tree.
+  */
+  size_t SizeOf() const;
+
+private:
+  template <class OverlapMask>
+  bool Internal_Search(
+    OverlapMask& overlap_mask,
+    bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+    void* a_context
+    ) const;
+
+  ON_SimpleArray<ON_FrozenRTreeNode> m_nodes;
+  ON_SimpleArray<ON__INT_PTR> m_id;
+  ON__UINT32 m_root = 0;
+};
+
+#include "opennurbs_rtree_defs.h"
+
 #endif
@@ -0,0 +1,1301 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_RTREE_DEFS_INC_)
+#define OPENNURBS_RTREE_DEFS_INC_
+
+////////////////////////////////////////////////////////////////
+//
+// ON_RTree bulk loading
+//
+
+// Sorts branches by the center of m_rect along one axis.
+// All branches are compared on the same axis, so m_min+m_max
+// orders them the same way the center does.
+struct ON_RTreeBranchCenterLess
+{
+  int m_axis;
+  bool operator()(const ON_RTreeBranch& a, const ON_RTreeBranch& b) const
+  {
+    return (a.m_rect.m_min[m_axis] + a.m_rect.m_max[m_axis]) < (b.m_rect.m_min[m_axis] + b.m_rect.m_max[m_axis]);
+  }
+};
+
+// Returns the smallest n with n^dim >= count (dim = 2 or 3).
+inline size_t ON_RTreeSTRSliceCount(size_t count, int dim)
+{
+  size_t n = (size_t)((3 == dim) ? cbrt((double)count) : sqrt((double)count));
+  if (n < 1)
+    n = 1;
+  while ((3 == dim ? n * n * n : n * n) < count)
+    ++n;
+  return n;
+}
+
+// Sort-Tile-Recursive ordering. When this function returns,
+// consecutive runs of node_capacity branches are spatially
+// coherent tiles.
+inline void ON_RTreeSTRSort(
+  ON_RTreeBranch* branch,
+  size_t branch_count,
+  size_t node_capacity,
+  bool b3d,
+  unsigned int thread_count
+  )
+{
+  const size_t M = node_capacity;
+  const size_t page_count = (branch_count + M - 1) / M;
+  if (page_count <= 1)
+    return;
+
+  const size_t slab_count = ON_RTreeSTRSliceCount(page_count, b3d ? 3 : 2);
+  const size_t slab_size = ((page_count + slab_count - 1) / slab_count) * M;
+
+  ON_RTreeBranchCenterLess less_x = { 0 };
+  ON_Parallel::Sort(branch, branch + branch_count, less_x, thread_count);
+
+  const size_t slab_total = (branch_count + slab_size - 1) / slab_size;
+  ON_Parallel::For(slab_total, thread_count,
+    [branch, branch_count, slab_size, b3d, M](size_t slab_index, unsigned int)
+    {
+      ON_RTreeBranch* slab = branch + slab_index * slab_size;
+      size_t slab_branch_count = branch_count - slab_index * slab_size;
+      if (slab_branch_count > slab_size)
+        slab_branch_count = slab_size;
+
+      ON_RTreeBranchCenterLess less_y = { 1 };
+      std::sort(slab, slab + slab_branch_count, less_y);
+      if (!b3d)
+        return;
+
+      const size_t slab_page_count = (slab_branch_count + M - 1) / M;
+      const size_t strip_count = ON_RTreeSTRSliceCount(slab_page_count, 2);
+      const size_t strip_size = ((slab_page_count + strip_count - 1) / strip_count) * M;
+      ON_RTreeBranchCenterLess less_z = { 2 };
+      for (size_t i = 0; i < slab_branch_count; i += strip_size)
+      {
+        const size_t n = (slab_branch_count - i < strip_size) ? (slab_branch_count - i) : strip_size;
+        std::sort(slab + i, slab + i + n, less_z);
+      }
+    }
+  );
+}
+
+// Copies the input of a bulk load into level_branch[] and validates it.
+// b3d is set to false when every box has the same z coordinates.
+inline bool ON_RTreeGetBulkLoadBranches(
+  const ON_RTreeBBox* a_rect,
+  const ON__INT_PTR* a_element_id,
+  size_t a_count,
+  ON_SimpleArray<ON_RTreeBranch>& level_branch,
+  bool& b3d
+  )
+{
+  b3d = false;
+  level_branch.SetCount(0);
+  if (nullptr == a_rect || a_count > 0x7FFFFFFF)
+  {
+    ON_ERROR("Invalid input.");
+    return false;
+  }
+
+  level_branch.Reserve(a_count);
+  level_branch.SetCount((int)a_count);
+  ON_RTreeBranch* branch = level_branch.Array();
+  for (size_t i = 0; i < a_count; ++i)
+  {
+    const ON_RTreeBBox& rect = a_rect[i];
+    if (!(rect.m_min[0] <= rect.m_max[0] && rect.m_min[1] <= rect.m_max[1] && rect.m_min[2] <= rect.m_max[2]))
+    {
+      ON_ERROR("Invalid element bounding box.");
+      level_branch.SetCount(0);
+      return false;
+    }
+    if (!b3d && (rect.m_min[2] != rect.m_max[2] || rect.m_min[2] != a_rect[0].m_min[2]))
+      b3d = true;
+    branch[i].m_rect = rect;
+    branch[i].m_id = (nullptr != a_element_id) ? a_element_id[i] : (ON__INT_PTR)i;
+  }
+  return true;
+}
+
+inline ON_RTree::ON_RTree(
+  const ON_RTreeBBox* a_rect,
+  const ON__INT_PTR* a_element_id,
+  size_t a_count,
+  bool bMultithreaded
+  )
+  : ON_RTree(a_count)
+{
+  BulkLoad(a_rect, a_element_id, a_count, bMultithreaded);
+}
+
+inline bool ON_RTree::BulkLoad(
+  const ON_RTreeBBox* a_rect,
+  const ON__INT_PTR* a_element_id,
+  size_t a_count,
+  bool bMultithreaded
+  )
+{
+  RemoveAll();
+  if (0 == a_count)
+    return true;
+
+  ON_SimpleArray<ON_RTreeBranch> level;
+  bool b3d = false;
+  if (!ON_RTreeGetBulkLoadBranches(a_rect, a_element_id, a_count, level, b3d))
+    return false;
+  ON_RTreeBranch* branch;
+
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(a_count, 0x4000)
+    : 1U;
+
+  const int M = ON_RTree_MAX_NODE_COUNT;
+  for (int node_level = 0; /*empty*/; ++node_level)
+  {
+    const int branch_count = level.Count();
+    branch = level.Array();
+    ON_RTreeSTRSort(branch, (size_t)branch_count, M, b3d, thread_count);
+
+    const int node_count = (branch_count + M - 1) / M;
+
+    // Fill every node except the last two. If the last node would get
+    // fewer than ON_RTree_MIN_NODE_COUNT branches, the last two nodes
+    // share their branches.
+    int last_count = branch_count - (node_count - 1) * M;
+    int next_to_last_count = M;
+    if (node_count > 1 && last_count < ON_RTree_MIN_NODE_COUNT)
+    {
+      next_to_last_count -= (ON_RTree_MIN_NODE_COUNT - last_count);
+      last_count = ON_RTree_MIN_NODE_COUNT;
+    }
+
+    ON_SimpleArray<ON_RTreeBranch> parent_level(node_count);
+    for (int node_index = 0, branch_index = 0; node_index < node_count; ++node_index)
+    {
+      const int count
+        = (node_index + 1 == node_count)
+        ? last_count
+        : ((node_index + 2 == node_count) ? next_to_last_count : M);
+
+      ON_RTreeNode* node = m_mem_pool.AllocNode();
+      if (nullptr == node)
+      {
+        RemoveAll();
+        return false;
+      }
+      node->m_level = node_level;
+      node->m_count = count;
+
+      ON_RTreeBranch& parent = parent_level.AppendNew();
+      parent.m_rect = branch[branch_index].m_rect;
+      for (int i = 0; i < count; ++i, ++branch_index)
+      {
+        const ON_RTreeBBox& rect = branch[branch_index].m_rect;
+        for (int j = 0; j < 3; ++j)
+        {
+          if (rect.m_min[j] < parent.m_rect.m_min[j])
+            parent.m_rect.m_min[j] = rect.m_min[j];
+          if (rect.m_max[j] > parent.m_rect.m_max[j])
+            parent.m_rect.m_max[j] = rect.m_max[j];
+        }
+        node->m_branch[i] = branch[branch_index];
+      }
+      parent.m_child = node;
+    }
+
+    if (1 == node_count)
+    {
+      m_root = parent_level[0].m_child;
+      break;
+    }
+    level = std::move(parent_level);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////
+//
+// ON_RTree nearest element and ray searches
+//
+
+// Returns the squared distance from P to rect. The distance is 0 when P is in rect.
+inline double ON_RTreeBBoxDistanceSquared(
+  const ON_RTreeBBox& rect,
+  const double P[3]
+  )
+{
+  double d2 = 0.0;
+  for (int j = 0; j < 3; ++j)
+  {
+    double d = rect.m_min[j] - P[j];
+    if (P[j] - rect.m_max[j] > d)
+      d = P[j] - rect.m_max[j];
+    if (d > 0.0)
+      d2 += d * d;
+  }
+  return d2;
+}
+
+/*
+Description:
+  Clip the part of the ray P + t*D with t0 <= t <= t1 to rect.
+Returns:
+  True if the ray hits rect. In this case *t_enter is the smallest
+  parameter in [t0,t1] where the ray is in rect.
+Remarks:
+  The slab parameters are padded by a relative ON_EPSILON so rays
+  that graze a box are not lost to rounding. When D[j] is zero, the ray
+  misses rect if P[j] is outside rect's j-th slab. When D[j] is so small
+  that a slab parameter is infinite, that parameter is not padded,
+  because inf - inf is a NaN.
+*/
+inline bool ON_RTreeClipRayToBBox(
+  const ON_RTreeBBox& rect,
+  const double P[3],
+  const double D[3],
+  double t0,
+  double t1,
+  double* t_enter
+  )
+{
+  for (int j = 0; j < 3; ++j)
+  {
+    if (0.0 == D[j])
+    {
+      if (P[j] < rect.m_min[j] || P[j] > rect.m_max[j])
+        return false;
+      continue;
+    }
+    double s0 = (rect.m_min[j] - P[j]) / D[j];
+    double s1 = (rect.m_max[j] - P[j]) / D[j];
+    if (s0 > s1)
+    {
+      const double s = s0;
+      s0 = s1;
+      s1 = s;
+    }
+    if (ON_IS_FINITE(s0))
+      s0 -= ON_EPSILON * fabs(s0);
+    if (ON_IS_FINITE(s1))
+      s1 += ON_EPSILON * fabs(s1);
+    if (s0 > t0)
+      t0 = s0;
+    if (s1 < t1)
+      t1 = s1;
+    if (!(t0 <= t1))
+      return false;
+  }
+  if (nullptr != t_enter)
+    *t_enter = t0;
+  return true;
+}
+
+// Priority queue item used by ON_RTree::SearchNearest() and ON_RTree::SearchRay().
+struct ON_RTreeQueueItem
+{
+  double m_key;
+  const ON_RTreeNode* m_node; // null when the item is an element
+  ON__INT_PTR m_id;
+  double m_distance;
+};
+
+// Makes std::push_heap() and std::pop_heap() produce a min heap.
+struct ON_RTreeQueueItemGreater
+{
+  bool operator()(const ON_RTreeQueueItem& a, const ON_RTreeQueueItem& b) const
+  {
+    return a.m_key > b.m_key;
+  }
+};
+
+inline int ON_RTree::SearchNearest(
+  const double a_point[3],
+  int a_k,
+  double a_max_distance,
+  double ON_CALLBACK_CDECL distanceCallback(void* a_context, ON__INT_PTR a_id),
+  void* a_context,
+  ON_SimpleArray<ON_RTreeNeighbor>& a_result
+  ) const
+{
+  if (nullptr == m_root || nullptr == a_point || a_k <= 0 || !(a_max_distance >= 0.0))
+    return 0;
+
+  const int count0 = a_result.Count();
+
+  // Nothing farther than sqrt(bound2) can be one of the a_k closest elements.
+  double bound2 = (a_max_distance < ON_DBL_MAX) ? a_max_distance * a_max_distance : ON_DBL_MAX;
+
+  // max heap of the a_k smallest squared element distances found so far.
+  // a_k can be much larger than the element count, so best2 starts small
+  // and grows as elements are found.
+  ON_SmallArray<double, 16> best2((a_k < 64) ? a_k + 1 : 65);
+
+  const ON_RTreeQueueItemGreater greater;
+  ON_SmallArray<ON_RTreeQueueItem, 64> queue(64);
+  ON_RTreeQueueItem item = { 0.0, m_root, 0, 0.0 };
+  queue.Append(item);
+  while (queue.Count() > 0)
+  {
+    std::pop_heap(queue.Array(), queue.Array() + queue.Count(), greater);
+    item = *queue.Last();
+    queue.SetCount(queue.Count() - 1);
+    if (item.m_key > bound2)
+      break;
+
+    if (nullptr == item.m_node)
+    {
+      // Items come out of the queue in order of increasing distance.
+      ON_RTreeNeighbor& n = a_result.AppendNew();
+      n.m_id = item.m_id;
+      n.m_distance = item.m_distance;
+      if (a_result.Count() - count0 >= a_k)
+        break;
+      continue;
+    }
+
+    const ON_RTreeNode* node = item.m_node;
+    for (int i = 0; i < node->m_count; ++i)
+    {
+      const ON_RTreeBranch& branch = node->m_branch[i];
+      const double d2 = ON_RTreeBBoxDistanceSquared(branch.m_rect, a_point);
+      if (d2 > bound2)
+        continue;
+      if (node->IsInternalNode())
+      {
+        item.m_key = d2;
+        item.m_node = branch.m_child;
+        item.m_id = 0;
+        item.m_distance = 0.0;
+      }
+      else
+      {
+        double d = sqrt(d2);
+        double e2 = d2;
+        if (nullptr != distanceCallback)
+        {
+          d = distanceCallback(a_context, branch.m_id);
+          if (!(d >= 0.0))
+            continue;
+          e2 = d * d;
+          if (e2 > bound2)
+            continue;
+        }
+        best2.Append(e2);
+        std::push_heap(best2.Array(), best2.Array() + best2.Count());
+        if (best2.Count() > a_k)
+        {
+          std::pop_heap(best2.Array(), best2.Array() + best2.Count());
+          best2.SetCount(a_k);
+        }
+        if (best2.Count() == a_k && best2[0] < bound2)
+          bound2 = best2[0];
+        item.m_key = e2;
+        item.m_node = nullptr;
+        item.m_id = branch.m_id;
+        item.m_distance = d;
+      }
+      queue.Append(item);
+      std::push_heap(queue.Array(), queue.Array() + queue.Count(), greater);
+    }
+  }
+
+  return a_result.Count() - count0;
+}
+
+inline bool ON_RTree::SearchRay(
+  const double a_point[3],
+  const double a_direction[3],
+  double a_t0,
+  double a_t1,
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id, double a_t, double* a_t1),
+  void* a_context
+  ) const
+{
+  if (nullptr == m_root || nullptr == resultCallback || nullptr == a_point || nullptr == a_direction)
+    return true;
+  if (!(a_t0 <= a_t1))
+    return true;
+
+  const ON_RTreeQueueItemGreater greater;
+  ON_SmallArray<ON_RTreeQueueItem, 64> queue(64);
+  ON_RTreeQueueItem item = { a_t0, m_root, 0, 0.0 };
+  queue.Append(item);
+  while (queue.Count() > 0)
+  {
+    std::pop_heap(queue.Array(), queue.Array() + queue.Count(), greater);
+    item = *queue.Last();
+    queue.SetCount(queue.Count() - 1);
+    if (item.m_key > a_t1)
+      break; // everything left in the queue is behind a_t1
+
+    if (nullptr == item.m_node)
+    {
+      if (!resultCallback(a_context, item.m_id, item.m_key, &a_t1))
+        return false;
+      continue;
+    }
+
+    const ON_RTreeNode* node = item.m_node;
+    for (int i = 0; i < node->m_count; ++i)
+    {
+      const ON_RTreeBranch& branch = node->m_branch[i];
+      if (!ON_RTreeClipRayToBBox(branch.m_rect, a_point, a_direction, a_t0, a_t1, &item.m_key))
+        continue;
+      if (node->IsInternalNode())
+      {
+        item.m_node = branch.m_child;
+        item.m_id = 0;
+      }
+      else
+      {
+        item.m_node = nullptr;
+        item.m_id = branch.m_id;
+      }
+      queue.Append(item);
+      std::push_heap(queue.Array(), queue.Array() + queue.Count(), greater);
+    }
+  }
+
+  return true;
+}
+
+inline bool ON_RTree::SearchRay(
+  const ON_Line& a_segment,
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id, double a_t, double* a_t1),
+  void* a_context
+  ) const
+{
+  const double P[3] = { a_segment.from.x, a_segment.from.y, a_segment.from.z };
+  const double D[3] = { a_segment.to.x - a_segment.from.x, a_segment.to.y - a_segment.from.y, a_segment.to.z - a_segment.from.z };
+  return SearchRay(P, D, 0.0, 1.0, resultCallback, a_context);
+}
+
+////////////////////////////////////////////////////////////////
+//
+// ON_RTree multi-threaded pair search
+//
+
+// A pair of branches from two R-trees. m_level[k] is the m_level of
+// the node that contains m_branch[k]. When m_level[k] = 0, m_branch[k]
+// is an element. Otherwise m_branch[k]->m_child is a node.
+struct ON_RTreePairSearchTask
+{
+  const ON_RTreeBranch* m_branch[2];
+  int m_level[2];
+};
+
+inline bool ON_RTreePairOverlap(
+  const ON_RTreeBBox& a,
+  const ON_RTreeBBox& b,
+  double tolerance
+  )
+{
+  return (a.m_min[0] - b.m_max[0] <= tolerance && b.m_min[0] - a.m_max[0] <= tolerance
+    && a.m_min[1] - b.m_max[1] <= tolerance && b.m_min[1] - a.m_max[1] <= tolerance
+    && a.m_min[2] - b.m_max[2] <= tolerance && b.m_min[2] - a.m_max[2] <= tolerance);
+}
+
+/*
+Returns:
+  True if the distance between the boxes is <= tolerance. This is the
+  element test used by ON_RTree::Search(a_rtreeA, a_rtreeB, tolerance, ...).
+  ON_RTreePairOverlap() only checks the gap on each axis.
+*/
+inline bool ON_RTreePairDistanceWithin(
+  const ON_RTreeBBox& a,
+  const ON_RTreeBBox& b,
+  double tolerance
+  )
+{
+  if (!(tolerance > 0.0))
+    return true;
+  double d2 = 0.0;
+  for (int k = 0; k < 3; ++k)
+  {
+    double d = a.m_min[k] - b.m_max[k];
+    if (d <= 0.0)
+    {
+      d = b.m_min[k] - a.m_max[k];
+      if (d <= 0.0)
+        continue;
+    }
+    d2 += d * d;
+  }
+  return (d2 <= tolerance * tolerance);
+}
+
+/*
+Description:
+  Append the tasks for the overlapping children of task to child_task[].
+  The side with the higher level is split.
+Returns:
+  False if both sides of task are elements and it cannot be split.
+*/
+inline bool ON_RTreeSplitPairSearchTask(
+  const ON_RTreePairSearchTask& task,
+  double tolerance,
+  ON_SimpleArray<ON_RTreePairSearchTask>& child_task
+  )
+{
+  if (task.m_level[0] <= 0 && task.m_level[1] <= 0)
+    return false;
+  const int k = (task.m_level[0] >= task.m_level[1]) ? 0 : 1;
+  const ON_RTreeNode* node = task.m_branch[k]->m_child;
+  const ON_RTreeBBox& other = task.m_branch[1 - k]->m_rect;
+  for (int i = 0; i < node->m_count; ++i)
+  {
+    if (ON_RTreePairOverlap(node->m_branch[i].m_rect, other, tolerance))
+    {
+      ON_RTreePairSearchTask& t = child_task.AppendNew();
+      t = task;
+      t.m_branch[k] = &node->m_branch[i];
+      t.m_level[k] = node->m_level;
+    }
+  }
+  return true;
+}
+
+inline void ON_RTreeRunPairSearchTask(
+  const ON_RTreePairSearchTask& task,
+  double tolerance,
+  ON_SimpleArray<ON_2dex>& a_result
+  )
+{
+  if (task.m_level[0] <= 0 && task.m_level[1] <= 0)
+  {
+    if (!ON_RTreePairDistanceWithin(task.m_branch[0]->m_rect, task.m_branch[1]->m_rect, tolerance))
+      return;
+    ON_2dex& pair = a_result.AppendNew();
+    pair.i = (int)task.m_branch[0]->m_id;
+    pair.j = (int)task.m_branch[1]->m_id;
+    return;
+  }
+  const int k = (task.m_level[0] >= task.m_level[1]) ? 0 : 1;
+  const ON_RTreeNode* node = task.m_branch[k]->m_child;
+  const ON_RTreeBBox& other = task.m_branch[1 - k]->m_rect;
+  ON_RTreePairSearchTask child = task;
+  child.m_level[k] = node->m_level;
+  for (int i = 0; i < node->m_count; ++i)
+  {
+    if (ON_RTreePairOverlap(node->m_branch[i].m_rect, other, tolerance))
+    {
+      child.m_branch[k] = &node->m_branch[i];
+      ON_RTreeRunPairSearchTask(child, tolerance, a_result);
+    }
+  }
+}
+
+inline bool ON_RTree::SearchMultithreaded(
+  const ON_RTree& a_rtreeA,
+  const ON_RTree& a_rtreeB,
+  double tolerance,
+  unsigned int thread_count,
+  bool bDeterministic,
+  ON_SimpleArray<ON_2dex>& a_result
+  )
+{
+  const ON_RTreeNode* root[2] = { a_rtreeA.Root(), a_rtreeB.Root() };
+  if (nullptr == root[0] || nullptr == root[1] || root[0]->m_count <= 0 || root[1]->m_count <= 0)
+    return true;
+  if (!(tolerance >= 0.0))
+    tolerance = 0.0;
+
+  // The roots do not have a parent branch, so make one for each.
+  ON_RTreeBranch root_branch[2];
+  for (int k = 0; k < 2; ++k)
+  {
+    root_branch[k].m_rect = root[k]->m_branch[0].m_rect;
+    for (int i = 1; i < root[k]->m_count; ++i)
+    {
+      const ON_RTreeBBox& r = root[k]->m_branch[i].m_rect;
+      for (int j = 0; j < 3; ++j)
+      {
+        if (r.m_min[j] < root_branch[k].m_rect.m_min[j])
+          root_branch[k].m_rect.m_min[j] = r.m_min[j];
+        if (r.m_max[j] > root_branch[k].m_rect.m_max[j])
+          root_branch[k].m_rect.m_max[j] = r.m_max[j];
+      }
+    }
+    root_branch[k].m_child = const_cast<ON_RTreeNode*>(root[k]);
+  }
+  if (!ON_RTreePairOverlap(root_branch[0].m_rect, root_branch[1].m_rect, tolerance))
+    return true;
+
+  // Split the top of the trees into enough subtree pairs to keep every thread busy.
+  // The number of tasks does not depend on thread_count, so the deterministic
+  // result is the same for any number of threads.
+  const int target_task_count = 1024;
+  ON_SimpleArray<ON_RTreePairSearchTask> task(target_task_count);
+  ON_SimpleArray<ON_RTreePairSearchTask> split_task(target_task_count);
+  ON_RTreePairSearchTask& root_task = task.AppendNew();
+  root_task.m_branch[0] = &root_branch[0];
+  root_task.m_branch[1] = &root_branch[1];
+  root_task.m_level[0] = root[0]->m_level + 1;
+  root_task.m_level[1] = root[1]->m_level + 1;
+  for (bool bSplit = true; bSplit && task.Count() > 0 && task.Count() < target_task_count; /*empty*/)
+  {
+    bSplit = false;
+    split_task.SetCount(0);
+    for (int i = 0; i < task.Count(); ++i)
+    {
+      if (ON_RTreeSplitPairSearchTask(task[i], tolerance, split_task))
+        bSplit = true;
+      else
+        split_task.Append(task[i]);
+    }
+    task = std::move(split_task);
+    split_task.Reserve(target_task_count);
+  }
+
+  const size_t task_count = (size_t)task.Count();
+  if (0 == thread_count)
+    thread_count = ON_Parallel::HardwareThreadCount();
+  if (thread_count > task_count)
+    thread_count = (unsigned int)task_count;
+
+  // bDeterministic: one result buffer per task, merged in task order.
+  // Otherwise: one result buffer per thread.
+  const size_t buffer_count = bDeterministic ? task_count : (size_t)thread_count;
+  ON_SimpleArray<ON_2dex>* buffer = new ON_SimpleArray<ON_2dex>[buffer_count];
+  const ON_RTreePairSearchTask* t = task.Array();
+  ON_Parallel::For(task_count, thread_count,
+    [t, tolerance, buffer, bDeterministic](size_t task_index, unsigned int thread_index)
+    {
+      ON_RTreeRunPairSearchTask(t[task_index], tolerance, buffer[bDeterministic ? task_index : thread_index]);
+    }
+  );
+
+  size_t result_count = (size_t)a_result.Count();
+  for (size_t i = 0; i < buffer_count; ++i)
+    result_count += (size_t)buffer[i].Count();
+  a_result.Reserve(result_count);
+  for (size_t i = 0; i < buffer_count; ++i)
+    a_result.Append(buffer[i].Count(), buffer[i].Array());
+  delete[] buffer;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////
+//
+// ON_FrozenRTree
+//
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ON_FROZEN_RTREE_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ON_FROZEN_RTREE_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+Returns:
+  Bit i is set if child i of node overlaps the box (qmin,qmax).
+*/
+inline unsigned int ON_FrozenRTreeBoxOverlapMask(
+  const ON_FrozenRTreeNode& node,
+  const float qmin[3],
+  const float qmax[3]
+  )
+{
+  unsigned int mask = 0;
+#if defined(ON_FROZEN_RTREE_SSE2)
+  const __m128 x0 = _mm_set1_ps(qmin[0]), y0 = _mm_set1_ps(qmin[1]), z0 = _mm_set1_ps(qmin[2]);
+  const __m128 x1 = _mm_set1_ps(qmax[0]), y1 = _mm_set1_ps(qmax[1]), z1 = _mm_set1_ps(qmax[2]);
+  for (int k = 0; k < ON_FrozenRTree_NODE_COUNT; k += 4)
+  {
+    __m128 m = _mm_and_ps(
+      _mm_cmple_ps(_mm_loadu_ps(&node.m_min[0][k]), x1),
+      _mm_cmpge_ps(_mm_loadu_ps(&node.m_max[0][k]), x0));
+    m = _mm_and_ps(m, _mm_cmple_ps(_mm_loadu_ps(&node.m_min[1][k]), y1));
+    m = _mm_and_ps(m, _mm_cmpge_ps(_mm_loadu_ps(&node.m_max[1][k]), y0));
+    m = _mm_and_ps(m, _mm_cmple_ps(_mm_loadu_ps(&node.m_min[2][k]), z1));
+    m = _mm_and_ps(m, _mm_cmpge_ps(_mm_loadu_ps(&node.m_max[2][k]), z0));
+    mask |= ((unsigned int)_mm_movemask_ps(m)) << k;
+  }
+#elif defined(ON_FROZEN_RTREE_NEON)
+  static const uint32_t lane_bit[4] = { 1, 2, 4, 8 };
+  const uint32x4_t bits = vld1q_u32(lane_bit);
+  const float32x4_t x0 = vdupq_n_f32(qmin[0]), y0 = vdupq_n_f32(qmin[1]), z0 = vdupq_n_f32(qmin[2]);
+  const float32x4_t x1 = vdupq_n_f32(qmax[0]), y1 = vdupq_n_f32(qmax[1]), z1 = vdupq_n_f32(qmax[2]);
+  for (int k = 0; k < ON_FrozenRTree_NODE_COUNT; k += 4)
+  {
+    uint32x4_t m = vandq_u32(
+      vcleq_f32(vld1q_f32(&node.m_min[0][k]), x1),
+      vcgeq_f32(vld1q_f32(&node.m_max[0][k]), x0));
+    m = vandq_u32(m, vcleq_f32(vld1q_f32(&node.m_min[1][k]), y1));
+    m = vandq_u32(m, vcgeq_f32(vld1q_f32(&node.m_max[1][k]), y0));
+    m = vandq_u32(m, vcleq_f32(vld1q_f32(&node.m_min[2][k]), z1));
+    m = vandq_u32(m, vcgeq_f32(vld1q_f32(&node.m_max[2][k]), z0));
+    mask |= ((unsigned int)vaddvq_u32(vandq_u32(m, bits))) << k;
+  }
+#else
+  for (int i = 0; i < ON_FrozenRTree_NODE_COUNT; ++i)
+  {
+    if (node.m_min[0][i] <= qmax[0] && node.m_max[0][i] >= qmin[0]
+      && node.m_min[1][i] <= qmax[1] && node.m_max[1][i] >= qmin[1]
+      && node.m_min[2][i] <= qmax[2] && node.m_max[2][i] >= qmin[2])
+      mask |= (1U << i);
+  }
+#endif
+  return mask & ((1U << node.m_count) - 1U);
+}
+
+/*
+Returns:
+  Bit i is set if the squared distance from center to the
+  bounding box of child i of node is <= r2.
+*/
+inline unsigned int ON_FrozenRTreeSphereOverlapMask(
+  const ON_FrozenRTreeNode& node,
+  const float center[3],
+  float r2
+  )
+{
+  unsigned int mask = 0;
+#if defined(ON_FROZEN_RTREE_SSE2)
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 cx = _mm_set1_ps(center[0]), cy = _mm_set1_ps(center[1]), cz = _mm_set1_ps(center[2]);
+  const __m128 rr = _mm_set1_ps(r2);
+  for (int k = 0; k < ON_FrozenRTree_NODE_COUNT; k += 4)
+  {
+    const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&node.m_min[0][k]), cx), _mm_sub_ps(cx, _mm_loadu_ps(&node.m_max[0][k]))), zero);
+    const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&node.m_min[1][k]), cy), _mm_sub_ps(cy, _mm_loadu_ps(&node.m_max[1][k]))), zero);
+    const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&node.m_min[2][k]), cz), _mm_sub_ps(cz, _mm_loadu_ps(&node.m_max[2][k]))), zero);
+    const __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    mask |= ((unsigned int)_mm_movemask_ps(_mm_cmple_ps(d2, rr))) << k;
+  }
+#elif defined(ON_FROZEN_RTREE_NEON)
+  static const uint32_t lane_bit[4] = { 1, 2, 4, 8 };
+  const uint32x4_t bits = vld1q_u32(lane_bit);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t cx = vdupq_n_f32(center[0]), cy = vdupq_n_f32(center[1]), cz = vdupq_n_f32(center[2]);
+  const float32x4_t rr = vdupq_n_f32(r2);
+  for (int k = 0; k < ON_FrozenRTree_NODE_COUNT; k += 4)
+  {
+    const float32x4_t dx = vmaxq_f32(vmaxq_f32(vsubq_f32(vld1q_f32(&node.m_min[0][k]), cx), vsubq_f32(cx, vld1q_f32(&node.m_max[0][k]))), zero);
+    const float32x4_t dy = vmaxq_f32(vmaxq_f32(vsubq_f32(vld1q_f32(&node.m_min[1][k]), cy), vsubq_f32(cy, vld1q_f32(&node.m_max[1][k]))), zero);
+    const float32x4_t dz = vmaxq_f32(vmaxq_f32(vsubq_f32(vld1q_f32(&node.m_min[2][k]), cz), vsubq_f32(cz, vld1q_f32(&node.m_max[2][k]))), zero);
+    const float32x4_t d2 = vaddq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vmulq_f32(dz, dz));
+    mask |= ((unsigned int)vaddvq_u32(vandq_u32(vcleq_f32(d2, rr), bits))) << k;
+  }
+#else
+  for (int i = 0; i < ON_FrozenRTree_NODE_COUNT; ++i)
+  {
+    float d2 = 0.0f;
+    for (int j = 0; j < 3; ++j)
+    {
+      float d = node.m_min[j][i] - center[j];
+      if (center[j] - node.m_max[j][i] > d)
+        d = center[j] - node.m_max[j][i];
+      if (d > 0.0f)
+        d2 += d * d;
+    }
+    if (d2 <= r2)
+      mask |= (1U << i);
+  }
+#endif
+  return mask & ((1U << node.m_count) - 1U);
+}
+
+// Box search region for ON_FrozenRTree::Internal_Search().
+// When dim = 2, the z coordinates are ignored.
+class ON_FrozenRTreeBoxQuery
+{
+public:
+  ON_FrozenRTreeBoxQuery(const double* a_min, const double* a_max, int dim)
+    : m_a_min(a_min)
+    , m_a_max(a_max)
+    , m_dim(dim)
+  {
+    m_min[2] = -HUGE_VALF;
+    m_max[2] = HUGE_VALF;
+    Update();
+  }
+
+  void Update()
+  {
+    for (int j = 0; j < m_dim; ++j)
+    {
+      m_min[j] = ON_FloatFloor(m_a_min[j]);
+      m_max[j] = ON_FloatCeil(m_a_max[j]);
+    }
+  }
+
+  unsigned int operator()(const ON_FrozenRTreeNode& node) const
+  {
+    return ON_FrozenRTreeBoxOverlapMask(node, m_min, m_max);
+  }
+
+private:
+  const double* m_a_min;
+  const double* m_a_max;
+  const int m_dim;
+  float m_min[3];
+  float m_max[3];
+};
+
+// Sphere search region for ON_FrozenRTree::Internal_Search().
+class ON_FrozenRTreeSphereQuery
+{
+public:
+  ON_FrozenRTreeSphereQuery(const ON_RTreeSphere* a_sphere)
+    : m_a_sphere(a_sphere)
+  {
+    Update();
+  }
+
+  void Update()
+  {
+    // The center is rounded to the nearest float and the distance
+    // calculation is done in float precision. The radius is padded
+    // to cover both errors so no overlapping box is missed.
+    double a = fabs(m_a_sphere->m_point[0]);
+    for (int j = 0; j < 3; ++j)
+    {
+      m_center[j] = (float)m_a_sphere->m_point[j];
+      if (fabs(m_a_sphere->m_point[j]) > a)
+        a = fabs(m_a_sphere->m_point[j]);
+    }
+    const double r = (m_a_sphere->m_radius > 0.0) ? m_a_sphere->m_radius : 0.0;
+    const double pad = 8.0 * ON_FLOAT_EPSILON * (a + r);
+    m_r2 = ON_FloatCeil((r + pad) * (r + pad));
+  }
+
+  unsigned int operator()(const ON_FrozenRTreeNode& node) const
+  {
+    return ON_FrozenRTreeSphereOverlapMask(node, m_center, m_r2);
+  }
+
+private:
+  const ON_RTreeSphere* m_a_sphere;
+  float m_center[3];
+  float m_r2;
+};
+
+// Capsule search region for ON_FrozenRTree::Internal_Search().
+// The SIMD box test against the capsule's bounding box rejects most
+// children. The remaining children are tested in double precision
+// with a slab test of the capsule segment against the child box
+// expanded by the capsule radius.
+class ON_FrozenRTreeCapsuleQuery
+{
+public:
+  ON_FrozenRTreeCapsuleQuery(const ON_RTreeCapsule* a_capsule)
+    : m_a_capsule(a_capsule)
+  {
+    Update();
+  }
+
+  void Update()
+  {
+    const ON_RTreeCapsule& c = *m_a_capsule;
+    m_t[0] = 0.0;
+    m_t[1] = 1.0;
+    if (c.m_domain[0] <= c.m_domain[1])
+    {
+      if (c.m_domain[0] < m_t[0])
+        m_t[0] = c.m_domain[0];
+      if (c.m_domain[1] > m_t[1])
+        m_t[1] = c.m_domain[1];
+    }
+    double a = 0.0;
+    for (int j = 0; j < 3; ++j)
+    {
+      m_P[j] = c.m_point[0][j];
+      m_D[j] = c.m_point[1][j] - c.m_point[0][j];
+      const double s0 = m_P[j] + m_t[0] * m_D[j];
+      const double s1 = m_P[j] + m_t[1] * m_D[j];
+      m_seg_min[j] = (s0 <= s1) ? s0 : s1;
+      m_seg_max[j] = (s0 <= s1) ? s1 : s0;
+      if (fabs(m_seg_min[j]) > a)
+        a = fabs(m_seg_min[j]);
+      if (fabs(m_seg_max[j]) > a)
+        a = fabs(m_seg_max[j]);
+    }
+    const double r = (c.m_radius > 0.0) ? c.m_radius : 0.0;
+    m_r = r + 4.0 * ON_EPSILON * (a + r);
+    for (int j = 0; j < 3; ++j)
+    {
+      m_min[j] = ON_FloatFloor(m_seg_min[j] - m_r);
+      m_max[j] = ON_FloatCeil(m_seg_max[j] + m_r);
+    }
+  }
+
+  unsigned int operator()(const ON_FrozenRTreeNode& node) const
+  {
+    unsigned int mask = ON_FrozenRTreeBoxOverlapMask(node, m_min, m_max);
+    for (int i = 0; i < node.m_count; ++i)
+    {
+      if (0 == (mask & (1U << i)))
+        continue;
+      ON_RTreeBBox rect;
+      for (int j = 0; j < 3; ++j)
+      {
+        rect.m_min[j] = (double)node.m_min[j][i] - m_r;
+        rect.m_max[j] = (double)node.m_max[j][i] + m_r;
+      }
+      if (!ON_RTreeClipRayToBBox(rect, m_P, m_D, m_t[0], m_t[1], nullptr))
+        mask &= ~(1U << i);
+    }
+    return mask;
+  }
+
+private:
+  const ON_RTreeCapsule* m_a_capsule;
+  double m_P[3];
+  double m_D[3];
+  double m_t[2];
+  double m_seg_min[3];
+  double m_seg_max[3];
+  double m_r;
+  float m_min[3];
+  float m_max[3];
+};
+
+inline bool ON_CALLBACK_CDECL ON_FrozenRTreeAppendInt(void* a_context, ON__INT_PTR a_id)
+{
+  ((ON_SimpleArray<int>*)a_context)->Append((int)a_id);
+  return true;
+}
+
+inline bool ON_CALLBACK_CDECL ON_FrozenRTreeAppendVoidPtr(void* a_context, ON__INT_PTR a_id)
+{
+  ((ON_SimpleArray<void*>*)a_context)->Append((void*)a_id);
+  return true;
+}
+
+inline void ON_FrozenRTree::Destroy()
+{
+  m_nodes.Destroy();
+  m_id.Destroy();
+  m_root = 0;
+}
+
+inline bool ON_FrozenRTree::Create(
+  const ON_RTree& rtree,
+  bool bMultithreaded
+  )
+{
+  // Collect the leaves in tree order.
+  ON_SimpleArray<ON_RTreeBBox> rect;
+  ON_SimpleArray<ON__INT_PTR> id;
+  const ON_RTreeNode* stack[32 * ON_RTree_MAX_NODE_COUNT];
+  int sp = 0;
+  if (nullptr != rtree.Root())
+    stack[sp++] = rtree.Root();
+  while (sp > 0)
+  {
+    const ON_RTreeNode* node = stack[--sp];
+    if (node->IsLeaf())
+    {
+      for (int i = 0; i < node->m_count; ++i)
+      {
+        rect.Append(node->m_branch[i].m_rect);
+        id.Append(node->m_branch[i].m_id);
+      }
+    }
+    else
+    {
+      for (int i = node->m_count - 1; i >= 0; --i)
+        stack[sp++] = node->m_branch[i].m_child;
+    }
+  }
+  return Create(rect.Array(), id.Array(), rect.UnsignedCount(), bMultithreaded);
+}
+
+inline bool ON_FrozenRTree::Create(
+  const ON_RTreeBBox* a_rect,
+  const ON__INT_PTR* a_element_id,
+  size_t a_count,
+  bool bMultithreaded
+  )
+{
+  Destroy();
+  if (0 == a_count)
+    return true;
+
+  ON_SimpleArray<ON_RTreeBranch> level;
+  bool b3d = false;
+  if (!ON_RTreeGetBulkLoadBranches(a_rect, a_element_id, a_count, level, b3d))
+    return false;
+
+  const unsigned int thread_count
+    = bMultithreaded
+    ? ON_Parallel::ThreadCount(a_count, 0x4000)
+    : 1U;
+
+  const int N = ON_FrozenRTree_NODE_COUNT;
+  m_id.Reserve(a_count);
+  m_nodes.Reserve(a_count / (N - 1) + 1);
+  for (int node_level = 0; /*empty*/; ++node_level)
+  {
+    const int branch_count = level.Count();
+    const ON_RTreeBranch* branch = level.Array();
+    ON_RTreeSTRSort(level.Array(), (size_t)branch_count, N, b3d, thread_count);
+
+    const int node_count = (branch_count + N - 1) / N;
+    ON_SimpleArray<ON_RTreeBranch> parent_level(node_count);
+    for (int branch_index = 0; branch_index < branch_count; /*empty*/)
+    {
+      const ON__UINT32 node_index = m_nodes.UnsignedCount();
+      ON_FrozenRTreeNode& node = m_nodes.AppendNew();
+      node.m_level = node_level;
+      node.m_count = (branch_count - branch_index < N) ? (branch_count - branch_index) : N;
+
+      ON_RTreeBranch& parent = parent_level.AppendNew();
+      parent.m_rect = branch[branch_index].m_rect;
+      parent.m_id = (ON__INT_PTR)node_index;
+      for (int i = 0; i < N; ++i)
+      {
+        if (i >= node.m_count)
+        {
+          for (int j = 0; j < 3; ++j)
+          {
+            node.m_min[j][i] = ON_FLT_MAX;
+            node.m_max[j][i] = -ON_FLT_MAX;
+          }
+          continue;
+        }
+        const ON_RTreeBranch& b = branch[branch_index++];
+        for (int j = 0; j < 3; ++j)
+        {
+          node.m_min[j][i] = ON_FloatFloor(b.m_rect.m_min[j]);
+          node.m_max[j][i] = ON_FloatCeil(b.m_rect.m_max[j]);
+          if (b.m_rect.m_min[j] < parent.m_rect.m_min[j])
+            parent.m_rect.m_min[j] = b.m_rect.m_min[j];
+          if (b.m_rect.m_max[j] > parent.m_rect.m_max[j])
+            parent.m_rect.m_max[j] = b.m_rect.m_max[j];
+        }
+        if (0 == node_level)
+        {
+          node.m_child[i] = m_id.UnsignedCount();
+          m_id.Append(b.m_id);
+        }
+        else
+          node.m_child[i] = (ON__UINT32)b.m_id;
+      }
+    }
+
+    if (1 == node_count)
+    {
+      m_root = (ON__UINT32)parent_level[0].m_id;
+      break;
+    }
+    level = std::move(parent_level);
+  }
+
+  return true;
+}
+
+template <class OverlapMask>
+bool ON_FrozenRTree::Internal_Search(
+  OverlapMask& overlap_mask,
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+  void* a_context
+  ) const
+{
+  if (m_nodes.Count() <= 0 || nullptr == resultCallback)
+    return true;
+
+  const ON_FrozenRTreeNode* nodes = m_nodes.Array();
+  const ON__INT_PTR* id = m_id.Array();
+
+  // The tree depth is at most 11 for 2^32 elements, so the
+  // stack never holds more than 11*(N-1)+1 node indices.
+  ON__UINT32 stack[32 * ON_FrozenRTree_NODE_COUNT];
+  int sp = 0;
+  stack[sp++] = m_root;
+  while (sp > 0)
+  {
+    const ON_FrozenRTreeNode& node = nodes[stack[--sp]];
+    unsigned int mask = overlap_mask(node);
+    if (node.m_level > 0)
+    {
+      // push in reverse order so children are searched in order
+      for (int i = node.m_count - 1; i >= 0; --i)
+      {
+        if (0 != (mask & (1U << i)))
+          stack[sp++] = node.m_child[i];
+      }
+    }
+    else
+    {
+      for (int i = 0; i < node.m_count; ++i)
+      {
+        if (0 == (mask & (1U << i)))
+          continue;
+        if (!resultCallback(a_context, id[node.m_child[i]]))
+          return false;
+        // the callback may have shrunk the search region
+        overlap_mask.Update();
+        mask &= overlap_mask(node);
+      }
+    }
+  }
+  return true;
+}
+
+inline bool ON_FrozenRTree::Search(
+  const double a_min[3],
+  const double a_max[3],
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+  void* a_context
+  ) const
+{
+  ON_FrozenRTreeBoxQuery q(a_min, a_max, 3);
+  return Internal_Search(q, resultCallback, a_context);
+}
+
+inline bool ON_FrozenRTree::Search(
+  ON_RTreeBBox* a_rect,
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+  void* a_context
+  ) const
+{
+  if (nullptr == a_rect)
+    return false;
+  ON_FrozenRTreeBoxQuery q(a_rect->m_min, a_rect->m_max, 3);
+  return Internal_Search(q, resultCallback, a_context);
+}
+
+inline bool ON_FrozenRTree::Search(
+  ON_RTreeSphere* a_sphere,
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+  void* a_context
+  ) const
+{
+  if (nullptr == a_sphere)
+    return false;
+  ON_FrozenRTreeSphereQuery q(a_sphere);
+  return Internal_Search(q, resultCallback, a_context);
+}
+
+inline bool ON_FrozenRTree::Search(
+  ON_RTreeCapsule* a_capsule,
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+  void* a_context
+  ) const
+{
+  if (nullptr == a_capsule)
+    return false;
+  ON_FrozenRTreeCapsuleQuery q(a_capsule);
+  return Internal_Search(q, resultCallback, a_context);
+}
+
+inline bool ON_FrozenRTree::Search(
+  const double a_min[3],
+  const double a_max[3],
+  ON_SimpleArray<int>& a_result
+  ) const
+{
+  return Search(a_min, a_max, ON_FrozenRTreeAppendInt, &a_result);
+}
+
+inline bool ON_FrozenRTree::Search(
+  const double a_min[3],
+  const double a_max[3],
+  ON_SimpleArray<void*>& a_result
+  ) const
+{
+  return Search(a_min, a_max, ON_FrozenRTreeAppendVoidPtr, &a_result);
+}
+
+inline bool ON_FrozenRTree::Search2d(
+  const double a_min[2],
+  const double a_max[2],
+  bool ON_CALLBACK_CDECL resultCallback(void* a_context, ON__INT_PTR a_id),
+  void* a_context
+  ) const
+{
+  ON_FrozenRTreeBoxQuery q(a_min, a_max, 2);
+  return Internal_Search(q, resultCallback, a_context);
+}
+
+inline bool ON_FrozenRTree::Search2d(
+  const double a_min[2],
+  const double a_max[2],
+  ON_SimpleArray<int>& a_result
+  ) const
+{
+  return Search2d(a_min, a_max, ON_FrozenRTreeAppendInt, &a_result);
+}
+
+inline bool ON_FrozenRTree::Search2d(
+  const double a_min[2],
+  const double a_max[2],
+  ON_SimpleArray<void*>& a_result
+  ) const
+{
+  return Search2d(a_min, a_max, ON_FrozenRTreeAppendVoidPtr, &a_result);
+}
+
+inline unsigned int ON_FrozenRTree::ElementCount() const
+{
+  return m_id.UnsignedCount();
+}
+
+inline unsigned int ON_FrozenRTree::NodeCount() const
+{
+  return m_nodes.UnsignedCount();
+}
+
+inline const ON_FrozenRTreeNode* ON_FrozenRTree::Root() const
+{
+  return (m_nodes.Count() > 0) ? &m_nodes[(int)m_root] : nullptr;
+}
+
+inline const ON_FrozenRTreeNode* ON_FrozenRTree::Node(ON__UINT32 node_index) const
+{
+  return (node_index < m_nodes.UnsignedCount()) ? &m_nodes[(int)node_index] : nullptr;
+}
+
+inline ON__INT_PTR ON_FrozenRTree::ElementId(ON__UINT32 element_index) const
+{
+  return (element_index < m_id.UnsignedCount()) ? m_id[(int)element_index] : 0;
+}
+
+inline ON_BoundingBox ON_FrozenRTree::BoundingBox() const
+{
+  const ON_FrozenRTreeNode* root = Root();
+  if (nullptr == root || root->m_count <= 0)
+    return ON_BoundingBox::EmptyBoundingBox;
+  double bmin[3], bmax[3];
+  for (int j = 0; j < 3; ++j)
+  {
+    bmin[j] = root->m_min[j][0];
+    bmax[j] = root->m_max[j][0];
+    for (int i = 1; i < root->m_count; ++i)
+    {
+      if (root->m_min[j][i] < bmin[j])
+        bmin[j] = root->m_min[j][i];
+      if (root->m_max[j][i] > bmax[j])
+        bmax[j] = root->m_max[j][i];
+    }
+  }
+  return ON_BoundingBox(ON_3dPoint(bmin), ON_3dPoint(bmax));
+}
+
+inline size_t ON_FrozenRTree::SizeOf() const
+{
+  return sizeof(*this)
+    + ((size_t)m_nodes.Capacity()) * sizeof(ON_FrozenRTreeNode)
+    + ((size_t)m_id.Capacity()) * sizeof(ON__INT_PTR);
+}
+
+#endif
@@ -0,0 +1,98 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_SMALL_ARRAY_INC_)
+#define OPENNURBS_SMALL_ARRAY_INC_
+
+/*
+Description:
+  An ON_SimpleArray that keeps up to N elements in a buffer inside the
+  class. Arrays that never hold more than N elements do no heap
+  allocation. When the capacity grows past N, the elements are copied
+  to memory from onmalloc() and the array works like an ON_SimpleArray.
+Remarks:
+  - ON_SmallArray<T,N> is an ON_SimpleArray<T> and can be passed to
+    functions that take an ON_SimpleArray<T>& or const ON_SimpleArray<T>&.
+  - Use MoveTo() to move the elements into an ON_SimpleArray. Do not
+    use the ON_SimpleArray move constructor or move assignment,
+    KeepArray(), or SetArray() on an ON_SmallArray. They assume the
+    memory is from onmalloc().
+  - As with ON_SimpleArray, T must be a type that can be copied with memcpy().
+  - Delete ON_SmallArray instances as ON_SmallArray.
+Example:
+
+        // No heap allocation unless a vertex has more than 8 edges.
+        ON_SmallArray<ON_SubDEdgePtr, 8> edges;
+
+*/
+template <class T, int N>
+class ON_SmallArray : public ON_SimpleArray<T>
+{
+public:
+  static_assert(N > 0, "N must be positive.");
+
+  ON_SmallArray() ON_NOEXCEPT;
+
+  // initial capacity
+  ON_SmallArray(
+    size_t capacity
+    );
+
+  ~ON_SmallArray();
+
+  ON_SmallArray(const ON_SmallArray<T, N>& src);
+  ON_SmallArray<T, N>& operator=(const ON_SmallArray<T, N>& src);
+
+  ON_SmallArray(const ON_SimpleArray<T>& src);
+  ON_SmallArray<T, N>& operator=(const ON_SimpleArray<T>& src);
+
+#if defined(ON_HAS_RVALUEREF)
+  // The heap memory of src is moved. Inline elements are copied.
+  ON_SmallArray(ON_SmallArray<T, N>&& src) ON_NOEXCEPT;
+  ON_SmallArray<T, N>& operator=(ON_SmallArray<T, N>&& src) ON_NOEXCEPT;
+
+  // src must be an ON_SimpleArray that uses onrealloc().
+  ON_SmallArray(ON_SimpleArray<T>&& src) ON_NOEXCEPT;
+  ON_SmallArray<T, N>& operator=(ON_SimpleArray<T>&& src) ON_NOEXCEPT;
+#endif
+
+  /*
+  Description:
+    Move the elements to dest. If the elements are on the heap, the memory
+    is given to dest. If they are in the inline buffer, they are copied.
+    When the function returns, this array is empty.
+  */
+  void MoveTo(
+    ON_SimpleArray<T>& dest
+    );
+
+  /*
+  Returns:
+    True if the elements are in the inline buffer.
+  */
+  bool UsesInlineBuffer() const;
+
+  T* Realloc(T* ptr, int capacity) override;
+
+private:
+  T* Internal_InlineBuffer();
+
+  void Internal_Move(ON_SmallArray<T, N>& src);
+
+private:
+  alignas(T) unsigned char m_inline_buffer[N * sizeof(T)];
+};
+
+#include "opennurbs_small_array_defs.h"
+
+#endif
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 1993-2022 Robert McNeel & Associates. All rights reserved.
+// OpenNURBS, Rhinoceros, and Rhino3D are registered trademarks of Robert
+// McNeel & Associates.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT EXPRESS OR IMPLIED WARRANTY.
+// ALL IMPLIED WARRANTIES OF FITNESS FOR ANY PARTICULAR PURPOSE AND OF
+// MERCHANTABILITY ARE HEREBY DISCLAIMED.
+//
+// For complete openNURBS copyright information see <http://www.opennurbs.org>.
+//
+////////////////////////////////////////////////////////////////
+
+#if !defined(OPENNURBS_SMALL_ARRAY_DEFS_INC_)
+#define OPENNURBS_SMALL_ARRAY_DEFS_INC_
+
+/////////////////////////////////////////////////////////////////////////////////////
+//  Class ON_SmallArray<>
+/////////////////////////////////////////////////////////////////////////////////////
+
+// The ON_SimpleArray constructors and destructor call the ON_SimpleArray
+// version of Realloc(), so the memory is allocated and freed in the
+// ON_SmallArray constructor and destructor bodies.
+
+template <class T, int N>
+ON_SmallArray<T, N>::ON_SmallArray() ON_NOEXCEPT
+  : ON_SimpleArray<T>()
+{}
+
+template <class T, int N>
+ON_SmallArray<T, N>::ON_SmallArray(
+  size_t capacity
+  )
+  : ON_SimpleArray<T>()
+{
+  if (capacity > 0)
+    this->SetCapacity(capacity);
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>::~ON_SmallArray()
+{
+  this->SetCapacity(0);
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>::ON_SmallArray(const ON_SmallArray<T, N>& src)
+  : ON_SimpleArray<T>()
+{
+  ON_SimpleArray<T>::operator=(src);
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>& ON_SmallArray<T, N>::operator=(const ON_SmallArray<T, N>& src)
+{
+  ON_SimpleArray<T>::operator=(src);
+  return *this;
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>::ON_SmallArray(const ON_SimpleArray<T>& src)
+  : ON_SimpleArray<T>()
+{
+  ON_SimpleArray<T>::operator=(src);
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>& ON_SmallArray<T, N>::operator=(const ON_SimpleArray<T>& src)
+{
+  ON_SimpleArray<T>::operator=(src);
+  return *this;
+}
+
+#if defined(ON_HAS_RVALUEREF)
+
+template <class T, int N>
+ON_SmallArray<T, N>::ON_SmallArray(ON_SmallArray<T, N>&& src) ON_NOEXCEPT
+  : ON_SimpleArray<T>()
+{
+  Internal_Move(src);
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>& ON_SmallArray<T, N>::operator=(ON_SmallArray<T, N>&& src) ON_NOEXCEPT
+{
+  if (this != &src)
+  {
+    this->Destroy();
+    Internal_Move(src);
+  }
+  return *this;
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>::ON_SmallArray(ON_SimpleArray<T>&& src) ON_NOEXCEPT
+  : ON_SimpleArray<T>()
+{
+  const int count = src.Count();
+  const int capacity = src.Capacity();
+  this->m_a = src.KeepArray();
+  if (nullptr != this->m_a)
+  {
+    this->m_count = count;
+    this->m_capacity = capacity;
+  }
+}
+
+template <class T, int N>
+ON_SmallArray<T, N>& ON_SmallArray<T, N>::operator=(ON_SimpleArray<T>&& src) ON_NOEXCEPT
+{
+  if (this != &src)
+  {
+    this->Destroy();
+    const int count = src.Count();
+    const int capacity = src.Capacity();
+    this->m_a = src.KeepArray();
+    if (nullptr != this->m_a)
+    {
+      this->m_count = count;
+      this->m_capacity = capacity;
+    }
+  }
+  return *this;
+}
+
+#endif
+
+template <class T, int N>
+void ON_SmallArray<T, N>::MoveTo(
+  ON_SimpleArray<T>& dest
+  )
+{
+  if (this == &dest)
+    return;
+  if (UsesInlineBuffer())
+  {
+    dest = *this;
+    this->m_count = 0;
+    return;
+  }
+  dest.Destroy();
+  if (nullptr != this->m_a)
+  {
+    // dest is empty, so SetArray() does not free anything.
+    dest.SetArray(this->m_a, this->m_count, this->m_capacity);
+    this->m_a = nullptr;
+    this->m_count = 0;
+    this->m_capacity = 0;
+  }
+}
+
+template <class T, int N>
+bool ON_SmallArray<T, N>::UsesInlineBuffer() const
+{
+  return this->m_a == (const T*)m_inline_buffer;
+}
+
+template <class T, int N>
+T* ON_SmallArray<T, N>::Realloc(T* ptr, int capacity)
+{
+  T* inline_buffer = Internal_InlineBuffer();
+  if (ptr == inline_buffer)
+  {
+    if (capacity <= 0)
+      return nullptr;
+    if (capacity <= N)
+      return inline_buffer;
+    // Realloc() is called before m_capacity is changed.
+    T* a = (T*)onmalloc(capacity * sizeof(T));
+    if (nullptr != a && this->m_capacity > 0)
+      memcpy((void*)a, (const void*)inline_buffer, this->m_capacity * sizeof(T));
+    return a;
+  }
+  if (nullptr == ptr && capacity > 0 && capacity <= N)
+    return inline_buffer;
+  return ON_SimpleArray<T>::Realloc(ptr, capacity);
+}
+
+template <class T, int N>
+T* ON_SmallArray<T, N>::Internal_InlineBuffer()
+{
+  return (T*)m_inline_buffer;
+}
+
+template <class T, int N>
+void ON_SmallArray<T, N>::Internal_Move(ON_SmallArray<T, N>& src)
+{
+  // this array is empty
+  if (src.UsesInlineBuffer())
+  {
+    ON_SimpleArray<T>::operator=(src);
+    src.m_count = 0;
+    return;
+  }
+  this->m_a = src.m_a;
+  this->m_count = src.m_count;
+  this->m_capacity = src.m_capacity;
+  src.m_a = nullptr;
+  src.m_count = 0;
+  src.m_capacity = 0;
+}
+
+#endif
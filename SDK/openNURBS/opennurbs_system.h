@@ -589,6 +589,10 @@ typedef ON__UINT32 wchar_t;
 #include <locale>  // for call create_locale(LC_ALL,"C") in ON_Locale().
 #pragma ON_PRAGMA_WARNING_AFTER_DIRTY_INCLUDE
 
+#pragma ON_PRAGMA_WARNING_BEFORE_DIRTY_INCLUDE
+#include <algorithm>  // for std::sort, std::inplace_merge, std::nth_element
+#pragma ON_PRAGMA_WARNING_AFTER_DIRTY_INCLUDE
+
 #pragma ON_PRAGMA_WARNING_BEFORE_DIRTY_INCLUDE
 #include <atomic>  // for std:atomic<type>
 #pragma ON_PRAGMA_WARNING_AFTER_DIRTY_INCLUDE